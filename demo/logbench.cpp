@@ -47,15 +47,18 @@ namespace bench
       unsigned long count;
       unsigned long loops;
       unsigned long enabled;
+      bool info;
 
     public:
       Logtester(unsigned long count_,
                 unsigned long loops_,
-                unsigned long enabled_)
+                unsigned long enabled_,
+                bool info_ = false)
         : thread( cxxtools::callable(*this, &Logtester::run) ),
           count(count_),
           loops(loops_),
-          enabled(enabled_)
+          enabled(enabled_),
+          info(info_)
           { }
 
       void start()
@@ -71,38 +74,14 @@ namespace bench
       void run();
   };
 
-  void Logtester::run()
-  {
-    for (unsigned long l = 0; l < loops; ++l)
-    {
-      if (enabled)
-        for (unsigned long i = 0; i < count; ++i)
-          log_fatal("fatal message");
-      else
-        for (unsigned long i = 0; i < count; ++i)
-          log_debug("info message");
-    }
-  }
-}
+  typedef std::vector<cxxtools::SmartPtr<Logtester> > Threads;
 
-int main(int argc, char* argv[])
-{
-  try
+  // doubles the message count until the runtime exceeds total seconds;
+  // returns messages per second of the last round
+  double measure(Threads& threads, unsigned long loops, double total)
   {
-    cxxtools::Arg<bool> enable(argc, argv, 'e');
-    cxxtools::Arg<double> total(argc, argv, 'T', 5.0); // minimum runtime
-    cxxtools::Arg<long> loops(argc, argv, 'l', 1000);
-    cxxtools::Arg<unsigned> numthreads(argc, argv, 't', 1);
-
     unsigned long count = 1;
-    double T;
-
-    log_init();
-
-    typedef std::vector<cxxtools::SmartPtr<bench::Logtester> > Threads;
-    Threads threads;
-    for (unsigned t = 0; t < numthreads; ++t)
-      threads.push_back(new bench::Logtester(count, loops.getValue() / numthreads.getValue(), enable));
+    double rate = 0;
 
     while (count > 0)
     {
@@ -128,14 +107,18 @@ int main(int argc, char* argv[])
           (*it)->join();
       }
 
+      // messages of the asynchronous logger are written, when they are visible
+      cxxtools::LogManager::getInstance().flush();
+
       gettimeofday(&tv1, 0);
 
       double t0 = tv0.tv_sec + tv0.tv_usec / 1e6;
       double t1 = tv1.tv_sec + tv1.tv_usec / 1e6;
-      T = t1 - t0;
+      double T = t1 - t0;
+      rate = count / T * loops;
 
       std::cout.precision(6);
-      std::cout << " T=" << T << '\t' << std::setprecision(12) << (count / T * loops)
+      std::cout << " T=" << T << '\t' << std::setprecision(12) << rate
         << " msg/s" << std::endl;
 
       if (T >= total)
@@ -144,6 +127,88 @@ int main(int argc, char* argv[])
       count <<= 1;
     }
 
+    return rate;
+  }
+
+  void Logtester::run()
+  {
+    for (unsigned long l = 0; l < loops; ++l)
+    {
+      if (info)
+        for (unsigned long i = 0; i < count; ++i)
+          log_info("info message");
+      else if (enabled)
+        for (unsigned long i = 0; i < count; ++i)
+          log_fatal("fatal message");
+      else
+        for (unsigned long i = 0; i < count; ++i)
+          log_debug("info message");
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    cxxtools::Arg<bool> enable(argc, argv, 'e');
+    cxxtools::Arg<double> total(argc, argv, 'T', 5.0); // minimum runtime
+    cxxtools::Arg<long> loops(argc, argv, 'l', 1000);
+    cxxtools::Arg<unsigned> numthreads(argc, argv, 't', 1);
+    cxxtools::Arg<bool> async(argc, argv, 'a');            // use asynchronous logging
+    cxxtools::Arg<unsigned> bufferSize(argc, argv, 'b', 65536);
+    cxxtools::Arg<bool> drop(argc, argv, 'd');             // drop messages on overflow
+    cxxtools::Arg<bool> compare(argc, argv, 'C');          // compare synchronous and asynchronous logging
+    cxxtools::Arg<std::string> file(argc, argv, 'f', "logbench.log");
+
+    log_init();
+
+    cxxtools::LogConfiguration config = cxxtools::LogManager::getInstance().getLogConfiguration();
+    if (compare)
+    {
+      config.setFile(file);
+      // fatal messages are flushed immediately in asynchronous mode
+      config.setRootLevel(cxxtools::Logger::INFO);
+    }
+
+    cxxtools::LogConfiguration::OverflowPolicy policy = drop ? cxxtools::LogConfiguration::DropOnOverflow
+                                                              : cxxtools::LogConfiguration::BlockOnOverflow;
+
+    bench::Threads threads;
+    for (unsigned t = 0; t < numthreads; ++t)
+      threads.push_back(new bench::Logtester(1, loops.getValue() / numthreads.getValue(), enable, compare));
+
+    if (compare)
+    {
+      std::cout << "synchronous logging with " << numthreads.getValue() << " threads" << std::endl;
+      config.setSync();
+      cxxtools::LogManager::logInit(config);
+      double syncRate = bench::measure(threads, loops, total);
+
+      std::cout << "asynchronous logging with " << numthreads.getValue() << " threads" << std::endl;
+      config.setAsync(bufferSize, policy);
+      cxxtools::LogManager::logInit(config);
+      double asyncRate = bench::measure(threads, loops, total);
+
+      std::cout.precision(3);
+      std::cout << "sync " << std::setprecision(12) << syncRate << " msg/s\t"
+                   "async " << asyncRate << " msg/s\t"
+                   "speedup " << std::setprecision(3) << (asyncRate / syncRate) << '\n'
+                << "dropped " << cxxtools::LogManager::getInstance().droppedMessages() << std::endl;
+    }
+    else
+    {
+      if (async)
+      {
+        config.setAsync(bufferSize, policy);
+        cxxtools::LogManager::logInit(config);
+      }
+
+      bench::measure(threads, loops, total);
+
+      if (async)
+        std::cout << "dropped " << cxxtools::LogManager::getInstance().droppedMessages() << std::endl;
+    }
   }
   catch (const std::exception& e)
   {
@@ -151,4 +216,3 @@ int main(int argc, char* argv[])
     return -1;
   }
 }
-
@@ -31,6 +31,9 @@
 
 #include <cxxtools/deserializer.h>
 #include <cxxtools/bin/serializer.h>
+#include <vector>
+#include <set>
+#include <string>
 
 namespace cxxtools
 {
@@ -45,11 +48,43 @@ namespace bin
                 : _in(in)
             { }
 
+            using cxxtools::Deserializer::deserialize;
+
+            /// Vectors of numbers are read directly from packed arrays.
+            /// Other representations are read the normal way.
+            void deserialize(std::vector<signed char>& v);
+            void deserialize(std::vector<unsigned char>& v);
+            void deserialize(std::vector<short>& v);
+            void deserialize(std::vector<unsigned short>& v);
+            void deserialize(std::vector<int>& v);
+            void deserialize(std::vector<unsigned int>& v);
+            void deserialize(std::vector<long>& v);
+            void deserialize(std::vector<unsigned long>& v);
+#ifdef HAVE_LONG_LONG
+            void deserialize(std::vector<long long>& v);
+#endif
+#ifdef HAVE_UNSIGNED_LONG_LONG
+            void deserialize(std::vector<unsigned long long>& v);
+#endif
+            void deserialize(std::vector<float>& v);
+            void deserialize(std::vector<double>& v);
+
+            /// Reads only object members with one of the given names.
+            /// Other members are skipped without building values for them.
+            /// Skipping is fast, when the input was written with sized
+            /// containers (see Formatter::useSizedContainers).
+            void projection(const std::set<std::string>& members)
+            { _projection = members; }
+
+            void clearProjection()
+            { _projection.clear(); }
+
         protected:
             void doDeserialize();
 
         private:
             std::istream& _in;
+            std::set<std::string> _projection;
     };
 }
 }
@@ -31,6 +31,10 @@
 
 #include <cxxtools/formatter.h>
 #include <cxxtools/textstream.h>
+#include <map>
+#include <vector>
+#include <sstream>
+#include <stdint.h>
 
 namespace cxxtools
 {
@@ -47,6 +51,64 @@ namespace cxxtools
 
                 void finish();
 
+                /// Enables the name dictionary.
+                ///
+                /// The first occurence of a member or type name in a value
+                /// defines an index, which is used instead of the name
+                /// later. This reduces the size of arrays of objects a lot,
+                /// but the output cannot be read by versions of cxxtools,
+                /// which do not know the dictionary. Such values start with
+                /// Serializer::NameDictionary; in other values names are
+                /// never read as references.
+                void useDictionary(bool sw)
+                { _useDictionary = sw; }
+
+                bool useDictionary() const
+                { return _useDictionary; }
+
+                /// By default the dictionary is cleared for each top level
+                /// value. When keepDictionary is set, names are defined only
+                /// once for all values written until the dictionary is
+                /// cleared explicitly. The reader must do the same.
+                void keepDictionary(bool sw)
+                { _keepDictionary = sw; }
+
+                bool keepDictionary() const
+                { return _keepDictionary; }
+
+                void clearDictionary();
+
+                /// Writes objects and arrays with their element count and
+                /// byte length. Readers reserve memory for the elements and
+                /// skip unwanted members without parsing them. A top level
+                /// container is kept in memory until it is complete, since
+                /// the lengths are known only then.
+                void useSizedContainers(bool sw)
+                { _useSizedContainers = sw; }
+
+                bool useSizedContainers() const
+                { return _useSizedContainers; }
+
+                /// Writes an array of numbers as raw little endian values.
+                /// Readers get the same events as for a normal array, but
+                /// writing and reading is much faster.
+                void addPackedArray(const std::string& name, const signed char* data, std::size_t count);
+                void addPackedArray(const std::string& name, const unsigned char* data, std::size_t count);
+                void addPackedArray(const std::string& name, const short* data, std::size_t count);
+                void addPackedArray(const std::string& name, const unsigned short* data, std::size_t count);
+                void addPackedArray(const std::string& name, const int* data, std::size_t count);
+                void addPackedArray(const std::string& name, const unsigned int* data, std::size_t count);
+                void addPackedArray(const std::string& name, const long* data, std::size_t count);
+                void addPackedArray(const std::string& name, const unsigned long* data, std::size_t count);
+#ifdef HAVE_LONG_LONG
+                void addPackedArray(const std::string& name, const long long* data, std::size_t count);
+#endif
+#ifdef HAVE_UNSIGNED_LONG_LONG
+                void addPackedArray(const std::string& name, const unsigned long long* data, std::size_t count);
+#endif
+                void addPackedArray(const std::string& name, const float* data, std::size_t count);
+                void addPackedArray(const std::string& name, const double* data, std::size_t count);
+
                 virtual void addValueString(const std::string& name, const std::string& type,
                                       const cxxtools::String& value);
 
@@ -80,8 +142,38 @@ namespace cxxtools
                 virtual void finishObject();
 
             private:
+                void beginValue();
+                void printName(const std::string& name);
+                void printTypeCode(const std::string& type, bool plain);
+                void printNumber(char typeCode, uint64_t v, unsigned size, const std::string& name);
+                void printUInt(uint64_t v, const std::string& name);
+                void printInt(int64_t v, const std::string& name);
+                void printPackedArray(const std::string& name, unsigned char typeCode,
+                                      const char* data, unsigned size, std::size_t count);
+                void beginSized();
+                void beginSizedContent();
+                void finishSized();
+
                 std::ostream* _out;
                 TextOStream _ts;
+
+                typedef std::map<std::string, unsigned> Dictionary;
+                Dictionary _dictionary;
+                bool _useDictionary;
+                bool _keepDictionary;
+                unsigned _level;
+
+                struct SizedContainer
+                {
+                    std::streampos pos;  // position of the count
+                    uint32_t count;
+                    unsigned level;
+                };
+
+                bool _useSizedContainers;
+                std::vector<SizedContainer> _sizedContainers;
+                std::stringstream _sizedBuffer;
+                std::ostream* _target;  // receives the buffer, when the top level container is complete
         };
 
     }
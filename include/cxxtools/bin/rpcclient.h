@@ -91,6 +91,8 @@ class RpcClient : public RemoteClient
 
         void cancel();
 
+        void cancelCall(IRemoteProcedure& proc);
+
         const std::string& domain() const;
 
         void domain(const std::string& p);
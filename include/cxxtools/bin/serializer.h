@@ -31,6 +31,8 @@
 
 #include <cxxtools/bin/formatter.h>
 #include <cxxtools/decomposer.h>
+#include <cxxtools/valuewriter.h>
+#include <vector>
 
 namespace cxxtools
 {
@@ -93,6 +95,8 @@ namespace cxxtools
                     TypePlainShortFloat = 0x61, // 1 bit sign, 7 bit exponent, 16 bit mantissa
                     TypePlainMediumFloat = 0x62,  // 1 bit sign, 7 bit exponent, 32 bit mantissa
                     TypePlainLongFloat = 0x63,  // 1 bit sign, 15 bit exponent, 64 bit mantissa
+                    TypePlainFloat32 = 0x64,    // IEEE 754 single, element type of packed arrays only
+                    TypePlainFloat64 = 0x65,    // IEEE 754 double, element type of packed arrays only
                     TypePlainPair = 0x70,
                     TypePlainArray = 0x71,
                     TypePlainVector = 0x72,
@@ -106,9 +110,19 @@ namespace cxxtools
                     CategoryObject = 0xa0,
                     CategoryArray = 0xa1,
                     CategoryReference = 0xa2,
+                    CategoryPackedArray = 0xa3, // followed by zero terminated name, element type code,
+                                                // 4 byte element count and the elements in little endian
+                    CategorySizedObject = 0xa4, // like CategoryObject, but the type is followed by
+                                                // 4 byte member count and 4 byte length of the members
+                                                // including the end marker
+                    CategorySizedArray = 0xa5,  // like CategoryArray with element count and length
                     RpcRequest = 0xc0,
                     RpcResponse = 0xc1,
                     RpcException = 0xc2,
+                    NameDictionary = 0xfb,  // precedes a value, whose names may use the name dictionary
+                    NameReference16 = 0xfc, // instead of a name: 2 byte index into the name dictionary
+                    NameReference8 = 0xfd,  // instead of a name: 1 byte index into the name dictionary
+                    NameDefinition = 0xfe,  // followed by zero terminated name, which gets the next index
                     Eod = 0xff
                 };
 
@@ -146,10 +160,127 @@ namespace cxxtools
                     return *this;
                 }
 
+                /// Vectors of numbers are written as packed arrays.
+                template <typename T, typename A>
+                Serializer& serialize(const std::vector<T, A>& v, const std::string& name)
+                {
+                    if (!formatPacked(v, name))
+                    {
+                        Decomposer<std::vector<T, A> > s;
+                        s.begin(v);
+                        s.setName(name);
+                        s.format(_formatter);
+                    }
+                    return *this;
+                }
+
+                template <typename T, typename A>
+                Serializer& serialize(const std::vector<T, A>& v)
+                { return serialize(v, std::string()); }
+
+                /// Like serialize but writes the value with a ValueWriter directly to the formatter.
+                template <typename T>
+                Serializer& serializeDirect(const T& v, const std::string& name)
+                {
+                    ValueWriter w(_formatter, name);
+                    w <<= v;
+                    return *this;
+                }
+
+                template <typename T>
+                Serializer& serializeDirect(const T& v)
+                {
+                    ValueWriter w(_formatter);
+                    w <<= v;
+                    return *this;
+                }
+
+                template <typename T, typename A>
+                Serializer& serializeDirect(const std::vector<T, A>& v, const std::string& name)
+                {
+                    if (!formatPacked(v, name))
+                    {
+                        ValueWriter w(_formatter, name);
+                        w <<= v;
+                    }
+                    return *this;
+                }
+
+                template <typename T, typename A>
+                Serializer& serializeDirect(const std::vector<T, A>& v)
+                { return serializeDirect(v, std::string()); }
+
                 void finish()
                 { }
 
+                /// Writes repeated member and type names as references into
+                /// a name dictionary (see Formatter::useDictionary).
+                Serializer& useDictionary(bool sw)
+                {
+                    _formatter.useDictionary(sw);
+                    return *this;
+                }
+
+                /// Writes objects and arrays with element count and byte
+                /// length (see Formatter::useSizedContainers).
+                Serializer& useSizedContainers(bool sw)
+                {
+                    _formatter.useSizedContainers(sw);
+                    return *this;
+                }
+
             private:
+                template <typename T, typename A>
+                bool formatPacked(const std::vector<T, A>& v, const std::string& name)
+                { return false; }
+
+                template <typename T>
+                bool formatPackedArray(const std::vector<T>& v, const std::string& name)
+                {
+                    _formatter.addPackedArray(name, v.empty() ? 0 : &v[0], v.size());
+                    return true;
+                }
+
+                bool formatPacked(const std::vector<signed char>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<unsigned char>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<short>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<unsigned short>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<int>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<unsigned int>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<long>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<unsigned long>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+#ifdef HAVE_LONG_LONG
+                bool formatPacked(const std::vector<long long>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+#endif
+
+#ifdef HAVE_UNSIGNED_LONG_LONG
+                bool formatPacked(const std::vector<unsigned long long>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+#endif
+
+                bool formatPacked(const std::vector<float>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
+                bool formatPacked(const std::vector<double>& v, const std::string& name)
+                { return formatPackedArray(v, name); }
+
                 Formatter _formatter;
         };
     }
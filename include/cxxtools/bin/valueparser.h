@@ -30,6 +30,9 @@
 #define CXXTOOLS_BIN_VALUEPARSER_H
 
 #include <cxxtools/serializationinfo.h>
+#include <string>
+#include <vector>
+#include <set>
 
 namespace cxxtools
 {
@@ -46,7 +49,10 @@ class ValueParser
 
     public:
         ValueParser()
-            : _next(0)
+            : _next(0),
+              _keepDictionary(false),
+              _projection(0),
+              _context(&_ownContext)
         { }
 
         ~ValueParser() 
@@ -63,7 +69,64 @@ class ValueParser
         DeserializerBase* current()
         { return _deserializer; }
 
+        /// When set, names defined in the name dictionary are kept for the
+        /// following values until the dictionary is cleared explicitly.
+        /// Must match the setting of the formatter.
+        void keepDictionary(bool sw)
+        { _keepDictionary = sw; }
+
+        bool keepDictionary() const
+        { return _keepDictionary; }
+
+        void clearDictionary()
+        { _context->dictionarySize = 0; }
+
+        /// Reads only object members with one of the given names. Other
+        /// members are skipped without passing them to the deserializer.
+        /// Objects in arrays are filtered as well, while selected members
+        /// are read completely. The set must be kept valid while parsing.
+        /// Pass 0 to read all members.
+        void projection(const std::set<std::string>* members)
+        { _projection = members; }
+
+        /// Returns the number of bytes, which the parser would ignore now
+        /// when skipping a sized container. The caller may drop them from
+        /// the input and call skipBytes instead of passing each byte to
+        /// advance.
+        std::size_t skipAvailable() const
+        { return _context->skip > 1 ? _context->skip - 1 : 0; }
+
+        void skipBytes(std::size_t n)
+        { _context->skip -= n; }
+
     private:
+        // State shared by a parser and its nested parsers.
+        struct Context
+        {
+            Context()
+                : dictionary(false),
+                  dictionarySize(0),
+                  skip(0)
+            { }
+
+            // set, when the value is announced with Serializer::NameDictionary;
+            // names are read as plain strings otherwise
+            bool dictionary;
+
+            // Names defined with Serializer::NameDefinition. The strings are
+            // reused, when the dictionary is cleared, so that resolving names
+            // does not allocate memory once the parser is warmed up.
+            std::vector<std::string> names;
+            unsigned dictionarySize;
+
+            // remaining bytes of a skipped sized container
+            std::size_t skip;
+        };
+
+        bool readString(char ch);
+        ValueParser* next();
+        void beginMember(DeserializerBase& handler);
+        void replayType();
 
         bool processFloatBase(char ch, unsigned shift, unsigned expOffset);
         enum State
@@ -95,16 +158,51 @@ class ValueParser
             state_array_member,
             state_array_member_value,
             state_array_member_value_next,
+            state_packed_type,
+            state_packed_count,
+            state_packed_element,
+            state_sized_header,
+            state_skip,
             state_end
         } _state, _nextstate;
 
+        void beginContent(State contentState);
+
+        enum StringState
+        {
+            string_begin,
+            string_plain,
+            string_definition,
+            string_reference
+        } _stringState;
+
         std::string _token;
         unsigned _count;
         uint64_t _int;
         int _exp;
         bool _isNeg;
+        unsigned char _packedType;
+        unsigned _elementSize;
+        unsigned _elementByte;
+        bool _sized;
+        uint32_t _elements;
         DeserializerBase* _deserializer;
         ValueParser* _next;
+
+        // A member, which is read only if its name is in the projection.
+        // Nothing is passed to the handler, until the name is known.
+        DeserializerBase* _memberHandler;
+        bool _memberOpen;
+        unsigned char _typeCode;
+        std::string _typeName;
+
+        unsigned _nameIndex;
+        unsigned _nameBytes;
+        const std::string* _string;  // string read by readString
+        bool _keepDictionary;
+        const std::set<std::string>* _projection;
+        Context _ownContext;
+        Context* _context;           // shared with nested parsers
 };
 }
 }
@@ -29,6 +29,7 @@
 #define cxxtools_Callable_h
 
 #include <cxxtools/invokable.h>
+#include <cxxtools/poolallocator.h>
 
 namespace cxxtools {
 
@@ -300,6 +300,16 @@
             enum { NumArgs = 0 };
 
         public:
+            /**
+              Callables without arguments are cloned for each task passed
+              to a thread pool, so they are allocated from the pool allocator.
+            */
+            static void* operator new(std::size_t size)
+            { return PoolAllocator::global().allocate(size); }
+
+            static void operator delete(void* p, std::size_t size)
+            { PoolAllocator::global().deallocate(p, size); }
+
             /**
               Creates a copy of this object and returns it. Caller owns
               the returned object.
@@ -0,0 +1,611 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_CONCURRENTCACHE_H
+#define CXXTOOLS_CONCURRENTCACHE_H
+
+#include <cxxtools/atomicity.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/condition.h>
+#include <cxxtools/noncopyable.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/timespan.h>
+#include <string>
+#include <vector>
+
+namespace cxxtools
+{
+    /// Hash function for the keys of a ConcurrentCache. Integral types and
+    /// strings are supported. Other key types need a specialization or a
+    /// hash functor passed as template parameter to the cache.
+    template <typename Key>
+    struct CacheHash
+    {
+        std::size_t operator() (const Key& key) const
+        { return static_cast<std::size_t>(key); }
+    };
+
+    template <>
+    struct CacheHash<std::string>
+    {
+        std::size_t operator() (const std::string& key) const
+        {
+            // FNV-1a
+            std::size_t h = 2166136261u;
+            for (std::string::const_iterator it = key.begin(); it != key.end(); ++it)
+            {
+                h ^= static_cast<unsigned char>(*it);
+                h *= 16777619u;
+            }
+            return h;
+        }
+    };
+
+    /** @brief A thread safe cache with least recently used eviction.
+
+        The keys are distributed over a number of shards by their hash.
+        Each shard has its own mutex, hash table and LRU list, so that
+        threads working on different keys rarely wait for each other and
+        lookup, insertion and eviction take constant time.
+
+        Each element has a cost, which is 1 by default. Elements are evicted,
+        when the sum of the costs exceeds the capacity. Passing the size of
+        the value in bytes as cost limits the memory used by the cache. The
+        capacity is split evenly between the shards.
+
+        getOrCompute calls a function to create missing values. When more
+        threads miss the same key at the same time, the function is called
+        just once and the other threads wait for its result.
+
+        Values are returned as copies, since another thread may evict the
+        element at any time. Value types, which are expensive to copy,
+        should be held by a smart pointer.
+     */
+    template <typename Key, typename Value, typename Hash = CacheHash<Key> >
+    class ConcurrentCache : private NonCopyable
+    {
+        public:
+            typedef Key key_type;
+            typedef Value value_type;
+            typedef std::size_t size_type;
+
+        private:
+            struct Entry
+            {
+                Entry(const Key& key_, std::size_t hash_)
+                    : key(key_),
+                      value(),
+                      hash(hash_),
+                      cost(0),
+                      pending(false),
+                      orphaned(false),
+                      hashNext(0),
+                      prev(0),
+                      next(0)
+                { }
+
+                Key key;
+                Value value;
+                std::size_t hash;
+                size_type cost;
+                Timespan expires;   // 0 when the cache has no time to live
+
+                // A pending entry is computed by getOrCompute. It is not in
+                // the LRU list and only the computing thread deletes it.
+                bool pending;
+                bool orphaned;      // removed from the table while pending
+
+                Entry* hashNext;
+                Entry* prev;        // LRU list, most recently used first
+                Entry* next;
+            };
+
+            struct Shard
+            {
+                Mutex mutex;
+                Condition ready;    // signaled, when a pending entry is done
+                std::vector<Entry*> buckets;
+                size_type count;
+                size_type cost;
+                size_type capacity;
+                Entry* head;
+                Entry* tail;
+
+                explicit Shard(size_type capacity_)
+                    : buckets(16),
+                      count(0),
+                      cost(0),
+                      capacity(capacity_),
+                      head(0),
+                      tail(0)
+                { }
+
+                ~Shard()
+                { clear(); }
+
+                Entry* find(const Key& key, std::size_t hash) const;
+                void insert(Entry* e);
+                void unlinkHash(Entry* e);
+                void linkFront(Entry* e);
+                void unlinkLru(Entry* e);
+                void touch(Entry* e);
+                void remove(Entry* e);
+                void evict();
+                void clear();
+            };
+
+            std::vector<Shard*> _shards;
+            Hash _hash;
+            size_type _capacity;
+            Timespan _ttl;
+            volatile atomic_t _hits;
+            volatile atomic_t _misses;
+
+            Shard& shard(std::size_t hash) const
+            {
+                // the buckets use the low bits of the hash, so mix them for the shard
+                std::size_t h = (hash * 2654435761u) >> 16;
+                return *_shards[h % _shards.size()];
+            }
+
+            Timespan expires() const
+            { return _ttl > 0 ? Clock::getSystemTicks() + _ttl : Timespan(0); }
+
+            static bool isExpired(const Entry* e)
+            { return e->expires > 0 && e->expires <= Clock::getSystemTicks(); }
+
+            void store(Shard& s, Entry* e, const Value& value, size_type cost);
+
+        public:
+            /** @brief Creates a cache.
+
+                The capacity is the maximum sum of the costs of the elements.
+             */
+            explicit ConcurrentCache(size_type capacity, unsigned shards = 16);
+
+            ~ConcurrentCache();
+
+            /// Elements expire after the time to live. 0 disables expiry,
+            /// which is the default. Applies to elements put later.
+            void ttl(const Timespan& t)
+            { _ttl = t; }
+
+            const Timespan& ttl() const
+            { return _ttl; }
+
+            /// Looks up the key and copies the value, if found.
+            bool get(const Key& key, Value& value);
+
+            /// Returns the value for the key or the passed default.
+            Value get(const Key& key, const Value& def = Value())
+            {
+                Value value;
+                return get(key, value) ? value : def;
+            }
+
+            /// Returns the value for the key. If the key is not found, the
+            /// value is created by calling compute(key) and put into the
+            /// cache. Concurrent calls for the same key wait for the first
+            /// one instead of computing the value again. If compute throws,
+            /// nothing is cached and the exception is passed to the caller.
+            template <typename Compute>
+            Value getOrCompute(const Key& key, Compute compute, size_type cost = 1);
+
+            /// Puts the element into the cache, replacing an old value.
+            void put(const Key& key, const Value& value, size_type cost = 1);
+
+            /// Removes the element from the cache and returns true, if found.
+            bool erase(const Key& key);
+
+            /// Removes all elements and optionally resets the statistics.
+            void clear(bool stats = false);
+
+            /// Returns the number of elements.
+            size_type size() const;
+
+            /// Returns the sum of the costs of the elements.
+            size_type cost() const;
+
+            size_type capacity() const
+            { return _capacity; }
+
+            void setCapacity(size_type capacity);
+
+            unsigned long hits() const
+            { return static_cast<unsigned long>(atomicGet(const_cast<volatile atomic_t&>(_hits))); }
+
+            unsigned long misses() const
+            { return static_cast<unsigned long>(atomicGet(const_cast<volatile atomic_t&>(_misses))); }
+
+            /// Returns the cache hit ratio between 0 and 1.
+            double hitRatio() const
+            {
+                unsigned long h = hits();
+                unsigned long m = misses();
+                return h + m > 0 ? static_cast<double>(h) / static_cast<double>(h + m) : 0;
+            }
+    };
+
+    template <typename Key, typename Value, typename Hash>
+    typename ConcurrentCache<Key, Value, Hash>::Entry*
+        ConcurrentCache<Key, Value, Hash>::Shard::find(const Key& key, std::size_t hash) const
+    {
+        for (Entry* e = buckets[hash & (buckets.size() - 1)]; e; e = e->hashNext)
+            if (e->hash == hash && e->key == key)
+                return e;
+        return 0;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::insert(Entry* e)
+    {
+        if (count >= buckets.size())
+        {
+            std::vector<Entry*> b(buckets.size() * 2);
+            std::size_t mask = b.size() - 1;
+            for (typename std::vector<Entry*>::iterator it = buckets.begin(); it != buckets.end(); ++it)
+            {
+                Entry* n = *it;
+                while (n)
+                {
+                    Entry* next = n->hashNext;
+                    n->hashNext = b[n->hash & mask];
+                    b[n->hash & mask] = n;
+                    n = next;
+                }
+            }
+            buckets.swap(b);
+        }
+
+        Entry*& bucket = buckets[e->hash & (buckets.size() - 1)];
+        e->hashNext = bucket;
+        bucket = e;
+        ++count;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::unlinkHash(Entry* e)
+    {
+        Entry** p = &buckets[e->hash & (buckets.size() - 1)];
+        while (*p != e)
+            p = &(*p)->hashNext;
+        *p = e->hashNext;
+        --count;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::linkFront(Entry* e)
+    {
+        e->prev = 0;
+        e->next = head;
+        if (head)
+            head->prev = e;
+        else
+            tail = e;
+        head = e;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::unlinkLru(Entry* e)
+    {
+        if (e->prev)
+            e->prev->next = e->next;
+        else
+            head = e->next;
+
+        if (e->next)
+            e->next->prev = e->prev;
+        else
+            tail = e->prev;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::touch(Entry* e)
+    {
+        if (head != e)
+        {
+            unlinkLru(e);
+            linkFront(e);
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::remove(Entry* e)
+    {
+        unlinkHash(e);
+        if (e->pending)
+        {
+            // the computing thread deletes it
+            e->orphaned = true;
+        }
+        else
+        {
+            unlinkLru(e);
+            cost -= e->cost;
+            delete e;
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::evict()
+    {
+        while (cost > capacity && tail)
+            remove(tail);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::Shard::clear()
+    {
+        for (typename std::vector<Entry*>::iterator it = buckets.begin(); it != buckets.end(); ++it)
+        {
+            Entry* e = *it;
+            *it = 0;
+            while (e)
+            {
+                Entry* next = e->hashNext;
+                if (e->pending)
+                    e->orphaned = true;
+                else
+                    delete e;
+                e = next;
+            }
+        }
+
+        count = 0;
+        cost = 0;
+        head = tail = 0;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    ConcurrentCache<Key, Value, Hash>::ConcurrentCache(size_type capacity, unsigned shards)
+        : _capacity(capacity),
+          _hits(0),
+          _misses(0)
+    {
+        if (shards == 0)
+            shards = 1;
+
+        size_type shardCapacity = (capacity + shards - 1) / shards;
+        _shards.reserve(shards);
+        for (unsigned n = 0; n < shards; ++n)
+            _shards.push_back(new Shard(shardCapacity));
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    ConcurrentCache<Key, Value, Hash>::~ConcurrentCache()
+    {
+        for (typename std::vector<Shard*>::iterator it = _shards.begin(); it != _shards.end(); ++it)
+            delete *it;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::store(Shard& s, Entry* e, const Value& value, size_type cost)
+    {
+        e->value = value;
+        e->cost = cost;
+        e->expires = expires();
+        s.cost += cost;
+        s.linkFront(e);
+        s.evict();
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    bool ConcurrentCache<Key, Value, Hash>::get(const Key& key, Value& value)
+    {
+        std::size_t h = _hash(key);
+        Shard& s = shard(h);
+
+        MutexLock lock(s.mutex);
+
+        Entry* e = s.find(key, h);
+        if (e && !e->pending)
+        {
+            if (isExpired(e))
+            {
+                s.remove(e);
+            }
+            else
+            {
+                s.touch(e);
+                value = e->value;
+                atomicIncrement(_hits);
+                return true;
+            }
+        }
+
+        atomicIncrement(_misses);
+        return false;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    template <typename Compute>
+    Value ConcurrentCache<Key, Value, Hash>::getOrCompute(const Key& key, Compute compute, size_type cost)
+    {
+        std::size_t h = _hash(key);
+        Shard& s = shard(h);
+        Entry* e;
+
+        {
+            MutexLock lock(s.mutex);
+
+            while (true)
+            {
+                e = s.find(key, h);
+                if (e == 0)
+                    break;
+
+                if (e->pending)
+                {
+                    s.ready.wait(lock);
+                }
+                else if (isExpired(e))
+                {
+                    s.remove(e);
+                    break;
+                }
+                else
+                {
+                    s.touch(e);
+                    atomicIncrement(_hits);
+                    return e->value;
+                }
+            }
+
+            atomicIncrement(_misses);
+            e = new Entry(key, h);
+            e->pending = true;
+            s.insert(e);
+        }
+
+        Value value;
+        try
+        {
+            value = compute(key);
+        }
+        catch (...)
+        {
+            MutexLock lock(s.mutex);
+            if (!e->orphaned)
+                s.unlinkHash(e);
+            delete e;
+            s.ready.broadcast();
+            throw;
+        }
+
+        MutexLock lock(s.mutex);
+        if (e->orphaned)
+        {
+            delete e;
+        }
+        else
+        {
+            e->pending = false;
+            store(s, e, value, cost);
+        }
+
+        s.ready.broadcast();
+        return value;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::put(const Key& key, const Value& value, size_type cost)
+    {
+        std::size_t h = _hash(key);
+        Shard& s = shard(h);
+
+        MutexLock lock(s.mutex);
+
+        Entry* e = s.find(key, h);
+        if (e && !e->pending)
+        {
+            s.unlinkLru(e);
+            s.cost -= e->cost;
+        }
+        else
+        {
+            // a value, which is computed right now, is replaced
+            if (e)
+                s.remove(e);
+
+            e = new Entry(key, h);
+            s.insert(e);
+        }
+
+        store(s, e, value, cost);
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    bool ConcurrentCache<Key, Value, Hash>::erase(const Key& key)
+    {
+        std::size_t h = _hash(key);
+        Shard& s = shard(h);
+
+        MutexLock lock(s.mutex);
+
+        Entry* e = s.find(key, h);
+        if (e == 0)
+            return false;
+
+        s.remove(e);
+        return true;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::clear(bool stats)
+    {
+        for (typename std::vector<Shard*>::iterator it = _shards.begin(); it != _shards.end(); ++it)
+        {
+            MutexLock lock((*it)->mutex);
+            (*it)->clear();
+        }
+
+        if (stats)
+        {
+            atomicSet(_hits, 0);
+            atomicSet(_misses, 0);
+        }
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    typename ConcurrentCache<Key, Value, Hash>::size_type ConcurrentCache<Key, Value, Hash>::size() const
+    {
+        size_type n = 0;
+        for (typename std::vector<Shard*>::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+        {
+            MutexLock lock((*it)->mutex);
+            n += (*it)->count;
+        }
+        return n;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    typename ConcurrentCache<Key, Value, Hash>::size_type ConcurrentCache<Key, Value, Hash>::cost() const
+    {
+        size_type n = 0;
+        for (typename std::vector<Shard*>::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+        {
+            MutexLock lock((*it)->mutex);
+            n += (*it)->cost;
+        }
+        return n;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void ConcurrentCache<Key, Value, Hash>::setCapacity(size_type capacity)
+    {
+        _capacity = capacity;
+        size_type shardCapacity = (capacity + _shards.size() - 1) / _shards.size();
+        for (typename std::vector<Shard*>::iterator it = _shards.begin(); it != _shards.end(); ++it)
+        {
+            MutexLock lock((*it)->mutex);
+            (*it)->capacity = shardCapacity;
+            (*it)->evict();
+        }
+    }
+}
+
+#endif // CXXTOOLS_CONCURRENTCACHE_H
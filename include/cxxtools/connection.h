@@ -54,8 +54,26 @@ namespace cxxtools {
             , _sender(&sender)
             { }
 
+            ConnectionData(Connectable& sender, const Slot& slot)
+            : _refs(1)
+            , _valid(true)
+            , _slot(slot.clone(_buffer.data, sizeof(_buffer.data)))
+            , _sender(&sender)
+            { }
+
             ~ConnectionData()
-            { delete _slot; }
+            {
+                if (static_cast<void*>(_slot) == _buffer.data)
+                    _slot->~Slot();
+                else
+                    delete _slot;
+            }
+
+            static void* operator new(std::size_t size)
+            { return PoolAllocator::global().allocate(size); }
+
+            static void operator delete(void* p, std::size_t size)
+            { PoolAllocator::global().deallocate(p, size); }
 
             unsigned ref()
             { return ++_refs; }
@@ -89,6 +107,16 @@ namespace cxxtools {
             bool _valid;
             Slot* _slot;
             Connectable* _sender;
+
+            // holds slots like methods and functions without a further
+            // allocation
+            union
+            {
+                char data[6 * sizeof(void*)];
+                void* p;
+                double d;
+                long long l;
+            } _buffer;
     };
 
     /** @brief Represents a connection between a Signal/Delegate and a slot
@@ -101,6 +129,8 @@ namespace cxxtools {
 
             Connection(Connectable& sender, Slot* slot);
 
+            Connection(Connectable& sender, const Slot& slot);
+
             Connection(const Connection& connection);
 
             ~Connection();
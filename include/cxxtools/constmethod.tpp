@@ -72,6 +72,9 @@ class ConstMethodSlot : public BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>
         Slot* clone() const
         { return new ConstMethodSlot(*this); }
 
+        Slot* clone(void* buffer, std::size_t size) const
+        { return sizeof(ConstMethodSlot) <= size ? ::new (buffer) ConstMethodSlot(*this) : clone(); }
+
         /** Returns a pointer to this object's internal Callable. */
         virtual const void* callable() const
         { return &_method; }
@@ -473,6 +473,75 @@ struct FloatFormat : public DecimalFormat<CharType>
     }
 };
 
+/** @internal @brief Significant digits of a decimal number as collected by getFloat.
+
+    The value is 0.d1d2...dn * 10^exp. Digits beyond maxDigits can not change
+    the nearest binary value except for breaking a tie, so only a flag is kept
+    for them.
+ */
+struct FloatDigits
+{
+    static const unsigned maxDigits = 800;
+
+    char digits[maxDigits];
+    unsigned count;
+    bool truncated;  // nonzero digits beyond maxDigits were dropped
+    long exp;
+
+    FloatDigits()
+        : count(0),
+          truncated(false),
+          exp(0)
+    { }
+
+    void add(unsigned digit)
+    {
+        if (count < maxDigits)
+            digits[count++] = static_cast<char>('0' + digit);
+        else if (digit != 0)
+            truncated = true;
+    }
+
+    void addIntegral(unsigned digit)
+    {
+        if (count != 0 || digit != 0)
+        {
+            add(digit);
+            ++exp;
+        }
+    }
+
+    void addFractional(unsigned digit)
+    {
+        if (count != 0 || digit != 0)
+            add(digit);
+        else
+            --exp;
+    }
+
+    void scale(long e)
+    {
+        // far beyond the range of any floating point type
+        const long limit = 100000;
+        exp += e > limit ? limit : e < -limit ? -limit : e;
+    }
+};
+
+/** @internal @brief Converts decimal digits to the nearest float value.
+ */
+CXXTOOLS_API void floatFromDigits(float& n, const FloatDigits& digits);
+
+/** @internal @brief Converts decimal digits to the nearest double value.
+
+    Uses the algorithm of Eisel and Lemire and falls back to strtod for
+    the rare cases it can not decide.
+ */
+CXXTOOLS_API void floatFromDigits(double& n, const FloatDigits& digits);
+
+/** @internal @brief Converts decimal digits to the nearest long double value.
+ */
+CXXTOOLS_API void floatFromDigits(long double& n, const FloatDigits& digits);
+
 //! @internal @brief Returns the absolute value of \a i
 inline unsigned char formatAbs(char i, bool& isNeg)
 {
@@ -543,7 +612,7 @@ inline unsigned long long formatAbs(long long i, bool& isNeg)
 }
 #endif
 
-#ifdef HAVE_UNSIGNEDLONG_LONG
+#ifdef HAVE_UNSIGNED_LONG_LONG
 //! @internal @brief Returns the absolute value of \a i
 inline unsigned long long formatAbs(unsigned long long i, bool& isNeg)
 {
@@ -636,6 +705,85 @@ inline OutIterT putInt(OutIterT it, T i)
 }
 
 
+//! @internal @brief Generates up to \a precision significant digits of a
+//! finite positive value by scaling it with powers of ten.
+//!
+//! Returns the number of digits written to \a digits. The value is
+//! 0.d1d2...dn * 10^exp10.
+template <typename T>
+int formatFloatScaled(char* digits, int& exp10, T num, int precision)
+{
+    const int maxPrecision = std::numeric_limits<T>::digits10 + 1;
+
+    if (precision > maxPrecision)
+        precision = maxPrecision;
+
+    int exp = static_cast<int>(std::floor(std::log10(num))) + 1;
+
+    num *= std::pow(T(10.0), static_cast<int>(precision) - exp);
+    num += .5;
+
+    int count = 0;
+    for (int d = precision; d > 0; --d)
+    {
+        T n = num / 10.0;
+        T fl = std::floor(n) * 10.0;
+        unsigned char v = static_cast<unsigned char>(num - fl);
+        if (v != 0 && count == 0)
+            count = d;
+        digits[d - 1] = static_cast<char>('0' + v);
+        num = n;
+    }
+
+    // rounding carried over into a new digit
+    if (num >= 1.0)
+    {
+        digits[0] = '1';
+        count = 1;
+        ++exp;
+    }
+
+    exp10 = exp;
+    return count;
+}
+
+/** @internal @brief Generates the shortest digits of a finite positive value,
+    which convert back to exactly the same value.
+
+    Returns the number of digits written to \a digits, which must have room
+    for 17 digits. The value is 0.d1d2...dn * 10^exp10.
+ */
+CXXTOOLS_API int formatFloatShortest(char* digits, int& exp10, double value);
+
+//! @internal @brief Generates the shortest digits of a float value.
+CXXTOOLS_API int formatFloatShortest(char* digits, int& exp10, float value);
+
+//! @internal @brief Generates the significant digits of a finite positive value.
+template <typename T>
+inline int formatFloatDigits(char* digits, int& exp10, T num, int precision)
+{
+    return formatFloatScaled(digits, exp10, num, precision);
+}
+
+//! @internal @brief Generates the significant digits of a finite positive value.
+//! A precision above digits10 requests the shortest round trip representation.
+inline int formatFloatDigits(char* digits, int& exp10, double num, int precision)
+{
+    return precision > std::numeric_limits<double>::digits10
+        ? formatFloatShortest(digits, exp10, num)
+        : formatFloatScaled(digits, exp10, num, precision);
+}
+
+//! @internal @brief Generates the significant digits of a finite positive value.
+//! A precision above digits10 requests the shortest round trip representation.
+inline int formatFloatDigits(char* digits, int& exp10, float num, int precision)
+{
+    return precision > std::numeric_limits<float>::digits10
+        ? formatFloatShortest(digits, exp10, num)
+        : formatFloatScaled(digits, exp10, num, precision);
+}
+
+
 template <typename OutIterT, typename T, typename FormatT>
 inline OutIterT putFloat(OutIterT it, T d, const FormatT& fmt, int precision)
 {
@@ -674,31 +822,11 @@ inline OutIterT putFloat(OutIterT it, T d, const FormatT& fmt, int precision)
         return it;
     }
 
-    const int bufsize = std::numeric_limits<T>::digits10 + 1;
-
-    if (precision > bufsize)
-        precision = bufsize;
+    char fract[std::numeric_limits<T>::digits10 + 4];
+    int exp = 0;
+    int count = num == 0 ? 0 : formatFloatDigits(fract, exp, num, precision);
 
-    CharT fract[bufsize + 1];
-    fract[bufsize] = CharT('\0');
-
-    int exp = static_cast<int>(std::floor(std::log10(num))) + 1;
-
-    num *= std::pow(T(10.0), static_cast<int>(precision) - exp);
-    num += .5;
-
-    bool notZero = false;
-    for (unsigned short d = precision; d > 0; --d)
-    {
-        T n = num / 10.0;
-        T fl = std::floor(n) * 10.0;
-        unsigned char v = static_cast<unsigned char>(num - fl);
-        notZero |= (v != 0);
-        fract[d - 1] = notZero ? fmt.toChar(v) : CharT('\0');
-        num = n;
-    }
-
-    if (fract[0] == CharT('\0'))
+    if (count == 0)
     {
         *it = '0'; ++it;
         return it;
@@ -707,7 +835,7 @@ inline OutIterT putFloat(OutIterT it, T d, const FormatT& fmt, int precision)
     if (exp <= 0)
     {
         *it = '0'; ++it;
-        *it = '.'; ++it;
+        *it = fmt.point(); ++it;
 
         while (exp < 0)
         {
@@ -715,21 +843,21 @@ inline OutIterT putFloat(OutIterT it, T d, const FormatT& fmt, int precision)
             ++exp;
         }
 
-        for (int d = 0; fract[d]; ++d)
+        for (int d = 0; d < count; ++d)
         {
-            *it = fract[d]; ++it;
+            *it = fmt.toChar(fract[d] - '0'); ++it;
         }
     }
     else
     {
-        for (int d = 0; fract[d]; ++d)
+        for (int d = 0; d < count; ++d)
         {
             if (exp-- == 0)
             {
-                *it = '.';
+                *it = fmt.point();
                 ++it;
             }
-            *it = fract[d]; ++it;
+            *it = fmt.toChar(fract[d] - '0'); ++it;
         }
 
         while (exp-- > 0)
@@ -745,6 +873,7 @@ inline OutIterT putFloat(OutIterT it, T d, const FormatT& fmt, int precision)
 template <typename OutIterT, typename T>
 inline OutIterT putFloat(OutIterT it, T d)
 {
+    // shortest round trip representation for float and double
     const int precision = std::numeric_limits<T>::digits10 + 1;
     FloatFormat<char> fmt;
     return putFloat(it, d, fmt, precision);
@@ -846,7 +975,6 @@ template <typename InIterT, typename T, typename FormatT>
 InIterT getFloat(InIterT it, InIterT end, bool& ok, T& n, const FormatT& fmt)
 {
     typedef typename FormatT::CharT CharT;
-    CharT zero = fmt.toChar(0);
     n = 0.0;
     ok = false;
 
@@ -966,6 +1094,7 @@ InIterT getFloat(InIterT it, InIterT end, bool& ok, T& n, const FormatT& fmt)
     }
 
     // integral part
+    FloatDigits digits;
     bool withFractional = false;
     for( ; it != end; ++it)
     {
@@ -983,58 +1112,30 @@ InIterT getFloat(InIterT it, InIterT end, bool& ok, T& n, const FormatT& fmt)
         if(digit >= fmt.base)
             return it;
         
-        n *= 10;
-        n += digit; 
+        digits.addIntegral(digit);
     }
     
     // it is ok, if fraction is missing
     if(it == end)
     {
+        floatFromDigits(n, digits);
         if( ! pos )
-            n *= -1;
+            n = -n;
 
         ok = true;
         return it;
     }
 
-    T base = 10.0;
     if( withFractional)
     {
-        // fractional part, ignore 0 digits after dot
-        unsigned short fractDigits = 0;
-        size_t maxDigits = std::numeric_limits<unsigned short>::max() - std::numeric_limits<T>::digits10;
-        while(it != end && *it == zero)
-        {
-            if( fractDigits > maxDigits )
-                return it;
-            
-            ++fractDigits;
-            ++it;
-        }
- 
-        // fractional part, parse like integer, skip insignificant digits
-        unsigned short significants = 0;
-        T fraction = 0.0;
         for( ; it != end; ++it)
         {
             unsigned digit = fmt.toDigit(*it); 
             if(digit >= fmt.base)
                 break;
             
-            if( significants <= std::numeric_limits<T>::digits10 )
-            {
-                fraction *= 10;
-                fraction += digit;
-                
-                ++fractDigits;
-                ++significants;
-            }
+            digits.addFractional(digit);
         }
-    
-
-        // fractional part, scale down
-        fraction /= std::pow(base, T(fractDigits));
-        n += fraction;
     }
 
     // exponent [e|E][+|-][0-9]*
@@ -1048,11 +1149,12 @@ InIterT getFloat(InIterT it, InIterT end, bool& ok, T& n, const FormatT& fmt)
         if( ! ok )
             return it;
             
-        n *= std::pow(base, T(exp));
+        digits.scale(exp);
     }
 
+    floatFromDigits(n, digits);
     if( ! pos )
-        n *= -1;
+        n = -n;
 
     ok = true;
     return it;
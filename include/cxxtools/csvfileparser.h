@@ -0,0 +1,328 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_CSVFILEPARSER_H
+#define CXXTOOLS_CSVFILEPARSER_H
+
+#include <cxxtools/api.h>
+#include <cxxtools/string.h>
+#include <cxxtools/convert.h>
+#include <cxxtools/serializationerror.h>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace cxxtools
+{
+    /// A field of a csv row as a view into the UTF-8 encoded input.
+    class CsvField
+    {
+        public:
+            CsvField()
+                : _data(0),
+                  _size(0)
+            { }
+
+            CsvField(const char* data, std::size_t size)
+                : _data(data),
+                  _size(size)
+            { }
+
+            const char* data() const
+            { return _data; }
+
+            std::size_t size() const
+            { return _size; }
+
+            bool empty() const
+            { return _size == 0; }
+
+            const char* begin() const
+            { return _data; }
+
+            const char* end() const
+            { return _data + _size; }
+
+            std::string str() const
+            { return std::string(_data, _size); }
+
+            /// Returns the decoded value.
+            CXXTOOLS_API String toString() const;
+
+            bool operator==(const char* s) const
+            { return std::strlen(s) == _size && std::memcmp(s, _data, _size) == 0; }
+
+            bool operator!=(const char* s) const
+            { return !operator==(s); }
+
+        private:
+            const char* _data;
+            std::size_t _size;
+    };
+
+    class CsvRow
+    {
+        public:
+            CsvRow(const std::vector<CsvField>& fields, unsigned chunk)
+                : _fields(fields),
+                  _chunk(chunk)
+            { }
+
+            std::size_t size() const
+            { return _fields.size(); }
+
+            const CsvField& operator[](std::size_t n) const
+            { return _fields[n]; }
+
+            /// Returns the index of the chunk, the row was read from.
+            unsigned chunk() const
+            { return _chunk; }
+
+        private:
+            const std::vector<CsvField>& _fields;
+            unsigned _chunk;
+    };
+
+    /**
+        Receives the rows from a CsvFileParser.
+
+        The chunks of the input are parsed concurrently. The rows of one
+        chunk are passed in order from one thread but rows of different
+        chunks are passed from different threads at the same time.
+     */
+    class CsvRowHandler
+    {
+        public:
+            virtual ~CsvRowHandler()
+            { }
+
+            /// Called before parsing with the column titles and the number of chunks.
+            virtual void begin(const std::vector<std::string>& titles, unsigned chunks)
+            { }
+
+            virtual void onRow(const CsvRow& row) = 0;
+
+            /// Called after all chunks are parsed.
+            virtual void end()
+            { }
+    };
+
+    /**
+        Parses csv files in parallel.
+
+        The file is mapped into memory and split into one chunk per thread
+        at line ends. Since a line end may be part of a quoted value, the
+        chunks are scanned for quotes first assuming that they start at a
+        row. The assumption is checked from chunk to chunk and the start
+        of a chunk is moved to the end of the row otherwise. Then the
+        chunks are parsed concurrently and the fields are passed as views
+        into the input to the row handlers.
+
+        The dialect is the one of CsvParser: the delimiter is detected from
+        the title line when not set, values may be quoted with single or
+        double quotes and every row must have as many columns as the title.
+        Only single byte delimiters are supported.
+
+        Example:
+        @code
+            cxxtools::CsvFileParser parser("prices.csv");
+            cxxtools::CsvColumn<double> price("price");
+            parser.addHandler(price);
+            parser.parse();
+            // price.values() holds the prices in file order
+        @endcode
+     */
+    class CXXTOOLS_API CsvFileParser
+    {
+        public:
+            /// Maps the file into memory.
+            explicit CsvFileParser(const std::string& filename);
+
+            /// Parses the buffer, which must stay valid while parsing.
+            CsvFileParser(const char* data, std::size_t size);
+
+            ~CsvFileParser();
+
+            Char delimiter() const
+            { return _delimiter; }
+
+            void delimiter(Char ch)
+            { _delimiter = ch; }
+
+            bool readTitle() const
+            { return _readTitle; }
+
+            void readTitle(bool sw)
+            { _readTitle = sw; }
+
+            /// Returns the number of threads; defaults to the number of processors.
+            unsigned threads() const
+            { return _threads; }
+
+            void threads(unsigned n)
+            { _threads = n > 0 ? n : 1; }
+
+            void addHandler(CsvRowHandler& handler)
+            { _handlers.push_back(&handler); }
+
+            /// Returns the column titles after parsing.
+            const std::vector<std::string>& titles() const
+            { return _titles; }
+
+            void parse();
+
+            static const Char autoDelimiter;
+
+        private:
+            CsvFileParser(const CsvFileParser&);
+            CsvFileParser& operator=(const CsvFileParser&);
+
+            enum ScanState
+            {
+                FieldStart,
+                InField,
+                AfterQuote,
+                InDoubleQuote,
+                InSingleQuote
+            };
+
+            struct Chunk;
+
+            const char* parseTitles(const char* p);
+            const char* scan(const char* p, const char* e, ScanState& state, bool stopAtRowEnd) const;
+            const char* parseRow(const char* p, std::vector<CsvField>& fields) const;
+            void parseChunk(Chunk& chunk);
+            void checkColumns(const char* row, std::size_t columns) const;
+
+            const char* _begin;
+            const char* _end;
+            void* _map;
+            std::size_t _mapSize;
+
+            Char _delimiter;
+            bool _readTitle;
+            unsigned _threads;
+            char _delim;
+
+            std::vector<std::string> _titles;
+            std::vector<CsvRowHandler*> _handlers;
+    };
+
+    CXXTOOLS_API void convert(int& n, const CsvField& field);
+    CXXTOOLS_API void convert(unsigned int& n, const CsvField& field);
+    CXXTOOLS_API void convert(long& n, const CsvField& field);
+    CXXTOOLS_API void convert(unsigned long& n, const CsvField& field);
+    CXXTOOLS_API void convert(float& n, const CsvField& field);
+    CXXTOOLS_API void convert(double& n, const CsvField& field);
+
+    inline void convert(std::string& s, const CsvField& field)
+    { s.assign(field.data(), field.size()); }
+
+    inline void convert(String& s, const CsvField& field)
+    { s = field.toString(); }
+
+    template <typename T>
+    inline void convert(T& t, const CsvField& field)
+    { convert(t, field.str()); }
+
+    /**
+        Collects the values of one column converted to T in file order.
+
+        Every chunk collects its values separately, so that no locking is
+        needed; they are joined in end().
+     */
+    template <typename T>
+    class CsvColumn : public CsvRowHandler
+    {
+        public:
+            explicit CsvColumn(std::size_t column)
+                : _column(column)
+            { }
+
+            explicit CsvColumn(const std::string& title)
+                : _column(noColumn),
+                  _title(title)
+            { }
+
+            const std::vector<T>& values() const
+            { return _values; }
+
+            std::vector<T>& values()
+            { return _values; }
+
+            virtual void begin(const std::vector<std::string>& titles, unsigned chunks)
+            {
+                if (!_title.empty())
+                {
+                    _column = noColumn;
+                    for (std::size_t n = 0; n < titles.size(); ++n)
+                        if (titles[n] == _title)
+                            _column = n;
+
+                    if (_column == noColumn)
+                        SerializationError::doThrow("csv column \"" + _title + "\" not found");
+                }
+
+                _values.clear();
+                _chunks.clear();
+                _chunks.resize(chunks);
+            }
+
+            virtual void onRow(const CsvRow& row)
+            {
+                if (_column >= row.size())
+                    SerializationError::doThrow("csv row has too few columns");
+
+                T value = T();
+                convert(value, row[_column]);
+                _chunks[row.chunk()].push_back(value);
+            }
+
+            virtual void end()
+            {
+                std::size_t size = 0;
+                for (std::size_t n = 0; n < _chunks.size(); ++n)
+                    size += _chunks[n].size();
+
+                _values.reserve(size);
+                for (std::size_t n = 0; n < _chunks.size(); ++n)
+                    _values.insert(_values.end(), _chunks[n].begin(), _chunks[n].end());
+
+                _chunks.clear();
+            }
+
+        private:
+            static const std::size_t noColumn = static_cast<std::size_t>(-1);
+
+            std::size_t _column;
+            std::string _title;
+            std::vector<T> _values;
+            std::vector<std::vector<T> > _chunks;
+    };
+}
+
+#endif // CXXTOOLS_CSVFILEPARSER_H
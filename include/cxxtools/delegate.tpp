@@ -22,7 +22,7 @@ class Delegate : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -71,6 +71,9 @@ class DelegateSlot : public BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>
             Slot* clone() const
             { return new DelegateSlot(*this); }
 
+            Slot* clone(void* buffer, std::size_t size) const
+            { return sizeof(DelegateSlot) <= size ? ::new (buffer) DelegateSlot(*this) : clone(); }
+
             /** Returns a pointer to this object's internal Callable. */
             virtual const void* callable() const
             {
@@ -167,7 +170,7 @@ class Delegate<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,Void> : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5,A6,A7,A8,A9>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -265,7 +268,7 @@ class Delegate<R, A1,A2,A3,A4,A5,A6,A7,A8,Void,Void> : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5,A6,A7,A8>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -363,7 +366,7 @@ class Delegate<R, A1,A2,A3,A4,A5,A6,A7,Void,Void,Void> : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5,A6,A7>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -461,7 +464,7 @@ class Delegate<R, A1,A2,A3,A4,A5,A6,Void,Void,Void,Void> : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5,A6>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -559,7 +562,7 @@ class Delegate<R, A1,A2,A3,A4,A5,Void,Void,Void,Void,Void> : public DelegateBase
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4,A5>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -657,7 +660,7 @@ class Delegate<R, A1,A2,A3,A4,Void,Void,Void,Void,Void,Void> : public DelegateBa
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3,A4>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -755,7 +758,7 @@ class Delegate<R, A1,A2,A3,Void,Void,Void,Void,Void,Void,Void> : public Delegate
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2,A3>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -853,7 +856,7 @@ class Delegate<R, A1,A2,Void,Void,Void,Void,Void,Void,Void,Void> : public Delega
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1,A2>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -951,7 +954,7 @@ class Delegate<R, A1,Void,Void,Void,Void,Void,Void,Void,Void,Void> : public Dele
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R,A1>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -1049,7 +1052,7 @@ class Delegate<R, Void,Void,Void,Void,Void,Void,Void,Void,Void,Void> : public De
             /** Connects this object to the given slot and returns that Connection. */
             Connection connect(const BasicSlot<R>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /**
@@ -32,6 +32,7 @@
 #include <cxxtools/deserializerbase.h>
 #include <cxxtools/serializationerror.h>
 #include <cxxtools/composer.h>
+#include <cxxtools/valuesink.h>
 
 namespace cxxtools
 {
@@ -88,6 +89,34 @@ namespace cxxtools
                 composer.fixup(*p);
             }
 
+            /** @brief Deserialize an object without building a SerializationInfo first
+
+                The parser passes the values to a ValueSink<T>, so that
+                containers are filled element by element. Types without a
+                specialized sink are read using their operator for
+                SerializationInfo.
+            */
+            template <typename T>
+            void deserializeDirect(T& type)
+            {
+                ValueSink<T> sink;
+                sink.begin(type);
+                beginSink(sink);
+
+                try
+                {
+                    doDeserialize();
+                }
+                catch (...)
+                {
+                    endSink();
+                    throw;
+                }
+
+                endSink();
+                sink.finish();
+            }
+
             void deserialize()
             {
                 begin();
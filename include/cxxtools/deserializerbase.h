@@ -31,9 +31,12 @@
 
 #include <cxxtools/serializationinfo.h>
 #include <cxxtools/api.h>
+#include <vector>
 
 namespace cxxtools
 {
+    class IValueSink;
+
     /**
      * convert format to SerializationInfo
      */
@@ -52,7 +55,8 @@ namespace cxxtools
 #endif
 
             DeserializerBase()
-                : _current(0)
+                : _si(_arena),
+                  _current(0)
             { }
 
             virtual ~DeserializerBase()
@@ -62,12 +66,14 @@ namespace cxxtools
             {
                 _current = &_si;
                 _si.clear();
+                _arena.release();
             }
 
             void clear()
             {
                 _current = 0;
                 _si.clear();
+                _arena.release();
             }
 
             SerializationInfo* si()
@@ -105,9 +111,22 @@ namespace cxxtools
 
             void leaveMember();
 
+            /// Announces the number of members of the current value, when
+            /// the format knows it in advance.
+            void reserveMembers(std::size_t n);
+
+            /// Passes the following events to the sink instead of building a SerializationInfo.
+            void beginSink(IValueSink& sink);
+
+            /// Stops passing events to the sink.
+            void endSink();
+
         private:
+            // the document is built in the arena and released at once by begin or clear
+            SerializationArena _arena;
             SerializationInfo _si;
             SerializationInfo* _current;
+            std::vector<IValueSink*> _sinks;
     };
 
 }
@@ -171,7 +171,7 @@ namespace cxxtools {
         private:
             bool _exitLoop;
             SelectorImpl* _selector;
-            Allocator _allocator;
+            Allocator& _allocator;
             std::deque<Event* > _eventQueue;
             RecursiveMutex _queueMutex;
     };
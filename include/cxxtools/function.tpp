@@ -67,6 +67,9 @@ class FunctionSlot : public BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>
         Slot* clone() const
         { return new FunctionSlot(*this); }
 
+        Slot* clone(void* buffer, std::size_t size) const
+        { return sizeof(FunctionSlot) <= size ? ::new (buffer) FunctionSlot(*this) : clone(); }
+
         virtual void onConnect(const Connection& c)
         { }
 
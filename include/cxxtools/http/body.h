@@ -0,0 +1,162 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef cxxtools_Http_Body_h
+#define cxxtools_Http_Body_h
+
+#include <cxxtools/http/api.h>
+#include <cxxtools/noncopyable.h>
+#include <cxxtools/callable.h>
+#include <sys/types.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cxxtools {
+
+namespace http {
+
+/**
+   The body of a http message.
+
+   The body is made of the data written to stream() and of segments, which
+   are sent without copying them: ranges of memory owned by the caller and
+   ranges of files. Segments are inserted at the current end of the stream
+   data, so that stream output and segments may be mixed in any order.
+
+   Alternatively a producer may be set, which generates the body piece by
+   piece while it is sent. The http server sends such a body with chunked
+   transfer encoding.
+ */
+class CXXTOOLS_HTTP_API Body : private NonCopyable
+{
+    public:
+        /// A producer writes the next piece of the body to the passed stream
+        /// and returns false, when the body is complete.
+        typedef Callable<bool, std::ostream&> Producer;
+
+        struct Segment
+        {
+            enum Type { Memory, File };
+
+            Type type;
+            std::size_t pos;     // position in the stream data
+            const char* data;    // type Memory
+            int fd;              // type File
+            off_t offset;        // type File
+            std::size_t size;
+        };
+
+        typedef std::vector<Segment> Segments;
+
+    private:
+        class StreamBuf : public std::streambuf
+        {
+                char* _buffer;
+                std::size_t _bufferSize;
+
+            public:
+                StreamBuf()
+                    : _buffer(0),
+                      _bufferSize(0)
+                    { }
+                ~StreamBuf()
+                    { delete[] _buffer; }
+
+                const char* data() const   { return _buffer; }
+                std::size_t size() const   { return pptr() - pbase(); }
+                void clear()               { setp(_buffer, _buffer + _bufferSize); }
+
+            protected:
+                int_type overflow(int_type ch);
+                std::streamsize xsputn(const char* s, std::streamsize n);
+
+            private:
+                void reserve(std::size_t size);
+        };
+
+        StreamBuf _streamBuf;
+        std::ostream _stream;
+        Segments _segments;
+        std::size_t _segmentsSize;
+        Producer* _producer;
+
+        void write(std::ostream& out) const;
+
+    public:
+        Body();
+        ~Body();
+
+        std::ostream& stream()
+        { return _stream; }
+
+        /// Returns the data written to stream().
+        const char* data() const
+        { return _streamBuf.data(); }
+
+        /// Returns the number of bytes written to stream().
+        std::size_t dataSize() const
+        { return _streamBuf.size(); }
+
+        /// Appends the memory range to the body without copying it. The data
+        /// must not be modified or released, until the message is sent.
+        void addData(const char* data, std::size_t size);
+
+        /// Appends a range of a file to the body. The file is kept open until
+        /// the body is cleared and sent with sendfile, when supported.
+        /// A size of std::string::npos sends the rest of the file.
+        void addFile(const std::string& fname, off_t offset = 0,
+            std::size_t size = std::string::npos);
+
+        const Segments& segments() const
+        { return _segments; }
+
+        /// Sets a producer, which generates the body, while it is sent.
+        void producer(const Producer& p);
+
+        Producer* producer() const
+        { return _producer; }
+
+        /// Returns the size of the body. The size of a body with a producer
+        /// is not known in advance and not included.
+        std::size_t size() const
+        { return dataSize() + _segmentsSize; }
+
+        /// Returns the body as a string; data of the producer is not included.
+        std::string str() const;
+
+        /// Writes the whole body to the stream, including the output of the
+        /// producer.
+        void send(std::ostream& out) const;
+
+        void clear();
+};
+
+} // namespace http
+
+} // namespace cxxtools
+
+#endif
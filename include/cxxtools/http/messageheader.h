@@ -43,15 +43,21 @@ namespace http
 class CXXTOOLS_HTTP_API MessageHeader
 {
     public:
+        /// Size of the header storage held in the object itself. Larger
+        /// headers are moved to the heap up to maxSize().
         static const unsigned MAXHEADERSIZE = 4096;
 
     private:
-        char _rawdata[MAXHEADERSIZE];  // key_1\0value_1\0key_2\0value_2\0...key_n\0value_n\0\0
+        char _buffer[MAXHEADERSIZE];
+        char* _rawdata;  // key_1\0value_1\0key_2\0value_2\0...key_n\0value_n\0\0
+        std::size_t _capacity;
         unsigned _endOffset;
         char* eptr() { return _rawdata + _endOffset; }
         unsigned _httpVersionMajor;
         unsigned _httpVersionMinor;
 
+        void reserve(std::size_t size);
+
     public:
         typedef std::pair<const char*, const char*> value_type;
         class const_iterator
@@ -111,14 +117,24 @@ class CXXTOOLS_HTTP_API MessageHeader
 
 
         MessageHeader()
-            : _endOffset(0),
+            : _rawdata(_buffer),
+              _capacity(MAXHEADERSIZE),
+              _endOffset(0),
               _httpVersionMajor(1),
               _httpVersionMinor(1)
         {
             _rawdata[0] = _rawdata[1] = '\0';
         }
 
-        virtual ~MessageHeader()  {}
+        MessageHeader(const MessageHeader& header);
+
+        MessageHeader& operator= (const MessageHeader& header);
+
+        virtual ~MessageHeader()
+        {
+            if (_rawdata != _buffer)
+                delete[] _rawdata;
+        }
 
         void clear();
 
@@ -160,6 +176,13 @@ class CXXTOOLS_HTTP_API MessageHeader
 
         bool keepAlive() const;
 
+        /// Returns the maximum size of the header storage. Adding headers
+        /// beyond this limit throws an exception. The default is 64k.
+        static std::size_t maxSize();
+
+        /// Sets the maximum size of the header storage for all message headers.
+        static void maxSize(std::size_t size);
+
         /// Returns a properly formatted current time-string, as needed in http.
         /// The buffer must have at least 30 bytes.
         static char* htdateCurrent(char* buffer);
@@ -31,6 +31,7 @@
 
 #include <cxxtools/http/api.h>
 #include <cxxtools/http/replyheader.h>
+#include <cxxtools/http/body.h>
 #include <string>
 #include <sstream>
 
@@ -43,7 +44,7 @@ class Request;
 class Reply
 {
         ReplyHeader _header;
-        std::ostringstream _body;
+        Body _body;
 
     public:
         Reply()
@@ -84,7 +85,6 @@ class Reply
         {
             _header.clear();
             _body.clear();
-            _body.str(std::string());
         }
 
         unsigned httpReturnCode() const
@@ -100,13 +100,30 @@ class Reply
         { return _body.str(); }
 
         std::ostream& body()
+        { return _body.stream(); }
+
+        /// Appends the memory range to the body without copying it.
+        /// The data must stay valid until the reply is sent.
+        void addBodyData(const char* data, std::size_t size)
+        { _body.addData(data, size); }
+
+        /// Appends a range of a file to the body, which is sent with sendfile.
+        void addBodyFile(const std::string& fname, off_t offset = 0,
+            std::size_t size = std::string::npos)
+        { _body.addFile(fname, offset, size); }
+
+        /// Sets a producer, which generates the body while it is sent.
+        void bodyProducer(const Body::Producer& producer)
+        { _body.producer(producer); }
+
+        const Body& bodyContent() const
         { return _body; }
 
         std::size_t bodySize() const
-        { return _body.str().size(); }
+        { return _body.size(); }
 
         void sendBody(std::ostream& out) const
-        { out << _body.str(); }
+        { _body.send(out); }
 
 };
 
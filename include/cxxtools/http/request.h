@@ -31,8 +31,10 @@
 
 #include <cxxtools/http/api.h>
 #include <cxxtools/http/requestheader.h>
+#include <cxxtools/http/body.h>
 #include <string>
 #include <sstream>
+#include <vector>
 
 namespace cxxtools {
 
@@ -40,8 +42,11 @@ namespace http {
 
 class Request
 {
+        typedef std::vector<std::pair<std::string, std::string> > RouteParams;
+
         RequestHeader _header;
-        std::ostringstream _body;
+        Body _body;
+        RouteParams _routeParams;
 
     public:
         struct Auth
@@ -89,7 +94,7 @@ class Request
         {
             _header.clear();
             _body.clear();
-            _body.str(std::string());
+            _routeParams.clear();
         }
 
         const std::string& url() const
@@ -114,16 +119,28 @@ class Request
         { return _body.str(); }
 
         std::ostream& body()
-        { return _body; }
+        { return _body.stream(); }
 
         std::size_t bodySize() const
-        { return _body.str().size(); }
+        { return _body.size(); }
 
         void sendBody(std::ostream& out) const
-        { out << _body.str(); }
+        { _body.send(out); }
 
         Auth auth() const;
 
+        /// Returns the parameter of the route, which matched the url. For
+        /// a service added for "/user/{id}" the parameter "id" holds the
+        /// segment of the url. Groups of regular expressions are named
+        /// "1" to "9". Returns an empty string, if the parameter is not set.
+        const std::string& routeParam(const std::string& name) const;
+
+        void routeParam(const std::string& name, const std::string& value)
+        { _routeParams.push_back(RouteParams::value_type(name, value)); }
+
+        void clearRouteParams()
+        { _routeParams.clear(); }
+
 };
 
 } // namespace http
@@ -59,7 +59,12 @@ class CXXTOOLS_HTTP_API Server : private cxxtools::NonCopyable
         void listen(const std::string& ip, unsigned short int port, int backlog = 64);
         void listen(unsigned short int port, int backlog = 64);
 
+        /// Adds a service for the url. Segments written as "{name}" match
+        /// any text up to the next '/', which is passed to the service
+        /// as route parameter of the request.
         void addService(const std::string& url, Service& service);
+        /// Adds a service for all urls starting with the prefix.
+        void addPrefixService(const std::string& prefix, Service& service);
         void addService(const Regex& url, Service& service);
         void removeService(Service& service);
 
@@ -77,6 +82,15 @@ class CXXTOOLS_HTTP_API Server : private cxxtools::NonCopyable
         unsigned maxThreads() const;
         void maxThreads(unsigned m);
 
+        /// Number of threads, which process connections event driven.
+        /// When set to 0 (the default), each active connection is served
+        /// by a thread of its own. Otherwise connections are multiplexed
+        /// on the given number of io threads and only the responders are
+        /// executed in a thread pool of minThreads() threads. The value
+        /// has to be set before the event loop is started.
+        unsigned ioThreads() const;
+        void ioThreads(unsigned n);
+
         enum Runmode {
           Stopped,
           Starting,
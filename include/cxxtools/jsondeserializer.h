@@ -115,8 +115,13 @@ namespace cxxtools
             virtual void doDeserialize();
 
         private:
+            void doDeserializeUtf8();
+
             TextIStream* _ts;
             std::basic_istream<Char>& _in;
+
+            // set, when the input is utf-8 encoded and can be parsed bytewise
+            std::istream* _inUtf8;
     };
 }
 
@@ -39,23 +39,42 @@ namespace cxxtools
         public:
             JsonFormatter()
                 : _ts(0),
+                  _out(0),
                   _level(1),
                   _lastLevel(0),
-                  _beautify(false)
+                  _beautify(false),
+                  _count(0)
             {
             }
 
             explicit JsonFormatter(std::basic_ostream<cxxtools::Char>& ts)
                 : _ts(0),
+                  _out(0),
                   _level(1),
                   _lastLevel(0),
-                  _beautify(false)
+                  _beautify(false),
+                  _count(0)
             {
                 begin(ts);
             }
 
+            /// Writes UTF-8 directly to the stream without a text codec.
+            explicit JsonFormatter(std::ostream& out)
+                : _ts(0),
+                  _out(0),
+                  _level(1),
+                  _lastLevel(0),
+                  _beautify(false),
+                  _count(0)
+            {
+                begin(out);
+            }
+
             void begin(std::basic_ostream<cxxtools::Char>& ts);
 
+            /// Writes UTF-8 directly to the stream without a text codec.
+            void begin(std::ostream& out);
+
             void finish();
 
             virtual void addValueString(const std::string& name, const std::string& type,
@@ -99,14 +118,44 @@ namespace cxxtools
             void finishValue();
 
         private:
+            enum { BufferSize = 1024 };
+
+            // The output is collected in _buffer and written to the stream
+            // in blocks. Since everything outside of ascii is escaped, the
+            // buffer holds plain chars for both kinds of streams.
+            char* reserve(unsigned n)
+            {
+                if (BufferSize - _count < n)
+                    flushBuffer();
+                return _buffer + _count;
+            }
+
+            void commit(char* p)
+            { _count = p - _buffer; }
+
+            void put(char ch)
+            {
+                if (_count >= BufferSize)
+                    flushBuffer();
+                _buffer[_count++] = ch;
+            }
+
+            void put(const char* s, std::size_t n);
+            void flushBuffer();
+
             void indent();
+            void escape(uint32_t ch);
             void stringOut(const std::string& str);
             void stringOut(const cxxtools::String& str);
 
             std::basic_ostream<cxxtools::Char>* _ts;
+            std::ostream* _out;
             unsigned _level;
             unsigned _lastLevel;
             bool _beautify;
+            char _buffer[BufferSize];
+            unsigned _count;
+            std::string _number;
     };
 
 }
@@ -40,6 +40,7 @@ namespace cxxtools
     class CXXTOOLS_API JsonParserError : public SerializationError
     {
             friend class JsonParser;
+            friend class JsonUtf8Parser;
             unsigned _lineNo;
             mutable std::string _msg;
 
@@ -31,6 +31,7 @@
 
 #include <cxxtools/textstream.h>
 #include <cxxtools/decomposer.h>
+#include <cxxtools/valuewriter.h>
 #include <cxxtools/jsonformatter.h>
 #include <sstream>
 #include <stdexcept>
@@ -173,7 +174,36 @@ namespace cxxtools
                 Decomposer<T> s;
                 s.begin(v);
                 s.format(_formatter);
-                _ts->flush();
+                if (_ts)
+                    _ts->flush();
+                return *this;
+            }
+
+            /// Like serialize but writes the value with a ValueWriter directly to the formatter.
+            template <typename T>
+            JsonSerializer& serializeDirect(const T& v, const std::string& name)
+            {
+                if (!_inObject)
+                {
+                    _formatter.beginObject(std::string(), std::string());
+                    _inObject = true;
+                }
+
+                ValueWriter w(_formatter, name);
+                w <<= v;
+                return *this;
+            }
+
+            template <typename T>
+            JsonSerializer& serializeDirect(const T& v)
+            {
+                if (_inObject)
+                    throw std::logic_error("can't serialize object without name into another object");
+
+                ValueWriter w(_formatter);
+                w <<= v;
+                if (_ts)
+                    _ts->flush();
                 return *this;
             }
 
@@ -0,0 +1,146 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_JSONUTF8PARSER_H
+#define CXXTOOLS_JSONUTF8PARSER_H
+
+#include <cxxtools/api.h>
+#include <cxxtools/jsonparser.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cxxtools
+{
+    class DeserializerBase;
+
+    /**
+     * A json parser, which reads utf-8 encoded bytes instead of unicode characters.
+     *
+     * The parser produces the same events as the JsonParser but does not need
+     * to decode the input to cxxtools::Char first. Whitespace, string contents
+     * and numbers are scanned in blocks, using SSE2 or AVX2 instructions when
+     * the compiler makes them available.
+     *
+     * The input is passed in chunks of arbitrary size. Tokens may span chunk
+     * boundaries.
+     *
+     * Tokens are found by the state machine directly; there is no separate
+     * pass indexing structural characters. When deserializing to a
+     * SerializationInfo, building the tree takes about three quarters of the
+     * time, so a faster scanner would gain little.
+     */
+    class CXXTOOLS_API JsonUtf8Parser
+    {
+        public:
+            JsonUtf8Parser();
+
+            void begin(DeserializerBase& handler);
+
+            /// Parses the next chunk of input.
+            /// Returns the number of bytes consumed. The parser stops consuming
+            /// as soon as the top level value is complete, so the return value
+            /// is less than size only when done() is true afterwards.
+            std::size_t advance(const char* data, std::size_t size);
+
+            /// Signals the end of input.
+            /// A pending number or literal at top level is completed. Throws
+            /// a SerializationError if the value is incomplete.
+            void finish();
+
+            /// Returns true, when the top level value is complete.
+            bool done() const
+            { return _state == state_end; }
+
+            unsigned lineNo() const
+            { return _lineNo; }
+
+        private:
+            enum State
+            {
+                state_value,
+                state_object_first,
+                state_object_next,
+                state_object_colon,
+                state_object_e,
+                state_array_first,
+                state_array_e,
+                state_string,
+                state_number,
+                state_token,
+                state_plainname,
+                state_comment0,
+                state_commentline,
+                state_comment,
+                state_comment_e,
+                state_end
+            };
+
+            State _state;
+            State _nextState;
+
+            // '{' or '[' for each open container
+            std::vector<char> _containers;
+
+            // part of the current token from previous chunks
+            std::string _token;
+            std::string _name;
+            std::string _value;
+
+            bool _first;
+            bool _isName;
+            bool _escape;
+            bool _hasEscape;
+            bool _nonAscii;
+            bool _float;
+
+            DeserializerBase* _deserializer;
+            unsigned _lineNo;
+
+            bool tokenState() const
+            {
+                return _state == state_string
+                    || _state == state_number
+                    || _state == state_token
+                    || _state == state_plainname;
+            }
+
+            void beginString(bool isName);
+            void beginComment();
+            void takeToken(const char* b, const char* e, std::string& str);
+            void stringEnd(const char* b, const char* e);
+            void numberEnd();
+            void tokenEnd();
+            void valueEnd();
+            void unescape(const std::string& in, std::string& out);
+
+            void doThrow(const std::string& msg);
+            void throwInvalidCharacter(char ch);
+    };
+}
+
+#endif // CXXTOOLS_JSONUTF8PARSER_H
@@ -156,6 +156,12 @@ namespace cxxtools
     public:
       typedef Logger::log_level_type log_level_type;
 
+      /// What an asynchronous logger does, when the ring buffer of a thread is full.
+      enum OverflowPolicy {
+        BlockOnOverflow,  ///< wait until the background thread made room
+        DropOnOverflow    ///< discard the message and count it
+      };
+
       LogConfiguration();
       LogConfiguration(const LogConfiguration&);
       LogConfiguration& operator=(const LogConfiguration&);
@@ -176,6 +182,22 @@ namespace cxxtools
       void setLoghost(const std::string& host, unsigned short port, bool broadcast = false);
       void setStdout();
       void setStderr();
+
+      /** Enables asynchronous logging.
+
+          Log messages are formatted by the logging thread and put into a
+          ring buffer of that thread. A background thread collects them and
+          writes them in batches to the configured destination. Messages of
+          one thread keep their order. Fatal messages are never dropped and
+          are flushed before the log statement returns.
+       */
+      void setAsync(unsigned bufferSize = 65536, OverflowPolicy policy = BlockOnOverflow);
+      /// Disables asynchronous logging, which is the default.
+      void setSync();
+
+      bool async() const;
+      unsigned asyncBufferSize() const;
+      OverflowPolicy overflowPolicy() const;
   };
 
   void operator>>= (const SerializationInfo& si, LogConfiguration& logConfiguration);
@@ -218,6 +240,11 @@ namespace cxxtools
 
       Logger::log_level_type rootLevel() const;
       Logger::log_level_type logLevel(const std::string& category) const;
+
+      /// Waits until all messages of the asynchronous logger are written.
+      void flush();
+      /// Returns the number of messages discarded by the asynchronous logger.
+      unsigned long droppedMessages() const;
   };
 
   //////////////////////////////////////////////////////////////////////
@@ -93,6 +93,9 @@ class MethodSlot : public BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>
         Slot* clone() const
         { return new MethodSlot(*this); }
 
+        Slot* clone(void* buffer, std::size_t size) const
+        { return sizeof(MethodSlot) <= size ? ::new (buffer) MethodSlot(*this) : clone(); }
+
         /** Returns a pointer to this object's internal Callable. */
         virtual const void* callable() const
         { return &_method; }
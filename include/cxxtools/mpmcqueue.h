@@ -0,0 +1,408 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_MPMCQUEUE_H
+#define CXXTOOLS_MPMCQUEUE_H
+
+#include <cxxtools/atomicity.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/condition.h>
+#include <cxxtools/noncopyable.h>
+#include <cxxtools/thread.h>
+#include <utility>
+
+namespace cxxtools
+{
+    /** @brief A bounded lock free multi producer multi consumer queue.
+
+        The queue is a ring buffer of a fixed capacity, where each slot has a
+        sequence number (D. Vyukov's algorithm). Putting and fetching
+        elements needs just one compare and exchange operation and no lock.
+
+        When the queue is empty (or full), get (or put) spins a short time
+        and then parks the thread on a condition. The mutex of the condition
+        is only used, when a thread is actually waiting.
+
+        The interface is compatible with cxxtools::Queue, so that it can be
+        used as a replacement, where a bounded queue is acceptable. Unlike
+        Queue the maximum size is fixed at construction.
+     */
+    template <typename T>
+    class MpmcQueue : private NonCopyable
+    {
+        public:
+            typedef T value_type;
+            typedef std::size_t size_type;
+            typedef const T& const_reference;
+
+        private:
+            struct Cell
+            {
+                volatile atomic_t sequence;
+                value_type data;
+            };
+
+            enum { CacheLine = 64, SpinCount = 64 };
+
+            Cell* _buffer;
+            size_type _mask;
+            char _pad0[CacheLine];
+            volatile atomic_t _enqueuePos;
+            char _pad1[CacheLine];
+            volatile atomic_t _dequeuePos;
+            char _pad2[CacheLine];
+
+            volatile atomic_t _getWaiting;
+            volatile atomic_t _putWaiting;
+            Mutex _mutex;
+            Condition _notEmpty;
+            Condition _notFull;
+
+            bool doPut(const_reference element);
+            bool doGet(value_type& element);
+            void notifyGetters(bool all = false);
+            void notifyPutters(bool all = false);
+
+        public:
+            /** @brief Creates a queue.
+
+                The capacity is rounded up to the next power of 2.
+             */
+            explicit MpmcQueue(size_type capacity = 1024);
+
+            ~MpmcQueue()
+            { delete[] _buffer; }
+
+            /// @brief Adds a element if the queue is not full.
+            bool tryPut(const_reference element);
+
+            /** @brief Returns the next element if the queue is not empty.
+
+                If the queue is empty, a default constructed value_type is
+                returned. The returned flag is set to false, if the queue was
+                empty.
+             */
+            std::pair<value_type, bool> tryGet();
+
+            /// @brief Fetches the next element if the queue is not empty.
+            bool tryGet(value_type& element);
+
+            /** @brief Adds a element to the queue.
+
+                If the queue is full, the method blocks until there is space
+                available. The force flag is accepted for compatibility with
+                Queue, but a full MpmcQueue can't be exceeded.
+             */
+            void put(const_reference element, bool force = false);
+
+            /** @brief Adds all elements of the range to the queue.
+
+                Waiting consumers are notified once for the whole batch.
+             */
+            template <typename InputIterator>
+            void put(InputIterator first, InputIterator last);
+
+            /** @brief Returns the next element.
+
+                If the queue is empty, the thread will be blocked until a
+                element is available.
+             */
+            value_type get();
+
+            /** @brief Fetches up to n elements without blocking.
+
+                The elements are written to the output iterator. The number of
+                fetched elements is returned.
+             */
+            template <typename OutputIterator>
+            size_type tryGet(OutputIterator out, size_type n);
+
+            /** @brief Fetches up to n elements.
+
+                Blocks until at least one element is available.
+             */
+            template <typename OutputIterator>
+            size_type get(OutputIterator out, size_type n);
+
+            /// @brief Returns true, if the queue is empty.
+            bool empty() const
+            { return size() == 0; }
+
+            /// @brief Returns the number of elements currently in queue.
+            size_type size() const
+            {
+                atomic_t s = atomicGet(const_cast<volatile atomic_t&>(_enqueuePos))
+                           - atomicGet(const_cast<volatile atomic_t&>(_dequeuePos));
+                return s > 0 ? static_cast<size_type>(s) : 0;
+            }
+
+            /// @brief returns the maximum size of the queue.
+            size_type maxSize() const
+            { return _mask + 1; }
+
+            /// @brief returns the number of threads blocked in the get method.
+            size_type numWaiting() const
+            { return static_cast<size_type>(atomicGet(const_cast<volatile atomic_t&>(_getWaiting))); }
+    };
+
+    template <typename T>
+    MpmcQueue<T>::MpmcQueue(size_type capacity)
+        : _enqueuePos(0),
+          _dequeuePos(0),
+          _getWaiting(0),
+          _putWaiting(0)
+    {
+        size_type size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        _buffer = new Cell[size];
+        _mask = size - 1;
+
+        for (size_type n = 0; n < size; ++n)
+            _buffer[n].sequence = static_cast<atomic_t>(n);
+
+        // publish the initialized buffer
+        atomicSet(_enqueuePos, 0);
+    }
+
+    template <typename T>
+    bool MpmcQueue<T>::doPut(const_reference element)
+    {
+        Cell* cell;
+        atomic_t pos = atomicGet(_enqueuePos);
+        while (true)
+        {
+            cell = &_buffer[pos & _mask];
+            atomic_t diff = atomicGet(cell->sequence) - pos;
+            if (diff == 0)
+            {
+                atomic_t p = atomicCompareExchange(_enqueuePos, pos + 1, pos);
+                if (p == pos)
+                    break;
+                pos = p;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = atomicGet(_enqueuePos);
+            }
+        }
+
+        cell->data = element;
+        atomicSet(cell->sequence, pos + 1);
+
+        return true;
+    }
+
+    template <typename T>
+    bool MpmcQueue<T>::tryPut(const_reference element)
+    {
+        if (!doPut(element))
+            return false;
+
+        notifyGetters();
+        return true;
+    }
+
+    template <typename T>
+    bool MpmcQueue<T>::doGet(value_type& element)
+    {
+        Cell* cell;
+        atomic_t pos = atomicGet(_dequeuePos);
+        while (true)
+        {
+            cell = &_buffer[pos & _mask];
+            atomic_t diff = atomicGet(cell->sequence) - (pos + 1);
+            if (diff == 0)
+            {
+                atomic_t p = atomicCompareExchange(_dequeuePos, pos + 1, pos);
+                if (p == pos)
+                    break;
+                pos = p;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = atomicGet(_dequeuePos);
+            }
+        }
+
+        element = cell->data;
+        cell->data = value_type();
+        atomicSet(cell->sequence, pos + static_cast<atomic_t>(_mask) + 1);
+
+        return true;
+    }
+
+    template <typename T>
+    bool MpmcQueue<T>::tryGet(value_type& element)
+    {
+        if (!doGet(element))
+            return false;
+
+        notifyPutters();
+        return true;
+    }
+
+    template <typename T>
+    std::pair<typename MpmcQueue<T>::value_type, bool> MpmcQueue<T>::tryGet()
+    {
+        std::pair<value_type, bool> ret;
+        ret.second = tryGet(ret.first);
+        return ret;
+    }
+
+    template <typename T>
+    void MpmcQueue<T>::notifyGetters(bool all)
+    {
+        if (atomicGet(_getWaiting) > 0)
+        {
+            MutexLock lock(_mutex);
+            if (all)
+                _notEmpty.broadcast();
+            else
+                _notEmpty.signal();
+        }
+    }
+
+    template <typename T>
+    void MpmcQueue<T>::notifyPutters(bool all)
+    {
+        if (atomicGet(_putWaiting) > 0)
+        {
+            MutexLock lock(_mutex);
+            if (all)
+                _notFull.broadcast();
+            else
+                _notFull.signal();
+        }
+    }
+
+    template <typename T>
+    void MpmcQueue<T>::put(const_reference element, bool /*force*/)
+    {
+        for (unsigned n = 0; n < SpinCount; ++n)
+        {
+            if (tryPut(element))
+                return;
+            if (n >= SpinCount / 2)
+                Thread::yield();
+        }
+
+        {
+            MutexLock lock(_mutex);
+            atomicIncrement(_putWaiting);
+            while (!doPut(element))
+                _notFull.wait(lock);
+            atomicDecrement(_putWaiting);
+        }
+
+        notifyGetters();
+    }
+
+    template <typename T>
+    template <typename InputIterator>
+    void MpmcQueue<T>::put(InputIterator first, InputIterator last)
+    {
+        for ( ; first != last; ++first)
+        {
+            if (!doPut(*first))
+            {
+                // full; wake all consumers and wait for space
+                notifyGetters(true);
+                put(*first);
+            }
+        }
+
+        notifyGetters(true);
+    }
+
+    template <typename T>
+    typename MpmcQueue<T>::value_type MpmcQueue<T>::get()
+    {
+        value_type element;
+
+        for (unsigned n = 0; n < SpinCount; ++n)
+        {
+            if (tryGet(element))
+                return element;
+            if (n >= SpinCount / 2)
+                Thread::yield();
+        }
+
+        {
+            MutexLock lock(_mutex);
+            atomicIncrement(_getWaiting);
+            while (!doGet(element))
+                _notEmpty.wait(lock);
+            atomicDecrement(_getWaiting);
+        }
+
+        notifyPutters();
+
+        return element;
+    }
+
+    template <typename T>
+    template <typename OutputIterator>
+    typename MpmcQueue<T>::size_type MpmcQueue<T>::tryGet(OutputIterator out, size_type n)
+    {
+        size_type count = 0;
+        value_type element;
+        while (count < n && doGet(element))
+        {
+            *out = element;
+            ++out;
+            ++count;
+        }
+
+        if (count > 0)
+            notifyPutters(true);
+
+        return count;
+    }
+
+    template <typename T>
+    template <typename OutputIterator>
+    typename MpmcQueue<T>::size_type MpmcQueue<T>::get(OutputIterator out, size_type n)
+    {
+        if (n == 0)
+            return 0;
+
+        *out = get();
+        ++out;
+        return tryGet(out, n - 1) + 1;
+    }
+}
+
+#endif // CXXTOOLS_MPMCQUEUE_H
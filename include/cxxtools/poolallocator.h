@@ -0,0 +1,151 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_POOLALLOCATOR_H
+#define CXXTOOLS_POOLALLOCATOR_H
+
+#include <cxxtools/allocator.h>
+#include <cxxtools/noncopyable.h>
+#include <new>
+
+namespace cxxtools {
+
+    class PoolAllocatorImpl;
+
+    /** @brief Allocator for small objects with per thread caches.
+
+        Blocks up to MaxSize bytes are rounded up to a multiple of 16 bytes
+        and taken from a free list of the calling thread, so that most
+        allocations neither lock nor call operator new. Empty free lists are
+        refilled with a batch of blocks from a global depot or a new chunk of
+        memory. Larger blocks are passed to operator new.
+
+        A block may be deallocated by any thread. It is put into the free
+        list of that thread and long free lists return batches to the depot,
+        so that memory flows back when one thread allocates and another one
+        releases, like the producer and the consumer of a queue.
+
+        The memory is returned to the system when the allocator is destroyed.
+        The size passed to deallocate must match the size passed to allocate.
+     */
+    class PoolAllocator : public Allocator, private NonCopyable
+    {
+        public:
+            enum {
+                Granularity = 16,
+                MaxSize = 512
+            };
+
+            struct Stats
+            {
+                Stats()
+                    : allocations(0),
+                      deallocations(0),
+                      largeAllocations(0),
+                      refills(0),
+                      flushes(0),
+                      chunks(0),
+                      reserved(0)
+                    { }
+
+                unsigned long allocations;       // all calls of allocate
+                unsigned long deallocations;     // all calls of deallocate
+                unsigned long largeAllocations;  // passed to operator new
+                unsigned long refills;           // free lists refilled from the depot
+                unsigned long flushes;           // batches returned to the depot
+                unsigned long chunks;            // chunks requested from the system
+                std::size_t reserved;            // bytes in chunks
+
+                unsigned long inUse() const
+                { return allocations - deallocations; }
+            };
+
+            PoolAllocator();
+
+            ~PoolAllocator();
+
+            virtual void* allocate(std::size_t size);
+
+            virtual void deallocate(void* p, std::size_t size);
+
+            /// Returns the statistics. The counters of running threads are
+            /// read without synchronization, so the result is approximate.
+            Stats stats() const;
+
+            /// Returns the allocator shared by the library. It is never
+            /// destroyed, so it may be used by static objects.
+            static PoolAllocator& global();
+
+        private:
+            PoolAllocatorImpl* _impl;
+    };
+
+    /**
+      Creator for Pool, which allocates the objects from the global
+      PoolAllocator. Use it together with PoolAllocatorDestroyPolicy:
+
+      \code
+        typedef cxxtools::Pool<Foo, cxxtools::PoolAllocatorCreator<Foo>,
+                               cxxtools::RefLinked, cxxtools::PoolAllocatorDestroyPolicy> FooPool;
+      \endcode
+     */
+    template <typename T>
+    class PoolAllocatorCreator
+    {
+        public:
+            T* operator() ()
+            {
+                void* p = PoolAllocator::global().allocate(sizeof(T));
+                try
+                {
+                    return new (p) T();
+                }
+                catch (...)
+                {
+                    PoolAllocator::global().deallocate(p, sizeof(T));
+                    throw;
+                }
+            }
+    };
+
+    template <typename T>
+    class PoolAllocatorDestroyPolicy
+    {
+        public:
+            static void destroy(T* ptr)
+            {
+                if (ptr)
+                {
+                    ptr->~T();
+                    PoolAllocator::global().deallocate(ptr, sizeof(T));
+                }
+            }
+    };
+
+}
+
+#endif
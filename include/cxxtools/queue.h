@@ -104,9 +104,9 @@ namespace cxxtools
 
             /** @brief sets the maximum size of the queue.
 
-                Setting the maximum size of the queue may wake up another
-                thread, if it is waiting for space to get available and the
-                limit is increased.
+                Setting the maximum size of the queue wakes up the threads,
+                which wait for space to get available, when the limit is
+                increased or removed.
              */
             void maxSize(size_type m);
 
@@ -141,7 +141,8 @@ namespace cxxtools
         if (!_queue.empty())
             _notEmpty.signal();
 
-        _notFull.signal();
+        if (_maxSize > 0)
+            _notFull.signal();
 
         return element;
     }
@@ -163,7 +164,8 @@ namespace cxxtools
         if (!_queue.empty())
             _notEmpty.signal();
 
-        _notFull.signal();
+        if (_maxSize > 0)
+            _notFull.signal();
 
         return return_type(element, true);
     }
@@ -187,9 +189,15 @@ namespace cxxtools
     template <typename T>
     void Queue<T>::maxSize(size_type m)
     {
-        _maxSize = m;
         MutexLock lock(_mutex);
-        if (_queue.size() < _maxSize)
+
+        // get signals notFull only while there is a limit, so all waiting
+        // producers are woken up, when the limit is raised or removed
+        bool raised = _maxSize > 0 && (m == 0 || m > _maxSize);
+        _maxSize = m;
+        if (raised)
+            _notFull.broadcast();
+        else if (_queue.size() < _maxSize)
             _notFull.signal();
     }
 }
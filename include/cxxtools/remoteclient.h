@@ -56,6 +56,15 @@ namespace cxxtools
 
             virtual void cancel() = 0;
 
+            /// Cancels the call of the procedure.
+            /// Clients, which run more than one call at a time, must forget
+            /// the procedure, since it may be destroyed.
+            virtual void cancelCall(IRemoteProcedure& proc)
+            {
+                if (activeProcedure() == &proc)
+                    cancel();
+            }
+
             virtual void wait(std::size_t msecs = WaitInfinite) = 0;
 
             virtual std::size_t timeout() const = 0;
@@ -66,8 +66,8 @@ class IRemoteProcedure
 
         void cancel()
         {
-            if (_client && _client->activeProcedure() == this)
-                _client->cancel();
+            if (_client)
+                _client->cancelCall(*this);
         }
 
         virtual void onFinished() = 0;
@@ -134,6 +134,18 @@ namespace cxxtools {
             */
             void wake();
 
+            /** @brief Sets the tick resolution of the timers
+
+                Timers are kept in a hierarchical timer wheel, which
+                processes timers in ticks of this resolution. Timers are
+                never sent early, but may be delayed by up to one tick.
+                The default resolution is 1 millisecond.
+            */
+            void setTimerResolution(const Timespan& resolution);
+
+            //! @brief Returns the tick resolution of the timers
+            const Timespan& timerResolution() const;
+
         protected:
             //! @brief Default constructor
             SelectorBase();
@@ -182,9 +194,10 @@ namespace cxxtools {
             //! @internal
             typedef std::multimap<Timespan, Timer*> TimerMap;
 
-            //! @internal
+            //! @internal unused; kept for binary compatibility
             TimerMap _timers;
 
+            //! @internal the TimerWheel, which holds the active timers
             void* _reserved;
     };
 
@@ -0,0 +1,95 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_SERIALIZATIONARENA_H
+#define CXXTOOLS_SERIALIZATIONARENA_H
+
+#include <cxxtools/api.h>
+#include <cxxtools/noncopyable.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cxxtools
+{
+    /**
+     * Memory for SerializationInfo documents.
+     *
+     * A SerializationInfo constructed with an arena keeps its members,
+     * names and string values in the arena instead of allocating each of
+     * them on the heap. Member and type names are interned, so that equal
+     * names share one string. All nodes of the document are released at
+     * once by release().
+     *
+     * @code
+     *   cxxtools::SerializationArena arena;
+     *   cxxtools::SerializationInfo si(arena);
+     *   ...
+     *   si.clear();
+     *   arena.release();
+     * @endcode
+     *
+     * The arena must outlive the SerializationInfo objects using it.
+     */
+    class CXXTOOLS_API SerializationArena : private NonCopyable
+    {
+        public:
+            explicit SerializationArena(std::size_t blockSize = 65536);
+
+            ~SerializationArena();
+
+            /// Returns uninitialized memory, which is valid until release is called.
+            void* allocate(std::size_t size, std::size_t align = sizeof(long double));
+
+            /// Returns the interned copy of the passed string.
+            const std::string& intern(const std::string& s);
+
+            /// Returns the interned copy of the passed string or null if it is not interned yet.
+            const std::string* find(const std::string& s) const;
+
+            /// Frees all memory and interned strings. The first block is kept for reuse.
+            void release();
+
+            /// Returns the number of bytes requested from the arena since the last release.
+            std::size_t bytesUsed() const
+            { return _bytesUsed; }
+
+        private:
+            std::size_t _blockSize;
+            std::vector<char*> _blocks;
+            std::vector<char*> _largeBlocks;
+            char* _ptr;
+            std::size_t _avail;
+            std::size_t _bytesUsed;
+
+            std::vector<std::string*> _names;
+            std::size_t _nameCount;
+
+            std::size_t _findSlot(const std::string& s) const;
+    };
+}
+
+#endif // CXXTOOLS_SERIALIZATIONARENA_H
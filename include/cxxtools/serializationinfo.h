@@ -33,6 +33,7 @@
 #include <cxxtools/string.h>
 #include <cxxtools/convert.h>
 #include <cxxtools/serializationerror.h>
+#include <cxxtools/serializationarena.h>
 #include <vector>
 #include <set>
 #include <map>
@@ -46,10 +47,17 @@ namespace cxxtools
 {
 
 /** @brief Represents arbitrary types during serialization.
+
+    A SerializationInfo constructed with a SerializationArena is the root
+    of an arena backed document. All members added to it use the same
+    arena: names are interned, members are stored in arena memory and
+    objects with many members get a hash index for findMember. The
+    document does not free anything itself; it is released as a whole by
+    SerializationArena::release.
 */
 class CXXTOOLS_API SerializationInfo
 {
-    typedef std::vector<SerializationInfo> Nodes;
+    struct MemberIndex;
 
     public:
         enum Category {
@@ -73,10 +81,12 @@ class CXXTOOLS_API SerializationInfo
     public:
         SerializationInfo();
 
+        /// Creates the root of a document, which keeps its data in the passed arena.
+        explicit SerializationInfo(SerializationArena& arena);
+
         SerializationInfo(const SerializationInfo& si);
 
-        ~SerializationInfo()
-        { _releaseValue(); }
+        ~SerializationInfo();
 
         void reserve(size_t n);
 
@@ -100,25 +110,31 @@ class CXXTOOLS_API SerializationInfo
             return _parent;
         }
 
+        /// Returns the arena of the document or null if the data is kept on the heap.
+        SerializationArena* arena() const
+        {
+            return _arena;
+        }
+
         const std::string& typeName() const
         {
-            return _type;
+            return _arena ? *_itype : _type;
         }
 
         void setTypeName(const std::string& type)
         {
-            _type = type;
+            if (_arena)
+                _itype = &_arena->intern(type);
+            else
+                _type = type;
         }
 
         const std::string& name() const
         {
-            return _name;
+            return _arena ? *_iname : _name;
         }
 
-        void setName(const std::string& name)
-        {
-            _name = name;
-        }
+        void setName(const std::string& name);
 
         /** @brief Serialization of flat data-types
         */
@@ -244,7 +260,7 @@ class CXXTOOLS_API SerializationInfo
 
         size_t memberCount() const
         {
-            return _nodes.size();
+            return _nodeCount;
         }
 
         Iterator begin();
@@ -262,8 +278,8 @@ class CXXTOOLS_API SerializationInfo
         void swap(SerializationInfo& si);
 
         bool isNull() const     { return _t == t_none && _category == Void; }
-        bool isString() const   { return _t == t_string; }
-        bool isString8() const  { return _t == t_string8; }
+        bool isString() const   { return _t == t_string || _t == t_astring; }
+        bool isString8() const  { return _t == t_string8 || _t == t_astring8; }
         bool isChar() const     { return _t == t_char; }
         bool isBool() const     { return _t == t_bool; }
         bool isInt() const      { return _t == t_int; }
@@ -278,14 +294,19 @@ class CXXTOOLS_API SerializationInfo
 
     private:
         SerializationInfo* _parent;
+        SerializationArena* _arena;
         Category _category;
         std::string _name;
         std::string _type;
+        const std::string* _iname;  // interned names, when _arena is set
+        const std::string* _itype;
 
         void _releaseValue();
         void _setString(const String& value);
+        void _setString(const Char* value, std::size_t length);
         void _setString8(const std::string& value);
         void _setString8(const char* value);
+        void _setString8(const char* value, std::size_t length);
         void _setChar(char value);
         void _setBool(bool value);
         void _setInt(int_type value);
@@ -299,9 +320,25 @@ class CXXTOOLS_API SerializationInfo
         unsigned_type _getUInt(const char* type, unsigned_type max) const;
         long double _getFloat(const char* type, long double max) const;
 
+        void _assign(const SerializationInfo& si);
+        void _reserve(std::size_t n);
+        void _releaseNodes();
+        void _fixParents();
+        void _moveFrom(SerializationInfo& si);
+        void _indexMember(std::size_t idx);
+        const SerializationInfo* _findMember(const std::string& name) const;
+
+        // string value in the arena
+        struct ArenaString
+        {
+            const void* _data;
+            std::size_t _length;
+        };
+
         union U
         {
             char _s[sizeof(String) >= sizeof(std::string) ? sizeof(String) : sizeof(std::string)];
+            ArenaString _a;
             char _c;
             bool _b;
             int_type _i;
@@ -317,6 +354,8 @@ class CXXTOOLS_API SerializationInfo
         std::string& _String8()                 { return *_String8Ptr(); }
         const std::string* _String8Ptr() const  { return reinterpret_cast<const std::string*>(_u._s); }
         const std::string& _String8() const     { return *_String8Ptr(); }
+        const Char* _AStr() const               { return static_cast<const Char*>(_u._a._data); }
+        const char* _AStr8() const              { return static_cast<const char*>(_u._a._data); }
 
         enum T
         {
@@ -327,10 +366,15 @@ class CXXTOOLS_API SerializationInfo
           t_bool,
           t_int,
           t_uint,
-          t_float
+          t_float,
+          t_astring,
+          t_astring8
         } _t;
 
-        Nodes _nodes;             // objects/arrays
+        SerializationInfo* _nodes;  // objects/arrays
+        std::size_t _nodeCount;
+        std::size_t _nodeCapacity;
+        MemberIndex* _index;        // only used with an arena
 };
 
 
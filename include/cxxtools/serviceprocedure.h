@@ -38,10 +38,15 @@
 namespace cxxtools
 {
 
+class ServiceProcedurePool;
+
 class ServiceProcedure
 {
+        friend class ServiceRegistry;
+
     public:
         ServiceProcedure()
+        : _pool(0)
         {}
 
         virtual ~ServiceProcedure()
@@ -49,9 +54,15 @@ class ServiceProcedure
 
         virtual ServiceProcedure* clone() const = 0;
 
+        /// Starts a call. Procedures are reused for further calls, so
+        /// the arguments are reset to their default values here.
         virtual IComposer** beginCall() = 0;
 
         virtual IDecomposer* endCall() = 0;
+
+    private:
+        // free list of the ServiceRegistry, which gets the procedure back
+        ServiceProcedurePool* _pool;
 };
 
 //! @cond internal
@@ -102,6 +113,17 @@ class BasicServiceProcedure : public ServiceProcedure
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+            _v6 = V6();
+            _v7 = V7();
+            _v8 = V8();
+            _v9 = V9();
+            _v10 = V10();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -209,6 +231,16 @@ class BasicServiceProcedure<R, A1, A2, A3, A4, A5, A6, A7, A8, A9,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+            _v6 = V6();
+            _v7 = V7();
+            _v8 = V8();
+            _v9 = V9();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -311,6 +343,15 @@ class BasicServiceProcedure<R, A1, A2, A3, A4, A5, A6, A7, A8,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+            _v6 = V6();
+            _v7 = V7();
+            _v8 = V8();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -408,6 +449,14 @@ class BasicServiceProcedure<R, A1, A2, A3, A4, A5, A6, A7,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+            _v6 = V6();
+            _v7 = V7();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -500,6 +549,13 @@ class BasicServiceProcedure<R, A1, A2, A3, A4, A5, A6,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+            _v6 = V6();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -587,6 +643,12 @@ class BasicServiceProcedure<R, A1, A2, A3, A4, A5,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+            _v5 = V5();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -669,6 +731,11 @@ class BasicServiceProcedure<R, A1, A2, A3, A4,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+            _v4 = V4();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -746,6 +813,10 @@ class BasicServiceProcedure<R, A1, A2, A3,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+            _v3 = V3();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
             _a3.begin(_v3);
@@ -818,6 +889,9 @@ class BasicServiceProcedure<R, A1, A2,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+            _v2 = V2();
+
             _a1.begin(_v1);
             _a2.begin(_v2);
 
@@ -885,6 +959,8 @@ class BasicServiceProcedure<R, A1,
 
         IComposer** beginCall()
         {
+            _v1 = V1();
+
             _a1.begin(_v1);
 
             return _args;
@@ -280,8 +280,22 @@ namespace cxxtools
                 this->registerProcedure(name, proc);
             }
 
+            /// Returns an instance of the procedure or 0, if the name is not
+            /// registered. Instances are taken from a free list, so that
+            /// a call does not need to allocate the procedure with its
+            /// argument composers and result decomposer. The instance must
+            /// be passed to releaseProcedure after the call.
             ServiceProcedure* getProcedure(const std::string& name) const;
 
+            /// Looks up a procedure once. The result is passed to
+            /// getProcedure for further calls of the same procedure, which
+            /// saves the lookup by name. It is valid as long as the
+            /// registry exists. Returns 0, if the name is not registered.
+            const ServiceProcedurePool* resolveProcedure(const std::string& name) const;
+
+            ServiceProcedure* getProcedure(const ServiceProcedurePool* pool) const;
+
+            /// Returns the procedure to its free list.
             void releaseProcedure(ServiceProcedure* proc) const;
 
             std::vector<std::string> getProcedureNames() const;
@@ -290,8 +304,16 @@ namespace cxxtools
             void registerProcedure(const std::string& name, ServiceProcedure* proc);
 
         private:
-            typedef std::map<std::string, ServiceProcedure*> ProcedureMap;
+            typedef std::map<std::string, ServiceProcedurePool*> ProcedureMap;
             ProcedureMap _procedures;
+
+            // hash index into the pools of _procedures with open addressing
+            std::vector<ServiceProcedurePool*> _index;
+
+            // pools of replaced procedures, which may still get instances back
+            std::vector<ServiceProcedurePool*> _retired;
+
+            void rebuildIndex();
     };
 
 }
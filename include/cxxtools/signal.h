@@ -38,6 +38,7 @@
 #include <cxxtools/connectable.h>
 #include <list>
 #include <map>
+#include <vector>
 
 
 namespace cxxtools {
@@ -73,7 +74,28 @@ namespace cxxtools {
 
             void disconnectSlot(const Slot& slot);
 
+        protected:
+            // The slots called by send. The invokable is cached to save the
+            // indirections through the connection and is set to 0, when the
+            // connection is closed while sending.
+            struct Target
+            {
+                Target(const Connection& c)
+                : connection(c)
+                , invokable(c.slot().callable())
+                { }
+
+                Connection connection;
+                const void* invokable;
+            };
+
+            typedef std::vector<Target> Targets;
+
+            const Targets& targets() const
+            { return _targets; }
+
         private:
+            mutable Targets _targets;
             mutable Sentry* _sentry;
             mutable bool _sending;
             mutable bool _dirty;
@@ -167,7 +189,7 @@ class Signal<const cxxtools::Event&> : public Connectable
         template <typename R>
         Connection connect(const BasicSlot<R, const cxxtools::Event&>& slot)
         {
-            Connection conn( *this, slot.clone() );
+            Connection conn( *this, slot );
             this->addRoute( 0, new IEventRoute(conn) );
             return conn;
         }
@@ -181,7 +203,7 @@ class Signal<const cxxtools::Event&> : public Connectable
         template <typename EventT>
         void subscribe( const BasicSlot<void, const EventT&>& slot )
         {
-            Connection conn( *this, slot.clone() );
+            Connection conn( *this, slot );
             const std::type_info& ti = typeid(EventT);
             this->addRoute( &ti, new EventRoute<EventT>(conn) );
         }
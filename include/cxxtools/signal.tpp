@@ -27,7 +27,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,A10>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -44,20 +44,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9, A10 a10) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -68,7 +71,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5,a6,a7,a8,a9,a10);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -105,6 +108,9 @@
             Slot* clone() const
             { return new SignalSlot(*this); }
 
+            Slot* clone(void* buffer, std::size_t size) const
+            { return sizeof(SignalSlot) <= size ? ::new (buffer) SignalSlot(*this) : clone(); }
+
             /** Returns a pointer to this object's internal Callable object. */
             virtual const void* callable() const
             {
@@ -242,7 +248,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,A9,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -259,20 +265,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8, A9 a9) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -283,7 +292,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5,a6,a7,a8,a9);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -387,7 +396,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,A8,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -404,20 +413,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7, A8 a8) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -428,7 +440,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5,a6,a7,a8);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -532,7 +544,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,A6,A7,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -549,20 +561,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6, A7 a7) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -573,7 +588,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5,a6,a7);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -677,7 +692,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,A6,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -694,20 +709,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5, A6 a6) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -718,7 +736,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5,a6);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -822,7 +840,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,A5,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -839,20 +857,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4, A5 a5) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -863,7 +884,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4,a5);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -967,7 +988,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,A4,Void,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -984,20 +1005,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3, A4 a4) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -1008,7 +1032,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3,a4);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -1112,7 +1136,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,A3,Void,Void,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -1129,20 +1153,23 @@
             */
             inline void send(A1 a1, A2 a2, A3 a3) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -1153,7 +1180,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2,a3);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -1257,7 +1284,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,A2,Void,Void,Void,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -1274,20 +1301,23 @@
             */
             inline void send(A1 a1, A2 a2) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -1298,7 +1328,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1,a2);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -1402,7 +1432,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, A1,Void,Void,Void,Void,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -1419,20 +1449,23 @@
             */
             inline void send(A1 a1) const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -1443,7 +1476,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke(a1);
 
                     // if this signal gets deleted by the slot, the Sentry
@@ -1547,7 +1580,7 @@
             template <typename R>
             Connection connect(const BasicSlot<R, Void,Void,Void,Void,Void,Void,Void,Void,Void,Void>& slot)
             {
-                return Connection(*this, slot.clone() );
+                return Connection(*this, slot);
             }
 
             /** The converse of connect(). */
@@ -1564,20 +1597,23 @@
             */
             inline void send() const
             {
+                if( SignalBase::targets().empty() )
+                    return;
+
                 // The sentry will set the Signal to the sending state and
                 // reset it to not-sending upon destruction. In the sending
                 // state, removing connection will leave invalid connections
-                // in the connection list to keep the iterator valid, but mark
+                // in the list of targets to keep the index valid, but mark
                 // the Signal dirty. If the Signal is dirty, all invalid
                 // connections will be removed by the Sentry when it destructs..
                 SignalBase::Sentry sentry(this);
 
-                std::list<Connection>::const_iterator it = Connectable::connections().begin();
-                std::list<Connection>::const_iterator end = Connectable::connections().end();
-
-                for(; it != end; ++it)
+                // Slots connected while sending are appended, so the size is
+                // checked in each step.
+                for(std::size_t n = 0; n < SignalBase::targets().size(); ++n)
                 {
-                    if( false == it->valid() || &( it->sender() ) != this  )
+                    const void* target = SignalBase::targets()[n].invokable;
+                    if( target == 0 )
                         continue;
 
                     // The following scenarios must be considered when the
@@ -1588,7 +1624,7 @@
                     //   calling any slots immediately
                     // - A new Connection might get added to this Signal in
                     //   the slot
-                    const InvokableT* invokable = static_cast<const InvokableT*>( it->slot().callable() );
+                    const InvokableT* invokable = static_cast<const InvokableT*>(target);
                     invokable->invoke();
 
                     // if this signal gets deleted by the slot, the Sentry
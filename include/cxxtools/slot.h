@@ -29,6 +29,8 @@
 #define cxxtools_Slot_h
 
 #include <cxxtools/void.h>
+#include <cxxtools/poolallocator.h>
+#include <new>
 
 namespace cxxtools {
 
@@ -38,8 +40,20 @@ namespace cxxtools {
         public:
             virtual ~Slot() {}
 
+            // slots are cloned for each connection
+            static void* operator new(std::size_t size)
+            { return PoolAllocator::global().allocate(size); }
+
+            static void operator delete(void* p, std::size_t size)
+            { PoolAllocator::global().deallocate(p, size); }
+
             virtual Slot* clone() const = 0;
 
+            // Clones the slot into buffer, when it fits, or on the heap
+            // otherwise. Connections keep small slots inline this way.
+            virtual Slot* clone(void* buffer, std::size_t size) const
+            { return clone(); }
+
             virtual const void* callable() const = 0;
 
             virtual void onConnect(const Connection& c) = 0;
@@ -0,0 +1,525 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_TASKPOOL_H
+#define CXXTOOLS_TASKPOOL_H
+
+#include <cxxtools/callable.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/condition.h>
+#include <cxxtools/noncopyable.h>
+#include <cxxtools/refcounted.h>
+#include <cxxtools/smartptr.h>
+#include <string>
+#include <deque>
+#include <cstddef>
+
+namespace cxxtools
+{
+    class TaskPoolImpl;
+    class TaskPool;
+
+    /// A unit of work executed by a TaskPool.
+    class PoolTask
+    {
+        public:
+            virtual ~PoolTask() { }
+            virtual void run() = 0;
+    };
+
+    /// The state shared between a task and the futures waiting for it.
+    class FutureStateBase : public AtomicRefCounted
+    {
+            mutable Mutex _mutex;
+            mutable Condition _finished;
+            mutable volatile atomic_t _ready;
+            std::string _error;
+            bool _failed;
+
+        public:
+            FutureStateBase()
+                : _ready(0),
+                  _failed(false)
+                { }
+
+            bool ready() const
+            { return atomicGet(_ready) != 0; }
+
+            /// Marks the state as finished and wakes all waiting threads.
+            void setFinished();
+
+            /// Records an error, which is rethrown by checkError. Only the
+            /// first error is kept.
+            void setError(const std::string& msg);
+
+            /// Blocks until the state is finished.
+            void wait() const;
+
+            /// Blocks until the state is finished or the timeout exceeds.
+            bool wait(unsigned msecs) const;
+
+            /// Throws a std::runtime_error, when an error was recorded.
+            void checkError() const;
+    };
+
+    template <typename R>
+    class FutureState : public FutureStateBase
+    {
+            R _value;
+
+        public:
+            FutureState()
+                : _value()
+                { }
+
+            void setValue(const R& value)
+            {
+                _value = value;
+                setFinished();
+            }
+
+            const R& value() const
+            { return _value; }
+    };
+
+    template <>
+    class FutureState<void> : public FutureStateBase
+    {
+    };
+
+    /** @brief A handle to the result of a task submitted to a TaskPool.
+
+        A future is copyable; all copies refer to the same result.
+        Waiting for a result in a worker thread of the pool executes other
+        tasks of the pool in the meantime, so that tasks may wait for
+        subtasks without blocking a worker.
+     */
+    template <typename R>
+    class Future
+    {
+            TaskPool* _pool;
+            SmartPtr<FutureState<R> > _state;
+
+        public:
+            Future()
+                : _pool(0)
+                { }
+
+            Future(TaskPool* pool, FutureState<R>* state)
+                : _pool(pool),
+                  _state(state)
+                { }
+
+            /// Returns true, when the future refers to a task.
+            bool valid() const
+            { return _state.getPointer() != 0; }
+
+            /// Returns true, when the task has finished.
+            bool ready() const
+            { return _state->ready(); }
+
+            /// Waits for the task to finish.
+            void wait() const;
+
+            /// Waits for the task and returns its result. When the task
+            /// failed with an exception, a std::runtime_error with the same
+            /// message is thrown.
+            const R& get() const
+            {
+                wait();
+                _state->checkError();
+                return _state->value();
+            }
+    };
+
+    template <>
+    class Future<void>
+    {
+            TaskPool* _pool;
+            SmartPtr<FutureState<void> > _state;
+
+        public:
+            Future()
+                : _pool(0)
+                { }
+
+            Future(TaskPool* pool, FutureState<void>* state)
+                : _pool(pool),
+                  _state(state)
+                { }
+
+            bool valid() const
+            { return _state.getPointer() != 0; }
+
+            bool ready() const
+            { return _state->ready(); }
+
+            void wait() const;
+
+            void get() const
+            {
+                wait();
+                _state->checkError();
+            }
+    };
+
+    /** @brief A work stealing thread pool.
+
+        Each worker thread has a deque of tasks of its own. Tasks submitted by
+        a worker are put to its own deque and processed last in first out,
+        while idle workers steal the oldest tasks from the other workers.
+        Tasks submitted from other threads are distributed through a shared
+        queue.
+
+        Unlike ThreadPool the submitted tasks may return results through a
+        Future. The fork join helpers parallelFor and parallelReduce split
+        an index range into tasks and wait for them.
+
+        @code
+          cxxtools::TaskPool pool;
+          cxxtools::Future<int> f = pool.submit(cxxtools::callable(&computeSomething));
+          // ... do something else
+          int result = f.get();
+        @endcode
+     */
+    class TaskPool : private NonCopyable
+    {
+            TaskPoolImpl* _impl;
+
+        public:
+            /** @brief Creates a pool and starts the worker threads.
+
+                When size is 0, the number of processors is used.
+             */
+            explicit TaskPool(unsigned size = 0);
+
+            /** @brief Waits for all tasks and stops the worker threads.
+             */
+            ~TaskPool();
+
+            /// Returns the number of worker threads.
+            unsigned size() const;
+
+            /// Returns the index of the worker, which runs the calling thread
+            /// or -1, when the caller is not a worker of this pool.
+            int currentWorker() const;
+
+            /** @brief Schedules a task, which does not return a result.
+
+                The optional affinity is a hint, which worker should process
+                the task; the task may still be stolen by other workers.
+                Exceptions thrown by the task are logged and ignored.
+             */
+            void schedule(const Callable<void>& cb, int affinity = -1);
+
+            /** @brief Schedules a task and returns a future for its result.
+             */
+            template <typename R>
+            Future<R> submit(const Callable<R>& cb, int affinity = -1);
+
+            /** @brief Calls f(b, e) for subranges [b, e) of [begin, end) in parallel.
+
+                The range is split into pieces of grain elements. When grain
+                is 0, a size giving some pieces per worker is chosen. The
+                calling thread processes the first piece itself and returns,
+                when all pieces are processed. When any call throws an
+                exception, a std::runtime_error is thrown afterwards.
+             */
+            template <typename Function>
+            void parallelFor(std::size_t begin, std::size_t end, const Function& f, std::size_t grain = 0);
+
+            /** @brief Calculates combine(...combine(init, f(b0, e0))..., f(bn, en)) in parallel.
+
+                The function f returns the result of a subrange. The partial
+                results are combined in index order, so combine needs to be
+                associative but not commutative.
+             */
+            template <typename T, typename Function, typename Combine>
+            T parallelReduce(std::size_t begin, std::size_t end, const T& init,
+                const Function& f, const Combine& combine, std::size_t grain = 0);
+
+            /// Puts a task into the pool, which takes ownership of it.
+            void submit(PoolTask* task, int affinity = -1);
+
+            /// Waits for the state; in a worker thread other tasks are
+            /// processed meanwhile.
+            void wait(const FutureStateBase& state);
+
+        private:
+            std::size_t grainSize(std::size_t count, std::size_t grain) const;
+    };
+
+    ////////////////////////////////////////////////////////////////////////
+    // implementation
+    //
+
+    template <typename R>
+    void Future<R>::wait() const
+    {
+        if (_pool)
+            _pool->wait(*_state);
+        else
+            _state->wait();
+    }
+
+    inline void Future<void>::wait() const
+    {
+        if (_pool)
+            _pool->wait(*_state);
+        else
+            _state->wait();
+    }
+
+    template <typename R>
+    class CallableTask : public PoolTask
+    {
+            Callable<R>* _cb;
+            SmartPtr<FutureState<R> > _state;
+
+        public:
+            CallableTask(const Callable<R>& cb, FutureState<R>* state)
+                : _cb(cb.clone()),
+                  _state(state)
+                { }
+
+            ~CallableTask()
+            { delete _cb; }
+
+            void run()
+            {
+                try
+                {
+                    _state->setValue((*_cb)());
+                    return;
+                }
+                catch (const std::exception& e)
+                {
+                    _state->setError(e.what());
+                }
+                catch (...)
+                {
+                    _state->setError("unknown exception in task");
+                }
+
+                _state->setFinished();
+            }
+    };
+
+    template <>
+    class CallableTask<void> : public PoolTask
+    {
+            Callable<void>* _cb;
+            SmartPtr<FutureState<void> > _state;
+
+        public:
+            CallableTask(const Callable<void>& cb, FutureState<void>* state)
+                : _cb(cb.clone()),
+                  _state(state)
+                { }
+
+            ~CallableTask()
+            { delete _cb; }
+
+            void run()
+            {
+                try
+                {
+                    (*_cb)();
+                }
+                catch (const std::exception& e)
+                {
+                    _state->setError(e.what());
+                }
+                catch (...)
+                {
+                    _state->setError("unknown exception in task");
+                }
+
+                _state->setFinished();
+            }
+    };
+
+    /// Counts down the pieces of a parallel loop.
+    class TaskLatch : public FutureStateBase
+    {
+            volatile atomic_t _count;
+
+        public:
+            explicit TaskLatch(atomic_t count)
+                : _count(count)
+                { }
+
+            void countDown()
+            {
+                if (atomicDecrement(_count) == 0)
+                    setFinished();
+            }
+    };
+
+    template <typename Function>
+    class RangeTask : public PoolTask
+    {
+            const Function& _f;
+            std::size_t _begin;
+            std::size_t _end;
+            SmartPtr<TaskLatch> _latch;
+
+        public:
+            RangeTask(const Function& f, std::size_t begin, std::size_t end, TaskLatch* latch)
+                : _f(f),
+                  _begin(begin),
+                  _end(end),
+                  _latch(latch)
+                { }
+
+            void run()
+            {
+                try
+                {
+                    _f(_begin, _end);
+                }
+                catch (const std::exception& e)
+                {
+                    _latch->setError(e.what());
+                }
+                catch (...)
+                {
+                    _latch->setError("unknown exception in task");
+                }
+
+                _latch->countDown();
+            }
+    };
+
+    template <typename T, typename Function>
+    class ReduceTask : public PoolTask
+    {
+            const Function& _f;
+            std::size_t _begin;
+            std::size_t _end;
+            T& _result;
+            SmartPtr<TaskLatch> _latch;
+
+        public:
+            ReduceTask(const Function& f, std::size_t begin, std::size_t end, T& result, TaskLatch* latch)
+                : _f(f),
+                  _begin(begin),
+                  _end(end),
+                  _result(result),
+                  _latch(latch)
+                { }
+
+            void run()
+            {
+                try
+                {
+                    _result = _f(_begin, _end);
+                }
+                catch (const std::exception& e)
+                {
+                    _latch->setError(e.what());
+                }
+                catch (...)
+                {
+                    _latch->setError("unknown exception in task");
+                }
+
+                _latch->countDown();
+            }
+    };
+
+    template <typename R>
+    Future<R> TaskPool::submit(const Callable<R>& cb, int affinity)
+    {
+        FutureState<R>* state = new FutureState<R>();
+        Future<R> future(this, state);
+        submit(new CallableTask<R>(cb, state), affinity);
+        return future;
+    }
+
+    template <typename Function>
+    void TaskPool::parallelFor(std::size_t begin, std::size_t end, const Function& f, std::size_t grain)
+    {
+        if (begin >= end)
+            return;
+
+        grain = grainSize(end - begin, grain);
+        std::size_t pieces = (end - begin + grain - 1) / grain;
+
+        SmartPtr<TaskLatch> latch(new TaskLatch(static_cast<atomic_t>(pieces)));
+
+        bool worker = currentWorker() >= 0;
+        std::size_t piece = 1;
+        for (std::size_t b = begin + grain; b < end; b += grain, ++piece)
+        {
+            std::size_t e = end - b > grain ? b + grain : end;
+            submit(new RangeTask<Function>(f, b, e, latch.getPointer()),
+                worker ? -1 : static_cast<int>(piece % size()));
+        }
+
+        RangeTask<Function>(f, begin, end - begin > grain ? begin + grain : end, latch.getPointer()).run();
+
+        wait(*latch);
+        latch->checkError();
+    }
+
+    template <typename T, typename Function, typename Combine>
+    T TaskPool::parallelReduce(std::size_t begin, std::size_t end, const T& init,
+        const Function& f, const Combine& combine, std::size_t grain)
+    {
+        if (begin >= end)
+            return init;
+
+        grain = grainSize(end - begin, grain);
+        std::size_t pieces = (end - begin + grain - 1) / grain;
+
+        std::deque<T> results(pieces, init);
+        SmartPtr<TaskLatch> latch(new TaskLatch(static_cast<atomic_t>(pieces)));
+
+        bool worker = currentWorker() >= 0;
+        std::size_t piece = 1;
+        for (std::size_t b = begin + grain; b < end; b += grain, ++piece)
+        {
+            std::size_t e = end - b > grain ? b + grain : end;
+            submit(new ReduceTask<T, Function>(f, b, e, results[piece], latch.getPointer()),
+                worker ? -1 : static_cast<int>(piece % size()));
+        }
+
+        ReduceTask<T, Function>(f, begin, end - begin > grain ? begin + grain : end,
+            results[0], latch.getPointer()).run();
+
+        wait(*latch);
+        latch->checkError();
+
+        T result = init;
+        for (typename std::deque<T>::const_iterator it = results.begin(); it != results.end(); ++it)
+            result = combine(result, *it);
+
+        return result;
+    }
+}
+
+#endif // CXXTOOLS_TASKPOOL_H
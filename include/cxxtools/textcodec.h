@@ -366,7 +366,7 @@ std::basic_string<typename CodecType::InternT> decode(const typename CodecType::
 {
     CodecType codec;
 
-    typename CodecType::InternT to[64];
+    typename CodecType::InternT to[256];
     MBState state;
     std::basic_string<typename CodecType::InternT> ret;
     const typename CodecType::ExternT* from = data;
@@ -385,7 +385,7 @@ std::basic_string<typename CodecType::InternT> decode(const typename CodecType::
         if (r == CodecType::partial && from_next == from)
             throw ConversionError("character conversion failed - unexpected end of input sequence");
 
-        ret.append(to, to_next);
+        ret.append(to, to_next - to);
 
         size -= (from_next - from);
         from = from_next;
@@ -419,7 +419,7 @@ template <typename CodecType>
 std::basic_string<typename CodecType::ExternT> encode(const typename CodecType::InternT* data, unsigned size)
 {
     CodecType codec;
-    char to[64];
+    char to[256];
     MBState state;
     
     typename CodecType::result r;
@@ -435,7 +435,7 @@ std::basic_string<typename CodecType::ExternT> encode(const typename CodecType::
         if (r == CodecType::error)
             throw ConversionError("character conversion failed");
 
-        ret.append(to, to_next);
+        ret.append(to, to_next - to);
 
         size -= (from_next - from);
         from = from_next;
@@ -447,7 +447,7 @@ std::basic_string<typename CodecType::ExternT> encode(const typename CodecType::
     if (r == CodecType::error)
         throw ConversionError("character conversion failed");
 
-    ret.append(to, to_next);
+    ret.append(to, to_next - to);
 
     return ret;
 }
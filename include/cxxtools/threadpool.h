@@ -30,6 +30,7 @@
 #define CXXTOOLS_THREADPOOL_H
 
 #include <cxxtools/callable.h>
+#include <cstddef>
 
 namespace cxxtools
 {
@@ -42,8 +43,13 @@ namespace cxxtools
 
                 When the argument \a doStart is set to true (which is the
                 default), the threads are started.
+
+                When \a queueSize is not 0, the tasks are passed to the
+                threads through a lock free queue (see MpmcQueue) of that
+                size instead of a unlimited queue protected by a mutex.
+                Scheduling a task blocks then, while the queue is full.
              */
-            explicit ThreadPool(unsigned size, bool doStart = true);
+            explicit ThreadPool(unsigned size, bool doStart = true, std::size_t queueSize = 0);
 
             /** @brief Destroys a thread pool structure.
 
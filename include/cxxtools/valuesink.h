@@ -0,0 +1,295 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_VALUESINK_H
+#define CXXTOOLS_VALUESINK_H
+
+#include <cxxtools/api.h>
+#include <cxxtools/serializationinfo.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <map>
+
+namespace cxxtools
+{
+    /**
+     * Receives the values of a parser directly.
+     *
+     * A deserializer normally builds a SerializationInfo of the whole
+     * input before the object is read from it. With
+     * Deserializer::deserializeDirect the events of the parser go to a
+     * sink instead. ValueSink<T> is the sink for type T.
+     */
+    class CXXTOOLS_API IValueSink
+    {
+        public:
+            typedef SerializationInfo::int_type int_type;
+            typedef SerializationInfo::unsigned_type unsigned_type;
+
+            virtual ~IValueSink()
+            { }
+
+            virtual void setCategory(SerializationInfo::Category category)
+            { }
+
+            virtual void setName(const std::string& name)
+            { }
+
+            virtual void setTypeName(const std::string& type)
+            { }
+
+            virtual void setValue(const String& value) = 0;
+
+            virtual void setValue(const std::string& value) = 0;
+
+            virtual void setValue(bool value) = 0;
+
+            virtual void setValue(int_type value) = 0;
+
+            virtual void setValue(unsigned_type value) = 0;
+
+            virtual void setValue(long double value) = 0;
+
+            virtual void setNull() = 0;
+
+            /// Returns the sink for the member or array element starting now.
+            virtual IValueSink* beginMember(const std::string& name, const std::string& type, SerializationInfo::Category category) = 0;
+
+            /// Called with the number of members, when the parser knows it
+            /// in advance.
+            virtual void reserve(std::size_t n)
+            { }
+
+            /// Called after the sink returned by beginMember is finished.
+            virtual void leaveMember()
+            { }
+
+            /// Called when the value is complete.
+            virtual void finish()
+            { }
+    };
+
+    /**
+     * Sink, which collects a value in a SerializationInfo.
+     *
+     * This is used for all types without a sink of their own. Since the
+     * sink is reused for each element of a container, only one element
+     * is kept in memory at a time.
+     */
+    class CXXTOOLS_API SiValueSink : public IValueSink
+    {
+        public:
+            SiValueSink()
+                : _current(&_si)
+            { }
+
+            void begin()
+            {
+                _si.clear();
+                _current = &_si;
+            }
+
+            virtual void setCategory(SerializationInfo::Category category);
+
+            virtual void setName(const std::string& name);
+
+            virtual void setTypeName(const std::string& type);
+
+            virtual void setValue(const String& value);
+
+            virtual void setValue(const std::string& value);
+
+            virtual void setValue(bool value);
+
+            virtual void setValue(int_type value);
+
+            virtual void setValue(unsigned_type value);
+
+            virtual void setValue(long double value);
+
+            virtual void setNull();
+
+            virtual IValueSink* beginMember(const std::string& name, const std::string& type, SerializationInfo::Category category);
+
+            virtual void finish();
+
+        protected:
+            /// Called with the complete value.
+            virtual void finishValue(const SerializationInfo& si) = 0;
+
+        private:
+            SerializationInfo _si;
+            SerializationInfo* _current;
+    };
+
+    template <typename T>
+    class ValueSink : public SiValueSink
+    {
+        public:
+            ValueSink()
+                : _value(0)
+            { }
+
+            void begin(T& value)
+            {
+                _value = &value;
+                SiValueSink::begin();
+            }
+
+        protected:
+            virtual void finishValue(const SerializationInfo& si)
+            { si >>= *_value; }
+
+        private:
+            T* _value;
+    };
+
+    /**
+     * Base of sinks for containers. Scalar values given for the container
+     * itself are ignored.
+     */
+    class CXXTOOLS_API ContainerSink : public IValueSink
+    {
+        public:
+            virtual void setValue(const String& value)        { }
+            virtual void setValue(const std::string& value)   { }
+            virtual void setValue(bool value)                 { }
+            virtual void setValue(int_type value)             { }
+            virtual void setValue(unsigned_type value)        { }
+            virtual void setValue(long double value)          { }
+            virtual void setNull()                            { }
+
+        protected:
+            static void beginElement(IValueSink& sink, const std::string& name, const std::string& type, SerializationInfo::Category category)
+            {
+                sink.setName(name);
+                sink.setTypeName(type);
+                sink.setCategory(category);
+            }
+    };
+
+    /// Sink for sequences, where each element is appended and filled in place.
+    template <typename C>
+    class SequenceSink : public ContainerSink
+    {
+        public:
+            typedef typename C::value_type value_type;
+
+            SequenceSink()
+                : _value(0)
+            { }
+
+            void begin(C& value)
+            {
+                _value = &value;
+                _value->clear();
+            }
+
+            virtual IValueSink* beginMember(const std::string& name, const std::string& type, SerializationInfo::Category category)
+            {
+                _value->resize(_value->size() + 1);
+                _element.begin(_value->back());
+                beginElement(_element, name, type, category);
+                return &_element;
+            }
+
+        protected:
+            C& value()
+            { return *_value; }
+
+        private:
+            C* _value;
+            ValueSink<value_type> _element;
+    };
+
+    /// Sink for associative containers, where each element is inserted, when it is complete.
+    template <typename C, typename E>
+    class InsertSink : public ContainerSink
+    {
+        public:
+            InsertSink()
+                : _value(0)
+            { }
+
+            void begin(C& value)
+            {
+                _value = &value;
+                _value->clear();
+            }
+
+            virtual IValueSink* beginMember(const std::string& name, const std::string& type, SerializationInfo::Category category)
+            {
+                _elementValue = E();
+                _element.begin(_elementValue);
+                beginElement(_element, name, type, category);
+                return &_element;
+            }
+
+            virtual void leaveMember()
+            { _value->insert(_elementValue); }
+
+        private:
+            C* _value;
+            E _elementValue;
+            ValueSink<E> _element;
+    };
+
+    template <typename T, typename A>
+    class ValueSink<std::vector<T, A> > : public SequenceSink<std::vector<T, A> >
+    {
+        public:
+            virtual void reserve(std::size_t n)
+            { this->value().reserve(n); }
+    };
+
+    template <typename T, typename A>
+    class ValueSink<std::list<T, A> > : public SequenceSink<std::list<T, A> >
+    { };
+
+    template <typename T, typename A>
+    class ValueSink<std::deque<T, A> > : public SequenceSink<std::deque<T, A> >
+    { };
+
+    template <typename T, typename C, typename A>
+    class ValueSink<std::set<T, C, A> > : public InsertSink<std::set<T, C, A>, T>
+    { };
+
+    template <typename T, typename C, typename A>
+    class ValueSink<std::multiset<T, C, A> > : public InsertSink<std::multiset<T, C, A>, T>
+    { };
+
+    template <typename K, typename V, typename P, typename A>
+    class ValueSink<std::map<K, V, P, A> > : public InsertSink<std::map<K, V, P, A>, std::pair<K, V> >
+    { };
+
+    template <typename K, typename V, typename P, typename A>
+    class ValueSink<std::multimap<K, V, P, A> > : public InsertSink<std::multimap<K, V, P, A>, std::pair<K, V> >
+    { };
+}
+
+#endif // CXXTOOLS_VALUESINK_H
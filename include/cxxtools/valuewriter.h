@@ -0,0 +1,270 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_VALUEWRITER_H
+#define CXXTOOLS_VALUEWRITER_H
+
+#include <cxxtools/api.h>
+#include <cxxtools/formatter.h>
+#include <cxxtools/decomposer.h>
+#include <cxxtools/serializationinfo.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <map>
+
+namespace cxxtools
+{
+    /**
+     * Writes values directly to a formatter.
+     *
+     * The serializers normally convert an object to a SerializationInfo
+     * first, which is then passed to the formatter. The ValueWriter skips
+     * that step. A type is written by defining an operator like this:
+     *
+     * @code
+     * void operator<<= (cxxtools::ValueWriter& w, const Configuration& config)
+     * {
+     *   w.beginObject("Configuration");
+     *   w.addMember("encoding") <<= config.encoding;
+     *   w.addMember("plug-ins") <<= config.plugIns;
+     *   w.finishObject();
+     * }
+     * @endcode
+     *
+     * Types, which do not have such an operator, are written using their
+     * operator for SerializationInfo, so the SerializationInfo is only
+     * built for the value itself and not for the whole container.
+     */
+    class CXXTOOLS_API ValueWriter
+    {
+            ValueWriter(const ValueWriter&);
+            ValueWriter& operator=(const ValueWriter&);
+
+        public:
+            typedef Formatter::int_type int_type;
+            typedef Formatter::unsigned_type unsigned_type;
+
+            explicit ValueWriter(Formatter& formatter, const std::string& name = std::string())
+                : _formatter(formatter),
+                  _name(name)
+            { }
+
+            Formatter& formatter()
+            { return _formatter; }
+
+            /// Returns the name of the next value.
+            const std::string& name() const
+            { return _name; }
+
+            void addValue(const std::string& type, bool value)
+            { _formatter.addValueBool(_name, type, value); }
+
+            void addValue(const std::string& type, int_type value)
+            { _formatter.addValueInt(_name, type, value); }
+
+            void addValue(const std::string& type, unsigned_type value)
+            { _formatter.addValueUnsigned(_name, type, value); }
+
+            void addValue(const std::string& type, long double value)
+            { _formatter.addValueFloat(_name, type, value); }
+
+            void addValue(const std::string& type, const std::string& value)
+            { _formatter.addValueStdString(_name, type, value); }
+
+            void addValue(const std::string& type, const String& value)
+            { _formatter.addValueString(_name, type, value); }
+
+            void addNull(const std::string& type)
+            { _formatter.addNull(_name, type); }
+
+            void beginObject(const std::string& type);
+
+            /// Starts the next member of the current object and returns the writer for its value.
+            ValueWriter& addMember(const std::string& name);
+
+            void finishObject();
+
+            void beginArray(const std::string& type);
+
+            /// Returns the writer for the next element of the current array.
+            ValueWriter& addElement()
+            {
+                _name.clear();
+                return *this;
+            }
+
+            void finishArray();
+
+        private:
+            Formatter& _formatter;
+            std::string _name;
+            std::vector<bool> _memberOpen;
+    };
+
+    /// Writes a value using its operator for SerializationInfo.
+    template <typename T>
+    inline void operator <<=(ValueWriter& w, const T& value)
+    {
+        SerializationInfo si;
+        si <<= value;
+        si.setName(w.name());
+        IDecomposer::formatEach(si, w.formatter());
+    }
+
+    inline void operator <<=(ValueWriter& w, bool n)
+    { w.addValue("bool", n); }
+
+    inline void operator <<=(ValueWriter& w, char n)
+    { w.addValue("char", String(1, Char(n))); }
+
+    inline void operator <<=(ValueWriter& w, signed char n)
+    { w.addValue("char", static_cast<ValueWriter::int_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, unsigned char n)
+    { w.addValue("char", static_cast<ValueWriter::unsigned_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, short n)
+    { w.addValue("int", static_cast<ValueWriter::int_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, unsigned short n)
+    { w.addValue("int", static_cast<ValueWriter::unsigned_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, int n)
+    { w.addValue("int", static_cast<ValueWriter::int_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, unsigned int n)
+    { w.addValue("int", static_cast<ValueWriter::unsigned_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, long n)
+    { w.addValue("int", static_cast<ValueWriter::int_type>(n)); }
+
+    inline void operator <<=(ValueWriter& w, unsigned long n)
+    { w.addValue("int", static_cast<ValueWriter::unsigned_type>(n)); }
+
+#ifdef HAVE_LONG_LONG
+    inline void operator <<=(ValueWriter& w, long long n)
+    { w.addValue("int", static_cast<ValueWriter::int_type>(n)); }
+#endif
+
+#ifdef HAVE_UNSIGNED_LONG_LONG
+    inline void operator <<=(ValueWriter& w, unsigned long long n)
+    { w.addValue("int", static_cast<ValueWriter::unsigned_type>(n)); }
+#endif
+
+    inline void operator <<=(ValueWriter& w, float n)
+    { w.addValue("double", static_cast<long double>(n)); }
+
+    inline void operator <<=(ValueWriter& w, double n)
+    { w.addValue("double", static_cast<long double>(n)); }
+
+    inline void operator <<=(ValueWriter& w, const std::string& n)
+    { w.addValue("string", n); }
+
+    inline void operator <<=(ValueWriter& w, const char* n)
+    { w.addValue("string", std::string(n)); }
+
+    inline void operator <<=(ValueWriter& w, const String& n)
+    { w.addValue("string", n); }
+
+    /// Writes the elements of a container as an array.
+    template <typename Iterator>
+    void writeArray(ValueWriter& w, const std::string& type, Iterator begin, Iterator end)
+    {
+        w.beginArray(type);
+        for ( ; begin != end; ++begin)
+            w.addElement() <<= *begin;
+        w.finishArray();
+    }
+
+    template <typename T, typename A>
+    inline void operator <<=(ValueWriter& w, const std::vector<T, A>& vec)
+    { writeArray(w, "array", vec.begin(), vec.end()); }
+
+    template <typename T, typename A>
+    inline void operator <<=(ValueWriter& w, const std::list<T, A>& list)
+    { writeArray(w, "list", list.begin(), list.end()); }
+
+    template <typename T, typename A>
+    inline void operator <<=(ValueWriter& w, const std::deque<T, A>& deque)
+    { writeArray(w, "deque", deque.begin(), deque.end()); }
+
+    template <typename T, typename C, typename A>
+    inline void operator <<=(ValueWriter& w, const std::set<T, C, A>& set)
+    { writeArray(w, "set", set.begin(), set.end()); }
+
+    template <typename T, typename C, typename A>
+    inline void operator <<=(ValueWriter& w, const std::multiset<T, C, A>& multiset)
+    { writeArray(w, "multiset", multiset.begin(), multiset.end()); }
+
+    template <typename A, typename B>
+    inline void operator <<=(ValueWriter& w, const std::pair<A, B>& p)
+    {
+        w.beginObject("pair");
+        w.addMember("first") <<= p.first;
+        w.addMember("second") <<= p.second;
+        w.finishObject();
+    }
+
+    template <typename K, typename V, typename P, typename A>
+    inline void operator <<=(ValueWriter& w, const std::map<K, V, P, A>& map)
+    { writeArray(w, "map", map.begin(), map.end()); }
+
+    template <typename K, typename V, typename P, typename A>
+    inline void operator <<=(ValueWriter& w, const std::multimap<K, V, P, A>& multimap)
+    { writeArray(w, "multimap", multimap.begin(), multimap.end()); }
+
+    /**
+     * Decomposer, which writes the value with a ValueWriter.
+     */
+    template <typename T>
+    class ValueDecomposer : public IDecomposer
+    {
+        public:
+            ValueDecomposer()
+                : _value(0)
+            { }
+
+            void begin(const T& value)
+            { _value = &value; }
+
+            virtual void setName(const std::string& name)
+            { _name = name; }
+
+            virtual void format(Formatter& formatter)
+            {
+                ValueWriter w(formatter, _name);
+                w <<= *_value;
+            }
+
+        private:
+            const T* _value;
+            std::string _name;
+    };
+}
+
+#endif // CXXTOOLS_VALUEWRITER_H
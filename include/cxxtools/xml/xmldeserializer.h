@@ -31,6 +31,7 @@
 #include <cxxtools/string.h>
 #include <cxxtools/deserializer.h>
 #include "cxxtools/xml/xmlreader.h"
+#include "cxxtools/xml/xmltokenizer.h"
 #include <memory>
 
 namespace cxxtools
@@ -40,6 +41,7 @@ namespace xml
 {
 
     class XmlReader;
+    class XmlTokenizer;
     class Node;
 
     /** @brief Deserialize objects or object data to XML
@@ -52,6 +54,13 @@ namespace xml
         public:
             XmlDeserializer(cxxtools::xml::XmlReader& reader);
 
+            /** @brief Deserializes from a XmlTokenizer
+
+                This is faster than using a XmlReader but accepts UTF-8
+                encoded input only.
+            */
+            XmlDeserializer(cxxtools::xml::XmlTokenizer& tokenizer);
+
             XmlDeserializer(std::istream& is);
 
             cxxtools::xml::XmlReader& reader()
@@ -72,6 +81,13 @@ namespace xml
                d.deserialize(type);
             }
 
+            template <typename T>
+            static void toObject(XmlTokenizer& in, T& type)
+            {
+               XmlDeserializer d(in);
+               d.deserialize(type);
+            }
+
             template <typename T>
             static void toObject(std::istream& in, T& type)
             {
@@ -83,22 +99,22 @@ namespace xml
             void doDeserialize();
 
             //! @internal
-            void beginDocument(const cxxtools::xml::Node& node);
+            void beginDocument(cxxtools::xml::Node::Type type);
 
             //! @internal
-            void onRootElement(const cxxtools::xml::Node& node);
+            void onRootElement(cxxtools::xml::Node::Type type);
 
             //! @internal
-            void onStartElement(const cxxtools::xml::Node& node);
+            void onStartElement(cxxtools::xml::Node::Type type);
 
             //! @internal
-            void onWhitespace(const cxxtools::xml::Node& node);
+            void onWhitespace(cxxtools::xml::Node::Type type);
 
             //! @internal
-            void onContent(const cxxtools::xml::Node& node);
+            void onContent(cxxtools::xml::Node::Type type);
 
             //! @internal
-            void onEndElement(const cxxtools::xml::Node& node);
+            void onEndElement(cxxtools::xml::Node::Type type);
 
         private:
             //! @internal
@@ -108,7 +124,25 @@ namespace xml
             std::auto_ptr<cxxtools::xml::XmlReader> _deleter;
 
             //! @internal
-            typedef void (XmlDeserializer::*ProcessNode)(const cxxtools::xml::Node&);
+            cxxtools::xml::XmlTokenizer* _tokenizer;
+
+            //! @internal the current node when reading from a XmlReader
+            const cxxtools::xml::Node* _node;
+
+            //! @internal
+            const cxxtools::xml::XmlSymbolTable* _symbols;
+
+            XmlSymbol _typeSymbol;
+
+            XmlSymbol _categorySymbol;
+
+            //! @internal decoded text of the current tokenizer event
+            cxxtools::String _content;
+
+            bool _contentValid;
+
+            //! @internal
+            typedef void (XmlDeserializer::*ProcessNode)(cxxtools::xml::Node::Type);
 
             //! @internal
             ProcessNode _processNode;
@@ -126,6 +160,16 @@ namespace xml
 
             SerializationInfo::Category nodeCategory() const;
 
+            void doDeserialize(cxxtools::xml::XmlTokenizer& tokenizer);
+
+            void readStartElement();
+
+            const cxxtools::String& endElementName() const;
+
+            const cxxtools::String& content();
+
+            std::size_t depth() const;
+
     };
 
 } // namespace xml
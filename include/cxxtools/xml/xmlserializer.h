@@ -30,6 +30,7 @@
 
 #include <cxxtools/xml/xmlformatter.h>
 #include <cxxtools/decomposer.h>
+#include <cxxtools/valuewriter.h>
 #include <sstream>
 
 namespace cxxtools
@@ -151,6 +152,20 @@ class XmlSerializer
             _formatter.flush();
         }
 
+        /** @brief Serialize an object to XML without building a SerializationInfo
+
+            The object is written with a ValueWriter directly to the
+            formatter. See ValueWriter for how to make a type writable.
+        */
+        template <typename T>
+        void serializeDirect(const T& type, const std::string& name)
+        {
+            ValueWriter w(_formatter, name);
+            w <<= type;
+            _formatter.finish();
+            _formatter.flush();
+        }
+
         void finish()
         {
         }
@@ -0,0 +1,289 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef cxxtools_Xml_XmlTokenizer_h
+#define cxxtools_Xml_XmlTokenizer_h
+
+#include <cxxtools/string.h>
+#include <cxxtools/xml/api.h>
+#include <cxxtools/xml/node.h>
+#include <cxxtools/xml/entityresolver.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstring>
+
+namespace cxxtools {
+
+namespace xml {
+
+/// Id of a name interned in a XmlSymbolTable. Equal names get equal ids.
+typedef unsigned XmlSymbol;
+
+/** @brief Interns UTF-8 encoded element and attribute names.
+
+    Every distinct name is stored once and identified by a small integer,
+    so that names can be compared by id. The table may be shared by
+    several tokenizers to get stable ids across documents.
+*/
+class CXXTOOLS_XML_API XmlSymbolTable
+{
+    public:
+        //! Returned by find() for names, which are not in the table.
+        static const XmlSymbol none;
+
+        XmlSymbolTable();
+
+        //! Returns the id of the name; the name is added when not found.
+        XmlSymbol intern(const char* name, std::size_t len);
+
+        XmlSymbol intern(const char* name)
+        { return intern(name, std::strlen(name)); }
+
+        XmlSymbol intern(const std::string& name)
+        { return intern(name.data(), name.size()); }
+
+        //! Returns the id of the name or none when it was never interned.
+        XmlSymbol find(const char* name, std::size_t len) const;
+
+        XmlSymbol find(const char* name) const
+        { return find(name, std::strlen(name)); }
+
+        //! Returns the UTF-8 encoded name of the symbol.
+        const std::string& name(XmlSymbol sym) const
+        { return _entries[sym].name; }
+
+        //! Returns the decoded name of the symbol.
+        const String& nameString(XmlSymbol sym) const
+        { return _entries[sym].nameString; }
+
+        std::size_t size() const
+        { return _entries.size(); }
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            String nameString;
+            unsigned hash;
+        };
+
+        std::vector<Entry> _entries;
+
+        // open addressing hash table of entry index + 1; 0 marks a free slot
+        std::vector<unsigned> _slots;
+};
+
+/** @brief Pull parser for UTF-8 encoded XML documents.
+
+    XmlTokenizer is a fast alternative to XmlReader for the common case
+    of UTF-8 input. It parses a document from a byte buffer and reports
+    the same kind of events, but instead of building Node objects it keeps
+    the state of the current event in the tokenizer itself:
+
+    @li element and attribute names are interned into a XmlSymbolTable and
+        reported as symbols,
+    @li character data and attribute values are reported as views into
+        the input buffer; only when entities or CDATA sections have to be
+        decoded, they refer to an internal buffer,
+    @li the storage for attributes and decoded text is reused for all
+        events.
+
+    Views and attributes stay valid until the next call to next().
+
+    Only the events Node::StartElement, Node::EndElement,
+    Node::Characters and Node::EndDocument are reported. The xml
+    declaration, processing instructions, comments and the document type
+    declaration are skipped. Namespace prefixes are kept as part of the
+    names.
+
+    @code
+    XmlTokenizer tok(data, size);
+    XmlSymbol item = tok.symbols().intern("item");
+    while (tok.next() != Node::EndDocument)
+    {
+        if (tok.type() == Node::StartElement && tok.name() == item)
+            std::cout << tok.attribute("id").str() << std::endl;
+    }
+    @endcode
+*/
+class CXXTOOLS_XML_API XmlTokenizer
+{
+    public:
+        //! A view into the input or into decoded text.
+        class Text
+        {
+            public:
+                Text()
+                : _data(0), _size(0)
+                { }
+
+                Text(const char* data, std::size_t size)
+                : _data(data), _size(size)
+                { }
+
+                const char* data() const
+                { return _data; }
+
+                std::size_t size() const
+                { return _size; }
+
+                bool empty() const
+                { return _size == 0; }
+
+                const char* begin() const
+                { return _data; }
+
+                const char* end() const
+                { return _data + _size; }
+
+                //! Returns the text as a UTF-8 encoded std::string.
+                std::string str() const
+                { return std::string(_data, _size); }
+
+                //! Returns the decoded text.
+                String toString() const;
+
+                bool operator==(const char* s) const
+                { return std::strlen(s) == _size && std::memcmp(s, _data, _size) == 0; }
+
+                bool operator!=(const char* s) const
+                { return !operator==(s); }
+
+            private:
+                const char* _data;
+                std::size_t _size;
+        };
+
+        struct Attribute
+        {
+            XmlSymbol name;
+            Text value;
+        };
+
+        //! Creates a tokenizer, which parses the buffer without copying it.
+        XmlTokenizer(const char* data, std::size_t size);
+
+        XmlTokenizer(const char* data, std::size_t size, XmlSymbolTable& symbols);
+
+        //! Creates a tokenizer, which reads the whole stream into a buffer.
+        explicit XmlTokenizer(std::istream& in);
+
+        XmlTokenizer(std::istream& in, XmlSymbolTable& symbols);
+
+        //! Starts parsing a new document; the symbol table is kept.
+        void reset(const char* data, std::size_t size);
+
+        void reset(std::istream& in);
+
+        //! Parses the next event and returns its type.
+        Node::Type next();
+
+        //! Returns the type of the current event or Node::StartDocument before the first call to next().
+        Node::Type type() const
+        { return _type; }
+
+        //! Returns the name of the current start or end element.
+        XmlSymbol name() const
+        { return _name; }
+
+        const String& nameString() const
+        { return _symbols->nameString(_name); }
+
+        //! Returns the content of the current characters event.
+        const Text& text() const
+        { return _text; }
+
+        const std::vector<Attribute>& attributes() const
+        { return _attributes; }
+
+        //! Returns the value of an attribute of the current start element or an empty text.
+        Text attribute(XmlSymbol name) const;
+
+        Text attribute(const char* name) const;
+
+        bool hasAttribute(XmlSymbol name) const;
+
+        //! Returns the number of open elements.
+        std::size_t depth() const
+        { return _open.size(); }
+
+        std::size_t line() const;
+
+        XmlSymbolTable& symbols()
+        { return *_symbols; }
+
+        const XmlSymbolTable& symbols() const
+        { return *_symbols; }
+
+        EntityResolver& entityResolver()
+        { return _resolver; }
+
+        const EntityResolver& entityResolver() const
+        { return _resolver; }
+
+    private:
+        XmlTokenizer(const XmlTokenizer&);
+        XmlTokenizer& operator=(const XmlTokenizer&);
+
+        void init(const char* data, std::size_t size);
+        void appendText(const char* b, const char* e, bool entities);
+        void decode(const char* b, const char* e, std::string& out);
+        const char* find(const char* p, const char* delim) const;
+        const char* skipDocType(const char* p);
+        const char* parseStartElement(const char* p);
+        const char* parseEndElement(const char* p);
+        void syntaxError(const char* msg, const char* p) const;
+
+        std::string _input;
+        const char* _begin;
+        const char* _pos;
+        const char* _end;
+
+        XmlSymbolTable _ownSymbols;
+        XmlSymbolTable* _symbols;
+        EntityResolver _resolver;
+
+        Node::Type _type;
+        XmlSymbol _name;
+        Text _text;
+        bool _textDecoded;
+        bool _emptyElement;
+        std::vector<Attribute> _attributes;
+        std::vector<XmlSymbol> _open;
+
+        std::string _textBuffer;
+        std::string _attributeBuffer;
+        // index of attributes with decoded values and their offset in _attributeBuffer
+        std::vector<std::pair<std::size_t, std::size_t> > _decodedAttributes;
+};
+
+}
+
+}
+
+#endif
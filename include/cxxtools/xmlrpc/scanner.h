@@ -30,6 +30,8 @@
 
 #include <cxxtools/xmlrpc/api.h>
 #include <cxxtools/string.h>
+#include <cxxtools/xml/node.h>
+#include <cxxtools/xml/xmltokenizer.h>
 
 namespace cxxtools
 {
@@ -37,13 +39,6 @@ namespace cxxtools
 class DeserializerBase;
 class IComposer;
 
-namespace xml
-{
-
-class Node;
-
-}
-
 namespace xmlrpc
 {
 
@@ -74,11 +69,26 @@ class CXXTOOLS_XMLRPC_API Scanner
         OnArrayEnd
     };
 
+    enum Tag
+    {
+        OtherTag,
+        ValueTag,
+        StructTag,
+        ArrayTag,
+        MemberTag,
+        NameTag,
+        DataTag,
+        ParamTag,
+        FaultTag,
+        TagCount
+    };
+
     public:
         Scanner()
         : _state(OnParam)
         , _deserializer(0)
         , _composer(0)
+        , _symbols(0)
         {}
 
         ~Scanner()
@@ -88,12 +98,24 @@ class CXXTOOLS_XMLRPC_API Scanner
 
         bool advance(const xml::Node& node);
 
+        //! Processes the current event of the tokenizer.
+        bool advance(xml::XmlTokenizer& tokenizer);
+
     private:
+        static Tag tagOf(const String& name);
+
+        bool advance(xml::Node::Type type, Tag tag, const String& text);
+
         State _state;
         DeserializerBase* _deserializer;
         IComposer* _composer;
         String _value;
         String _type;
+        String _text;
+
+        // ids of the tag names in the symbol table of the last tokenizer
+        const xml::XmlSymbolTable* _symbols;
+        xml::XmlSymbol _tags[TagCount];
 };
 
 }
@@ -29,22 +29,123 @@
 #include <cxxtools/bin/deserializer.h>
 #include <cxxtools/bin/valueparser.h>
 #include <cxxtools/serializationerror.h>
+#include "packedarray.h"
 
 namespace cxxtools
 {
 namespace bin
 {
+namespace
+{
+    // Values with name dictionary start with Serializer::NameDictionary
+    // and are not read here, so that the name is always a plain string.
+    void skipName(std::istream& in)
+    {
+        int ch;
+        do
+        {
+            ch = in.get();
+        } while (ch != '\0' && ch != std::char_traits<char>::eof());
+    }
+
+    // Reads a packed array into v. Returns false, if the input does not
+    // start with a packed array.
+    template <typename T>
+    bool readPackedArray(std::istream& in, std::vector<T>& v)
+    {
+        if (in.peek() != Serializer::CategoryPackedArray)
+            return false;
+
+        in.get();
+        skipName(in);
+
+        unsigned char typeCode = static_cast<unsigned char>(in.get());
+        unsigned size = packedElementSize(typeCode);
+        if (size == 0)
+            SerializationError::doThrow("invalid element type of packed array");
+
+        uint32_t count = 0;
+        for (unsigned n = 0; n < 4; ++n)
+            count = (count << 8) | static_cast<unsigned char>(in.get());
+
+        if (!in)
+            SerializationError::doThrow("binary deserialization failed");
+
+        v.resize(count);
+        if (count == 0)
+            return true;
+
+        if (typeCode == packedTypeCode<T>())
+        {
+            char* data = reinterpret_cast<char*>(&v[0]);
+            in.read(data, static_cast<std::streamsize>(count) * sizeof(T));
+            swapPackedElements(data, sizeof(T), count);
+        }
+        else
+        {
+            char buffer[8];
+            for (uint32_t n = 0; n < count && in.read(buffer, size); ++n)
+            {
+                uint64_t bits = 0;
+                for (unsigned b = size; b > 0; --b)
+                    bits = (bits << 8) | static_cast<unsigned char>(buffer[b - 1]);
+                v[n] = packedElementValue<T>(typeCode, bits);
+            }
+        }
+
+        if (!in)
+            SerializationError::doThrow("binary deserialization failed");
+
+        return true;
+    }
+}
+
 void Deserializer::doDeserialize()
 {
     ValueParser vp;
     vp.begin(*this);
+    if (!_projection.empty())
+        vp.projection(&_projection);
 
     char ch;
     while (_in.get(ch) && !vp.advance(ch))
-        ;
+    {
+        std::size_t n = vp.skipAvailable();
+        if (n > 0)
+        {
+            _in.ignore(n);
+            vp.skipBytes(_in.gcount());
+        }
+    }
 
     if (_in.rdstate() & std::ios::badbit)
         SerializationError::doThrow("binary deserialization failed");
 }
+#define CXXTOOLS_BIN_DESERIALIZE_VECTOR(T) \
+void Deserializer::deserialize(std::vector<T>& v) \
+{ \
+    if (current() != 0 || !readPackedArray(_in, v)) \
+        cxxtools::Deserializer::deserialize(v); \
+}
+
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(signed char)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(unsigned char)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(short)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(unsigned short)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(int)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(unsigned int)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(long)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(unsigned long)
+#ifdef HAVE_LONG_LONG
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(long long)
+#endif
+#ifdef HAVE_UNSIGNED_LONG_LONG
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(unsigned long long)
+#endif
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(float)
+CXXTOOLS_BIN_DESERIALIZE_VECTOR(double)
+
+#undef CXXTOOLS_BIN_DESERIALIZE_VECTOR
+
 }
 }
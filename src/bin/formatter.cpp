@@ -28,6 +28,7 @@
 
 #include <cxxtools/bin/formatter.h>
 #include <cxxtools/bin/serializer.h>
+#include "packedarray.h"
 #include <cxxtools/utf8codec.h>
 #include <cxxtools/convert.h>
 #include <cxxtools/log.h>
@@ -44,130 +45,6 @@ namespace bin
 
 namespace
 {
-    void printTypeCode(std::ostream& out, const std::string& type, bool plain)
-    {
-        if (type.empty())
-            out << static_cast<char>(plain ? Serializer::TypePlainEmpty : Serializer::TypeEmpty);
-        else if (type == "bool")
-            out << static_cast<char>(plain ? Serializer::TypePlainBool : Serializer::TypeBool);
-        else if (type == "char")
-            out << static_cast<char>(plain ? Serializer::TypePlainChar : Serializer::TypeChar);
-        else if (type == "string")
-            out << static_cast<char>(plain ? Serializer::TypePlainString : Serializer::TypeString);
-        else if (type == "int")
-            out << static_cast<char>(plain ? Serializer::TypePlainInt : Serializer::TypeInt);
-        else if (type == "double")
-            out << static_cast<char>(plain ? Serializer::TypePlainBcdFloat : Serializer::TypeBcdFloat);
-        else if (type == "pair")
-            out << static_cast<char>(plain ? Serializer::TypePlainPair : Serializer::TypePair);
-        else if (type == "array")
-            out << static_cast<char>(plain ? Serializer::TypePlainArray : Serializer::TypeArray);
-        else if (type == "list")
-            out << static_cast<char>(plain ? Serializer::TypePlainList : Serializer::TypeList);
-        else if (type == "deque")
-            out << static_cast<char>(plain ? Serializer::TypePlainDeque : Serializer::TypeDeque);
-        else if (type == "set")
-            out << static_cast<char>(plain ? Serializer::TypePlainSet : Serializer::TypeSet);
-        else if (type == "multiset")
-            out << static_cast<char>(plain ? Serializer::TypePlainMultiset : Serializer::TypeMultiset);
-        else if (type == "map")
-            out << static_cast<char>(plain ? Serializer::TypePlainMap : Serializer::TypeMap);
-        else if (type == "multimap")
-            out << static_cast<char>(plain ? Serializer::TypePlainMultimap : Serializer::TypeMultimap);
-        else
-            out << static_cast<char>(plain ? Serializer::TypePlainOther : Serializer::TypeOther) << type << '\0';
-    }
-
-    void printUInt(std::ostream& out, uint64_t v, const std::string& name)
-    {
-        if (v <= std::numeric_limits<uint8_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainUInt8 : Serializer::TypeUInt8);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v);
-        }
-        else if (v <= std::numeric_limits<uint16_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainUInt16 : Serializer::TypeUInt16);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-        else if (v <= std::numeric_limits<uint32_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainUInt32 : Serializer::TypeUInt32);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 24)
-                << static_cast<char>(v >> 16)
-                << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-        else
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainUInt64 : Serializer::TypeUInt64);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 56)
-                << static_cast<char>(v >> 48)
-                << static_cast<char>(v >> 40)
-                << static_cast<char>(v >> 32)
-                << static_cast<char>(v >> 24)
-                << static_cast<char>(v >> 16)
-                << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-    }
-
-    void printInt(std::ostream& out, int64_t v, const std::string& name)
-    {
-        if (v >= 0)
-        {
-            printUInt(out, v, name);
-        }
-        else if (v >= std::numeric_limits<int8_t>::min() && v <= std::numeric_limits<int8_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainInt8 : Serializer::TypeInt8);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v);
-        }
-        else if (v >= std::numeric_limits<int16_t>::min() && v <= std::numeric_limits<int16_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainInt16 : Serializer::TypeInt16);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-        else if (v >= std::numeric_limits<int32_t>::min() && v <= std::numeric_limits<int32_t>::max())
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainInt32 : Serializer::TypeInt32);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 24)
-                << static_cast<char>(v >> 16)
-                << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-        else
-        {
-            out << static_cast<char>(name.empty() ? Serializer::TypePlainInt64 : Serializer::TypeInt64);
-            if (!name.empty())
-                out << name << '\0';
-            out << static_cast<char>(v >> 56)
-                << static_cast<char>(v >> 48)
-                << static_cast<char>(v >> 40)
-                << static_cast<char>(v >> 32)
-                << static_cast<char>(v >> 24)
-                << static_cast<char>(v >> 16)
-                << static_cast<char>(v >> 8)
-                << static_cast<char>(v);
-        }
-    }
-
     template <typename StringT>
     bool isTrue(const StringT& s)
     {
@@ -186,15 +63,114 @@ namespace
     }
 }
 
+void Formatter::printTypeCode(const std::string& type, bool plain)
+{
+    if (type.empty())
+        *_out << static_cast<char>(plain ? Serializer::TypePlainEmpty : Serializer::TypeEmpty);
+    else if (type == "bool")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainBool : Serializer::TypeBool);
+    else if (type == "char")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainChar : Serializer::TypeChar);
+    else if (type == "string")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainString : Serializer::TypeString);
+    else if (type == "int")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainInt : Serializer::TypeInt);
+    else if (type == "double")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainBcdFloat : Serializer::TypeBcdFloat);
+    else if (type == "pair")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainPair : Serializer::TypePair);
+    else if (type == "array")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainArray : Serializer::TypeArray);
+    else if (type == "list")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainList : Serializer::TypeList);
+    else if (type == "deque")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainDeque : Serializer::TypeDeque);
+    else if (type == "set")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainSet : Serializer::TypeSet);
+    else if (type == "multiset")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainMultiset : Serializer::TypeMultiset);
+    else if (type == "map")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainMap : Serializer::TypeMap);
+    else if (type == "multimap")
+        *_out << static_cast<char>(plain ? Serializer::TypePlainMultimap : Serializer::TypeMultimap);
+    else
+    {
+        *_out << static_cast<char>(plain ? Serializer::TypePlainOther : Serializer::TypeOther);
+        printName(type);
+    }
+}
+
+void Formatter::printNumber(char typeCode, uint64_t v, unsigned size, const std::string& name)
+{
+    // collect the type code and the big endian value, so that unnamed
+    // numbers are written with a single call
+    char data[9];
+    data[0] = typeCode;
+    for (unsigned n = size; n > 0; --n)
+    {
+        data[n] = static_cast<char>(v);
+        v >>= 8;
+    }
+
+    if (name.empty())
+    {
+        _out->write(data, size + 1);
+    }
+    else
+    {
+        _out->put(typeCode);
+        printName(name);
+        _out->write(data + 1, size);
+    }
+}
+
+void Formatter::printUInt(uint64_t v, const std::string& name)
+{
+    bool plain = name.empty();
+    if (v <= std::numeric_limits<uint8_t>::max())
+        printNumber(plain ? Serializer::TypePlainUInt8 : Serializer::TypeUInt8, v, 1, name);
+    else if (v <= std::numeric_limits<uint16_t>::max())
+        printNumber(plain ? Serializer::TypePlainUInt16 : Serializer::TypeUInt16, v, 2, name);
+    else if (v <= std::numeric_limits<uint32_t>::max())
+        printNumber(plain ? Serializer::TypePlainUInt32 : Serializer::TypeUInt32, v, 4, name);
+    else
+        printNumber(plain ? Serializer::TypePlainUInt64 : Serializer::TypeUInt64, v, 8, name);
+}
+
+void Formatter::printInt(int64_t v, const std::string& name)
+{
+    bool plain = name.empty();
+    if (v >= 0)
+        printUInt(v, name);
+    else if (v >= std::numeric_limits<int8_t>::min())
+        printNumber(plain ? Serializer::TypePlainInt8 : Serializer::TypeInt8, v, 1, name);
+    else if (v >= std::numeric_limits<int16_t>::min())
+        printNumber(plain ? Serializer::TypePlainInt16 : Serializer::TypeInt16, v, 2, name);
+    else if (v >= std::numeric_limits<int32_t>::min())
+        printNumber(plain ? Serializer::TypePlainInt32 : Serializer::TypeInt32, v, 4, name);
+    else
+        printNumber(plain ? Serializer::TypePlainInt64 : Serializer::TypeInt64, v, 8, name);
+}
+
 Formatter::Formatter()
     : _out(0),
-      _ts(new Utf8Codec())
+      _ts(new Utf8Codec()),
+      _useDictionary(false),
+      _keepDictionary(false),
+      _level(0),
+      _useSizedContainers(false),
+      _target(0)
 {
 }
 
 Formatter::Formatter(std::ostream& out)
     : _out(0),
-      _ts(new Utf8Codec())
+      _ts(new Utf8Codec()),
+      _useDictionary(false),
+      _keepDictionary(false),
+      _level(0),
+      _useSizedContainers(false),
+      _target(0)
 {
     begin(out);
 }
@@ -203,6 +179,131 @@ void Formatter::begin(std::ostream& out)
 {
     _out = &out;
     _ts.attach(out);
+    _level = 0;
+    _sizedContainers.clear();
+}
+
+void Formatter::clearDictionary()
+{
+    _dictionary.clear();
+}
+
+void Formatter::beginValue()
+{
+    if (_level == 0)
+    {
+        if (!_keepDictionary)
+            _dictionary.clear();
+
+        // readers interpret name references only in announced values
+        if (_useDictionary)
+            _out->put(static_cast<char>(Serializer::NameDictionary));
+    }
+
+    if (!_sizedContainers.empty())
+        ++_sizedContainers.back().count;
+}
+
+void Formatter::beginSized()
+{
+    if (_sizedContainers.empty())
+    {
+        _target = _out;
+        _sizedBuffer.str(std::string());
+        _sizedBuffer.clear();
+        _out = &_sizedBuffer;
+        _ts.attach(_sizedBuffer);
+    }
+}
+
+void Formatter::beginSizedContent()
+{
+    SizedContainer c;
+    c.pos = _out->tellp();
+    c.count = 0;
+    c.level = _level;
+    _sizedContainers.push_back(c);
+
+    // placeholder for count and length
+    _out->write("\0\0\0\0\0\0\0\0", 8);
+}
+
+void Formatter::finishSized()
+{
+    SizedContainer c = _sizedContainers.back();
+    _sizedContainers.pop_back();
+
+    std::streampos end = _out->tellp();
+    uint32_t length = static_cast<uint32_t>(end - c.pos - 8);
+
+    char data[8] = {
+        static_cast<char>(c.count >> 24),
+        static_cast<char>(c.count >> 16),
+        static_cast<char>(c.count >> 8),
+        static_cast<char>(c.count),
+        static_cast<char>(length >> 24),
+        static_cast<char>(length >> 16),
+        static_cast<char>(length >> 8),
+        static_cast<char>(length) };
+
+    _out->seekp(c.pos);
+    _out->write(data, 8);
+    _out->seekp(end);
+
+    if (_sizedContainers.empty())
+    {
+        *_target << _sizedBuffer.rdbuf();
+        _sizedBuffer.str(std::string());
+        _out = _target;
+        _ts.attach(*_out);
+    }
+}
+
+void Formatter::printName(const std::string& name)
+{
+    if (!_useDictionary)
+    {
+        _out->write(name.c_str(), name.size() + 1);
+        return;
+    }
+
+    // A name, which starts like a reference, is always defined. Other names
+    // with less than 2 characters are not shorter as a reference.
+    unsigned char first = name.empty() ? 0 : static_cast<unsigned char>(name[0]);
+    bool escape = first >= Serializer::NameReference16 && first <= Serializer::NameDefinition;
+
+    if (name.size() < 2 && !escape)
+    {
+        _out->write(name.c_str(), name.size() + 1);
+        return;
+    }
+
+    Dictionary::iterator it = _dictionary.lower_bound(name);
+    if (it != _dictionary.end() && it->first == name)
+    {
+        unsigned idx = it->second;
+        if (idx <= 0xff)
+            *_out << static_cast<char>(Serializer::NameReference8)
+                  << static_cast<char>(idx);
+        else
+            *_out << static_cast<char>(Serializer::NameReference16)
+                  << static_cast<char>(idx >> 8)
+                  << static_cast<char>(idx);
+    }
+    else if (_dictionary.size() <= 0xffff)
+    {
+        _dictionary.insert(it, Dictionary::value_type(name, _dictionary.size()));
+        *_out << static_cast<char>(Serializer::NameDefinition)
+              << name << '\0';
+    }
+    else
+    {
+        // the index of the definition is not referenced, when the
+        // dictionary is full
+        if (escape)
+            _out->put(static_cast<char>(Serializer::NameDefinition));
+        _out->write(name.c_str(), name.size() + 1);
+    }
 }
 
 void Formatter::finish()
@@ -213,6 +314,7 @@ void Formatter::addValueString(const std::string& name, const std::string& type,
                       const cxxtools::String& value)
 {
     log_trace("addValueString(\"" << name << "\", \"" << type << "\", \"" << value << "\")");
+    beginValue();
 
     bool plain = name.empty();
 
@@ -221,12 +323,12 @@ void Formatter::addValueString(const std::string& name, const std::string& type,
         if (value.size() > 0 && (value[0] == L'-' || value[0] == L'+'))
         {
             int64_t v = convert<int64_t>(value);
-            printInt(*_out, v, name);
+            printInt(v, name);
         }
         else
         {
             uint64_t v = convert<uint64_t>(value);
-            printUInt(*_out, v, name);
+            printUInt(v, name);
         }
     }
     else if (type == "double")
@@ -251,7 +353,7 @@ void Formatter::addValueString(const std::string& name, const std::string& type,
         *_out << static_cast<char>(plain ? Serializer::TypePlainBcdFloat : Serializer::TypeBcdFloat);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         if (value == L"nan")
         {
@@ -293,16 +395,16 @@ void Formatter::addValueString(const std::string& name, const std::string& type,
         *_out << static_cast<char>(plain ? Serializer::TypePlainBool : Serializer::TypeBool);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         *_out << (isTrue(value) ? '\1' : '\0');
     }
     else
     {
-        printTypeCode(*_out, type, plain);
+        printTypeCode(type, plain);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         _ts << value;
         _ts.flush();
@@ -315,6 +417,7 @@ void Formatter::addValueString(const std::string& name, const std::string& type,
 void Formatter::addValueStdString(const std::string& name, const std::string& type, const std::string& value)
 {
     log_trace("addValueStdString(\"" << name << "\", \"" << type << "\", \"" << value << "\")");
+    beginValue();
 
     bool plain = name.empty();
 
@@ -323,12 +426,12 @@ void Formatter::addValueStdString(const std::string& name, const std::string& ty
         if (value.size() > 0 && (value[0] == L'-' || value[0] == L'+'))
         {
             int64_t v = convert<int64_t>(value);
-            printInt(*_out, v, name);
+            printInt(v, name);
         }
         else
         {
             uint64_t v = convert<uint64_t>(value);
-            printUInt(*_out, v, name);
+            printUInt(v, name);
         }
     }
     else if (type == "double")
@@ -353,7 +456,7 @@ void Formatter::addValueStdString(const std::string& name, const std::string& ty
         *_out << static_cast<char>(plain ? Serializer::TypePlainBcdFloat : Serializer::TypeBcdFloat);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         if (value == "nan")
         {
@@ -396,7 +499,7 @@ void Formatter::addValueStdString(const std::string& name, const std::string& ty
         *_out << static_cast<char>(plain ? Serializer::TypePlainBool : Serializer::TypeBool);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         *_out << (isTrue(value) ? '\1' : '\0');
     }
@@ -408,14 +511,14 @@ void Formatter::addValueStdString(const std::string& name, const std::string& ty
             *_out << static_cast<char>(plain ? Serializer::TypePlainBinary2 : Serializer::TypeBinary2);
 
             if (!plain)
-                *_out << name << '\0';
+                printName(name);
         }
         else
         {
             *_out << static_cast<char>(plain ? Serializer::TypePlainBinary4 : Serializer::TypeBinary4);
 
             if (!plain)
-                *_out << name << '\0';
+                printName(name);
 
             *_out << static_cast<char>(v >> 24)
                   << static_cast<char>(v >> 16);
@@ -427,10 +530,10 @@ void Formatter::addValueStdString(const std::string& name, const std::string& ty
     }
     else
     {
-        printTypeCode(*_out, type, plain);
+        printTypeCode(type, plain);
 
         if (!plain)
-            *_out << name << '\0';
+            printName(name);
 
         *_out << value << '\0'
               << '\xff';
@@ -442,13 +545,14 @@ void Formatter::addValueBool(const std::string& name, const std::string& type,
                          bool value)
 {
     log_trace("addValueBool(\"" << name << "\", \"" << type << "\", " << value << ')');
+    beginValue();
 
     bool plain = name.empty();
 
     *_out << static_cast<char>(plain ? Serializer::TypePlainBool : Serializer::TypeBool);
 
     if (!plain)
-        *_out << name << '\0';
+        printName(name);
 
     *_out << (value ? '\1' : '\0');
 }
@@ -457,41 +561,44 @@ void Formatter::addValueInt(const std::string& name, const std::string& type,
                          int_type value)
 {
     log_trace("addValueInt(\"" << name << "\", \"" << type << "\", " << value << ')');
-    printInt(*_out, value, name);
+    beginValue();
+    printInt(value, name);
 }
 
 void Formatter::addValueUnsigned(const std::string& name, const std::string& type,
                          unsigned_type value)
 {
     log_trace("addValueUnsigned(\"" << name << "\", \"" << type << "\", " << value << ')');
-    printUInt(*_out, value, name);
+    beginValue();
+    printUInt(value, name);
 }
 
 void Formatter::addValueFloat(const std::string& name, const std::string& type,
                       long double value)
 {
     log_trace("addValueFloat(\"" << name << "\", \"" << type << "\", " << value << ')');
+    beginValue();
 
     if (value != value)
     {
         // NaN
         *_out << static_cast<char>(name.empty() ? Serializer::TypePlainShortFloat : Serializer::TypeShortFloat);
         if (!name.empty())
-            *_out << name << '\0';
+            printName(name);
         *_out << '\x7f' << '\x1' << '\0';
     }
     else if (value == std::numeric_limits<long double>::infinity())
     {
         *_out << static_cast<char>(name.empty() ? Serializer::TypePlainShortFloat : Serializer::TypeShortFloat);
         if (!name.empty())
-            *_out << name << '\0';
+            printName(name);
         *_out << '\x7f' << '\x0' << '\0';
     }
     else if (value == -std::numeric_limits<long double>::infinity())
     {
         *_out << static_cast<char>(name.empty() ? Serializer::TypePlainShortFloat : Serializer::TypeShortFloat);
         if (!name.empty())
-            *_out << name << '\0';
+            printName(name);
         *_out << '\xff' << '\x0' << '\0';
     }
     else if (value == 0.0)
@@ -499,7 +606,7 @@ void Formatter::addValueFloat(const std::string& name, const std::string& type,
         log_debug("value is zero");
         *_out << static_cast<char>(name.empty() ? Serializer::TypePlainShortFloat : Serializer::TypeShortFloat);
         if (!name.empty())
-            *_out << name << '\0';
+            printName(name);
         *_out << '\0' << '\0' << '\0';
     }
     else
@@ -525,7 +632,7 @@ void Formatter::addValueFloat(const std::string& name, const std::string& type,
                 e |= 0x8000;
             *_out << static_cast<char>(name.empty() ? Serializer::TypePlainLongFloat : Serializer::TypeLongFloat);
             if (!name.empty())
-                *_out << name << '\0';
+                printName(name);
             *_out << static_cast<char>(e >> 8)
                   << static_cast<char>(e)
                   << static_cast<char>(m >> 56)
@@ -546,7 +653,7 @@ void Formatter::addValueFloat(const std::string& name, const std::string& type,
                 e |= 0x80;
             *_out << static_cast<char>(name.empty() ? Serializer::TypePlainMediumFloat : Serializer::TypeMediumFloat);
             if (!name.empty())
-                *_out << name << '\0';
+                printName(name);
             *_out << static_cast<char>(e)
                   << static_cast<char>(m >> 56)
                   << static_cast<char>(m >> 48)
@@ -562,7 +669,7 @@ void Formatter::addValueFloat(const std::string& name, const std::string& type,
                 e |= 0x80;
             *_out << static_cast<char>(name.empty() ? Serializer::TypePlainShortFloat : Serializer::TypeShortFloat);
             if (!name.empty())
-                *_out << name << '\0';
+                printName(name);
             *_out << static_cast<char>(e)
                   << static_cast<char>(m >> 56)
                   << static_cast<char>(m >> 48);
@@ -570,13 +677,71 @@ void Formatter::addValueFloat(const std::string& name, const std::string& type,
     }
 }
 
+void Formatter::printPackedArray(const std::string& name, unsigned char typeCode,
+                                 const char* data, unsigned size, std::size_t count)
+{
+    log_trace("addPackedArray(\"" << name << "\", " << count << " elements)");
+
+    beginValue();
+
+    uint32_t c = count;
+    *_out << static_cast<char>(Serializer::CategoryPackedArray);
+    printName(name);
+    *_out << static_cast<char>(typeCode)
+          << static_cast<char>(c >> 24)
+          << static_cast<char>(c >> 16)
+          << static_cast<char>(c >> 8)
+          << static_cast<char>(c);
+
+#if defined(CXXTOOLS_LITTLE_ENDIAN)
+    _out->write(data, static_cast<std::streamsize>(size) * count);
+#else
+    char buffer[256];
+    while (count > 0)
+    {
+        std::size_t n = std::min(count, sizeof(buffer) / size);
+        memcpy(buffer, data, n * size);
+        swapPackedElements(buffer, size, n);
+        _out->write(buffer, n * size);
+        data += n * size;
+        count -= n;
+    }
+#endif
+}
+
+#define CXXTOOLS_BIN_PACKED_ARRAY(T) \
+void Formatter::addPackedArray(const std::string& name, const T* data, std::size_t count) \
+{ \
+    printPackedArray(name, packedTypeCode<T>(), reinterpret_cast<const char*>(data), sizeof(T), count); \
+}
+
+CXXTOOLS_BIN_PACKED_ARRAY(signed char)
+CXXTOOLS_BIN_PACKED_ARRAY(unsigned char)
+CXXTOOLS_BIN_PACKED_ARRAY(short)
+CXXTOOLS_BIN_PACKED_ARRAY(unsigned short)
+CXXTOOLS_BIN_PACKED_ARRAY(int)
+CXXTOOLS_BIN_PACKED_ARRAY(unsigned int)
+CXXTOOLS_BIN_PACKED_ARRAY(long)
+CXXTOOLS_BIN_PACKED_ARRAY(unsigned long)
+#ifdef HAVE_LONG_LONG
+CXXTOOLS_BIN_PACKED_ARRAY(long long)
+#endif
+#ifdef HAVE_UNSIGNED_LONG_LONG
+CXXTOOLS_BIN_PACKED_ARRAY(unsigned long long)
+#endif
+CXXTOOLS_BIN_PACKED_ARRAY(float)
+CXXTOOLS_BIN_PACKED_ARRAY(double)
+
+#undef CXXTOOLS_BIN_PACKED_ARRAY
+
 void Formatter::addNull(const std::string& name, const std::string& type)
 {
     log_trace("addNull(\"" << name << "\", \"" << type << "\")");
+    beginValue();
     *_out << static_cast<char>(name.empty() ? Serializer::TypePlainEmpty : Serializer::TypeEmpty);
 
     if (!name.empty())
-        *_out << name << '\0';
+        printName(name);
 
     *_out << '\xff';
 }
@@ -584,23 +749,52 @@ void Formatter::addNull(const std::string& name, const std::string& type)
 void Formatter::beginArray(const std::string& name, const std::string& type)
 {
     log_trace("beginArray(\"" << name << "\", \"" << type << ')');
-    *_out << static_cast<char>(Serializer::CategoryArray)
-          << name << '\0';
-    printTypeCode(*_out, type, name.empty());
+    beginValue();
+    ++_level;
+    if (_useSizedContainers)
+    {
+        beginSized();
+        *_out << static_cast<char>(Serializer::CategorySizedArray);
+        printName(name);
+        printTypeCode(type, name.empty());
+        beginSizedContent();
+    }
+    else
+    {
+        *_out << static_cast<char>(Serializer::CategoryArray);
+        printName(name);
+        printTypeCode(type, name.empty());
+    }
 }
 
 void Formatter::finishArray()
 {
     log_trace("finishArray()");
     *_out << '\xff';
+    if (!_sizedContainers.empty() && _sizedContainers.back().level == _level)
+        finishSized();
+    --_level;
 }
 
 void Formatter::beginObject(const std::string& name, const std::string& type)
 {
     log_trace("beginObject(\"" << name << "\", \"" << type << ')');
-    *_out << static_cast<char>(Serializer::CategoryObject)
-          << name << '\0';
-    printTypeCode(*_out, type, false);
+    beginValue();
+    ++_level;
+    if (_useSizedContainers)
+    {
+        beginSized();
+        *_out << static_cast<char>(Serializer::CategorySizedObject);
+        printName(name);
+        printTypeCode(type, false);
+        beginSizedContent();
+    }
+    else
+    {
+        *_out << static_cast<char>(Serializer::CategoryObject);
+        printName(name);
+        printTypeCode(type, false);
+    }
 }
 
 void Formatter::beginMember(const std::string& name)
@@ -618,6 +812,9 @@ void Formatter::finishObject()
 {
     log_trace("finishObject()");
     *_out << '\xff';
+    if (!_sizedContainers.empty() && _sizedContainers.back().level == _level)
+        finishSized();
+    --_level;
 }
 
 }
@@ -0,0 +1,139 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_BIN_PACKEDARRAY_H
+#define CXXTOOLS_BIN_PACKEDARRAY_H
+
+#include <cxxtools/bin/serializer.h>
+#include <cxxtools/serializationerror.h>
+#include <cxxtools/byteorder.h>
+#include <limits>
+#include <string.h>
+#include <stdint.h>
+
+namespace cxxtools
+{
+namespace bin
+{
+    // Type code of the elements of a packed array of T.
+    template <typename T>
+    unsigned char packedTypeCode()
+    {
+        if (!std::numeric_limits<T>::is_integer)
+            return sizeof(T) == 4 ? Serializer::TypePlainFloat32 : Serializer::TypePlainFloat64;
+
+        bool isSigned = std::numeric_limits<T>::is_signed;
+        switch (sizeof(T))
+        {
+            case 1: return isSigned ? Serializer::TypePlainInt8 : Serializer::TypePlainUInt8;
+            case 2: return isSigned ? Serializer::TypePlainInt16 : Serializer::TypePlainUInt16;
+            case 4: return isSigned ? Serializer::TypePlainInt32 : Serializer::TypePlainUInt32;
+            default: return isSigned ? Serializer::TypePlainInt64 : Serializer::TypePlainUInt64;
+        }
+    }
+
+    // Size in bytes of an element of a packed array or 0 for invalid type codes.
+    inline unsigned packedElementSize(unsigned char typeCode)
+    {
+        switch (typeCode)
+        {
+            case Serializer::TypePlainInt8:
+            case Serializer::TypePlainUInt8:
+                return 1;
+
+            case Serializer::TypePlainInt16:
+            case Serializer::TypePlainUInt16:
+                return 2;
+
+            case Serializer::TypePlainInt32:
+            case Serializer::TypePlainUInt32:
+            case Serializer::TypePlainFloat32:
+                return 4;
+
+            case Serializer::TypePlainInt64:
+            case Serializer::TypePlainUInt64:
+            case Serializer::TypePlainFloat64:
+                return 8;
+
+            default:
+                return 0;
+        }
+    }
+
+    // Converts the little endian bits of an element of a packed array.
+    template <typename T>
+    T packedElementValue(unsigned char typeCode, uint64_t bits)
+    {
+        switch (typeCode)
+        {
+            case Serializer::TypePlainInt8:   return static_cast<T>(static_cast<int8_t>(bits));
+            case Serializer::TypePlainInt16:  return static_cast<T>(static_cast<int16_t>(bits));
+            case Serializer::TypePlainInt32:  return static_cast<T>(static_cast<int32_t>(bits));
+            case Serializer::TypePlainInt64:  return static_cast<T>(static_cast<int64_t>(bits));
+            case Serializer::TypePlainUInt8:  return static_cast<T>(static_cast<uint8_t>(bits));
+            case Serializer::TypePlainUInt16: return static_cast<T>(static_cast<uint16_t>(bits));
+            case Serializer::TypePlainUInt32: return static_cast<T>(static_cast<uint32_t>(bits));
+            case Serializer::TypePlainUInt64: return static_cast<T>(bits);
+
+            case Serializer::TypePlainFloat32:
+            {
+                uint32_t b = static_cast<uint32_t>(bits);
+                float f;
+                memcpy(&f, &b, sizeof(f));
+                return static_cast<T>(f);
+            }
+
+            case Serializer::TypePlainFloat64:
+            {
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                return static_cast<T>(d);
+            }
+        }
+
+        SerializationError::doThrow("invalid element type of packed array");
+        return T();  // never reached
+    }
+
+    // Converts the elements of a packed array between little endian and
+    // host byte order in place.
+    inline void swapPackedElements(char* data, unsigned size, std::size_t count)
+    {
+#if !defined(CXXTOOLS_LITTLE_ENDIAN)
+#if !defined(CXXTOOLS_BIG_ENDIAN)
+        if (isLittleEndian())
+            return;
+#endif
+        if (size > 1)
+            for (std::size_t n = 0; n < count; ++n, data += size)
+                std::reverse(data, data + size);
+#endif
+    }
+}
+}
+
+#endif // CXXTOOLS_BIN_PACKEDARRAY_H
@@ -0,0 +1,64 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_BIN_PROTOCOL_H
+#define CXXTOOLS_BIN_PROTOCOL_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace cxxtools
+{
+namespace bin
+{
+    // A request or reply may be prefixed by this marker and a 4 byte request
+    // id in network byte order. Replies to requests with id are sent in the
+    // order of completion and not in the order of the requests.
+    const char requestIdMarker = '\xc4';
+
+    // Name of the procedure, which a client calls to find out, if the server
+    // accepts requests with id. Older servers reply with an error, since
+    // they do not know the procedure. Both sides use the name dictionary
+    // of the formatter in requests and replies with id.
+    const char multiplexProcedure[] = "\x01multiplex";
+
+    // Version of the protocol with request ids, which is returned by
+    // the multiplex procedure.
+    const int multiplexVersion = 1;
+
+    inline void writeRequestId(std::ostream& out, uint32_t id)
+    {
+        out << requestIdMarker
+            << static_cast<char>(id >> 24)
+            << static_cast<char>(id >> 16)
+            << static_cast<char>(id >> 8)
+            << static_cast<char>(id);
+    }
+}
+}
+
+#endif // CXXTOOLS_BIN_PROTOCOL_H
@@ -28,6 +28,8 @@
 
 #include "responder.h"
 #include "rpcserverimpl.h"
+#include "protocol.h"
+#include "socket.h"
 #include <cxxtools/bin/valueparser.h>
 #include <cxxtools/serviceprocedure.h>
 #include <cxxtools/remoteexception.h>
@@ -55,7 +57,7 @@ void Responder::reply(IOStream& out)
     out << '\xff';
 }
 
-void Responder::replyError(IOStream& out, const char* msg, int rc)
+void Responder::replyError(std::ostream& out, const char* msg, int rc)
 {
     log_info("send error \"" << msg << '"');
 
@@ -74,10 +76,35 @@ bool Responder::onInput(IOStream& ios)
     {
         if (advance(ios.buffer().sbumpc()))
         {
+            if (_hasId && !_failed && !_multiplex)
+            {
+                // the procedure is processed in the thread pool of the server,
+                // while further requests are read
+                _socket.beginCall(_proc, _id);
+                _proc = 0;
+                _args = 0;
+                _state = state_0;
+                _hasId = false;
+                continue;
+            }
+
+            if (_hasId)
+                writeRequestId(ios, _id);
+
             if (_failed)
             {
                 replyError(ios, _errorMessage.c_str(), 0);
             }
+            else if (_multiplex)
+            {
+                log_info("multiplexed calls requested");
+                Decomposer<int> version;
+                version.begin(multiplexVersion);
+                ios << '\xc1';
+                _formatter.begin(ios);
+                version.format(_formatter);
+                ios << '\xff';
+            }
             else
             {
                 try
@@ -97,11 +124,14 @@ bool Responder::onInput(IOStream& ios)
                 }
             }
 
-            _serviceRegistry.releaseProcedure(_proc);
+            if (_proc)
+                _serviceRegistry.releaseProcedure(_proc);
             _proc = 0;
             _args = 0;
             _result = 0;
             _state = state_0;
+            _hasId = false;
+            _multiplex = false;
             _failed = false;
             _errorMessage.clear();
 
@@ -121,10 +151,23 @@ bool Responder::advance(char ch)
                 _state = state_method;
             else if (ch == '\xc3')
                 _state = state_domain;
+            else if (ch == requestIdMarker && !_hasId)
+            {
+                _hasId = true;
+                _id = 0;
+                _idCount = 4;
+                _state = state_id;
+            }
             else
                 throw std::runtime_error("domain or method name expected");
             break;
 
+        case state_id:
+            _id = (_id << 8) | static_cast<unsigned char>(ch);
+            if (--_idCount == 0)
+                _state = state_0;
+            break;
+
         case state_domain:
             if (ch == '\0')
             {
@@ -140,7 +183,22 @@ bool Responder::advance(char ch)
             {
                 log_info("rpc method \"" << _methodName << '"');
 
-                _proc = _serviceRegistry.getProcedure(_domain.empty() ? _methodName : _domain + '\0' + _methodName);
+                if (_domain.empty() && _methodName == multiplexProcedure)
+                {
+                    _multiplex = true;
+                    _methodName.clear();
+                    _state = state_params_skip;
+                    break;
+                }
+
+                if (_resolved == 0 || _methodName != _resolvedMethod || _domain != _resolvedDomain)
+                {
+                    _resolved = _serviceRegistry.resolveProcedure(_domain.empty() ? _methodName : _domain + '\0' + _methodName);
+                    _resolvedDomain = _domain;
+                    _resolvedMethod = _methodName;
+                }
+
+                _proc = _resolved ? _serviceRegistry.getProcedure(_resolved) : 0;
 
                 if (_proc)
                 {
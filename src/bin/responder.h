@@ -35,6 +35,7 @@
 #include <cxxtools/iostream.h>
 #include <cxxtools/bin/formatter.h>
 #include <cxxtools/serviceregistry.h>
+#include <stdint.h>
 
 namespace cxxtools
 {
@@ -53,6 +54,7 @@ class Responder
         enum State
         {
             state_0,
+            state_id,
             state_domain,
             state_method,
             state_params,
@@ -62,9 +64,13 @@ class Responder
         };
 
     public:
-        explicit Responder(ServiceRegistry& serviceRegistry)
-            : _serviceRegistry(serviceRegistry),
+        Responder(Socket& socket, ServiceRegistry& serviceRegistry)
+            : _socket(socket),
+              _serviceRegistry(serviceRegistry),
               _state(state_0),
+              _hasId(false),
+              _multiplex(false),
+              _resolved(0),
               _proc(0),
               _args(0),
               _result(0),
@@ -73,17 +79,30 @@ class Responder
 
         ~Responder();
 
-        // returns true, if request is ready and reply is put to the socket
+        // returns true, if request is ready and reply is put to the socket;
+        // requests with id are passed to the socket for processing
         bool onInput(IOStream& ios);
         bool advance(char ch);
         void reply(IOStream& out);
-        void replyError(IOStream& out, const char* msg, int rc);
+        static void replyError(std::ostream& out, const char* msg, int rc);
 
     private:
+        Socket& _socket;
         ServiceRegistry& _serviceRegistry;
         State _state;
+        unsigned _idCount;
+        uint32_t _id;
+        bool _hasId;
+        bool _multiplex;
         std::string _domain;
         std::string _methodName;
+
+        // the procedure of the last call on this connection, which is
+        // usually called again
+        std::string _resolvedDomain;
+        std::string _resolvedMethod;
+        const ServiceProcedurePool* _resolved;
+
         ValueParser _valueParser;
         DeserializerBase _deserializer;
 
@@ -155,6 +155,11 @@ void RpcClient::cancel()
     _impl->cancel();
 }
 
+void RpcClient::cancelCall(IRemoteProcedure& proc)
+{
+    _impl->cancelCall(proc);
+}
+
 const std::string& RpcClient::domain() const
 {
     return _impl->domain();
@@ -25,14 +25,15 @@
  * License along with this library; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
-
 #include "rpcclientimpl.h"
+#include "protocol.h"
 #include <cxxtools/log.h>
 #include <cxxtools/remoteprocedure.h>
 #include <cxxtools/bin/rpcclient.h>
 #include <cxxtools/selector.h>
 #include <cxxtools/clock.h>
 #include <stdexcept>
+#include <sstream>
 
 log_define("cxxtools.bin.rpcclient.impl")
 
@@ -42,9 +43,15 @@ namespace bin
 {
 
 RpcClientImpl::RpcClientImpl(SelectorBase& selector, const std::string& addr, unsigned short port, const std::string& domain, bool realConnect)
-    : _proc(0),
-      _stream(_socket, 8192, true),
+    : _stream(_socket, 8192, true),
       _formatter(_stream),
+      _nextId(1),
+      _protocol(protocol_unknown),
+      _multiplexVersion(0),
+      _inReply(false),
+      _idCount(0),
+      _replyId(0),
+      _connecting(false),
       _exceptionPending(false),
       _domain(domain),
       _timeout(Selectable::WaitInfinite),
@@ -61,9 +68,15 @@ RpcClientImpl::RpcClientImpl(SelectorBase& selector, const std::string& addr, un
 }
 
 RpcClientImpl::RpcClientImpl(const std::string& addr, unsigned short port, const std::string& domain, bool realConnect)
-    : _proc(0),
-      _stream(_socket, 8192, true),
+    : _stream(_socket, 8192, true),
       _formatter(_stream),
+      _nextId(1),
+      _protocol(protocol_unknown),
+      _multiplexVersion(0),
+      _inReply(false),
+      _idCount(0),
+      _replyId(0),
+      _connecting(false),
       _exceptionPending(false),
       _domain(domain),
       _timeout(Selectable::WaitInfinite),
@@ -83,6 +96,7 @@ void RpcClientImpl::connect(const std::string& addr, unsigned short port, const
     if (_addr != addr || _port != port)
     {
         _socket.close();
+        _protocol = protocol_unknown;
         _addr = addr;
         _port = port;
     }
@@ -99,6 +113,7 @@ void RpcClientImpl::connect(const std::string& addr, unsigned short port, const
 void RpcClientImpl::close()
 {
     _socket.close();
+    _protocol = protocol_unknown;
 }
 
 void RpcClientImpl::beginCall(IComposer& r, IRemoteProcedure& method, IDecomposer** argv, unsigned argc)
@@ -106,38 +121,53 @@ void RpcClientImpl::beginCall(IComposer& r, IRemoteProcedure& method, IDecompose
     if (_socket.selector() == 0)
         throw std::logic_error("cannot run async rpc request without a selector");
 
-    if (_proc)
+    if (_procs.find(&method) != _procs.end())
         throw std::logic_error("asyncronous request already running");
 
-    _proc = &method;
+    uint32_t id = _nextId++;
+    if (_nextId == 0)
+        _nextId = 1;
 
-    prepareRequest(method.name(), argv, argc);
+    Call& call = _calls[id];
+    call.proc = &method;
+    call.result = &r;
+    _procs[&method] = id;
 
-    if (_socket.isConnected())
+    if (_protocol == protocol_multiplex)
     {
-        try
-        {
-            _stream.buffer().beginWrite();
-        }
-        catch (const IOError&)
-        {
-            log_debug("write failed, connection is not active any more");
-            _socket.beginConnect(_addr, _port);
-        }
+        // requests started together are collected in the output buffer
+        // and sent with a single write
+        writeRequestId(_stream, id);
+        _formatter.useDictionary(true);
+        prepareRequest(_stream, method.name(), argv, argc);
+        _formatter.useDictionary(false);
     }
     else
     {
-        log_debug("not yet connected - do it now");
-        _socket.beginConnect(_addr, _port);
+        std::ostringstream out;
+        prepareRequest(out, method.name(), argv, argc);
+        call.request = out.str();
+        _unsent.push_back(id);
+
+        if (_protocol == protocol_unknown)
+        {
+            log_debug("ask server for multiplexed calls");
+            _multiplexVersion = 0;
+            _multiplexResult.begin(_multiplexVersion);
+            _calls[0].result = &_multiplexResult;
+            _sent.push_back(0);
+            _stream << '\xc0' << multiplexProcedure << '\0' << '\xff';
+            _protocol = protocol_negotiating;
+        }
+        else
+            sendRequests();
     }
 
-    _scanner.begin(_deserializer, r);
+    beginWrite();
 }
 
 void RpcClientImpl::endCall()
 {
-    _proc = 0;
-
     if (_exceptionPending)
     {
         _exceptionPending = false;
@@ -147,9 +177,10 @@ void RpcClientImpl::endCall()
 
 void RpcClientImpl::call(IComposer& r, IRemoteProcedure& method, IDecomposer** argv, unsigned argc)
 {
-    _proc = &method;
+    if (!_calls.empty())
+        throw std::logic_error("asyncronous request already running");
 
-    prepareRequest(_proc->name(), argv, argc);
+    prepareRequest(_stream, method.name(), argv, argc);
 
     if (!_socket.isConnected())
     {
@@ -170,7 +201,6 @@ void RpcClientImpl::call(IComposer& r, IRemoteProcedure& method, IDecomposer** a
         {
             if (_scanner.advance(ch))
             {
-                _proc = 0;
                 _scanner.checkException();
                 break;
             }
@@ -186,8 +216,6 @@ void RpcClientImpl::call(IComposer& r, IRemoteProcedure& method, IDecomposer** a
         throw;
     }
 
-    _proc = 0;
-
     if (!_stream)
     {
         cancel();
@@ -224,22 +252,218 @@ void RpcClientImpl::cancel()
     _socket.close();
     _stream.clear();
     _stream.buffer().discard();
-    _proc = 0;
+    _calls.clear();
+    _procs.clear();
+    _unsent.clear();
+    _sent.clear();
+    _protocol = protocol_unknown;
+    _inReply = false;
+    _idCount = 0;
+    _connecting = false;
+}
+
+void RpcClientImpl::cancelCall(IRemoteProcedure& proc)
+{
+    Procs::iterator p = _procs.find(&proc);
+    if (p == _procs.end())
+        return;
+
+    Calls::iterator it = _calls.find(p->second);
+    _procs.erase(p);
+
+    if (!it->second.request.empty())
+    {
+        // not sent yet - the id is skipped in the queue
+        _calls.erase(it);
+    }
+    else
+    {
+        // the reply is still read from the connection but not passed
+        // to anyone
+        it->second.proc = 0;
+        it->second.result = 0;
+        if (_inReply && _replyId == it->first)
+            _scanner.skip();
+    }
 }
 
-void RpcClientImpl::prepareRequest(const String& name, IDecomposer** argv, unsigned argc)
+void RpcClientImpl::prepareRequest(std::ostream& out, const String& name, IDecomposer** argv, unsigned argc)
 {
     if (_domain.empty())
-        _stream << '\xc0' << name << '\0';
+        out << '\xc0' << name << '\0';
     else
-        _stream << '\xc3' << _domain << '\0' << name << '\0';
+        out << '\xc3' << _domain << '\0' << name << '\0';
 
+    _formatter.begin(out);
     for(unsigned n = 0; n < argc; ++n)
     {
         argv[n]->format(_formatter);
     }
 
-    _stream << '\xff';
+    out << '\xff';
+}
+
+void RpcClientImpl::sendRequests()
+{
+    while (!_unsent.empty()
+        && (_protocol == protocol_multiplex
+            || (_protocol == protocol_single && _sent.empty())))
+    {
+        uint32_t id = _unsent.front();
+        _unsent.pop_front();
+
+        Calls::iterator it = _calls.find(id);
+        if (it == _calls.end())
+            continue;
+
+        if (_protocol == protocol_multiplex)
+            writeRequestId(_stream, id);
+        else
+            _sent.push_back(id);
+
+        _stream << it->second.request;
+        std::string().swap(it->second.request);
+    }
+}
+
+void RpcClientImpl::beginWrite()
+{
+    if (_connecting)
+        return;
+
+    if (_socket.isConnected())
+    {
+        try
+        {
+            _stream.buffer().beginWrite();
+            return;
+        }
+        catch (const IOError&)
+        {
+            log_debug("write failed, connection is not active any more");
+        }
+    }
+    else
+        log_debug("not yet connected - do it now");
+
+    _connecting = true;
+    _socket.beginConnect(_addr, _port);
+}
+
+bool RpcClientImpl::advance(char ch)
+{
+    if (!_inReply)
+    {
+        if (_idCount > 0)
+        {
+            _replyId = (_replyId << 8) | static_cast<unsigned char>(ch);
+            if (--_idCount == 0)
+                beginReply();
+            return false;
+        }
+
+        if (ch == requestIdMarker)
+        {
+            _replyId = 0;
+            _idCount = 4;
+            return false;
+        }
+
+        // replies without id come in the order of the requests
+        if (_sent.empty())
+            throw std::runtime_error("unexpected reply from rpc server");
+
+        _replyId = _sent.front();
+        _sent.pop_front();
+        beginReply();
+    }
+
+    if (!_scanner.advance(ch))
+        return false;
+
+    _inReply = false;
+    return true;
+}
+
+void RpcClientImpl::beginReply()
+{
+    Calls::const_iterator it = _calls.find(_replyId);
+    if (it == _calls.end())
+        throw std::runtime_error("reply to unknown request from rpc server");
+
+    if (it->second.result)
+        _scanner.begin(_deserializer, *it->second.result);
+    else
+        _scanner.beginSkip(_deserializer);
+
+    _inReply = true;
+}
+
+void RpcClientImpl::finishCall()
+{
+    Calls::iterator it = _calls.find(_replyId);
+    IRemoteProcedure* proc = it->second.proc;
+    _calls.erase(it);
+
+    if (_replyId == 0)
+    {
+        if (_scanner.failed() || _multiplexVersion < multiplexVersion)
+        {
+            log_debug("server does not support multiplexed calls");
+            _protocol = protocol_single;
+        }
+        else
+        {
+            log_debug("server supports multiplexed calls");
+            _protocol = protocol_multiplex;
+        }
+
+        sendRequests();
+        beginWrite();
+        return;
+    }
+
+    if (_protocol == protocol_single && !_unsent.empty())
+    {
+        sendRequests();
+        beginWrite();
+    }
+
+    if (proc == 0)
+        return;
+
+    _procs.erase(proc);
+
+    if (_scanner.failed())
+        proc->setFault(_scanner.errorCode(), _scanner.errorMessage());
+
+    proc->onFinished();
+}
+
+void RpcClientImpl::failCalls()
+{
+    Calls calls;
+    calls.swap(_calls);
+    cancel();
+
+    bool notified = false;
+    bool unhandled = false;
+    for (Calls::iterator it = calls.begin(); it != calls.end(); ++it)
+    {
+        if (it->second.proc == 0)
+            continue;
+
+        notified = true;
+        _exceptionPending = true;
+        it->second.proc->onFinished();
+        if (_exceptionPending)
+            unhandled = true;
+    }
+
+    _exceptionPending = false;
+
+    if (!notified || unhandled)
+        throw;
 }
 
 void RpcClientImpl::onConnect(net::TcpSocket& socket)
@@ -248,6 +472,7 @@ void RpcClientImpl::onConnect(net::TcpSocket& socket)
     {
         log_trace("onConnect");
 
+        _connecting = false;
         _exceptionPending = false;
         socket.endConnect();
 
@@ -255,17 +480,7 @@ void RpcClientImpl::onConnect(net::TcpSocket& socket)
     }
     catch (const std::exception& )
     {
-        IRemoteProcedure* proc = _proc;
-        cancel();
-
-        if (!proc)
-            throw;
-
-        _exceptionPending = true;
-        proc->onFinished();
-
-        if (_exceptionPending)
-            throw;
+        failCalls();
     }
 }
 
@@ -282,17 +497,7 @@ void RpcClientImpl::onOutput(StreamBuffer& sb)
     }
     catch (const std::exception&)
     {
-        IRemoteProcedure* proc = _proc;
-        cancel();
-
-        if (!proc)
-            throw;
-
-        _exceptionPending = true;
-        proc->onFinished();
-
-        if (_exceptionPending)
-            throw;
+        failCalls();
     }
 }
 
@@ -309,13 +514,13 @@ void RpcClientImpl::onInput(StreamBuffer& sb)
         char ch;
         while (_stream.buffer().in_avail() && _stream.get(ch))
         {
-            if (_scanner.advance(ch))
+            if (advance(ch))
             {
-                _scanner.checkException();
-                IRemoteProcedure* proc = _proc;
-                _proc = 0;
-                proc->onFinished();
-                return;
+                finishCall();
+
+                // the callback may have canceled the client
+                if (!_socket.isConnected())
+                    return;
             }
         }
 
@@ -325,21 +530,12 @@ void RpcClientImpl::onInput(StreamBuffer& sb)
             throw std::runtime_error("reading result failed");
         }
 
-        sb.beginRead();
+        if (!_calls.empty())
+            sb.beginRead();
     }
     catch (const std::exception&)
     {
-        IRemoteProcedure* proc = _proc;
-        cancel();
-
-        if (!proc)
-            throw;
-
-        _exceptionPending = true;
-        proc->onFinished();
-
-        if (_exceptionPending)
-            throw;
+        failCalls();
     }
 }
 
@@ -37,7 +37,11 @@
 #include <cxxtools/connectable.h>
 #include <cxxtools/deserializerbase.h>
 #include <cxxtools/refcounted.h>
+#include <cxxtools/composer.h>
 #include <string>
+#include <map>
+#include <deque>
+#include <stdint.h>
 #include "scanner.h"
 
 namespace cxxtools
@@ -80,12 +84,14 @@ class RpcClientImpl : public RefCounted, public Connectable
         void connectTimeout(std::size_t t)  { _connectTimeout = t; _connectTimeoutSet = true; }
 
         const IRemoteProcedure* activeProcedure() const
-        { return _proc; }
+        { return _procs.empty() ? 0 : _procs.begin()->first; }
 
         void wait(std::size_t msecs);
 
         void cancel();
 
+        void cancelCall(IRemoteProcedure& proc);
+
         const std::string& domain() const
         { return _domain; }
 
@@ -93,18 +99,63 @@ class RpcClientImpl : public RefCounted, public Connectable
         { _domain = p; }
 
     private:
-        void prepareRequest(const String& name, IDecomposer** argv, unsigned argc);
+        struct Call
+        {
+            Call()
+                : proc(0),
+                  result(0)
+            { }
+
+            IRemoteProcedure* proc;   // 0, when the call was canceled
+            IComposer* result;
+            std::string request;      // formatted request, until it is sent
+        };
+
+        typedef std::map<uint32_t, Call> Calls;
+        typedef std::map<IRemoteProcedure*, uint32_t> Procs;
+
+        enum Protocol
+        {
+            protocol_unknown,         // not negotiated yet on the connection
+            protocol_negotiating,     // multiplex procedure is called
+            protocol_single,          // server processes one request at a time
+            protocol_multiplex        // requests and replies carry ids
+        };
+
+        void prepareRequest(std::ostream& out, const String& name, IDecomposer** argv, unsigned argc);
+        void sendRequests();
+        void beginWrite();
+        bool advance(char ch);
+        void beginReply();
+        void finishCall();
+        void failCalls();
         void onConnect(net::TcpSocket& socket);
         void onOutput(StreamBuffer& sb);
         void onInput(StreamBuffer& sb);
 
-        IRemoteProcedure* _proc;
         net::TcpSocket _socket;
         IOStream _stream;
         Scanner _scanner;
         DeserializerBase _deserializer;
         Formatter _formatter;
 
+        // Asynchronous calls by request id. The id 0 is used for the call
+        // of the multiplex procedure.
+        Calls _calls;
+        Procs _procs;
+        std::deque<uint32_t> _unsent;   // calls waiting for negotiation or the previous reply
+        std::deque<uint32_t> _sent;     // calls sent without id in order
+        uint32_t _nextId;
+        Protocol _protocol;
+        int _multiplexVersion;
+        Composer<int> _multiplexResult;
+
+        // state of the reply currently read
+        bool _inReply;
+        unsigned _idCount;
+        uint32_t _replyId;
+
+        bool _connecting;
         bool _exceptionPending;
 
         std::string _addr;
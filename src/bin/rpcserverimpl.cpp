@@ -31,6 +31,7 @@
 #include "worker.h"
 
 #include <cxxtools/eventloop.h>
+#include <cxxtools/threadpool.h>
 #include <cxxtools/net/tcpserver.h>
 #include <cxxtools/log.h>
 
@@ -101,7 +102,8 @@ RpcServerImpl::RpcServerImpl(EventLoopBase& eventLoop, Signal<RpcServer::Runmode
       inputSlot(slot(*this, &RpcServerImpl::onInput)),
       _serviceRegistry(serviceRegistry),
       _minThreads(5),
-      _maxThreads(200)
+      _maxThreads(200),
+      _callPool(0)
 {
     _eventLoop.event.subscribe(slot(*this, &RpcServerImpl::onIdleSocket));
     _eventLoop.event.subscribe(slot(*this, &RpcServerImpl::onNoWaitingThreads));
@@ -127,6 +129,7 @@ RpcServerImpl::~RpcServerImpl()
         }
     }
 
+    delete _callPool;
 }
 
 void RpcServerImpl::listen(const std::string& ip, unsigned short int port, int backlog)
@@ -151,6 +154,9 @@ void RpcServerImpl::start()
     log_trace("start server");
     runmode(RpcServer::Starting);
 
+    if (_callPool == 0)
+        _callPool = new ThreadPool(minThreads());
+
     MutexLock lock(_threadMutex);
     while (_threads.size() < minThreads())
     {
@@ -201,6 +207,10 @@ void RpcServerImpl::terminate()
 
         _idleSocket.clear();
 
+        // the sockets wait for their calls, so the pool is stopped last
+        delete _callPool;
+        _callPool = 0;
+
         runmode(RpcServer::Stopped);
     }
     catch (const std::exception& e)
@@ -209,6 +219,11 @@ void RpcServerImpl::terminate()
     }
 }
 
+void RpcServerImpl::schedule(const Callable<void>& call)
+{
+    _callPool->schedule(call);
+}
+
 void RpcServerImpl::noWaitingThreads()
 {
     if (runmode() == RpcServer::Running)
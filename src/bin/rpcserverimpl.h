@@ -39,12 +39,14 @@
 #include <cxxtools/queue.h>
 #include <cxxtools/signal.h>
 #include <cxxtools/connectable.h>
+#include <cxxtools/callable.h>
 #include <cxxtools/bin/rpcserver.h>
 
 namespace cxxtools
 {
     class EventLoopBase;
     class ServiceProcedure;
+    class ThreadPool;
 
     namespace net
     {
@@ -88,6 +90,9 @@ namespace cxxtools
                 RpcServer::Runmode runmode() const
                 { return _runmode; }
 
+                // Processes a call with request id in the thread pool.
+                void schedule(const Callable<void>& call);
+
             private:
                 void runmode(RpcServer::Runmode runmode)
                 {
@@ -127,6 +132,10 @@ namespace cxxtools
                 typedef std::set<Socket*> IdleSocket;
                 IdleSocket _idleSocket;
 
+                // runs calls with request id, so that calls from one
+                // connection are processed concurrently
+                ThreadPool* _callPool;
+
                 Mutex _threadMutex;
                 Condition _threadTerminated;
                 typedef std::set<Worker*> Threads;
@@ -39,10 +39,16 @@ namespace bin
 {
 
 void Scanner::begin(DeserializerBase& handler, IComposer& composer)
+{
+    beginSkip(handler);
+    _composer = &composer;
+}
+
+void Scanner::beginSkip(DeserializerBase& handler)
 {
     _vp.begin(handler);
     _deserializer = &handler;
-    _composer = &composer;
+    _composer = 0;
     _deserializer->begin();
     _state = state_0;
     _failed = false;
@@ -73,7 +79,8 @@ bool Scanner::advance(char ch)
         case state_value:
             if (_vp.advance(ch))
             {
-                _composer->fixup(*_deserializer->si());
+                if (_composer)
+                    _composer->fixup(*_deserializer->si());
                 _deserializer->si()->clear();
                 _state = state_end;
             }
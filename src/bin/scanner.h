@@ -47,10 +47,26 @@ namespace cxxtools
 
                 void begin(DeserializerBase& handler, IComposer& composer);
 
+                // parses a reply, which nobody waits for any more
+                void beginSkip(DeserializerBase& handler);
+
                 bool advance(char ch);
 
                 void checkException();
 
+                bool failed() const
+                { return _failed; }
+
+                int errorCode() const
+                { return _errorCode; }
+
+                const std::string& errorMessage() const
+                { return _errorMessage; }
+
+                // the result is not needed any more
+                void skip()
+                { _composer = 0; }
+
             private:
                 enum
                 {
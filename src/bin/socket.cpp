@@ -28,7 +28,12 @@
 
 #include "socket.h"
 #include "rpcserverimpl.h"
+#include "protocol.h"
+#include <cxxtools/serviceprocedure.h>
+#include <cxxtools/remoteexception.h>
+#include <cxxtools/selector.h>
 #include <cxxtools/log.h>
+#include <sstream>
 
 log_define("cxxtools.bin.socket")
 
@@ -37,12 +42,65 @@ namespace cxxtools
 namespace bin
 {
 
+// A call with request id, which is processed in the thread pool of the server.
+class Socket::Call
+{
+        Socket& _socket;
+        ServiceProcedure* _proc;
+        uint32_t _id;
+
+    public:
+        Call(Socket& socket, ServiceProcedure* proc, uint32_t id)
+            : _socket(socket),
+              _proc(proc),
+              _id(id)
+        { }
+
+        void run();
+};
+
+void Socket::Call::run()
+{
+    std::ostringstream out;
+    writeRequestId(out, _id);
+
+    try
+    {
+        IDecomposer* result = _proc->endCall();
+        Formatter formatter(out);
+        // clients sending requests with id know the name dictionary
+        formatter.useDictionary(true);
+        out << '\xc1';
+        result->format(formatter);
+        out << '\xff';
+    }
+    catch (const RemoteException& e)
+    {
+        out.str(std::string());
+        writeRequestId(out, _id);
+        Responder::replyError(out, e.what(), e.rc());
+    }
+    catch (const std::exception& e)
+    {
+        out.str(std::string());
+        writeRequestId(out, _id);
+        Responder::replyError(out, e.what(), 0);
+    }
+
+    _socket._responder._serviceRegistry.releaseProcedure(_proc);
+    _socket.endCall(out.str());
+
+    delete this;
+}
+
 Socket::Socket(RpcServerImpl& server, ServiceRegistry& serviceRegistry, net::TcpServer& tcpServer)
     : inputSlot(slot(*this, &Socket::onInput)),
       _tcpServer(tcpServer),
       _server(server),
-      _responder(serviceRegistry),
-      _accepted(false)
+      _responder(*this, serviceRegistry),
+      _accepted(false),
+      _callsPending(0),
+      _replySelector(0)
 {
     _stream.attachDevice(*this);
     cxxtools::connect(IODevice::inputReady, *this, &Socket::onIODeviceInput);
@@ -53,14 +111,23 @@ Socket::Socket(Socket& socket)
     : inputSlot(slot(*this, &Socket::onInput)),
       _tcpServer(socket._tcpServer),
       _server(socket._server),
-      _responder(socket._responder._serviceRegistry),
-      _accepted(false)
+      _responder(*this, socket._responder._serviceRegistry),
+      _accepted(false),
+      _callsPending(0),
+      _replySelector(0)
 {
     _stream.attachDevice(*this);
     cxxtools::connect(IODevice::inputReady, *this, &Socket::onIODeviceInput);
     cxxtools::connect(_stream.buffer().outputReady, *this, &Socket::onOutput);
 }
 
+Socket::~Socket()
+{
+    MutexLock lock(_replyMutex);
+    while (_callsPending > 0)
+        _callsFinished.wait(lock);
+}
+
 void Socket::accept()
 {
     net::TcpSocket::accept(_tcpServer, net::TcpSocket::DEFER_ACCEPT);
@@ -73,11 +140,17 @@ void Socket::accept()
 void Socket::setSelector(SelectorBase* s)
 {
     s->add(*this);
+
+    MutexLock lock(_replyMutex);
+    _replySelector = s;
 }
 
 void Socket::removeSelector()
 {
     TcpSocket::setSelector(0);
+
+    MutexLock lock(_replyMutex);
+    _replySelector = 0;
 }
 
 void Socket::onIODeviceInput(IODevice& iodevice)
@@ -141,5 +214,63 @@ bool Socket::onOutput(StreamBuffer& sb)
     return true;
 }
 
+void Socket::beginCall(ServiceProcedure* proc, uint32_t id)
+{
+    Call* call = new Call(*this, proc, id);
+
+    {
+        MutexLock lock(_replyMutex);
+        ++_callsPending;
+    }
+
+    try
+    {
+        _server.schedule(callable(*call, &Call::run));
+    }
+    catch (...)
+    {
+        MutexLock lock(_replyMutex);
+        --_callsPending;
+        delete call;
+        throw;
+    }
+}
+
+void Socket::endCall(const std::string& reply)
+{
+    MutexLock lock(_replyMutex);
+
+    _replies += reply;
+
+    if (--_callsPending == 0)
+        _callsFinished.broadcast();
+
+    if (_replySelector)
+        _replySelector->wake();
+}
+
+void Socket::sendReplies()
+{
+    std::string replies;
+
+    {
+        MutexLock lock(_replyMutex);
+        if (_replies.empty())
+            return;
+        replies.swap(_replies);
+    }
+
+    log_debug("send " << replies.size() << " bytes of replies");
+
+    _stream.write(replies.data(), replies.size());
+    buffer().beginWrite();
+}
+
+bool Socket::callsPending()
+{
+    MutexLock lock(_replyMutex);
+    return _callsPending > 0 || !_replies.empty();
+}
+
 }
 }
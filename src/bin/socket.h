@@ -35,6 +35,8 @@
 #include <cxxtools/connectable.h>
 #include <cxxtools/signal.h>
 #include <cxxtools/method.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/condition.h>
 #include "responder.h"
 
 namespace cxxtools
@@ -46,9 +48,12 @@ class RpcServerImpl;
 
 class Socket : public net::TcpSocket, public Connectable
 {
+        class Call;
+
     public:
         Socket(RpcServerImpl& server, ServiceRegistry& _serviceRegistry, net::TcpServer& tcpServer);
         explicit Socket(Socket& socket);
+        ~Socket();
 
         void accept();
         bool hasAccepted() const  { return _accepted; }
@@ -60,6 +65,14 @@ class Socket : public net::TcpSocket, public Connectable
         void onInput(StreamBuffer& sb);
         bool onOutput(StreamBuffer& sb);
 
+        // Processes a request with id in the thread pool of the server.
+        void beginCall(ServiceProcedure* proc, uint32_t id);
+
+        // Moves the replies of finished calls to the output buffer.
+        void sendReplies();
+
+        bool callsPending();
+
         Signal<Socket&> inputReady;
 
         StreamBuffer& buffer()         { return _stream.buffer(); }
@@ -77,6 +90,15 @@ class Socket : public net::TcpSocket, public Connectable
         IOStream _stream;
 
         bool _accepted;
+
+        // replies of calls processed in other threads
+        Mutex _replyMutex;
+        Condition _callsFinished;
+        std::string _replies;
+        unsigned _callsPending;
+        SelectorBase* _replySelector;
+
+        void endCall(const std::string& reply);
 };
 
 }
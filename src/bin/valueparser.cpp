@@ -31,6 +31,7 @@
 #include <cxxtools/bin/serializer.h>
 #include <cxxtools/serializationerror.h>
 #include <cxxtools/log.h>
+#include "packedarray.h"
 
 #include <math.h>
 
@@ -83,7 +84,9 @@ namespace
             case Serializer::TypeLongFloat:
             case Serializer::TypePlainLongFloat:
             case Serializer::TypeBcdFloat:
-            case Serializer::TypePlainBcdFloat: return "double";
+            case Serializer::TypePlainBcdFloat:
+            case Serializer::TypePlainFloat32:
+            case Serializer::TypePlainFloat64: return "double";
             case Serializer::TypePair:
             case Serializer::TypePlainPair: return "pair";
             case Serializer::TypeArray:
@@ -116,9 +119,19 @@ namespace
 void ValueParser::begin(DeserializerBase& handler)
 {
     log_debug(static_cast<void*>(this) << " begin");
+    if (_context == &_ownContext)
+    {
+        _ownContext.dictionary = false;
+        if (!_keepDictionary)
+            _ownContext.dictionarySize = 0;
+    }
     _state = state_type;
+    _stringState = string_begin;
     _nextstate = state_type;
     _deserializer = &handler;
+    _sized = false;
+    _memberHandler = 0;
+    _memberOpen = false;
     _int = 0;
     _exp = 0;
     _token.clear();
@@ -127,14 +140,176 @@ void ValueParser::begin(DeserializerBase& handler)
 
 void ValueParser::beginSkip()
 {
+    if (_context == &_ownContext)
+    {
+        _ownContext.dictionary = false;
+        if (!_keepDictionary)
+            _ownContext.dictionarySize = 0;
+    }
     _state = state_type;
+    _stringState = string_begin;
     _deserializer = 0;
+    _sized = false;
+    _memberHandler = 0;
+    _memberOpen = false;
     _int = 0;
     _exp = 0;
     _token.clear();
 }
 
 
+ValueParser* ValueParser::next()
+{
+    if (_next == 0)
+    {
+        _next = new ValueParser();
+        _next->_context = _context;
+    }
+
+    return _next;
+}
+
+void ValueParser::beginMember(DeserializerBase& handler)
+{
+    // The member is skipped until its name shows, that it is projected.
+    beginSkip();
+    _memberHandler = &handler;
+}
+
+void ValueParser::beginContent(State contentState)
+{
+    if (_sized)
+    {
+        _nextstate = contentState;
+        _count = 8;
+        _int = 0;
+        _state = state_sized_header;
+    }
+    else
+    {
+        _state = contentState;
+    }
+}
+
+void ValueParser::replayType()
+{
+    Serializer::TypeCode tc = static_cast<Serializer::TypeCode>(_typeCode);
+    switch (tc)
+    {
+        case Serializer::CategoryObject:
+        case Serializer::CategorySizedObject:
+            _deserializer->setCategory(SerializationInfo::Object);
+            break;
+
+        case Serializer::CategoryArray:
+        case Serializer::CategorySizedArray:
+            _deserializer->setCategory(SerializationInfo::Array);
+            break;
+
+        case Serializer::CategoryPackedArray:
+            _deserializer->setCategory(SerializationInfo::Array);
+            _deserializer->setTypeName("array");
+            break;
+
+        case Serializer::TypeOther:
+            _deserializer->setTypeName(_typeName);
+            break;
+
+        default:
+            _deserializer->setTypeName(typeName(_typeCode));
+            _deserializer->setCategory(SerializationInfo::Value);
+            switch (tc)
+            {
+                case Serializer::TypeEmpty:
+                    _deserializer->setNull();
+                    break;
+
+                case Serializer::TypeArray:
+                case Serializer::TypeVector:
+                case Serializer::TypeList:
+                case Serializer::TypeDeque:
+                case Serializer::TypeSet:
+                case Serializer::TypeMultiset:
+                    _deserializer->setCategory(SerializationInfo::Array);
+                    break;
+
+                case Serializer::TypePair:
+                case Serializer::TypeMap:
+                case Serializer::TypeMultimap:
+                    _deserializer->setCategory(SerializationInfo::Object);
+                    break;
+
+                default:
+                    break;
+            }
+    }
+}
+
+bool ValueParser::readString(char ch)
+{
+    switch (_stringState)
+    {
+        case string_begin:
+            // without announced dictionary a name may start with any byte
+            if (_context->dictionary)
+            {
+                if (ch == static_cast<char>(Serializer::NameDefinition))
+                {
+                    _stringState = string_definition;
+                    return false;
+                }
+                else if (ch == static_cast<char>(Serializer::NameReference8)
+                      || ch == static_cast<char>(Serializer::NameReference16))
+                {
+                    _nameIndex = 0;
+                    _nameBytes = (ch == static_cast<char>(Serializer::NameReference8) ? 1 : 2);
+                    _stringState = string_reference;
+                    return false;
+                }
+            }
+
+            _stringState = string_plain;
+            // no break
+
+        case string_plain:
+        case string_definition:
+            if (ch != '\0')
+            {
+                _token += ch;
+                return false;
+            }
+
+            if (_stringState == string_definition)
+            {
+                Context& c = *_context;
+                if (c.dictionarySize < c.names.size())
+                    c.names[c.dictionarySize].assign(_token);
+                else
+                    c.names.push_back(_token);
+                _string = &c.names[c.dictionarySize++];
+            }
+            else
+                _string = &_token;
+
+            _stringState = string_begin;
+            return true;
+
+        case string_reference:
+            _nameIndex = (_nameIndex << 8) | static_cast<unsigned char>(ch);
+            if (--_nameBytes > 0)
+                return false;
+
+            if (_nameIndex >= _context->dictionarySize)
+                SerializationError::doThrow("invalid name reference");
+
+            _string = &_context->names[_nameIndex];
+            _stringState = string_begin;
+            return true;
+    }
+
+    return false;
+}
+
 bool ValueParser::advance(char ch)
 {
     //log_debug(static_cast<void*>(this) << " advance " << std::hex << static_cast<unsigned>(static_cast<unsigned char>(ch)) << std::dec << " state " << _state << " nextstate " << _nextstate);
@@ -143,20 +318,39 @@ bool ValueParser::advance(char ch)
         case state_type:
             {
                 Serializer::TypeCode tc = static_cast<Serializer::TypeCode>(static_cast<unsigned char>(ch));
-                if (tc == Serializer::CategoryObject)
+                if (tc == Serializer::NameDictionary && _context == &_ownContext)
                 {
+                    _ownContext.dictionary = true;
+                    break;
+                }
+
+                _typeCode = static_cast<unsigned char>(ch);
+                if (tc == Serializer::CategoryObject || tc == Serializer::CategorySizedObject)
+                {
+                    _sized = (tc == Serializer::CategorySizedObject);
                     _nextstate = state_object_type;
                     _state = state_name;
                     if (_deserializer)
                         _deserializer->setCategory(SerializationInfo::Object);
                 }
-                else if (tc == Serializer::CategoryArray)
+                else if (tc == Serializer::CategoryArray || tc == Serializer::CategorySizedArray)
                 {
+                    _sized = (tc == Serializer::CategorySizedArray);
                     _nextstate = state_array_type;
                     _state = state_name;
                     if (_deserializer)
                         _deserializer->setCategory(SerializationInfo::Array);
                 }
+                else if (tc == Serializer::CategoryPackedArray)
+                {
+                    _nextstate = state_packed_type;
+                    _state = state_name;
+                    if (_deserializer)
+                    {
+                        _deserializer->setCategory(SerializationInfo::Array);
+                        _deserializer->setTypeName("array");
+                    }
+                }
                 else if (tc == Serializer::TypeOther)
                 {
                     log_debug("type other");
@@ -419,31 +613,38 @@ bool ValueParser::advance(char ch)
             break;
 
         case state_name:
-            if (ch == '\0')
+            if (readString(ch))
             {
-                log_debug("name=" << _token);
+                log_debug("name=" << *_string);
+                if (_memberHandler && !_memberOpen && _projection->count(*_string))
+                {
+                    _projection = 0;
+                    _deserializer = _memberHandler;
+                    _deserializer->beginMember(*_string, "", SerializationInfo::Void);
+                    _memberOpen = true;
+                    replayType();
+                }
+
                 if (_deserializer)
-                    _deserializer->setName(_token);
+                    _deserializer->setName(*_string);
                 _token.clear();
                 _state = _nextstate;
             }
-            else
-                _token += ch;
             break;
 
         case state_value_type_other:
-            if (ch == '\0')
+            if (readString(ch))
             {
-                log_debug("typename=" << _token);
+                log_debug("typename=" << *_string);
                 if (_deserializer)
-                    _deserializer->setTypeName(_token);
+                    _deserializer->setTypeName(*_string);
+                else if (_memberHandler)
+                    _typeName = *_string;
 
                 _token.clear();
                 _state = _nextstate;
                 _nextstate = state_value_value;
             }
-            else
-                _token += ch;
             break;
 
         case state_value_intsign:
@@ -626,20 +827,18 @@ bool ValueParser::advance(char ch)
             {
                 if (_deserializer)
                     _deserializer->setTypeName(typeName(ch));
-                _state = state_object_member;
+                beginContent(state_object_member);
             }
             break;
 
         case state_object_type_other:
-            if (ch == '\0')
+            if (readString(ch))
             {
                 if (_deserializer)
-                    _deserializer->setTypeName(_token);
+                    _deserializer->setTypeName(*_string);
                 _token.clear();
-                _state = state_object_member;
+                beginContent(state_object_member);
             }
-            else
-                _token += ch;
             break;
 
         case state_object_member:
@@ -649,16 +848,21 @@ bool ValueParser::advance(char ch)
             if (ch != '\1')
                 SerializationError::doThrow("member expected");
 
-            if (_next == 0)
-                _next = new ValueParser();
+            next();
 
-            if (_deserializer)
+            if (_deserializer == 0)
+                _next->beginSkip();
+            else if (_projection)
+            {
+                _next->beginMember(*_deserializer);
+                _next->_projection = _projection;
+            }
+            else
             {
                 _deserializer->beginMember(_token, "", SerializationInfo::Void);
                 _next->begin(*_deserializer);
+                _next->_projection = 0;
             }
-            else
-                _next->beginSkip();
 
             _state = state_object_member_value;
             break;
@@ -666,7 +870,7 @@ bool ValueParser::advance(char ch)
         case state_object_member_value:
             if (_next->advance(ch))
             {
-                if (_deserializer)
+                if (_deserializer && (_next->_memberHandler == 0 || _next->_memberOpen))
                     _deserializer->leaveMember();
                 _state = state_object_member;
             }
@@ -679,33 +883,31 @@ bool ValueParser::advance(char ch)
             {
                 if (_deserializer)
                     _deserializer->setTypeName(typeName(ch));
-                _state = state_array_member;
+                beginContent(state_array_member);
             }
             break;
 
         case state_array_type_other:
-            if (ch == '\0')
+            if (readString(ch))
             {
                 if (_deserializer)
-                    _deserializer->setTypeName(_token);
+                    _deserializer->setTypeName(*_string);
                 _token.clear();
-                _state = state_array_member;
+                beginContent(state_array_member);
             }
-            else
-                _token += ch;
             break;
 
         case state_array_member:
             if (ch == '\xff')
                 return true;
 
-            if (_next == 0)
-                _next = new ValueParser();
+            next();
 
             if (_deserializer)
             {
                 _deserializer->beginMember("", "", SerializationInfo::Void);
                 _next->begin(*_deserializer);
+                _next->_projection = _projection;
             }
             else
             {
@@ -736,6 +938,7 @@ bool ValueParser::advance(char ch)
                 {
                     _deserializer->beginMember("", "", SerializationInfo::Void);
                     _next->begin(*_deserializer);
+                    _next->_projection = _projection;
                 }
                 else
                 {
@@ -747,6 +950,91 @@ bool ValueParser::advance(char ch)
             }
             break;
 
+        case state_packed_type:
+            _packedType = static_cast<unsigned char>(ch);
+            _elementSize = packedElementSize(_packedType);
+            if (_elementSize == 0)
+                SerializationError::doThrow("invalid element type of packed array");
+            _count = 4;
+            _int = 0;
+            _state = state_packed_count;
+            break;
+
+        case state_packed_count:
+            _int = (_int << 8) | static_cast<unsigned char>(ch);
+            if (--_count == 0)
+            {
+                _count = static_cast<unsigned>(_int);
+                _int = 0;
+                _elementByte = 0;
+                if (_count == 0)
+                    return true;
+                _state = state_packed_element;
+            }
+            break;
+
+        case state_packed_element:
+            _int |= static_cast<uint64_t>(static_cast<unsigned char>(ch)) << (_elementByte * 8);
+            if (++_elementByte == _elementSize)
+            {
+                if (_deserializer)
+                {
+                    _deserializer->beginMember("", typeName(_packedType), SerializationInfo::Value);
+                    switch (_packedType)
+                    {
+                        case Serializer::TypePlainFloat32:
+                        case Serializer::TypePlainFloat64:
+                            _deserializer->setValue(packedElementValue<long double>(_packedType, _int));
+                            break;
+
+                        case Serializer::TypePlainInt8:
+                        case Serializer::TypePlainInt16:
+                        case Serializer::TypePlainInt32:
+                        case Serializer::TypePlainInt64:
+                            _deserializer->setValue(packedElementValue<DeserializerBase::int_type>(_packedType, _int));
+                            break;
+
+                        default:
+                            _deserializer->setValue(packedElementValue<DeserializerBase::unsigned_type>(_packedType, _int));
+                    }
+                    _deserializer->leaveMember();
+                }
+
+                _int = 0;
+                _elementByte = 0;
+                if (--_count == 0)
+                    return true;
+            }
+            break;
+
+        case state_sized_header:
+            _int = (_int << 8) | static_cast<unsigned char>(ch);
+            if (--_count == 0)
+            {
+                _elements = static_cast<uint32_t>(_int >> 32);
+                std::size_t length = static_cast<uint32_t>(_int);
+                _int = 0;
+                if (length == 0)
+                    SerializationError::doThrow("invalid length of sized container");
+
+                if (_deserializer)
+                {
+                    _deserializer->reserveMembers(_elements);
+                    _state = _nextstate;
+                }
+                else
+                {
+                    _context->skip = length;
+                    _state = state_skip;
+                }
+            }
+            break;
+
+        case state_skip:
+            if (--_context->skip == 0)
+                return true;
+            break;
+
         case state_end:
             if (ch != '\xff')
                 SerializationError::doThrow("end of value marker expected");
@@ -29,6 +29,7 @@
 #include "worker.h"
 #include "rpcserverimpl.h"
 #include <cxxtools/log.h>
+#include <cxxtools/selector.h>
 #include "socket.h"
 
 log_define("cxxtools.bin.worker")
@@ -41,6 +42,11 @@ namespace bin
 void Worker::run()
 {
     log_info("new thread running");
+
+    // The selector is woken, when a call processed in the thread pool of
+    // the server has finished.
+    Selector selector;
+
     while (!_server.isTerminating() && _server._queue.numWaiting() < _server.minThreads())
     {
         Socket* socket = _server._queue.get();
@@ -90,8 +96,14 @@ void Worker::run()
             Connection inputConnection = connect(socket->buffer().inputReady,
                 socket->inputSlot);
 
-            while (socket->wait(10) && socket->isConnected())
-                ;
+            socket->setSelector(&selector);
+
+            // the socket stays in this thread, while calls are pending
+            do
+                socket->sendReplies();
+            while (socket->isConnected() && (selector.wait(10) || socket->callsPending()));
+
+            socket->removeSelector();
 
             if (socket->isConnected())
             {
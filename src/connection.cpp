@@ -49,6 +49,19 @@ Connection::Connection(Connectable& sender, Slot* slot)
 }
 
 
+Connection::Connection(Connectable& sender, const Slot& slot)
+{
+    std::auto_ptr<ConnectionData> data( new ConnectionData(sender, slot) );
+    _data = data.get();
+    _data->setValid(false);
+
+    sender.onConnectionOpen(*this);
+    _data->slot().onConnect(*this);
+   _data->setValid(true);
+    data.release();
+}
+
+
 Connection::Connection(const Connection& connection)
 {
     _data = connection._data;
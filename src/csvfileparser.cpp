@@ -0,0 +1,537 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <cxxtools/csvfileparser.h>
+#include <cxxtools/utf8codec.h>
+#include <cxxtools/systemerror.h>
+#include <cxxtools/conversionerror.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/method.h>
+#include <cxxtools/log.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+log_define("cxxtools.csv.fileparser")
+
+namespace cxxtools
+{
+
+namespace
+{
+    // chunks are not made smaller than this
+    const std::size_t minChunkSize = 4096;
+
+    unsigned processors()
+    {
+        long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? static_cast<unsigned>(n) : 1;
+    }
+
+    inline bool isTitleChar(char ch)
+    {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')
+            || ch == '_' || ch == ' ' || static_cast<unsigned char>(ch) >= 0x80;
+    }
+
+    template <typename T>
+    void convertInt(T& n, const CsvField& field, const char* typeto)
+    {
+        bool ok = false;
+        const char* r = getInt(field.begin(), field.end(), ok, n);
+        if (r != field.end() || !ok)
+            ConversionError::doThrow(typeto, "csv field", field.str().c_str());
+    }
+
+    template <typename T>
+    void convertFloat(T& n, const CsvField& field, const char* typeto)
+    {
+        bool ok = false;
+        const char* r = getFloat(field.begin(), field.end(), ok, n);
+        if (r != field.end() || !ok)
+            ConversionError::doThrow(typeto, "csv field", field.str().c_str());
+    }
+}
+
+struct CsvFileParser::Chunk
+{
+    CsvFileParser* parser;
+    unsigned index;
+    const char* begin;
+    const char* end;
+    ScanState entry;
+    ScanState exit;
+
+    // errors are passed from the threads to parse()
+    enum { noError, serializationError, conversionError, otherError } error;
+    std::string what;
+
+    void scan()
+    {
+        exit = FieldStart;
+        parser->scan(begin, end, exit, false);
+    }
+
+    void run()
+    {
+        try
+        {
+            parser->parseChunk(*this);
+        }
+        catch (const SerializationError& e)
+        {
+            error = serializationError;
+            what = e.what();
+        }
+        catch (const ConversionError& e)
+        {
+            error = conversionError;
+            what = e.what();
+        }
+        catch (const std::exception& e)
+        {
+            error = otherError;
+            what = e.what();
+        }
+    }
+};
+
+const Char CsvFileParser::autoDelimiter = L'\0';
+
+String CsvField::toString() const
+{
+    return _size == 0 ? String() : Utf8Codec::decode(_data, static_cast<unsigned>(_size));
+}
+
+CsvFileParser::CsvFileParser(const std::string& filename)
+    : _begin(0),
+      _end(0),
+      _map(0),
+      _mapSize(0),
+      _delimiter(autoDelimiter),
+      _readTitle(true),
+      _threads(processors()),
+      _delim('\0')
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw SystemError("open", "failed to open csv file \"" + filename + '"');
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw SystemError("fstat");
+    }
+
+    _mapSize = static_cast<std::size_t>(st.st_size);
+    if (_mapSize > 0)
+    {
+        _map = ::mmap(0, _mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (_map == MAP_FAILED)
+        {
+            _map = 0;
+            ::close(fd);
+            throw SystemError("mmap");
+        }
+
+        ::madvise(_map, _mapSize, MADV_SEQUENTIAL);
+    }
+
+    ::close(fd);
+
+    _begin = static_cast<const char*>(_map);
+    _end = _begin + _mapSize;
+}
+
+CsvFileParser::CsvFileParser(const char* data, std::size_t size)
+    : _begin(data),
+      _end(data + size),
+      _map(0),
+      _mapSize(0),
+      _delimiter(autoDelimiter),
+      _readTitle(true),
+      _threads(processors()),
+      _delim('\0')
+{
+}
+
+CsvFileParser::~CsvFileParser()
+{
+    if (_map)
+        ::munmap(_map, _mapSize);
+}
+
+void CsvFileParser::parse()
+{
+    if (_delimiter == autoDelimiter && !_readTitle)
+        throw std::logic_error("can't read csv data with auto delimiter but without title");
+
+    if (_delimiter.value() >= 0x80)
+        throw std::logic_error("csv file parser supports ASCII delimiters only");
+
+    const char* p = _begin;
+
+    // skip byte order mark
+    if (_end - p >= 3 && std::memcmp(p, "\xef\xbb\xbf", 3) == 0)
+        p += 3;
+
+    _titles.clear();
+    _delim = static_cast<char>(_delimiter.value());
+    if (_readTitle)
+        p = parseTitles(p);
+
+    // split the data at line ends
+    std::vector<Chunk> chunks;
+    std::size_t size = _end - p;
+    std::size_t chunkSize = std::max(size / _threads, minChunkSize);
+    while (p < _end)
+    {
+        Chunk chunk;
+        chunk.parser = this;
+        chunk.index = chunks.size();
+        chunk.begin = p;
+        chunk.entry = FieldStart;
+        chunk.exit = FieldStart;
+        chunk.error = Chunk::noError;
+
+        if (static_cast<std::size_t>(_end - p) <= chunkSize)
+        {
+            p = _end;
+        }
+        else
+        {
+            p = static_cast<const char*>(std::memchr(p + chunkSize, '\n', _end - p - chunkSize));
+            p = p ? p + 1 : _end;
+        }
+
+        chunk.end = p;
+        chunks.push_back(chunk);
+    }
+
+    log_debug(chunks.size() << " chunks");
+
+    // scan the chunks for quotes assuming that they start at a row
+    if (chunks.size() > 1)
+    {
+        std::vector<AttachedThread*> threads;
+        for (unsigned n = 1; n < chunks.size(); ++n)
+        {
+            threads.push_back(new AttachedThread(callable(chunks[n], &Chunk::scan)));
+            threads.back()->start();
+        }
+
+        chunks[0].scan();
+
+        for (unsigned n = 0; n < threads.size(); ++n)
+            delete threads[n];
+    }
+
+    // check the assumption and rescan chunks, which start within a quoted value
+    ScanState state = FieldStart;
+    for (unsigned n = 0; n < chunks.size(); ++n)
+    {
+        Chunk& chunk = chunks[n];
+        chunk.entry = state;
+        if (state != FieldStart)
+        {
+            log_debug("chunk " << n << " starts within a quoted value");
+            chunk.exit = state;
+            scan(chunk.begin, chunk.end, chunk.exit, false);
+        }
+
+        state = chunk.exit;
+    }
+
+    for (unsigned n = 0; n < _handlers.size(); ++n)
+        _handlers[n]->begin(_titles, chunks.size());
+
+    if (chunks.size() > 1)
+    {
+        std::vector<AttachedThread*> threads;
+        for (unsigned n = 1; n < chunks.size(); ++n)
+        {
+            threads.push_back(new AttachedThread(callable(chunks[n], &Chunk::run)));
+            threads.back()->start();
+        }
+
+        chunks[0].run();
+
+        for (unsigned n = 0; n < threads.size(); ++n)
+            delete threads[n];
+    }
+    else if (chunks.size() == 1)
+    {
+        chunks[0].run();
+    }
+
+    // report the first error
+    for (unsigned n = 0; n < chunks.size(); ++n)
+    {
+        switch (chunks[n].error)
+        {
+            case Chunk::noError:              continue;
+            case Chunk::serializationError:   SerializationError::doThrow(chunks[n].what);
+            case Chunk::conversionError:      throw ConversionError(chunks[n].what);
+            case Chunk::otherError:           throw std::runtime_error(chunks[n].what);
+        }
+    }
+
+    for (unsigned n = 0; n < _handlers.size(); ++n)
+        _handlers[n]->end();
+}
+
+const char* CsvFileParser::parseTitles(const char* p)
+{
+    if (_delimiter == autoDelimiter)
+    {
+        // the delimiter is the first character of the title line, which is
+        // not valid in a title
+        _delim = '\n';
+        char quote = '\0';
+        for (const char* t = p; t < _end && *t != '\n' && *t != '\r'; ++t)
+        {
+            if (quote)
+            {
+                if (*t == quote)
+                    quote = '\0';
+            }
+            else if (*t == '"' || *t == '\'')
+            {
+                quote = *t;
+            }
+            else if (!isTitleChar(*t))
+            {
+                _delim = *t;
+                break;
+            }
+        }
+
+        log_debug("delimiter=" << _delim);
+    }
+
+    std::vector<CsvField> fields;
+    p = parseRow(p, fields);
+
+    for (std::size_t n = 0; n < fields.size(); ++n)
+    {
+        _titles.push_back(fields[n].str());
+        log_debug("title=\"" << _titles.back() << '"');
+    }
+
+    return p;
+}
+
+const char* CsvFileParser::scan(const char* p, const char* e, ScanState& state, bool stopAtRowEnd) const
+{
+    while (p < e)
+    {
+        switch (state)
+        {
+            case InDoubleQuote:
+            case InSingleQuote:
+            {
+                const char* q = static_cast<const char*>(std::memchr(p, state == InDoubleQuote ? '"' : '\'', e - p));
+                if (q == 0)
+                    return e;
+
+                p = q + 1;
+                state = AfterQuote;
+                continue;
+            }
+
+            case FieldStart:
+                if (*p == '"')
+                {
+                    state = InDoubleQuote;
+                    ++p;
+                    continue;
+                }
+                else if (*p == '\'')
+                {
+                    state = InSingleQuote;
+                    ++p;
+                    continue;
+                }
+                break;
+
+            case InField:
+            case AfterQuote:
+                break;
+        }
+
+        char ch = *p++;
+        if (ch == '\n' || ch == '\r')
+        {
+            state = FieldStart;
+            if (stopAtRowEnd)
+            {
+                if (ch == '\r' && p < _end && *p == '\n')
+                    ++p;
+                return p;
+            }
+        }
+        else if (ch == _delim)
+        {
+            state = FieldStart;
+        }
+        else
+        {
+            state = InField;
+        }
+    }
+
+    return p;
+}
+
+const char* CsvFileParser::parseRow(const char* p, std::vector<CsvField>& fields) const
+{
+    const char delim = _delim;
+    fields.clear();
+
+    while (true)
+    {
+        const char* f = p;
+        if (p < _end && (*p == '"' || *p == '\''))
+        {
+            const char* q = static_cast<const char*>(std::memchr(p + 1, *p, _end - p - 1));
+            if (q == 0)
+            {
+                // unterminated quote; CsvParser keeps the quote character
+                fields.push_back(CsvField(f, _end - f));
+                return _end;
+            }
+
+            p = q + 1;
+            if (p == _end || *p == delim || *p == '\n' || *p == '\r')
+            {
+                fields.push_back(CsvField(f + 1, q - f - 1));
+            }
+            else
+            {
+                // characters after the closing quote make the quotes part of the value
+                while (p < _end && *p != delim && *p != '\n' && *p != '\r')
+                    ++p;
+                fields.push_back(CsvField(f, p - f));
+            }
+        }
+        else
+        {
+            while (p < _end && *p != delim && *p != '\n' && *p != '\r')
+                ++p;
+            fields.push_back(CsvField(f, p - f));
+        }
+
+        if (p == _end)
+            return p;
+
+        if (*p == '\n')
+            return p + 1;
+
+        if (*p == '\r')
+        {
+            ++p;
+            if (p < _end && *p == '\n')
+                ++p;
+            return p;
+        }
+
+        ++p;  // delimiter
+    }
+}
+
+void CsvFileParser::parseChunk(Chunk& chunk)
+{
+    const char* p = chunk.begin;
+
+    // a row, which started in the previous chunk, is parsed there
+    if (chunk.entry != FieldStart)
+    {
+        ScanState state = chunk.entry;
+        p = scan(p, _end, state, true);
+    }
+
+    std::vector<CsvField> fields;
+    std::size_t columns = _titles.size();
+    while (p < chunk.end)
+    {
+        const char* row = p;
+        p = parseRow(p, fields);
+
+        if (_readTitle && fields.size() != columns)
+            checkColumns(row, fields.size());
+
+        CsvRow r(fields, chunk.index);
+        for (unsigned n = 0; n < _handlers.size(); ++n)
+            _handlers[n]->onRow(r);
+    }
+}
+
+void CsvFileParser::checkColumns(const char* row, std::size_t columns) const
+{
+    std::ostringstream msg;
+    msg << "number of columns " << columns << " in line " << (std::count(_begin, row, '\n') + 1)
+        << " does not match expected number of columns " << _titles.size();
+    SerializationError::doThrow(msg.str());
+}
+
+void convert(int& n, const CsvField& field)
+{
+    convertInt(n, field, "int");
+}
+
+void convert(unsigned int& n, const CsvField& field)
+{
+    convertInt(n, field, "unsigned int");
+}
+
+void convert(long& n, const CsvField& field)
+{
+    convertInt(n, field, "long");
+}
+
+void convert(unsigned long& n, const CsvField& field)
+{
+    convertInt(n, field, "unsigned long");
+}
+
+void convert(float& n, const CsvField& field)
+{
+    convertFloat(n, field, "float");
+}
+
+void convert(double& n, const CsvField& field)
+{
+    convertFloat(n, field, "double");
+}
+
+}
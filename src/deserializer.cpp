@@ -27,67 +27,140 @@
  */
 
 #include "cxxtools/deserializer.h"
+#include "cxxtools/valuesink.h"
 #include <stdexcept>
 
 namespace cxxtools
 {
     void DeserializerBase::setCategory(SerializationInfo::Category category)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setCategory(category);
+            return;
+        }
+
         _current->setCategory(category);
     }
 
     void DeserializerBase::setName(const std::string& name)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setName(name);
+            return;
+        }
+
         _current->setName(name);
     }
 
     void DeserializerBase::setTypeName(const std::string& type)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setTypeName(type);
+            return;
+        }
+
         _current->setTypeName(type);
     }
 
     void DeserializerBase::setValue(const String& value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(const std::string& value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(const char* value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(std::string(value));
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(bool value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(int_type value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(unsigned_type value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setValue(long double value)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setValue(value);
+            return;
+        }
+
         _current->setValue(value);
     }
 
     void DeserializerBase::setNull()
     {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->setNull();
+            return;
+        }
+
         _current->setNull();
     }
 
     void DeserializerBase::beginMember(const std::string& name, const std::string& type, SerializationInfo::Category category)
     {
+        if (!_sinks.empty())
+        {
+            _sinks.push_back(_sinks.back()->beginMember(name, type, category));
+            return;
+        }
+
         SerializationInfo& child = _current->addMember(name);
         child.setTypeName(type);
         child.setCategory(category);
@@ -96,6 +169,17 @@ namespace cxxtools
 
     void DeserializerBase::leaveMember()
     {
+        if (!_sinks.empty())
+        {
+            if (_sinks.size() <= 1)
+                SerializationError::doThrow("invalid member");
+
+            _sinks.back()->finish();
+            _sinks.pop_back();
+            _sinks.back()->leaveMember();
+            return;
+        }
+
         SerializationInfo* p = _current->parent();
         if( !p )
             SerializationError::doThrow("invalid member");
@@ -103,4 +187,26 @@ namespace cxxtools
         _current = p;
     }
 
+    void DeserializerBase::reserveMembers(std::size_t n)
+    {
+        if (!_sinks.empty())
+        {
+            _sinks.back()->reserve(n);
+            return;
+        }
+
+        _current->reserve(n);
+    }
+
+    void DeserializerBase::beginSink(IValueSink& sink)
+    {
+        _sinks.clear();
+        _sinks.push_back(&sink);
+    }
+
+    void DeserializerBase::endSink()
+    {
+        _sinks.clear();
+    }
+
 } // namespace cxxtools
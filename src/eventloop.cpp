@@ -28,12 +28,13 @@
  */
 #include "selectorimpl.h"
 #include "cxxtools/eventloop.h"
+#include "cxxtools/poolallocator.h"
 
 namespace cxxtools {
 
 EventLoop::EventLoop()
 : _exitLoop(false)
-, _allocator(/*255, 64*/)
+, _allocator(PoolAllocator::global())
 {
     _selector = new SelectorImpl();
 }
@@ -149,8 +150,6 @@ void EventLoop::onCommitEvent(const Event& ev)
     {
         RecursiveLock lock( _queueMutex );
 
-        // TODO: use a continuous block of memory to store events
-        // this avoids new/delete
         Event& clonedEvent = ev.clone(_allocator);
 
         try
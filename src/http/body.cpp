@@ -0,0 +1,241 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cxxtools/http/body.h>
+#include <cxxtools/ioerror.h>
+#include <cxxtools/systemerror.h>
+#include <cxxtools/log.h>
+#include <cstring>
+#include <sstream>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+log_define("cxxtools.http.body")
+
+namespace cxxtools {
+
+namespace http {
+
+Body::StreamBuf::int_type Body::StreamBuf::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof()))
+        return traits_type::not_eof(ch);
+
+    reserve(size() + 1);
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize Body::StreamBuf::xsputn(const char* s, std::streamsize n)
+{
+    if (epptr() - pptr() < n)
+        reserve(size() + n);
+    std::memcpy(pptr(), s, n);
+    pbump(n);
+    return n;
+}
+
+void Body::StreamBuf::reserve(std::size_t s)
+{
+    if (s <= _bufferSize)
+        return;
+
+    std::size_t n = size();
+    std::size_t bufferSize = _bufferSize < 256 ? 256 : _bufferSize * 2;
+    while (bufferSize < s)
+        bufferSize *= 2;
+
+    char* buffer = new char[bufferSize];
+    if (n > 0)
+        std::memcpy(buffer, _buffer, n);
+    delete[] _buffer;
+
+    _buffer = buffer;
+    _bufferSize = bufferSize;
+    setp(_buffer, _buffer + _bufferSize);
+    // pbump takes an int; bodies may be larger
+    while (n > 0)
+    {
+        int c = n > 0x40000000 ? 0x40000000 : static_cast<int>(n);
+        pbump(c);
+        n -= c;
+    }
+}
+
+Body::Body()
+    : _stream(&_streamBuf),
+      _segmentsSize(0),
+      _producer(0)
+{
+}
+
+Body::~Body()
+{
+    clear();
+}
+
+void Body::addData(const char* data, std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    Segment segment;
+    segment.type = Segment::Memory;
+    segment.pos = dataSize();
+    segment.data = data;
+    segment.fd = -1;
+    segment.offset = 0;
+    segment.size = size;
+    _segments.push_back(segment);
+    _segmentsSize += size;
+}
+
+void Body::addFile(const std::string& fname, off_t offset, std::size_t size)
+{
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            throw FileNotFound(fname);
+        throwSystemError(("open " + fname).c_str());
+    }
+
+    try
+    {
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+            throwSystemError("fstat");
+
+        if (offset > st.st_size)
+            offset = st.st_size;
+
+        if (size == std::string::npos || static_cast<off_t>(size) > st.st_size - offset)
+            size = st.st_size - offset;
+
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        log_debug("add file \"" << fname << "\" fd " << fd << " offset " << offset << " size " << size);
+
+        Segment segment;
+        segment.type = Segment::File;
+        segment.pos = dataSize();
+        segment.data = 0;
+        segment.fd = fd;
+        segment.offset = offset;
+        segment.size = size;
+        _segments.push_back(segment);
+        _segmentsSize += size;
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+}
+
+void Body::producer(const Producer& p)
+{
+    Producer* producer = p.clone();
+    delete _producer;
+    _producer = producer;
+}
+
+void Body::write(std::ostream& s) const
+{
+    std::size_t pos = 0;
+    for (Segments::const_iterator it = _segments.begin(); it != _segments.end(); ++it)
+    {
+        s.write(data() + pos, it->pos - pos);
+        pos = it->pos;
+
+        if (it->type == Segment::Memory)
+        {
+            s.write(it->data, it->size);
+        }
+        else
+        {
+            char buffer[8192];
+            off_t offset = it->offset;
+            std::size_t count = it->size;
+            while (count > 0)
+            {
+                ssize_t n = ::pread(it->fd, buffer, count < sizeof(buffer) ? count : sizeof(buffer), offset);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    throw IOError("failed to read file for http body");
+                s.write(buffer, n);
+                offset += n;
+                count -= n;
+            }
+        }
+    }
+
+    s.write(data() + pos, dataSize() - pos);
+}
+
+std::string Body::str() const
+{
+    std::ostringstream s;
+    write(s);
+    return s.str();
+}
+
+void Body::send(std::ostream& out) const
+{
+    write(out);
+
+    if (_producer)
+    {
+        while ((*_producer)(out))
+            ;
+    }
+}
+
+void Body::clear()
+{
+    for (Segments::iterator it = _segments.begin(); it != _segments.end(); ++it)
+    {
+        if (it->type == Segment::File)
+            ::close(it->fd);
+    }
+
+    _segments.clear();
+    _segmentsSize = 0;
+
+    delete _producer;
+    _producer = 0;
+
+    _streamBuf.clear();
+    _stream.clear();
+}
+
+} // namespace http
+
+} // namespace cxxtools
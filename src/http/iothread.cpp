@@ -0,0 +1,224 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "iothread.h"
+#include "serverimpl.h"
+#include "socket.h"
+#include <cxxtools/threadpool.h>
+#include <cxxtools/log.h>
+
+log_define("cxxtools.http.iothread")
+
+namespace cxxtools
+{
+namespace http
+{
+
+class NewSocketEvent : public BasicEvent<NewSocketEvent>
+{
+        Socket* _socket;
+
+    public:
+        explicit NewSocketEvent(Socket* socket)
+            : _socket(socket)
+            { }
+
+        Socket* socket() const   { return _socket; }
+};
+
+class ReplyReadyEvent : public BasicEvent<ReplyReadyEvent>
+{
+        Socket* _socket;
+
+    public:
+        explicit ReplyReadyEvent(Socket* socket)
+            : _socket(socket)
+            { }
+
+        Socket* socket() const   { return _socket; }
+};
+
+class CloseSocketEvent : public BasicEvent<CloseSocketEvent>
+{
+        Socket* _socket;
+
+    public:
+        explicit CloseSocketEvent(Socket* socket)
+            : _socket(socket)
+            { }
+
+        Socket* socket() const   { return _socket; }
+};
+
+IOThread::IOThread(ServerImpl& server)
+    : AttachedThread(callable(*this, &IOThread::run)),
+      _server(server),
+      _terminating(false)
+{
+    _loop.event.subscribe(slot(*this, &IOThread::onNewSocket));
+    _loop.event.subscribe(slot(*this, &IOThread::onReplyReady));
+    _loop.event.subscribe(slot(*this, &IOThread::onCloseSocket));
+}
+
+IOThread::~IOThread()
+{
+    for (std::set<Socket*>::iterator it = _sockets.begin(); it != _sockets.end(); ++it)
+        delete *it;
+}
+
+void IOThread::run()
+{
+    log_info("io thread running");
+    _loop.run();
+    log_info("io thread terminated");
+}
+
+void IOThread::addSocket(Socket* socket)
+{
+    _loop.commitEvent(NewSocketEvent(socket));
+}
+
+void IOThread::scheduleReply(Socket& socket)
+{
+    _server._replyPool->schedule(callable(socket, &Socket::onReplyJob));
+}
+
+void IOThread::replyReady(Socket& socket)
+{
+    _loop.commitEvent(ReplyReadyEvent(&socket));
+}
+
+void IOThread::terminate()
+{
+    log_debug("terminate io thread with " << _sockets.size() << " connections");
+
+    _loop.exit();
+    join();
+
+    // the loop is not running any more; drop pending events
+    _terminating = true;
+    _loop.processEvents();
+
+    for (std::set<Socket*>::iterator it = _sockets.begin(); it != _sockets.end(); ++it)
+        delete *it;
+    _sockets.clear();
+}
+
+void IOThread::closeSocket(Socket& socket)
+{
+    if (_sockets.erase(&socket) == 0)
+        return;
+
+    log_debug("close socket " << static_cast<void*>(&socket));
+
+    // we are called from a signal of the socket, so it is deleted later
+    socket.removeSelector();
+    _loop.commitEvent(CloseSocketEvent(&socket));
+}
+
+void IOThread::onNewSocket(const NewSocketEvent& event)
+{
+    Socket* socket = event.socket();
+
+    if (_terminating)
+    {
+        delete socket;
+        return;
+    }
+
+    log_debug("new socket " << static_cast<void*>(socket));
+
+    _sockets.insert(socket);
+    socket->ioThread(this);
+    socket->setSelector(&_loop);
+    connect(socket->buffer().inputReady, *this, &IOThread::onInput);
+    connect(socket->buffer().outputReady, *this, &IOThread::onOutput);
+    connect(socket->timeout, *this, &IOThread::onTimeout);
+}
+
+void IOThread::onReplyReady(const ReplyReadyEvent& event)
+{
+    if (_terminating)
+        return;
+
+    Socket& socket = *event.socket();
+
+    try
+    {
+        socket.sendReply();
+        socket.onOutput(socket.buffer());
+    }
+    catch (const std::exception& e)
+    {
+        log_debug("error occured in device: " << e.what());
+        socket.close();
+    }
+
+    if (!socket.isConnected())
+        closeSocket(socket);
+}
+
+void IOThread::onCloseSocket(const CloseSocketEvent& event)
+{
+    log_debug("delete socket " << static_cast<void*>(event.socket()));
+    delete event.socket();
+}
+
+void IOThread::onInput(StreamBuffer& sb)
+{
+    Socket& socket = *static_cast<Socket*>(sb.device());
+
+    try
+    {
+        socket.onInput(sb);
+    }
+    catch (const std::exception& e)
+    {
+        log_debug("error occured in device: " << e.what());
+        socket.close();
+    }
+
+    if (!socket.isConnected())
+        closeSocket(socket);
+}
+
+void IOThread::onOutput(StreamBuffer& sb)
+{
+    // the socket itself sends the data; we just check for a closed connection
+    Socket& socket = *static_cast<Socket*>(sb.device());
+    if (!socket.isConnected())
+        closeSocket(socket);
+}
+
+void IOThread::onTimeout(Socket& socket)
+{
+    log_debug("timeout; socket " << static_cast<void*>(&socket));
+    socket.close();
+    closeSocket(socket);
+}
+
+}
+}
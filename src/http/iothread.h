@@ -0,0 +1,98 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_HTTP_IOTHREAD_H
+#define CXXTOOLS_HTTP_IOTHREAD_H
+
+#include <cxxtools/thread.h>
+#include <cxxtools/eventloop.h>
+#include <cxxtools/connectable.h>
+#include <set>
+
+namespace cxxtools
+{
+
+class StreamBuffer;
+
+namespace http
+{
+
+class ServerImpl;
+class Socket;
+class NewSocketEvent;
+class ReplyReadyEvent;
+class CloseSocketEvent;
+
+/**
+   An IOThread runs an event loop, which serves a set of connections.
+
+   It reads and parses the requests of its connections and sends the
+   replies, so that many keep alive connections are handled by a small
+   number of threads. Only the responders are executed in the reply
+   thread pool of the server.
+ */
+class IOThread : public AttachedThread, public Connectable
+{
+    public:
+        explicit IOThread(ServerImpl& server);
+        ~IOThread();
+
+        // Passes an accepted socket to this thread; thread safe.
+        void addSocket(Socket* socket);
+
+        // Passes the request of the socket to the reply thread pool.
+        void scheduleReply(Socket& socket);
+
+        // Notifies, that the reply of the socket is generated; called
+        // from the reply thread pool.
+        void replyReady(Socket& socket);
+
+        // Stops the event loop and releases all connections.
+        void terminate();
+
+    private:
+        void run();
+
+        void closeSocket(Socket& socket);
+
+        void onNewSocket(const NewSocketEvent& event);
+        void onReplyReady(const ReplyReadyEvent& event);
+        void onCloseSocket(const CloseSocketEvent& event);
+
+        void onInput(StreamBuffer& sb);
+        void onOutput(StreamBuffer& sb);
+        void onTimeout(Socket& socket);
+
+        ServerImpl& _server;
+        EventLoop _loop;
+        std::set<Socket*> _sockets;
+        bool _terminating;
+};
+
+}
+}
+
+#endif // CXXTOOLS_HTTP_IOTHREAD_H
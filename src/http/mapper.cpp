@@ -28,7 +28,10 @@
 
 #include <cxxtools/http/service.h>
 #include <cxxtools/http/request.h>
+#include <cxxtools/atomicity.h>
+#include <cxxtools/thread.h>
 #include <cxxtools/log.h>
+#include <algorithm>
 #include "mapper.h"
 
 log_define("cxxtools.http.mapper")
@@ -38,66 +41,383 @@ namespace cxxtools
 namespace http
 {
 
+namespace
+{
+    struct Entry
+    {
+        unsigned index;              // position in the list of routes
+        Service* service;
+        std::vector<std::string> names;   // names of the parameters
+    };
+
+    struct Node
+    {
+        std::string label;
+        std::vector<Node*> children;   // first characters of the labels differ
+        Node* param;                   // matches a segment up to the next '/'
+        std::vector<const Entry*> urls;
+        std::vector<const Entry*> prefixes;
+
+        Node()
+            : param(0)
+            { }
+
+        explicit Node(const std::string& label_)
+            : label(label_),
+              param(0)
+            { }
+
+        ~Node()
+        {
+            for (std::vector<Node*>::iterator it = children.begin(); it != children.end(); ++it)
+                delete *it;
+            delete param;
+        }
+
+        Node* insert(const std::string& s);
+    };
+
+    // Returns the node, which matches the static text s after this node.
+    Node* Node::insert(const std::string& s)
+    {
+        Node* node = this;
+        std::string::size_type pos = 0;
+
+        while (pos < s.size())
+        {
+            std::vector<Node*>::iterator it = node->children.begin();
+            while (it != node->children.end() && (*it)->label[0] != s[pos])
+                ++it;
+
+            if (it == node->children.end())
+            {
+                Node* child = new Node(s.substr(pos));
+                node->children.push_back(child);
+                return child;
+            }
+
+            Node* child = *it;
+            std::string::size_type n = 1;
+            while (n < child->label.size() && pos + n < s.size() && child->label[n] == s[pos + n])
+                ++n;
+
+            if (n < child->label.size())
+            {
+                // split the label
+                Node* mid = new Node(child->label.substr(0, n));
+                child->label.erase(0, n);
+                mid->children.push_back(child);
+                *it = mid;
+                child = mid;
+            }
+
+            node = child;
+            pos += n;
+        }
+
+        return node;
+    }
+
+    struct Candidate
+    {
+        const Entry* entry;
+        std::vector<std::string> values;
+
+        bool operator< (const Candidate& c) const
+        { return entry->index < c.entry->index; }
+    };
+
+    void collect(const Node* node, const std::string& url, std::string::size_type pos,
+                 std::vector<std::string>& values, std::vector<Candidate>& result)
+    {
+        for (std::vector<const Entry*>::const_iterator it = node->prefixes.begin(); it != node->prefixes.end(); ++it)
+        {
+            result.push_back(Candidate());
+            result.back().entry = *it;
+            result.back().values = values;
+        }
+
+        if (pos == url.size())
+        {
+            for (std::vector<const Entry*>::const_iterator it = node->urls.begin(); it != node->urls.end(); ++it)
+            {
+                result.push_back(Candidate());
+                result.back().entry = *it;
+                result.back().values = values;
+            }
+
+            return;
+        }
+
+        for (std::vector<Node*>::const_iterator it = node->children.begin(); it != node->children.end(); ++it)
+        {
+            const std::string& label = (*it)->label;
+            if (label[0] == url[pos])
+            {
+                if (url.compare(pos, label.size(), label) == 0)
+                    collect(*it, url, pos + label.size(), values, result);
+                break;
+            }
+        }
+
+        if (node->param)
+        {
+            std::string::size_type end = url.find('/', pos);
+            if (end == std::string::npos)
+                end = url.size();
+
+            if (end > pos)
+            {
+                values.push_back(url.substr(pos, end - pos));
+                collect(node->param, url, end, values, result);
+                values.pop_back();
+            }
+        }
+    }
+}
+
+class Mapper::Routes
+{
+        std::vector<Entry> _entries;
+        std::vector<std::pair<const Entry*, Regex> > _patterns;
+        Node _root;
+
+    public:
+        explicit Routes(const std::vector<Route>& routes);
+
+        // lookups using the snapshot
+        volatile atomic_t readers;
+
+        // Returns the matching routes except regular expressions in the
+        // order they were added.
+        void find(const std::string& url, std::vector<Candidate>& result) const
+        {
+            std::vector<std::string> values;
+            collect(&_root, url, 0, values, result);
+            std::sort(result.begin(), result.end());
+        }
+
+        const std::vector<std::pair<const Entry*, Regex> >& patterns() const
+        { return _patterns; }
+};
+
+Mapper::Routes::Routes(const std::vector<Route>& routes)
+    : readers(0)
+{
+    _entries.resize(routes.size());
+
+    for (unsigned n = 0; n < routes.size(); ++n)
+    {
+        const Route& route = routes[n];
+        Entry& entry = _entries[n];
+        entry.index = n;
+        entry.service = route.service;
+
+        if (route.type == Route::Pattern)
+        {
+            _patterns.push_back(std::pair<const Entry*, Regex>(&entry, route.regex));
+            continue;
+        }
+
+        Node* node = &_root;
+        std::string::size_type pos = 0;
+
+        if (route.type == Route::Prefix)
+        {
+            node = node->insert(route.url);
+            node->prefixes.push_back(&entry);
+            continue;
+        }
+
+        while (true)
+        {
+            std::string::size_type b = route.url.find('{', pos);
+            std::string::size_type e = b == std::string::npos ? std::string::npos : route.url.find('}', b);
+            if (e == std::string::npos)
+            {
+                node = node->insert(route.url.substr(pos));
+                break;
+            }
+
+            node = node->insert(route.url.substr(pos, b - pos));
+            entry.names.push_back(route.url.substr(b + 1, e - b - 1));
+            if (node->param == 0)
+                node->param = new Node();
+            node = node->param;
+            pos = e + 1;
+        }
+
+        node->urls.push_back(&entry);
+    }
+}
+
+Mapper::Mapper()
+    : _routes(new Routes(_routeList)),
+      _pinning(0)
+{
+}
+
+Mapper::~Mapper()
+{
+    delete _routes;
+    for (std::vector<Routes*>::iterator it = _retired.begin(); it != _retired.end(); ++it)
+        delete *it;
+}
+
+void Mapper::publish()
+{
+    Routes* routes = new Routes(_routeList);
+    Routes* old = static_cast<Routes*>(atomicExchange(reinterpret_cast<void* volatile&>(_routes), routes));
+    _retired.push_back(old);
+    reclaim();
+}
+
+void Mapper::reclaim()
+{
+    // A lookup may have read a retired snapshot without having pinned it
+    // yet. Once no lookup is in between, the counters are reliable.
+    if (atomicGet(_pinning) > 0)
+        return;
+
+    std::vector<Routes*>::iterator out = _retired.begin();
+    for (std::vector<Routes*>::iterator it = _retired.begin(); it != _retired.end(); ++it)
+    {
+        if (atomicGet((*it)->readers) > 0)
+            *out++ = *it;
+        else
+            delete *it;
+    }
+
+    _retired.erase(out, _retired.end());
+}
+
 void Mapper::addService(const std::string& url, Service& service)
 {
     log_debug("add service for url <" << url << '>');
 
-    WriteLock serviceLock(_serviceMutex);
-    _services.push_back(ServicesType::value_type(url, &service));
+    MutexLock lock(_mutex);
+    _routeList.push_back(Route(Route::Url, url, &service));
+    publish();
+}
+
+void Mapper::addPrefixService(const std::string& prefix, Service& service)
+{
+    log_debug("add service for prefix <" << prefix << '>');
+
+    MutexLock lock(_mutex);
+    _routeList.push_back(Route(Route::Prefix, prefix, &service));
+    publish();
 }
 
 void Mapper::addService(const Regex& url, Service& service)
 {
     log_debug("add service for regex");
 
-    WriteLock serviceLock(_serviceMutex);
-    _services.push_back(ServicesType::value_type(url, &service));
+    MutexLock lock(_mutex);
+    _routeList.push_back(Route(url, &service));
+    publish();
 }
 
 void Mapper::removeService(Service& service)
 {
-    WriteLock serviceLock(_serviceMutex);
-    service.waitIdle();
+    MutexLock lock(_mutex);
 
-    ServicesType::size_type n = 0;
-    while (n < _services.size())
+    std::vector<Route>::size_type n = 0;
+    while (n < _routeList.size())
     {
-        if (_services[n].second == &service)
-        {
-            _services.erase(_services.begin() + n);
-        }
+        if (_routeList[n].service == &service)
+            _routeList.erase(_routeList.begin() + n);
         else
-        {
             ++n;
-        }
     }
+
+    publish();
+
+    // wait for lookups, which may still find the service
+    for (std::vector<Routes*>::iterator it = _retired.begin(); it != _retired.end(); ++it)
+        while (atomicGet((*it)->readers) > 0)
+            Thread::yield();
+
+    while (atomicGet(_pinning) > 0)
+        Thread::yield();
+
+    reclaim();
+
+    service.waitIdle();
 }
 
-Responder* Mapper::getResponder(const Request& request)
+Responder* Mapper::getResponder(Request& request)
 {
     log_debug("get responder for url <" << request.url() << '>');
 
-    ReadLock serviceLock(_serviceMutex);
+    // Pin the current snapshot. When it was replaced before the counter
+    // was incremented, removeService may not have seen us, so try again.
+    // While _pinning is set, the snapshot read is not freed.
+    Routes* routes;
+    atomicIncrement(_pinning);
+    while (true)
+    {
+        routes = _routes;
+        atomicIncrement(routes->readers);
+        if (routes == _routes)
+            break;
+        atomicDecrement(routes->readers);
+    }
+    atomicDecrement(_pinning);
 
-    for (ServicesType::const_iterator it = _services.begin();
-         it != _services.end(); ++it)
+    struct Unpin
     {
-        if (it->first.match(request.url()))
+        Routes* routes;
+        ~Unpin() { atomicDecrement(routes->readers); }
+    } unpin = { routes };
+
+    std::vector<Candidate> candidates;
+    routes->find(request.url(), candidates);
+
+    const std::vector<std::pair<const Entry*, Regex> >& patterns = routes->patterns();
+    std::vector<Candidate>::const_iterator c = candidates.begin();
+    std::vector<std::pair<const Entry*, Regex> >::const_iterator p = patterns.begin();
+
+    while (c != candidates.end() || p != patterns.end())
+    {
+        const Entry* entry;
+        request.clearRouteParams();
+
+        if (p == patterns.end() || (c != candidates.end() && c->entry->index < p->first->index))
         {
-            if (!it->second->checkAuth(request))
-            {
-                return _noAuthService.createResponder(request, it->second->realm(), it->second->authContent());
-            }
+            entry = c->entry;
+            for (unsigned n = 0; n < entry->names.size(); ++n)
+                request.routeParam(entry->names[n], c->values[n]);
+            ++c;
+        }
+        else
+        {
+            entry = p->first;
+            RegexSMatch m;
+            bool matched = p->second.match(request.url(), m);
+            ++p;
+            if (!matched)
+                continue;
 
-            Responder* resp = it->second->doCreateResponder(request);
-            if (resp)
-            {
-                log_debug("got responder");
-                return resp;
-            }
+            for (unsigned n = 1; n < 10 && m.has(n); ++n)
+                request.routeParam(std::string(1, static_cast<char>('0' + n)), m.get(n));
+        }
+
+        Service* service = entry->service;
+        if (!service->checkAuth(request))
+        {
+            return _noAuthService.createResponder(request, service->realm(), service->authContent());
+        }
+
+        Responder* resp = service->doCreateResponder(request);
+        if (resp)
+        {
+            log_debug("got responder");
+            return resp;
         }
     }
 
+    request.clearRouteParams();
     log_debug("use default responder");
     return _defaultService.createResponder(request);
 }
@@ -31,44 +31,80 @@
 
 #include "notfoundservice.h"
 #include "notauthenticatedservice.h"
-#include <map>
+#include <vector>
 #include <cxxtools/regex.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/atomicity.h>
+#include <cxxtools/noncopyable.h>
 
 namespace cxxtools
 {
 namespace http
 {
 
-class Mapper
+/**
+   Finds the service for a request.
+
+   Urls and prefixes are compiled into a radix trie, so that the lookup
+   does not depend on the number of services. Regular expressions are
+   tried in addition. When more services match, they are asked in the
+   order they were added until one returns a responder.
+
+   The routes are held in an immutable snapshot, which is replaced on
+   each change. Lookups do not lock; they pin the snapshot with an atomic
+   counter, so that removeService can wait until no lookup uses the
+   removed service any more. Replaced snapshots are freed on the next
+   change, once no lookup uses them.
+ */
+class Mapper : private NonCopyable
 {
     public:
+        Mapper();
+        ~Mapper();
+
         void addService(const std::string& url, Service& service);
+        void addPrefixService(const std::string& prefix, Service& service);
         void addService(const Regex& url, Service& service);
         void removeService(Service& service);
 
-        Responder* getResponder(const Request& request);
+        Responder* getResponder(Request& request);
         Responder* getDefaultResponder(const Request& request)
             { return _defaultService.createResponder(request); }
 
     private:
-        struct Key
+        struct Route
         {
-          Regex regex;
-          std::string url;
-          Key() { }
-          Key(const Regex& regex_)
-            : regex(regex_)
-          { }
-          Key(const std::string& url_)
-            : url(url_)
-          { }
-          bool match(const std::string& u) const
-          { return regex.empty() ? url == u
-                                 : regex.match(u); }
+            enum Type { Url, Prefix, Pattern };
+
+            Route(Type type_, const std::string& url_, Service* service_)
+              : type(type_),
+                url(url_),
+                service(service_)
+            { }
+
+            Route(const Regex& regex_, Service* service_)
+              : type(Pattern),
+                regex(regex_),
+                service(service_)
+            { }
+
+            Type type;
+            std::string url;
+            Regex regex;
+            Service* service;
         };
-        typedef std::vector<std::pair<Key, Service*> > ServicesType;
-        ReadWriteMutex _serviceMutex;
-        ServicesType _services;
+
+        class Routes;
+
+        void publish();
+        void reclaim();
+
+        Mutex _mutex;   // serializes changes
+        std::vector<Route> _routeList;
+        Routes* volatile _routes;
+        std::vector<Routes*> _retired;
+        volatile atomic_t _pinning;   // lookups between reading _routes and pinning it
+
         NotFoundService _defaultService;
         NotAuthenticatedService _noAuthService;
 };
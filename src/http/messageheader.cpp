@@ -68,8 +68,71 @@ int compareIgnoreCase(const char* s1, const char* s2)
                 : *it2 ? -1 : 0;
 }
 
+std::size_t maxHeaderSize = 65536;
+
 } 
 
+MessageHeader::MessageHeader(const MessageHeader& header)
+    : _rawdata(_buffer),
+      _capacity(MAXHEADERSIZE),
+      _endOffset(0),
+      _httpVersionMajor(header._httpVersionMajor),
+      _httpVersionMinor(header._httpVersionMinor)
+{
+    reserve(header._endOffset + 1);
+    std::memcpy(_rawdata, header._rawdata, header._endOffset + 1);
+    _endOffset = header._endOffset;
+}
+
+MessageHeader& MessageHeader::operator= (const MessageHeader& header)
+{
+    if (this != &header)
+    {
+        reserve(header._endOffset + 1);
+        std::memcpy(_rawdata, header._rawdata, header._endOffset + 1);
+        _endOffset = header._endOffset;
+        _httpVersionMajor = header._httpVersionMajor;
+        _httpVersionMinor = header._httpVersionMinor;
+    }
+
+    return *this;
+}
+
+void MessageHeader::reserve(std::size_t size)
+{
+    if (size <= _capacity)
+        return;
+
+    if (size > maxHeaderSize)
+        throw std::runtime_error("message header too big");
+
+    std::size_t capacity = _capacity;
+    while (capacity < size)
+        capacity *= 2;
+    if (capacity > maxHeaderSize)
+        capacity = maxHeaderSize;
+
+    log_debug("grow header storage from " << _capacity << " to " << capacity << " bytes");
+
+    char* rawdata = new char[capacity];
+    std::memcpy(rawdata, _rawdata, _endOffset + 1);
+    if (_rawdata != _buffer)
+        delete[] _rawdata;
+
+    _rawdata = rawdata;
+    _capacity = capacity;
+}
+
+std::size_t MessageHeader::maxSize()
+{
+    return maxHeaderSize;
+}
+
+void MessageHeader::maxSize(std::size_t size)
+{
+    maxHeaderSize = size < MAXHEADERSIZE ? MAXHEADERSIZE : size;
+}
+
 
 const char* MessageHeader::getHeader(const char* key) const
 {
@@ -108,13 +171,13 @@ void MessageHeader::setHeader(const char* key, const char* value, bool replace)
     if (replace)
         removeHeader(key);
 
-    char* p = eptr();
-
     size_t lk = strlen(key);     // length of key
     size_t lv = strlen(value);   // length of value
 
-    if (p - _rawdata + lk + lv + 2 > MAXHEADERSIZE)
-        throw std::runtime_error("message header too big");
+    // key, value and the new end marker
+    reserve(_endOffset + lk + lv + 3);
+
+    char* p = eptr();
 
     std::strcpy(p, key);   // copy key
     p += lk + 1;
@@ -138,10 +201,10 @@ void MessageHeader::removeHeader(const char* key)
         {
             unsigned slen = it->second - it->first + std::strlen(it->second) + 1;
 
-            std::memcpy(
+            std::memmove(
                 const_cast<char*>(it->first),
                 it->first + slen,
-                p - it->first + slen);
+                p - (it->first + slen) + 1);
 
             p -= slen;
 
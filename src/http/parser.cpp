@@ -31,7 +31,13 @@
 #include <cxxtools/log.h>
 #include <cctype>
 #include <algorithm>
-#include <string.h>
+#include <cstring>
+#include <streambuf>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define CXXTOOLS_HTTP_SSE2
+#endif
 
 log_define("cxxtools.http.parser")
 
@@ -70,6 +76,94 @@ namespace http {
                  : ch >= 'A' && ch <= 'Z' ? ch - 'A' + 10
                  : 0;
         }
+
+        // Returns the first '\r' or '\n' in [p, e) or e. Compares 16 bytes
+        // or a machine word at a time, which makes long values like cookies
+        // cheap to skip.
+        const char* findLineEnd(const char* p, const char* e)
+        {
+#ifdef CXXTOOLS_HTTP_SSE2
+            const __m128i cr = _mm_set1_epi8('\r');
+            const __m128i lf = _mm_set1_epi8('\n');
+            while (e - p >= 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned m = static_cast<unsigned>(_mm_movemask_epi8(
+                                _mm_or_si128(_mm_cmpeq_epi8(v, cr),
+                                             _mm_cmpeq_epi8(v, lf))));
+                if (m)
+                    return p + __builtin_ctz(m);
+                p += 16;
+            }
+#else
+            typedef unsigned long Word;
+            static const Word ones = ~Word(0) / 255;
+            static const Word highs = ones * 0x80;
+            static const Word crs = ones * '\r';
+            static const Word lfs = ones * '\n';
+
+            while (e - p >= static_cast<std::ptrdiff_t>(sizeof(Word)))
+            {
+                Word w;
+                std::memcpy(&w, p, sizeof(Word));
+
+                Word cr = w ^ crs;
+                Word lf = w ^ lfs;
+                if (((cr - ones) & ~cr & highs) | ((lf - ones) & ~lf & highs))
+                    break;
+
+                p += sizeof(Word);
+            }
+#endif
+
+            while (p < e && *p != '\r' && *p != '\n')
+                ++p;
+
+            return p;
+        }
+
+        // Returns the first character in [p, e), which does not belong to a
+        // header field name or e.
+        inline const char* findFieldNameEnd(const char* p, const char* e)
+        {
+#ifdef CXXTOOLS_HTTP_SSE2
+            // printable characters except ':'; bytes with the high bit set
+            // are negative and fail the lower bound
+            const __m128i lo = _mm_set1_epi8(32);
+            const __m128i hi = _mm_set1_epi8(127);
+            const __m128i colon = _mm_set1_epi8(':');
+            while (e - p >= 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi8(v, colon),
+                                _mm_and_si128(_mm_cmpgt_epi8(v, lo),
+                                              _mm_cmpgt_epi8(hi, v)));
+                unsigned m = ~static_cast<unsigned>(_mm_movemask_epi8(ok)) & 0xffff;
+                if (m)
+                    return p + __builtin_ctz(m);
+                p += 16;
+            }
+#endif
+
+            while (p < e && *p > 32 && *p < 127 && *p != ':')
+                ++p;
+            return p;
+        }
+
+        // Gives access to the get area of a streambuf, so that the parser
+        // can consume buffered data without extracting it character by
+        // character.
+        struct GetArea : public std::streambuf
+        {
+            static const char* begin(std::streambuf& sb)
+            { return (sb.*&GetArea::gptr)(); }
+
+            static const char* end(std::streambuf& sb)
+            { return (sb.*&GetArea::egptr)(); }
+
+            static void consume(std::streambuf& sb, int n)
+            { (sb.*&GetArea::gbump)(n); }
+        };
     }
 
     void HeaderParser::Event::onMethod(const std::string& method)
@@ -111,12 +205,12 @@ namespace http {
 
     void HeaderParser::MessageHeaderEvent::onKey(const std::string& key)
     {
-        strncpy(_key, key.c_str(), MessageHeader::MAXHEADERSIZE);
+        _key = key;
     }
 
     void HeaderParser::MessageHeaderEvent::onValue(const std::string& value)
     {
-        _header.addHeader(_key, value.c_str());
+        _header.addHeader(_key.c_str(), value.c_str());
     }
 
     std::size_t HeaderParser::advance(std::streambuf& sb)
@@ -125,14 +219,58 @@ namespace http {
 
         while (sb.in_avail() > 0)
         {
-            ++ret;
-            if (parse(sb.sbumpc()))
+            const char* b = GetArea::begin(sb);
+            const char* e = GetArea::end(sb);
+
+            if (b == e)
+            {
+                // data is available but not yet in the get area
+                ++ret;
+                if (parse(static_cast<char>(sb.sbumpc())))
+                    return ret;
+                continue;
+            }
+
+            std::size_t n = parse(b, e);
+            GetArea::consume(sb, static_cast<int>(n));
+            ret += n;
+
+            if (end())
                 return ret;
         }
 
         return ret;
     }
 
+    std::size_t HeaderParser::parse(const char* begin, const char* end)
+    {
+        const char* p = begin;
+
+        while (p < end)
+        {
+            // header names and values make up most of a message; copy
+            // them in runs and leave the delimiters to the state machine
+            const char* e = p;
+            if (state == &HeaderParser::state_hfieldbody)
+                e = findLineEnd(p, end);
+            else if (state == &HeaderParser::state_hfieldname)
+                e = findFieldNameEnd(p, end);
+
+            if (e != p)
+            {
+                token.append(p, e);
+                p = e;
+                if (p == end)
+                    break;
+            }
+
+            if (parse(*p++))
+                break;
+        }
+
+        return p - begin;
+    }
+
     void HeaderParser::state_cmd0(char ch)
     {
         if (istokenchar(ch))
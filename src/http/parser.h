@@ -60,7 +60,7 @@ class CXXTOOLS_HTTP_API HeaderParser
         class CXXTOOLS_HTTP_API MessageHeaderEvent : public Event
         {
                 MessageHeader& _header;
-                char _key[MessageHeader::MAXHEADERSIZE];
+                std::string _key;
 
             public:
                 explicit MessageHeaderEvent(MessageHeader& header)
@@ -133,6 +133,10 @@ class CXXTOOLS_HTTP_API HeaderParser
         std::size_t advance(std::istream& is)
         { return advance(*is.rdbuf()); }
 
+        /// parses the characters in the range [begin, end) and returns the
+        /// number of characters consumed. Stops after the end of the message.
+        std::size_t parse(const char* begin, const char* end);
+
         /// parses a single character and returns true, if message is finished
         bool parse(char ch)
         {
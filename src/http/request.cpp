@@ -58,6 +58,17 @@ Request::Auth Request::auth() const
     return ret;
 }
 
+const std::string& Request::routeParam(const std::string& name) const
+{
+    static const std::string empty;
+
+    for (RouteParams::const_iterator it = _routeParams.begin(); it != _routeParams.end(); ++it)
+        if (it->first == name)
+            return it->second;
+
+    return empty;
+}
+
 }
 
 }
@@ -82,6 +82,11 @@ void Server::addService(const std::string& url, Service& service)
     _impl->addService(url, service);
 }
 
+void Server::addPrefixService(const std::string& prefix, Service& service)
+{
+    _impl->addPrefixService(prefix, service);
+}
+
 void Server::addService(const Regex& url, Service& service)
 {
     _impl->addService(url, service);
@@ -142,6 +147,16 @@ void Server::maxThreads(unsigned m)
     _impl->maxThreads(m);
 }
 
+unsigned Server::ioThreads() const
+{
+    return _impl->ioThreads();
+}
+
+void Server::ioThreads(unsigned n)
+{
+    _impl->ioThreads(n);
+}
+
 } // namespace http
 
 } // namespace cxxtools
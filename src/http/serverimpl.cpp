@@ -28,9 +28,11 @@
 
 #include "serverimpl.h"
 #include "worker.h"
+#include "iothread.h"
 #include "socket.h"
 
 #include <cxxtools/eventloop.h>
+#include <cxxtools/threadpool.h>
 #include <cxxtools/log.h>
 #include <cxxtools/net/tcpserver.h>
 
@@ -115,7 +117,9 @@ class ActiveSocketEvent : public BasicEvent<ActiveSocketEvent>
 ServerImpl::ServerImpl(EventLoopBase& eventLoop, Signal<Server::Runmode>& runmodeChanged)
     : ServerImplBase(eventLoop, runmodeChanged),
       inputSlot(slot(*this, &ServerImpl::onInput)),
-      timeoutSlot(slot(*this, &ServerImpl::onTimeout))
+      timeoutSlot(slot(*this, &ServerImpl::onTimeout)),
+      _nextIOThread(0),
+      _replyPool(0)
 {
     _eventLoop.event.subscribe(slot(*this, &ServerImpl::onIdleSocket));
     _eventLoop.event.subscribe(slot(*this, &ServerImpl::onActiveSocket));
@@ -151,22 +155,81 @@ void ServerImpl::listen(const std::string& ip, unsigned short int port, int back
     try
     {
         _listener.push_back(listener);
-        _queue.put(new Socket(*this, *listener));
     }
     catch (...)
     {
         delete listener;
         throw;
     }
+
+    if (runmode() == Server::Running)
+        startListener(listener);
+}
+
+void ServerImpl::startListener(net::TcpServer* listener)
+{
+    if (ioThreads() > 0)
+    {
+        // accept connections in the event loop and pass them to the io threads
+        connect(listener->connectionPending, *this, &ServerImpl::onConnectionPending);
+        _eventLoop.add(*listener);
+    }
+    else
+    {
+        _queue.put(new Socket(*this, *listener));
+    }
+}
+
+void ServerImpl::onConnectionPending(net::TcpServer& listener)
+{
+    Socket* socket = new Socket(*this, listener);
+    try
+    {
+        socket->accept();
+        log_debug("connection accepted from " << socket->getPeerAddr());
+    }
+    catch (const std::exception& e)
+    {
+        log_warn("failed to accept connection: " << e.what());
+        delete socket;
+        return;
+    }
+
+    IOThread* ioThread = _ioThreads[_nextIOThread];
+    _nextIOThread = (_nextIOThread + 1) % _ioThreads.size();
+    ioThread->addSocket(socket);
 }
 
 void ServerImpl::start()
 {
     log_trace("start server");
+
+    if (runmode() == Server::Running)
+    {
+        // a start event of a previous server object at the same address
+        log_debug("server already running");
+        return;
+    }
+
     runmode(Server::Starting);
 
+    if (ioThreads() > 0)
+    {
+        log_debug("start " << ioThreads() << " io threads");
+        _replyPool = new ThreadPool(minThreads() > 0 ? minThreads() : 1);
+        while (_ioThreads.size() < ioThreads())
+        {
+            IOThread* ioThread = new IOThread(*this);
+            _ioThreads.push_back(ioThread);
+            ioThread->start();
+        }
+    }
+
+    for (ListenerType::iterator it = _listener.begin(); it != _listener.end(); ++it)
+        startListener(*it);
+
     MutexLock lock(_threadMutex);
-    while (_threads.size() < minThreads())
+    while (ioThreads() == 0 && _threads.size() < minThreads())
     {
         Worker* worker = new Worker(*this);
         _threads.insert(worker);
@@ -211,6 +274,23 @@ void ServerImpl::terminate()
             _terminatedThreads.clear();
         }
 
+        if (_replyPool)
+        {
+            log_debug("stop reply thread pool");
+            _replyPool->stop();
+        }
+
+        log_debug("terminate " << _ioThreads.size() << " io threads");
+        for (IOThreads::iterator it = _ioThreads.begin(); it != _ioThreads.end(); ++it)
+        {
+            (*it)->terminate();
+            delete *it;
+        }
+        _ioThreads.clear();
+
+        delete _replyPool;
+        _replyPool = 0;
+
         log_debug("delete " << _listener.size() << " listeners");
         for (ServerImpl::ListenerType::iterator it = _listener.begin(); it != _listener.end(); ++it)
             delete *it;
@@ -40,6 +40,7 @@ namespace cxxtools
 {
 
 class EventLoopBase;
+class ThreadPool;
 
 namespace net
 {
@@ -50,6 +51,7 @@ namespace http
 {
 
 class Worker;
+class IOThread;
 class ServerImpl;
 class Socket;
 class IdleSocketEvent;
@@ -88,7 +90,11 @@ class ServerImpl : public ServerImplBase, public Connectable
         void onServerStart(const ServerStartEvent& event);
         void start();
 
+        void startListener(net::TcpServer* listener);
+        void onConnectionPending(net::TcpServer& listener);
+
         friend class Worker;
+        friend class IOThread;
 
         ////////////////////////////////////////////////////
 
@@ -109,6 +115,13 @@ class ServerImpl : public ServerImplBase, public Connectable
         Mutex _threadMutex;
         Condition _threadTerminated;
         void threadTerminated(Worker* worker);
+
+        ////////////////////////////////////////////////////
+        // event driven mode (ioThreads() > 0)
+        typedef std::vector<IOThread*> IOThreads;
+        IOThreads _ioThreads;
+        IOThreads::size_type _nextIOThread;
+        ThreadPool* _replyPool;
 };
 
 }
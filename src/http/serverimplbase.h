@@ -51,6 +51,7 @@ class ServerImplBase : private NonCopyable
               _keepAliveTimeout(30000),
               _minThreads(5),
               _maxThreads(200),
+              _ioThreads(0),
               _runmodeChanged(runmodeChanged),
               _runmode(Server::Stopped)
         { }
@@ -61,12 +62,14 @@ class ServerImplBase : private NonCopyable
 
         void addService(const std::string& url, Service& service)
         { _mapper.addService(url, service); }
+        void addPrefixService(const std::string& prefix, Service& service)
+        { _mapper.addPrefixService(prefix, service); }
         void addService(const Regex& url, Service& service)
         { _mapper.addService(url, service); }
         void removeService(Service& service)
         { _mapper.removeService(service); }
 
-        Responder* getResponder(const Request& request)
+        Responder* getResponder(Request& request)
             { return _mapper.getResponder(request); }
         Responder* getDefaultResponder(const Request& request)
             { return _mapper.getDefaultResponder(request); }
@@ -85,6 +88,9 @@ class ServerImplBase : private NonCopyable
         unsigned maxThreads() const           { return _maxThreads; }
         void maxThreads(unsigned m)           { _maxThreads = m; }
 
+        unsigned ioThreads() const            { return _ioThreads; }
+        void ioThreads(unsigned n)            { _ioThreads = n; }
+
         virtual void terminate()              { }
         Server::Runmode runmode() const
         { return _runmode; }
@@ -105,6 +111,7 @@ class ServerImplBase : private NonCopyable
 
         unsigned _minThreads;
         unsigned _maxThreads;
+        unsigned _ioThreads;
 
         Signal<Server::Runmode>& _runmodeChanged;
         Server::Runmode _runmode;
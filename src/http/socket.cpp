@@ -28,10 +28,24 @@
 
 #include "socket.h"
 #include "serverimpl.h"
+#include "iothread.h"
 #include <cxxtools/log.h>
+#include <cxxtools/ioerror.h>
+#include <cxxtools/systemerror.h>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <errno.h>
+#include <limits.h>
+#include <sys/socket.h>
 #include "config.h"
 
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+#include <sys/sendfile.h>
+#endif
+
 log_define("cxxtools.http.socket")
 
 namespace cxxtools
@@ -62,7 +76,15 @@ Socket::Socket(ServerImpl& server, net::TcpServer& tcpServer)
       _parseEvent(_request),
       _parser(_parseEvent, false),
       _responder(0),
-      _accepted(false)
+      _accepted(false),
+      _ioThread(0),
+      _iovPos(0),
+      _filePos(0),
+      _producer(0),
+      _chunked(false),
+      _moreChunks(false),
+      _sending(false),
+      _writePending(false)
 {
     _stream.attachDevice(*this);
     cxxtools::connect(IODevice::inputReady, *this, &Socket::onIODeviceInput);
@@ -77,7 +99,15 @@ Socket::Socket(Socket& socket)
       _parseEvent(_request),
       _parser(_parseEvent, false),
       _responder(0),
-      _accepted(false)
+      _accepted(false),
+      _ioThread(0),
+      _iovPos(0),
+      _filePos(0),
+      _producer(0),
+      _chunked(false),
+      _moreChunks(false),
+      _sending(false),
+      _writePending(false)
 {
     _stream.attachDevice(*this);
     cxxtools::connect(IODevice::inputReady, *this, &Socket::onIODeviceInput);
@@ -177,7 +207,7 @@ void Socket::onInput(StreamBuffer& sb)
             if (_contentLength == 0)
             {
                 _timer.stop();
-                doReply();
+                processReply();
                 return;
             }
 
@@ -214,7 +244,7 @@ void Socket::onInput(StreamBuffer& sb)
         if (_contentLength <= 0)
         {
             _timer.stop();
-            doReply();
+            processReply();
         }
         else
         {
@@ -223,9 +253,27 @@ void Socket::onInput(StreamBuffer& sb)
     }
 }
 
+void Socket::processReply()
+{
+    if (_ioThread)
+        _ioThread->scheduleReply(*this);
+    else
+        doReply();
+}
+
 bool Socket::doReply()
 {
     log_trace("http::Socket::doReply");
+
+    executeReply();
+
+    sendReply();
+
+    return onOutput(_stream.buffer());
+}
+
+void Socket::executeReply()
+{
     try
     {
         _responder->reply(_reply.body(), _request, _reply);
@@ -239,10 +287,13 @@ bool Socket::doReply()
 
     _responder->release();
     _responder = 0;
+}
 
-    sendReply();
-
-    return onOutput(_stream.buffer());
+void Socket::onReplyJob()
+{
+    log_trace("http::Socket::onReplyJob");
+    executeReply();
+    _ioThread->replyReady(*this);
 }
 
 bool Socket::onOutput(StreamBuffer& sb)
@@ -253,13 +304,26 @@ bool Socket::onOutput(StreamBuffer& sb)
 
     try
     {
-        sb.endWrite();
+        if (_writePending)
+        {
+            // the write was started by the socket itself and not by the stream buffer
+            _writePending = false;
+            advanceSend(IODevice::endWrite());
+        }
+        else
+        {
+            sb.endWrite();
+        }
 
         if ( sb.out_avail() )
         {
             sb.beginWrite();
             _timer.start(_server.writeTimeout());
         }
+        else if (_sending && !continueSend())
+        {
+            _timer.start(_server.writeTimeout());
+        }
         else
         {
             bool keepAlive = _request.header().keepAlive()
@@ -313,7 +377,23 @@ void Socket::sendReply()
         << " ready, returncode " << _reply.httpReturnCode() << ' '
         << _reply.httpReturnText());
 
-    _stream << "HTTP/"
+    const Body& body = _reply.bodyContent();
+
+    // a produced body is sent chunked; http 1.0 clients get it until the
+    // connection is closed
+    bool chunked = false;
+    if (body.producer())
+    {
+        if (_request.header().httpVersionMajor() > 1
+          || (_request.header().httpVersionMajor() == 1 && _request.header().httpVersionMinor() >= 1))
+            chunked = true;
+        else
+            _reply.setHeader(connection, "close");
+    }
+
+    std::ostringstream header;
+
+    header << "HTTP/"
         << _reply.header().httpVersionMajor() << '.'
         << _reply.header().httpVersionMinor() << ' '
         << _reply.header().httpReturnCode() << ' '
@@ -322,36 +402,344 @@ void Socket::sendReply()
     for (ReplyHeader::const_iterator it = _reply.header().begin();
         it != _reply.header().end(); ++it)
     {
-        _stream << it->first << ": " << it->second << "\r\n";
+        header << it->first << ": " << it->second << "\r\n";
     }
 
-    if (!_reply.header().hasHeader(contentLength))
+    if (chunked)
     {
-        _stream << "Content-Length: " << _reply.bodySize() << "\r\n";
+        header << "Transfer-Encoding: chunked\r\n";
+    }
+    else if (!body.producer() && !_reply.header().hasHeader(contentLength))
+    {
+        header << "Content-Length: " << _reply.bodySize() << "\r\n";
     }
 
     if (!_reply.header().hasHeader(server))
     {
-        _stream << "Server: cxxtools-Http-Server " PACKAGE_VERSION "\r\n";
+        header << "Server: cxxtools-Http-Server " PACKAGE_VERSION "\r\n";
     }
 
     if (!_reply.header().hasHeader(connection))
     {
-        _stream << "Connection: "
-                << (_request.header().keepAlive() ? "keep-alive" : "close")
-                << "\r\n";
+        header << "Connection: "
+               << (_request.header().keepAlive() ? "keep-alive" : "close")
+               << "\r\n";
     }
 
     if (!_reply.header().hasHeader(date))
     {
         char buffer[50];
-        _stream << "Date: " << MessageHeader::htdateCurrent(buffer) << "\r\n";
+        header << "Date: " << MessageHeader::htdateCurrent(buffer) << "\r\n";
     }
 
-    _stream << "\r\n";
+    header << "\r\n";
+
+    _sendHeader = header.str();
+
+    prepareBody(chunked);
+}
+
+void Socket::prepareBody(bool chunked)
+{
+    // Header and body are passed to the kernel in as few system calls as
+    // possible: memory is gathered with sendmsg and files are sent with
+    // sendfile. Nothing is sent here; onOutput sends the reply without
+    // blocking.
+
+    const Body& body = _reply.bodyContent();
+    const Body::Segments& segments = body.segments();
+
+    _iov.clear();
+    _iov.reserve(segments.size() * 2 + 4);
+    _iovPos = 0;
+    _files.clear();
+    _filePos = 0;
+
+    _chunked = chunked;
+    _producer = body.producer();
+    _moreChunks = _producer != 0;
 
-    _reply.sendBody(_stream);
+    addIovec(_iov, _sendHeader.data(), _sendHeader.size());
+
+    // with chunked encoding the body before the produced data is the first chunk
+    if (chunked && body.size() > 0)
+    {
+        int n = ::snprintf(_chunkPrefix, sizeof(_chunkPrefix), "%lx\r\n", static_cast<unsigned long>(body.size()));
+        addIovec(_iov, _chunkPrefix, n);
+    }
+
+    std::size_t pos = 0;
+    for (Body::Segments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        addIovec(_iov, body.data() + pos, it->pos - pos);
+        pos = it->pos;
+
+        if (it->type == Body::Segment::Memory)
+            addIovec(_iov, it->data, it->size);
+        else
+            addFile(it->fd, it->offset, it->size);
+    }
+
+    addIovec(_iov, body.data() + pos, body.dataSize() - pos);
+
+    if (chunked && body.size() > 0)
+        addIovec(_iov, "\r\n", 2);
+
+    _sending = true;
+}
+
+void Socket::produceChunk()
+{
+    _chunk.clear();
+    _moreChunks = (*_producer)(_chunk.stream());
+
+    _iov.clear();
+    _iovPos = 0;
+    _files.clear();
+    _filePos = 0;
+
+    if (_chunked && _chunk.dataSize() > 0)
+    {
+        int n = ::snprintf(_chunkPrefix, sizeof(_chunkPrefix), "%lx\r\n", static_cast<unsigned long>(_chunk.dataSize()));
+        addIovec(_iov, _chunkPrefix, n);
+    }
+
+    addIovec(_iov, _chunk.data(), _chunk.dataSize());
+
+    if (_chunked && _chunk.dataSize() > 0)
+        addIovec(_iov, "\r\n", 2);
+
+    if (_chunked && !_moreChunks)
+        addIovec(_iov, "0\r\n\r\n", 5);
+}
+
+bool Socket::continueSend()
+{
+    // Sends as much of the reply as the socket accepts. Returns true, when
+    // the reply is complete. Otherwise a write is started, which signals
+    // outputReady, when the socket is writable again.
+
+    while (true)
+    {
+        while (_iovPos < _iov.size())
+        {
+            bool done = _iov[_iovPos].iov_len > 0 ? writeIovec() : sendFile();
+            if (!done)
+            {
+                beginPendingWrite();
+                return false;
+            }
+        }
+
+        if (!_moreChunks)
+            break;
+
+        produceChunk();
+    }
+
+    _sending = false;
+    _iov.clear();
+    _files.clear();
+    _chunk.clear();
+
+    return true;
+}
+
+void Socket::beginPendingWrite()
+{
+    // The socket buffer is full; the next piece is passed to the io device,
+    // so that the selector waits until the socket is writable. Only a small
+    // part of a file is copied here.
 
+    const iovec& v = _iov[_iovPos];
+    if (v.iov_len > 0)
+    {
+        beginWrite(static_cast<const char*>(v.iov_base), v.iov_len);
+    }
+    else
+    {
+        const FileRange& f = _files[_filePos];
+        _fileBuffer.resize(std::min(f.count, static_cast<std::size_t>(8192)));
+
+        ssize_t n;
+        do
+        {
+            n = ::pread(f.fd, &_fileBuffer[0], _fileBuffer.size(), f.offset);
+        } while (n < 0 && errno == EINTR);
+
+        if (n <= 0)
+            throw IOError("unexpected end of file in http body");
+
+        beginWrite(&_fileBuffer[0], n);
+    }
+
+    _writePending = true;
+}
+
+void Socket::advanceSend(std::size_t n)
+{
+    while (n > 0)
+    {
+        iovec& v = _iov[_iovPos];
+        if (v.iov_len == 0)
+        {
+            // a file is never sent together with other parts
+            FileRange& f = _files[_filePos];
+            f.offset += n;
+            f.count -= n;
+            if (f.count == 0)
+            {
+                ++_filePos;
+                ++_iovPos;
+            }
+
+            return;
+        }
+
+        if (n < v.iov_len)
+        {
+            v.iov_base = static_cast<char*>(v.iov_base) + n;
+            v.iov_len -= n;
+            return;
+        }
+
+        n -= v.iov_len;
+        ++_iovPos;
+    }
+}
+
+void Socket::addFile(int fd, off_t offset, std::size_t count)
+{
+    if (count == 0)
+        return;
+
+    FileRange f;
+    f.fd = fd;
+    f.offset = offset;
+    f.count = count;
+    _files.push_back(f);
+
+    // an empty entry marks the position of the file in the reply
+    iovec v;
+    v.iov_base = 0;
+    v.iov_len = 0;
+    _iov.push_back(v);
+}
+
+void Socket::addIovec(std::vector<iovec>& iov, const char* data, std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    iovec v;
+    v.iov_base = const_cast<char*>(data);
+    v.iov_len = size;
+    iov.push_back(v);
+}
+
+bool Socket::writeIovec()
+{
+    // sends the memory parts up to the next file; returns false, when the
+    // socket is not writable
+
+    std::vector<iovec>::size_type end = _iovPos;
+    while (end < _iov.size() && _iov[end].iov_len > 0)
+        ++end;
+
+    int flags = MSG_NOSIGNAL;
+    if (end < _iov.size() || _moreChunks)
+        flags |= MSG_MORE;
+
+    while (_iovPos < end)
+    {
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &_iov[_iovPos];
+        msg.msg_iovlen = std::min(end - _iovPos, static_cast<std::vector<iovec>::size_type>(IOV_MAX));
+
+        ssize_t ret = ::sendmsg(getFd(), &msg, flags);
+        log_debug("sendmsg with " << msg.msg_iovlen << " buffers returned " << ret);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return false;
+
+            if (errno == ECONNRESET || errno == EPIPE)
+                throw IOError("lost connection to peer");
+
+            throwSystemError("sendmsg");
+        }
+
+        advanceSend(static_cast<std::size_t>(ret));
+    }
+
+    return true;
+}
+
+bool Socket::sendFile()
+{
+    // sends the current file range; returns false, when the socket is not
+    // writable
+
+    const FileRange& f = _files[_filePos];
+
+    log_debug("send " << f.count << " bytes from fd " << f.fd << " offset " << f.offset);
+
+    while (f.count > 0)
+    {
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+        off_t offset = f.offset;
+        ssize_t ret = ::sendfile(getFd(), f.fd, &offset, f.count);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return false;
+
+            if (errno == ECONNRESET || errno == EPIPE)
+                throw IOError("lost connection to peer");
+
+            throwSystemError("sendfile");
+        }
+
+        if (ret == 0)
+            throw IOError("unexpected end of file in http body");
+#else
+        char buffer[8192];
+        ssize_t n = ::pread(f.fd, buffer, std::min(f.count, sizeof(buffer)), f.offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n <= 0)
+            throw IOError("unexpected end of file in http body");
+
+        // a partial send is read again from the file next time
+        ssize_t ret = ::send(getFd(), buffer, n, MSG_NOSIGNAL | MSG_MORE);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return false;
+
+            if (errno == ECONNRESET || errno == EPIPE)
+                throw IOError("lost connection to peer");
+
+            throwSystemError("send");
+        }
+#endif
+
+        advanceSend(static_cast<std::size_t>(ret));
+    }
+
+    return true;
 }
 
 } // namespace http
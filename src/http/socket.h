@@ -38,6 +38,9 @@
 #include <cxxtools/signal.h>
 #include <cxxtools/method.h>
 #include "parser.h"
+#include <string>
+#include <vector>
+#include <sys/uio.h>
 
 namespace cxxtools {
 
@@ -45,6 +48,7 @@ namespace http {
 
 class ServerImpl;
 class Responder;
+class IOThread;
 
 class Socket : public net::TcpSocket, public Connectable
 {
@@ -80,6 +84,8 @@ class Socket : public net::TcpSocket, public Connectable
         void onTimeout();
 
         bool doReply();
+        void executeReply();
+        void onReplyJob();
         void sendReply();
         bool isReady() const
         { return _parser.end() && _contentLength == 0; }
@@ -92,12 +98,34 @@ class Socket : public net::TcpSocket, public Connectable
 
         StreamBuffer& buffer()         { return _stream.buffer(); }
 
+        void ioThread(IOThread* t)     { _ioThread = t; }
+
         MethodSlot<void, Socket, StreamBuffer&> inputSlot;
 
         Connection inputConnection;
         Connection timeoutConnection;
 
     private:
+        // a range of a file in the reply body
+        struct FileRange
+        {
+            int fd;
+            off_t offset;
+            std::size_t count;
+        };
+
+        void processReply();
+
+        void prepareBody(bool chunked);
+        void produceChunk();
+        bool continueSend();
+        bool writeIovec();
+        bool sendFile();
+        void beginPendingWrite();
+        void advanceSend(std::size_t n);
+        void addFile(int fd, off_t offset, std::size_t count);
+        static void addIovec(std::vector<iovec>& iov, const char* data, std::size_t size);
+
         net::TcpServer& _tcpServer;
         ServerImpl& _server;
 
@@ -112,6 +140,26 @@ class Socket : public net::TcpSocket, public Connectable
         IOStream _stream;
 
         bool _accepted;
+        IOThread* _ioThread;
+
+        // State of the reply, which is written directly to the socket.
+        // Memory parts are collected in _iov; an empty entry stands for
+        // the next entry of _files. When the socket is not writable, the
+        // next bytes are passed to beginWrite and the reply is continued
+        // in onOutput.
+        std::string _sendHeader;
+        char _chunkPrefix[20];
+        std::vector<iovec> _iov;
+        std::vector<iovec>::size_type _iovPos;
+        std::vector<FileRange> _files;
+        std::vector<FileRange>::size_type _filePos;
+        std::vector<char> _fileBuffer;
+        Body _chunk;
+        Body::Producer* _producer;
+        bool _chunked;
+        bool _moreChunks;
+        bool _sending;
+        bool _writePending;
 };
 
 } // namespace http
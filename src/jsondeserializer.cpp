@@ -27,17 +27,20 @@
  */
 
 #include <cxxtools/jsondeserializer.h>
+#include <cxxtools/jsonutf8parser.h>
 
 namespace cxxtools
 {
     JsonDeserializer::JsonDeserializer(std::istream& in, TextCodec<Char, char>* codec)
         : _ts(new TextIStream(in, codec)),
-          _in(*_ts)
+          _in(*_ts),
+          _inUtf8(dynamic_cast<Utf8Codec*>(codec) ? &in : 0)
     { }
 
     JsonDeserializer::JsonDeserializer(std::basic_istream<Char>& in)
         : _ts(0),
-          _in(in)
+          _in(in),
+          _inUtf8(0)
     { }
 
     JsonDeserializer::~JsonDeserializer()
@@ -47,6 +50,12 @@ namespace cxxtools
 
     void JsonDeserializer::doDeserialize()
     {
+        if (_inUtf8)
+        {
+            doDeserializeUtf8();
+            return;
+        }
+
         JsonParser parser;
         parser.begin(*this);
         Char ch;
@@ -65,4 +74,49 @@ namespace cxxtools
 
         parser.finish();
     }
+
+    void JsonDeserializer::doDeserializeUtf8()
+    {
+        // The utf-8 input is passed in chunks to the parser without decoding
+        // it to unicode first. Bytes after the end of the value are put back
+        // into the stream buffer.
+        std::streambuf* sb = _inUtf8->rdbuf();
+
+        JsonUtf8Parser parser;
+        parser.begin(*this);
+
+        char buffer[8192];
+
+        while (true)
+        {
+            std::streamsize n = sb->in_avail();
+            if (n <= 0)
+            {
+                if (sb->sgetc() == std::streambuf::traits_type::eof())
+                    break;
+
+                n = sb->in_avail();
+                if (n <= 0)
+                    n = 1;
+            }
+
+            if (n > static_cast<std::streamsize>(sizeof(buffer)))
+                n = sizeof(buffer);
+
+            n = sb->sgetn(buffer, n);
+            if (n <= 0)
+                break;
+
+            std::size_t count = parser.advance(buffer, n);
+            if (parser.done())
+            {
+                while (static_cast<std::size_t>(n) > count)
+                    sb->sputbackc(buffer[--n]);
+                return;
+            }
+        }
+
+        _inUtf8->setstate(std::ios::eofbit);
+        parser.finish();
+    }
 }
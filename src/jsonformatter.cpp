@@ -31,6 +31,7 @@
 #include <cxxtools/convert.h>
 #include <cxxtools/log.h>
 #include <limits>
+#include <cstring>
 
 log_define("cxxtools.jsonformatter")
 
@@ -40,18 +41,44 @@ namespace cxxtools
 namespace
 {
 
-    void checkTs(std::basic_ostream<Char>* _ts)
+    void checkTs(std::basic_ostream<Char>* _ts, std::ostream* _out)
     {
-        if (_ts == 0)
+        if (_ts == 0 && _out == 0)
             throw std::logic_error("textstream is not set in JsonFormatter");
 
     }
 
+    inline bool needsEscape(uint32_t ch)
+    {
+        return ch < 0x20 || ch >= 0x80 || ch == '"' || ch == '\\';
+    }
+
+    char* putHex4(char* p, uint32_t v)
+    {
+        static const char hex[] = "0123456789abcdef";
+        *p++ = hex[(v >> 12) & 0xf];
+        *p++ = hex[(v >> 8) & 0xf];
+        *p++ = hex[(v >> 4) & 0xf];
+        *p++ = hex[v & 0xf];
+        return p;
+    }
+
 }
 
 void JsonFormatter::begin(std::basic_ostream<Char>& ts)
 {
     _ts = &ts;
+    _out = 0;
+    _count = 0;
+    _level = 0;
+    _lastLevel = std::numeric_limits<unsigned>::max();
+}
+
+void JsonFormatter::begin(std::ostream& out)
+{
+    _ts = 0;
+    _out = &out;
+    _count = 0;
     _level = 0;
     _lastLevel = std::numeric_limits<unsigned>::max();
 }
@@ -60,7 +87,8 @@ void JsonFormatter::finish()
 {
     log_trace("finish");
     if (_beautify)
-        *_ts << L'\n';
+        put('\n');
+    flushBuffer();
     _level = 0;
     _lastLevel = std::numeric_limits<unsigned>::max();
 }
@@ -84,13 +112,13 @@ void JsonFormatter::addValueString(const std::string& name, const std::string& t
         }
         else if (type == "null")
         {
-            *_ts << L"null";
+            put("null", 4);
         }
         else
         {
-            *_ts << L'"';
+            put('"');
             stringOut(value);
-            *_ts << L'"';
+            put('"');
         }
 
         finishValue();
@@ -116,13 +144,13 @@ void JsonFormatter::addValueStdString(const std::string& name, const std::string
         }
         else if (type == "null")
         {
-            *_ts << L"null";
+            put("null", 4);
         }
         else
         {
-            *_ts << L'"';
+            put('"');
             stringOut(value);
-            *_ts << L'"';
+            put('"');
         }
 
         finishValue();
@@ -136,7 +164,10 @@ void JsonFormatter::addValueBool(const std::string& name, const std::string& typ
 
     beginValue(name);
 
-    *_ts << (value ? L"true" : L"false");
+    if (value)
+        put("true", 4);
+    else
+        put("false", 5);
 
     finishValue();
 }
@@ -149,9 +180,16 @@ void JsonFormatter::addValueInt(const std::string& name, const std::string& type
     beginValue(name);
 
     if (type == "bool")
-        *_ts << (value ? L"true" : L"false");
+    {
+        if (value)
+            put("true", 4);
+        else
+            put("false", 5);
+    }
     else
-        *_ts << value;
+    {
+        commit(putInt(reserve(std::numeric_limits<int_type>::digits10 + 3), value));
+    }
 
     finishValue();
 }
@@ -164,9 +202,16 @@ void JsonFormatter::addValueUnsigned(const std::string& name, const std::string&
     beginValue(name);
 
     if (type == "bool")
-        *_ts << (value ? L"true" : L"false");
+    {
+        if (value)
+            put("true", 4);
+        else
+            put("false", 5);
+    }
     else
-        *_ts << value;
+    {
+        commit(putInt(reserve(std::numeric_limits<unsigned_type>::digits10 + 3), value));
+    }
 
     finishValue();
 }
@@ -182,11 +227,15 @@ void JsonFormatter::addValueFloat(const std::string& name, const std::string& ty
         || value == std::numeric_limits<long double>::infinity()
         || value == -std::numeric_limits<long double>::infinity())
     {
-        *_ts << L"null";
+        put("null", 4);
     }
     else
     {
-        *_ts << convert<String>(value);
+        // the plain decimal notation may get long, so it is not
+        // written into the buffer directly
+        _number.clear();
+        putFloat(std::back_inserter(_number), value);
+        put(_number.data(), _number.size());
     }
 
     finishValue();
@@ -195,19 +244,19 @@ void JsonFormatter::addValueFloat(const std::string& name, const std::string& ty
 void JsonFormatter::addNull(const std::string& name, const std::string& type)
 {
     beginValue(name);
-    *_ts << L"null";
+    put("null", 4);
     finishValue();
 }
 
 void JsonFormatter::beginArray(const std::string& name, const std::string& type)
 {
-    checkTs(_ts);
+    checkTs(_ts, _out);
 
     if (_level == _lastLevel)
     {
-        *_ts << L',';
+        put(',');
         if (_beautify)
-            *_ts << L'\n';
+            put('\n');
     }
     else
         _lastLevel = _level;
@@ -219,44 +268,47 @@ void JsonFormatter::beginArray(const std::string& name, const std::string& type)
 
     if (!name.empty())
     {
-        *_ts << L'"';
+        put('"');
         stringOut(name);
-        *_ts << L'"'
-             << L':';
+        put('"');
+        put(':');
         if (_beautify)
-            *_ts << L' ';
+            put(' ');
     }
 
-    *_ts << L'[';
+    put('[');
     if (_beautify)
-        *_ts << L'\n';
+        put('\n');
 }
 
 void JsonFormatter::finishArray()
 {
-    checkTs(_ts);
+    checkTs(_ts, _out);
 
     --_level;
     _lastLevel = _level;
     if (_beautify)
     {
-        *_ts << L'\n';
+        put('\n');
         indent();
     }
-    *_ts << L']';
+    put(']');
+
+    if (_level == 0)
+        flushBuffer();
 }
 
 void JsonFormatter::beginObject(const std::string& name, const std::string& type)
 {
-    checkTs(_ts);
+    checkTs(_ts, _out);
 
     log_trace("beginObject name=\"" << name << '"');
 
     if (_level == _lastLevel)
     {
-        *_ts << L',';
+        put(',');
         if (_beautify)
-            *_ts << L'\n';
+            put('\n');
     }
     else
         _lastLevel = _level;
@@ -268,17 +320,17 @@ void JsonFormatter::beginObject(const std::string& name, const std::string& type
 
     if (!name.empty())
     {
-        *_ts << L'"';
+        put('"');
         stringOut(name);
-        *_ts << L'"'
-             << L':';
+        put('"');
+        put(':');
         if (_beautify)
-            *_ts << L' ';
+            put(' ');
     }
 
-    *_ts << L'{';
+    put('{');
     if (_beautify)
-        *_ts << L'\n';
+        put('\n');
 }
 
 void JsonFormatter::beginMember(const std::string& name)
@@ -291,7 +343,7 @@ void JsonFormatter::finishMember()
 
 void JsonFormatter::finishObject()
 {
-    checkTs(_ts);
+    checkTs(_ts, _out);
 
     log_trace("finishObject");
 
@@ -299,110 +351,144 @@ void JsonFormatter::finishObject()
     _lastLevel = _level;
     if (_beautify)
     {
-        *_ts << L'\n';
+        put('\n');
         indent();
     }
-    *_ts << L'}';
+    put('}');
+
+    if (_level == 0)
+        flushBuffer();
+}
+
+void JsonFormatter::put(const char* s, std::size_t n)
+{
+    while (n > 0)
+    {
+        if (_count >= BufferSize)
+            flushBuffer();
+
+        std::size_t count = std::min(n, static_cast<std::size_t>(BufferSize - _count));
+        std::memcpy(_buffer + _count, s, count);
+        _count += count;
+        s += count;
+        n -= count;
+    }
+}
+
+void JsonFormatter::flushBuffer()
+{
+    if (_count == 0)
+        return;
+
+    if (_out)
+    {
+        _out->write(_buffer, _count);
+    }
+    else if (_ts)
+    {
+        Char wbuffer[BufferSize];
+        for (unsigned n = 0; n < _count; ++n)
+            wbuffer[n] = Char(_buffer[n]);
+        _ts->write(wbuffer, _count);
+    }
+
+    _count = 0;
 }
 
 void JsonFormatter::indent()
 {
     for (unsigned n = 0; n < _level; ++n)
-        *_ts << L'\t';
+        put('\t');
 }
 
-void JsonFormatter::stringOut(const std::string& str)
+void JsonFormatter::escape(uint32_t ch)
 {
-    for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+    char* p = reserve(12);
+    *p++ = '\\';
+    switch (ch)
     {
-        if (*it == '"')
-            *_ts << L'\\'
-                << L'\"';
-        else if (*it == '\\')
-            *_ts << L'\\'
-                << L'\\';
-        else if (*it == '\b')
-            *_ts << L'\\'
-                << L'b';
-        else if (*it == '\f')
-            *_ts << L'\\'
-                << L'f';
-        else if (*it == '\n')
-            *_ts << L'\\'
-                << L'n';
-        else if (*it == '\r')
-            *_ts << L'\\'
-                << L'r';
-        else if (*it == '\t')
-            *_ts << L'\\'
-                << L't';
-        else if (static_cast<unsigned char>(*it) >= 0x80 || static_cast<unsigned char>(*it) < 0x20)
-        {
-            *_ts << L'\\'
-                 << L'u';
-            static const char hex[] = "0123456789abcdef";
-            uint32_t v = static_cast<unsigned char>(*it);
-            for (uint32_t s = 16; s > 0; s -= 4)
+        case '"':  *p++ = '"'; break;
+        case '\\': *p++ = '\\'; break;
+        case '\b': *p++ = 'b'; break;
+        case '\f': *p++ = 'f'; break;
+        case '\n': *p++ = 'n'; break;
+        case '\r': *p++ = 'r'; break;
+        case '\t': *p++ = 't'; break;
+
+        default:
+            *p++ = 'u';
+            if (ch <= 0xffff)
             {
-                *_ts << Char(hex[(v >> (s - 4)) & 0xf]);
+                p = putHex4(p, ch);
             }
-        }
-        else
-            *_ts << Char(*it);
+            else if (ch <= 0x10ffff)
+            {
+                // characters outside the basic multilingual plane are
+                // written as a utf-16 surrogate pair
+                ch -= 0x10000;
+                p = putHex4(p, 0xd800 + (ch >> 10));
+                *p++ = '\\';
+                *p++ = 'u';
+                p = putHex4(p, 0xdc00 + (ch & 0x3ff));
+            }
+            else
+            {
+                p = putHex4(p, 0xfffd);
+            }
+    }
+    commit(p);
+}
+
+void JsonFormatter::stringOut(const std::string& str)
+{
+    const char* p = str.data();
+    const char* e = p + str.size();
+    while (p < e)
+    {
+        // copy runs of characters, which need no escaping, at once
+        const char* s = p;
+        while (p < e && !needsEscape(static_cast<unsigned char>(*p)))
+            ++p;
+
+        put(s, p - s);
+
+        if (p < e)
+            escape(static_cast<unsigned char>(*p++));
     }
 }
 
 void JsonFormatter::stringOut(const cxxtools::String& str)
 {
-    for (cxxtools::String::const_iterator it = str.begin(); it != str.end(); ++it)
+    const Char* p = str.data();
+    const Char* e = p + str.size();
+    while (p < e)
     {
-        if (*it == L'"')
-            *_ts << L'\\'
-                << L'\"';
-        else if (*it == L'\\')
-            *_ts << L'\\'
-                << L'\\';
-        else if (*it == L'\b')
-            *_ts << L'\\'
-                << L'b';
-        else if (*it == L'\f')
-            *_ts << L'\\'
-                << L'f';
-        else if (*it == L'\n')
-            *_ts << L'\\'
-                << L'n';
-        else if (*it == L'\r')
-            *_ts << L'\\'
-                << L'r';
-        else if (*it == L'\t')
-            *_ts << L'\\'
-                << L't';
-        else if (it->value() >= 0x80 || it->value() < 0x20)
+        if (needsEscape(p->value()))
         {
-            *_ts << L'\\'
-                 << L'u';
-            static const char hex[] = "0123456789abcdef";
-            uint32_t v = it->value();
-            for (uint32_t s = 16; s > 0; s -= 4)
-            {
-                *_ts << Char(hex[(v >> (s - 4)) & 0xf]);
-            }
+            escape(p->value());
+            ++p;
+            continue;
         }
-        else
-            *_ts << *it;
+
+        // narrow a run of ascii characters directly into the buffer
+        char* b = reserve(1);
+        char* be = _buffer + BufferSize;
+        while (b < be && p < e && !needsEscape(p->value()))
+            *b++ = static_cast<char>(p++->value());
+        commit(b);
     }
 }
 
 void JsonFormatter::beginValue(const std::string& name)
 {
-    checkTs(_ts);
+    checkTs(_ts, _out);
 
     if (_level == _lastLevel)
     {
-        *_ts << L',';
+        put(',');
         if (_beautify)
         {
-            *_ts << L'\n';
+            put('\n');
             indent();
         }
     }
@@ -415,12 +501,12 @@ void JsonFormatter::beginValue(const std::string& name)
 
     if (!name.empty())
     {
-        *_ts << L'"';
+        put('"');
         stringOut(name);
-        *_ts << L'"'
-             << L':';
+        put('"');
+        put(':');
         if (_beautify)
-            *_ts << L' ';
+            put(' ');
     }
 
     ++_level;
@@ -429,6 +515,9 @@ void JsonFormatter::beginValue(const std::string& name)
 void JsonFormatter::finishValue()
 {
     --_level;
+
+    if (_level == 0)
+        flushBuffer();
 }
 
 }
@@ -35,18 +35,29 @@ namespace cxxtools
 
 JsonSerializer::JsonSerializer(std::ostream& os,
     TextCodec<Char, char>* codec)
-    : _ts(new TextOStream(os, codec ? codec : new Utf8Codec())),
+    : _ts(0),
       _inObject(false)
 {
-    _formatter.begin(*_ts);
+    begin(os, codec);
 }
 
 JsonSerializer& JsonSerializer::begin(std::ostream& os,
     TextCodec<Char, char>* codec)
 {
     delete _ts;
-    _ts = new TextOStream(os, codec ? codec : new Utf8Codec());
-    _formatter.begin(*_ts);
+    _ts = 0;
+
+    // without a codec the formatter writes utf-8 directly to the stream
+    if (codec)
+    {
+        _ts = new TextOStream(os, codec);
+        _formatter.begin(*_ts);
+    }
+    else
+    {
+        _formatter.begin(os);
+    }
+
     return *this;
 }
 
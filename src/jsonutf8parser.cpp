@@ -0,0 +1,774 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <cxxtools/jsonutf8parser.h>
+#include <cxxtools/deserializerbase.h>
+#include <cxxtools/serializationerror.h>
+#include <cxxtools/utf8codec.h>
+#include <cxxtools/log.h>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#  include <immintrin.h>
+#  define CXXTOOLS_JSON_AVX2
+#endif
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define CXXTOOLS_JSON_SSE2
+#endif
+
+log_define("cxxtools.json.utf8parser")
+
+namespace cxxtools
+{
+
+namespace
+{
+    inline bool isSpace(char ch)
+    { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+    inline bool isAlpha(char ch)
+    { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'); }
+
+    inline bool isDigit(char ch)
+    { return ch >= '0' && ch <= '9'; }
+
+    // Returns the first non whitespace character in [p, e) or e.
+    const char* skipSpace(const char* p, const char* e)
+    {
+        // tokens are mostly separated by no or a single space; indentation
+        // of formatted json is handled in blocks
+        if (p == e || !isSpace(*p))
+            return p;
+
+        if (++p == e || !isSpace(*p))
+            return p;
+
+#ifdef CXXTOOLS_JSON_AVX2
+        {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i lo = _mm256_set1_epi8('\t' - 1);
+            const __m256i hi = _mm256_set1_epi8('\r' + 1);
+            while (e - p >= 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                                _mm256_and_si256(_mm256_cmpgt_epi8(v, lo),
+                                                 _mm256_cmpgt_epi8(hi, v)));
+                unsigned m = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+                if (m)
+                    return p + __builtin_ctz(m);
+                p += 32;
+            }
+        }
+#endif
+
+#ifdef CXXTOOLS_JSON_SSE2
+        {
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i lo = _mm_set1_epi8('\t' - 1);
+            const __m128i hi = _mm_set1_epi8('\r' + 1);
+            while (e - p >= 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                _mm_and_si128(_mm_cmpgt_epi8(v, lo),
+                                              _mm_cmpgt_epi8(hi, v)));
+                unsigned m = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xffff;
+                if (m)
+                    return p + __builtin_ctz(m);
+                p += 16;
+            }
+        }
+#endif
+
+        while (p < e && isSpace(*p))
+            ++p;
+
+        return p;
+    }
+
+    // Returns the first '"' or '\\' in [p, e) or e.
+    // nonAscii is set, when a byte with the high bit set is skipped.
+    const char* scanString(const char* p, const char* e, bool& nonAscii)
+    {
+#ifdef CXXTOOLS_JSON_AVX2
+        {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            while (e - p >= 32)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                unsigned m = static_cast<unsigned>(_mm256_movemask_epi8(
+                                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                                _mm256_cmpeq_epi8(v, backslash))));
+                unsigned h = static_cast<unsigned>(_mm256_movemask_epi8(v));
+                if (m)
+                {
+                    unsigned n = __builtin_ctz(m);
+                    if (h & ((1u << n) - 1))
+                        nonAscii = true;
+                    return p + n;
+                }
+
+                if (h)
+                    nonAscii = true;
+                p += 32;
+            }
+        }
+#endif
+
+#ifdef CXXTOOLS_JSON_SSE2
+        {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            while (e - p >= 16)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                unsigned m = static_cast<unsigned>(_mm_movemask_epi8(
+                                _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                             _mm_cmpeq_epi8(v, backslash))));
+                unsigned h = static_cast<unsigned>(_mm_movemask_epi8(v));
+                if (m)
+                {
+                    unsigned n = __builtin_ctz(m);
+                    if (h & ((1u << n) - 1))
+                        nonAscii = true;
+                    return p + n;
+                }
+
+                if (h)
+                    nonAscii = true;
+                p += 16;
+            }
+        }
+#endif
+
+        for (; p < e; ++p)
+        {
+            if (*p == '"' || *p == '\\')
+                break;
+            if (static_cast<unsigned char>(*p) >= 0x80)
+                nonAscii = true;
+        }
+
+        return p;
+    }
+
+    unsigned countLines(const char* p, const char* e)
+    {
+        unsigned count = 0;
+        while (p < e && (p = static_cast<const char*>(std::memchr(p, '\n', e - p))) != 0)
+        {
+            ++count;
+            ++p;
+        }
+        return count;
+    }
+
+    void appendUtf8(std::string& s, unsigned long ch)
+    {
+        if (ch < 0x80)
+            s += static_cast<char>(ch);
+        else if (ch < 0x800)
+        {
+            s += static_cast<char>(0xc0 | (ch >> 6));
+            s += static_cast<char>(0x80 | (ch & 0x3f));
+        }
+        else if (ch < 0x10000)
+        {
+            s += static_cast<char>(0xe0 | (ch >> 12));
+            s += static_cast<char>(0x80 | ((ch >> 6) & 0x3f));
+            s += static_cast<char>(0x80 | (ch & 0x3f));
+        }
+        else
+        {
+            s += static_cast<char>(0xf0 | (ch >> 18));
+            s += static_cast<char>(0x80 | ((ch >> 12) & 0x3f));
+            s += static_cast<char>(0x80 | ((ch >> 6) & 0x3f));
+            s += static_cast<char>(0x80 | (ch & 0x3f));
+        }
+    }
+}
+
+JsonUtf8Parser::JsonUtf8Parser()
+    : _state(state_value),
+      _nextState(state_value),
+      _first(true),
+      _isName(false),
+      _escape(false),
+      _hasEscape(false),
+      _nonAscii(false),
+      _float(false),
+      _deserializer(0),
+      _lineNo(1)
+{ }
+
+void JsonUtf8Parser::begin(DeserializerBase& handler)
+{
+    _state = state_value;
+    _containers.clear();
+    _token.clear();
+    _first = true;
+    _deserializer = &handler;
+}
+
+std::size_t JsonUtf8Parser::advance(const char* data, std::size_t size)
+{
+    const char* p = data;
+    const char* e = data + size;
+    const char* b = data;  // begin of the current token in this chunk
+
+    if (_first && size > 0)
+    {
+        _first = false;
+        if (size >= 3 && std::memcmp(p, "\xef\xbb\xbf", 3) == 0)
+            p += 3;
+    }
+
+    try
+    {
+        while (p < e && _state != state_end)
+        {
+            switch (_state)
+            {
+                case state_value:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == '{')
+                    {
+                        _deserializer->setCategory(SerializationInfo::Object);
+                        _containers.push_back('{');
+                        _state = state_object_first;
+                        ++p;
+                    }
+                    else if (*p == '[')
+                    {
+                        _deserializer->setCategory(SerializationInfo::Array);
+                        _containers.push_back('[');
+                        _state = state_array_first;
+                        ++p;
+                    }
+                    else if (*p == '"')
+                    {
+                        _deserializer->setCategory(SerializationInfo::Value);
+                        beginString(false);
+                        b = ++p;
+                    }
+                    else if (isDigit(*p) || *p == '+' || *p == '-')
+                    {
+                        _deserializer->setCategory(SerializationInfo::Value);
+                        _float = false;
+                        _state = state_number;
+                        b = p++;
+                    }
+                    else if (*p == '/')
+                    {
+                        beginComment();
+                        ++p;
+                    }
+                    else
+                    {
+                        _state = state_token;
+                        b = p++;
+                    }
+                    break;
+
+                case state_object_first:
+                case state_object_next:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == '"')
+                    {
+                        beginString(true);
+                        b = ++p;
+                    }
+                    else if (*p == '}' && _state == state_object_first)
+                    {
+                        ++p;
+                        _containers.pop_back();
+                        valueEnd();
+                    }
+                    else if (*p == '/')
+                    {
+                        beginComment();
+                        ++p;
+                    }
+                    else if (isAlpha(*p))
+                    {
+                        _state = state_plainname;
+                        b = p++;
+                    }
+                    else
+                        throwInvalidCharacter(*p);
+                    break;
+
+                case state_object_colon:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == ':')
+                    {
+                        log_debug("begin object member " << _name);
+                        _deserializer->beginMember(_name, std::string(), SerializationInfo::Void);
+                        _state = state_value;
+                        ++p;
+                    }
+                    else if (*p == '/')
+                    {
+                        beginComment();
+                        ++p;
+                    }
+                    else
+                        throwInvalidCharacter(*p);
+                    break;
+
+                case state_object_e:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == ',')
+                        _state = state_object_next;
+                    else if (*p == '}')
+                    {
+                        _containers.pop_back();
+                        valueEnd();
+                    }
+                    else if (*p == '/')
+                        beginComment();
+                    else
+                        throwInvalidCharacter(*p);
+                    ++p;
+                    break;
+
+                case state_array_first:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == ']')
+                    {
+                        ++p;
+                        _containers.pop_back();
+                        valueEnd();
+                    }
+                    else if (*p == '/')
+                    {
+                        beginComment();
+                        ++p;
+                    }
+                    else
+                    {
+                        log_debug("begin array member");
+                        _deserializer->beginMember(std::string(), std::string(), SerializationInfo::Void);
+                        _state = state_value;
+                    }
+                    break;
+
+                case state_array_e:
+                    p = skipSpace(p, e);
+                    if (p == e)
+                        break;
+
+                    if (*p == ',')
+                    {
+                        log_debug("begin array member");
+                        _deserializer->beginMember(std::string(), std::string(), SerializationInfo::Void);
+                        _state = state_value;
+                    }
+                    else if (*p == ']')
+                    {
+                        _containers.pop_back();
+                        valueEnd();
+                    }
+                    else if (*p == '/')
+                        beginComment();
+                    else
+                        throwInvalidCharacter(*p);
+                    ++p;
+                    break;
+
+                case state_string:
+                    if (_escape)
+                    {
+                        // the escaped character; hex digits of \u are
+                        // checked when the string is complete
+                        _escape = false;
+                        ++p;
+                    }
+                    else
+                    {
+                        const char* q = scanString(p, e, _nonAscii);
+                        if (q == e)
+                            p = e;
+                        else if (*q == '\\')
+                        {
+                            _hasEscape = true;
+                            _escape = true;
+                            p = q + 1;
+                        }
+                        else
+                        {
+                            stringEnd(b, q);
+                            p = q + 1;
+                        }
+                    }
+                    break;
+
+                case state_number:
+                    for (; p < e; ++p)
+                    {
+                        if (isDigit(*p))
+                            continue;
+                        else if (*p == '.' || *p == 'e' || *p == 'E')
+                            _float = true;
+                        else if (!_float || (*p != '+' && *p != '-'))
+                            break;
+                    }
+
+                    if (p < e)
+                    {
+                        takeToken(b, p, _value);
+                        numberEnd();
+                    }
+                    break;
+
+                case state_token:
+                    while (p < e && isAlpha(*p))
+                        ++p;
+
+                    if (p < e)
+                    {
+                        takeToken(b, p, _value);
+                        tokenEnd();
+                    }
+                    break;
+
+                case state_plainname:
+                    while (p < e && (isAlpha(*p) || isDigit(*p)))
+                        ++p;
+
+                    if (p < e)
+                    {
+                        takeToken(b, p, _name);
+                        _state = state_object_colon;
+                    }
+                    break;
+
+                case state_comment0:
+                    if (*p == '/')
+                        _state = state_commentline;
+                    else if (*p == '*')
+                        _state = state_comment;
+                    else
+                        throwInvalidCharacter(*p);
+                    ++p;
+                    break;
+
+                case state_commentline:
+                {
+                    const char* q = static_cast<const char*>(std::memchr(p, '\n', e - p));
+                    if (q == 0)
+                        p = e;
+                    else
+                    {
+                        _state = _nextState;
+                        p = q + 1;
+                    }
+                    break;
+                }
+
+                case state_comment:
+                {
+                    const char* q = static_cast<const char*>(std::memchr(p, '*', e - p));
+                    if (q == 0)
+                        p = e;
+                    else
+                    {
+                        _state = state_comment_e;
+                        p = q + 1;
+                    }
+                    break;
+                }
+
+                case state_comment_e:
+                    if (*p == '/')
+                        _state = _nextState;
+                    else if (*p != '*')
+                        _state = state_comment;
+                    ++p;
+                    break;
+
+                case state_end:
+                    break;
+            }
+        }
+
+        if (tokenState())
+            _token.append(b, p);
+    }
+    catch (JsonParserError& ex)
+    {
+        ex._lineNo = _lineNo + countLines(data, p);
+        throw;
+    }
+
+    _lineNo += countLines(data, p);
+
+    return p - data;
+}
+
+void JsonUtf8Parser::finish()
+{
+    if (_state == state_commentline)
+        _state = _nextState;
+
+    if (_state == state_number)
+    {
+        takeToken(0, 0, _value);
+        numberEnd();
+    }
+    else if (_state == state_token)
+    {
+        takeToken(0, 0, _value);
+        tokenEnd();
+    }
+
+    if (_state != state_end)
+        SerializationError::doThrow("unexpected end");
+}
+
+void JsonUtf8Parser::beginString(bool isName)
+{
+    _state = state_string;
+    _isName = isName;
+    _escape = false;
+    _hasEscape = false;
+    _nonAscii = false;
+}
+
+void JsonUtf8Parser::beginComment()
+{
+    _nextState = _state;
+    _state = state_comment0;
+}
+
+void JsonUtf8Parser::takeToken(const char* b, const char* e, std::string& str)
+{
+    if (_token.empty())
+        str.assign(b, e);
+    else
+    {
+        _token.append(b, e);
+        str.swap(_token);
+        _token.clear();
+    }
+}
+
+void JsonUtf8Parser::stringEnd(const char* b, const char* e)
+{
+    std::string& str = _isName ? _name : _value;
+    takeToken(b, e, str);
+
+    if (_hasEscape)
+    {
+        unescape(str, _token);
+        str.swap(_token);
+        _token.clear();
+    }
+
+    if (_isName)
+    {
+        _state = state_object_colon;
+        return;
+    }
+
+    log_debug("set string value \"" << _value << '"');
+    if (_nonAscii)
+        _deserializer->setValue(Utf8Codec::decode(_value.data(), _value.size()));
+    else
+        _deserializer->setValue(_value);
+    _deserializer->setTypeName("string");
+    valueEnd();
+}
+
+void JsonUtf8Parser::numberEnd()
+{
+    log_debug("set " << (_float ? "double" : "int") << " value \"" << _value << '"');
+    _deserializer->setValue(_value);
+    _deserializer->setTypeName(_float ? "double" : "int");
+    valueEnd();
+}
+
+void JsonUtf8Parser::tokenEnd()
+{
+    for (std::string::size_type n = 1; n < _value.size(); ++n)
+        if (_value[n] >= 'A' && _value[n] <= 'Z')
+            _value[n] += 'a' - 'A';
+
+    if (_value == "true" || _value == "false")
+    {
+        log_debug("set bool value \"" << _value << '"');
+        _deserializer->setValue(_value);
+        _deserializer->setTypeName("bool");
+    }
+    else if (_value == "null")
+    {
+        log_debug("set null value");
+        _deserializer->setTypeName("null");
+        _deserializer->setNull();
+    }
+
+    valueEnd();
+}
+
+void JsonUtf8Parser::valueEnd()
+{
+    if (_containers.empty())
+    {
+        _state = state_end;
+        return;
+    }
+
+    log_debug("leave member");
+    _deserializer->leaveMember();
+    _state = _containers.back() == '{' ? state_object_e : state_array_e;
+}
+
+void JsonUtf8Parser::unescape(const std::string& in, std::string& out)
+{
+    out.clear();
+
+    const char* p = in.data();
+    const char* e = p + in.size();
+
+    while (p < e)
+    {
+        const char* q = static_cast<const char*>(std::memchr(p, '\\', e - p));
+        if (q == 0)
+        {
+            out.append(p, e);
+            break;
+        }
+
+        out.append(p, q);
+        p = q + 2;
+
+        switch (q[1])
+        {
+            case '"':
+            case '\\':
+            case '/':  out += q[1]; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+
+            case 'u':
+            {
+                unsigned long value = 0;
+                for (unsigned n = 0; n < 4; ++n, ++p)
+                {
+                    if (p == e)
+                        doThrow("incomplete hex sequence");
+
+                    char ch = *p;
+                    if (ch >= '0' && ch <= '9')
+                        value = (value << 4) | (ch - '0');
+                    else if (ch >= 'a' && ch <= 'f')
+                        value = (value << 4) | (ch - 'a' + 10);
+                    else if (ch >= 'A' && ch <= 'F')
+                        value = (value << 4) | (ch - 'A' + 10);
+                    else
+                        doThrow(std::string("invalid character '") + ch + "' in hex sequence");
+                }
+
+                if (value >= 0xd800 && value < 0xe000)
+                {
+                    // combine a surrogate pair; a single surrogate is
+                    // no valid character
+                    unsigned long low = 0;
+                    if (value < 0xdc00 && e - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                    {
+                        for (unsigned n = 2; n < 6; ++n)
+                        {
+                            char ch = p[n];
+                            if (ch >= '0' && ch <= '9')
+                                low = (low << 4) | (ch - '0');
+                            else if (ch >= 'a' && ch <= 'f')
+                                low = (low << 4) | (ch - 'a' + 10);
+                            else if (ch >= 'A' && ch <= 'F')
+                                low = (low << 4) | (ch - 'A' + 10);
+                            else
+                            {
+                                low = 0;
+                                break;
+                            }
+                        }
+                    }
+
+                    if (low >= 0xdc00 && low < 0xe000)
+                    {
+                        value = 0x10000 + ((value - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    }
+                    else
+                        value = 0xfffd;
+                }
+
+                if (value >= 0x80)
+                    _nonAscii = true;
+
+                appendUtf8(out, value);
+                break;
+            }
+
+            default:
+                doThrow(std::string("invalid character '") + q[1] + "' in string");
+        }
+    }
+}
+
+void JsonUtf8Parser::doThrow(const std::string& msg)
+{
+    throw JsonParserError(msg, _lineNo);
+}
+
+void JsonUtf8Parser::throwInvalidCharacter(char ch)
+{
+    doThrow(std::string("invalid character '") + ch + '\'');
+}
+
+}
@@ -31,6 +31,8 @@
 #include <cxxtools/smartptr.h>
 #include <cxxtools/convert.h>
 #include <cxxtools/mutex.h>
+#include <cxxtools/condition.h>
+#include <cxxtools/thread.h>
 #include <cxxtools/atomicity.h>
 #include <cxxtools/serializationinfo.h>
 #include <cxxtools/xml/xmldeserializer.h>
@@ -49,6 +51,9 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
 #include <pthread.h>
 
 namespace cxxtools
@@ -129,16 +134,29 @@ namespace cxxtools
         }
     };
 
-    void logentry(std::string& entry, const char* level, const std::string& category)
+    // formatted date of the last second; each thread, which formats log
+    // entries concurrently, needs its own
+    struct DateCache
+    {
+      char date[20];
+      time_t psec;
+
+      DateCache()
+        : psec(0)
+      { }
+    };
+
+    DateCache syncDateCache;
+
+    void logentry(std::string& entry, const char* level, const std::string& category, DateCache& cache)
     {
       struct timeval t;
       gettimeofday(&t, 0);
 
       // format date only once per second:
-      static char date[20];
-      static time_t psec = 0;
+      char* date = cache.date;
       time_t sec = static_cast<time_t>(t.tv_sec);
-      if (sec != psec)
+      if (sec != cache.psec)
       {
         struct tm tt;
         localtime_r(&sec, &tt);
@@ -165,7 +183,7 @@ namespace cxxtools
         date[18] = static_cast<char>('0' + tt.tm_sec % 10);
         date[19] = '.';
 
-        psec = sec;
+        cache.psec = sec;
       }
 
       entry.append(date, 20);
@@ -196,8 +214,20 @@ namespace cxxtools
         virtual ~LogAppender() { }
         virtual void putMessage(const std::string& msg) = 0;
         virtual void finish(bool flush) = 0;
+
+        // writes a batch of complete log lines including their line feeds
+        virtual void putMessages(const struct iovec* iov, unsigned count);
     };
 
+    void LogAppender::putMessages(const struct iovec* iov, unsigned count)
+    {
+      for (unsigned n = 0; n < count; ++n)
+      {
+        putMessage(std::string(static_cast<const char*>(iov[n].iov_base), iov[n].iov_len - 1));
+        finish(true);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////
     // FdAppender - writes log to a file descriptor
     //
@@ -214,6 +244,10 @@ namespace cxxtools
 
         virtual void putMessage(const std::string& msg);
         virtual void finish(bool flush);
+        virtual void putMessages(const struct iovec* iov, unsigned count);
+
+      private:
+        std::vector<struct iovec> _iov;
     };
 
     void FdAppender::putMessage(const std::string& msg)
@@ -231,6 +265,48 @@ namespace cxxtools
       _msg.clear();
     }
 
+    void FdAppender::putMessages(const struct iovec* iov, unsigned count)
+    {
+      if (!_msg.empty())
+        finish(true);
+
+      while (count > 0)
+      {
+        unsigned n = count < IOV_MAX ? count : IOV_MAX;
+        _iov.assign(iov, iov + n);
+
+        struct iovec* p = &_iov[0];
+        unsigned left = n;
+        while (left > 0)
+        {
+          ssize_t ret = ::writev(_fd, p, left);
+          if (ret < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            return;
+          }
+
+          // skip what is written
+          while (left > 0 && static_cast<size_t>(ret) >= p->iov_len)
+          {
+            ret -= p->iov_len;
+            ++p;
+            --left;
+          }
+
+          if (left > 0)
+          {
+            p->iov_base = static_cast<char*>(p->iov_base) + ret;
+            p->iov_len -= ret;
+          }
+        }
+
+        iov += n;
+        count -= n;
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////
     // FileAppender
     //
@@ -241,6 +317,7 @@ namespace cxxtools
       public:
         explicit FileAppender(const std::string& fname);
         virtual void putMessage(const std::string& msg);
+        virtual void putMessages(const struct iovec* iov, unsigned count);
 
         const std::string& fname() const  { return _fname; }
         void closeFile();
@@ -275,6 +352,14 @@ namespace cxxtools
       FdAppender::putMessage(msg);
     }
 
+    void FileAppender::putMessages(const struct iovec* iov, unsigned count)
+    {
+      if (_fd == -1)
+        openFile();
+
+      FdAppender::putMessages(iov, count);
+    }
+
     //////////////////////////////////////////////////////////////////////
     // RollingFileAppender
     //
@@ -291,6 +376,7 @@ namespace cxxtools
       public:
         RollingFileAppender(const std::string& fname, unsigned maxfilesize, unsigned maxbackupindex);
         virtual void putMessage(const std::string& msg);
+        virtual void putMessages(const struct iovec* iov, unsigned count);
     };
 
     RollingFileAppender::RollingFileAppender(const std::string& fname, unsigned maxfilesize, unsigned maxbackupindex)
@@ -346,6 +432,15 @@ namespace cxxtools
       _fsize += msg.size() + 1;  // FileAppender adds line feed to the message
     }
 
+    void RollingFileAppender::putMessages(const struct iovec* iov, unsigned count)
+    {
+      if (_fsize >= _maxfilesize)
+        doRotate();
+      FileAppender::putMessages(iov, count);
+      for (unsigned n = 0; n < count; ++n)
+        _fsize += iov[n].iov_len;
+    }
+
     //////////////////////////////////////////////////////////////////////
     // UdpAppender
     //
@@ -380,6 +475,421 @@ namespace cxxtools
       _msg.clear();
     }
 
+    //////////////////////////////////////////////////////////////////////
+    // AsyncLogBuffer - ring buffer of formatted log lines of one thread
+    //
+    // The owning thread is the only producer and the background thread of
+    // AsyncLog the only consumer, so the positions need no locking. Each
+    // record is a length header followed by the text, aligned to 8 bytes.
+    // A record, which does not fit at the end, starts at the beginning and
+    // the rest is marked as skipped.
+    //
+    class AsyncLogBuffer
+    {
+        static const unsigned SkipMarker = ~0u;
+        enum { Align = 8, CacheLine = 64 };
+
+        char* _data;
+        std::size_t _size;
+        char _pad0[CacheLine];
+        volatile atomic_t _head;
+        char _pad1[CacheLine];
+        volatile atomic_t _tail;
+        volatile atomic_t _orphaned;
+
+        AsyncLogBuffer(const AsyncLogBuffer&);
+        AsyncLogBuffer& operator=(const AsyncLogBuffer&);
+
+        static std::size_t recordSize(std::size_t len)
+        { return (sizeof(unsigned) + len + Align - 1) & ~static_cast<std::size_t>(Align - 1); }
+
+      public:
+        // used by the producer for formatting
+        DateCache dateCache;
+        std::string record;
+
+        explicit AsyncLogBuffer(std::size_t size);
+        ~AsyncLogBuffer()
+        { delete[] _data; }
+
+        std::size_t maxRecordSize() const
+        { return _size / 2 - sizeof(unsigned); }
+
+        std::size_t fill() const
+        { return static_cast<std::size_t>(atomicGet(const_cast<volatile atomic_t&>(_head)) - atomicGet(const_cast<volatile atomic_t&>(_tail))); }
+
+        std::size_t size() const
+        { return _size; }
+
+        bool empty() const
+        { return fill() == 0; }
+
+        // returns false when there is not enough room
+        bool put(const char* data, std::size_t len);
+
+        // adds the pending records to iov and returns the read position behind them
+        std::size_t collect(std::vector<struct iovec>& iov, std::size_t maxCount) const;
+
+        // releases the buffer space up to the position returned by collect
+        void release(std::size_t tail)
+        { atomicSet(_tail, static_cast<atomic_t>(tail)); }
+
+        // called when the owning thread terminates
+        void orphan()
+        { atomicSet(_orphaned, 1); }
+
+        bool orphaned() const
+        { return atomicGet(const_cast<volatile atomic_t&>(_orphaned)) != 0; }
+    };
+
+    AsyncLogBuffer::AsyncLogBuffer(std::size_t size)
+      : _data(0),
+        _size(1024),
+        _head(0),
+        _tail(0),
+        _orphaned(0)
+    {
+      while (_size < size)
+        _size <<= 1;
+      _data = new char[_size];
+    }
+
+    bool AsyncLogBuffer::put(const char* data, std::size_t len)
+    {
+      std::size_t need = recordSize(len);
+      std::size_t head = static_cast<std::size_t>(atomicGet(_head));
+      std::size_t offset = head & (_size - 1);
+      std::size_t toEnd = _size - offset;
+      std::size_t total = toEnd < need ? toEnd + need : need;
+
+      if (_size - (head - static_cast<std::size_t>(atomicGet(_tail))) < total)
+        return false;
+
+      if (toEnd < need)
+      {
+        *reinterpret_cast<unsigned*>(_data + offset) = SkipMarker;
+        head += toEnd;
+        offset = 0;
+      }
+
+      *reinterpret_cast<unsigned*>(_data + offset) = static_cast<unsigned>(len);
+      ::memcpy(_data + offset + sizeof(unsigned), data, len);
+
+      atomicSet(_head, static_cast<atomic_t>(head + need));
+      return true;
+    }
+
+    std::size_t AsyncLogBuffer::collect(std::vector<struct iovec>& iov, std::size_t maxCount) const
+    {
+      std::size_t tail = static_cast<std::size_t>(atomicGet(const_cast<volatile atomic_t&>(_tail)));
+      std::size_t head = static_cast<std::size_t>(atomicGet(const_cast<volatile atomic_t&>(_head)));
+
+      while (tail != head && iov.size() < maxCount)
+      {
+        std::size_t offset = tail & (_size - 1);
+        unsigned len = *reinterpret_cast<const unsigned*>(_data + offset);
+        if (len == SkipMarker)
+        {
+          tail += _size - offset;
+          continue;
+        }
+
+        struct iovec v;
+        v.iov_base = _data + offset + sizeof(unsigned);
+        v.iov_len = len;
+        iov.push_back(v);
+
+        tail += recordSize(len);
+      }
+
+      return tail;
+    }
+
+    //////////////////////////////////////////////////////////////////////
+    // AsyncLog - writes log messages from a background thread
+    //
+    // Each thread gets its own AsyncLogBuffer on its first message. The
+    // background thread drains all buffers and passes the records in one
+    // batch to the appender. It is woken up when a buffer gets a quarter
+    // full or someone waits for it and otherwise looks for new messages
+    // every FlushInterval milliseconds.
+    //
+    class AsyncLog
+    {
+        typedef std::vector<AsyncLogBuffer*> Buffers;
+        enum { FlushInterval = 50, MaxBatch = 4096 };
+
+        SmartPtr<LogAppender>& _appender;
+
+        pthread_key_t _key;
+        Mutex _buffersMutex;
+        Buffers _buffers;
+        std::vector<std::size_t> _tails;
+        std::vector<struct iovec> _iov;
+
+        volatile atomic_t _bufferSize;
+        volatile atomic_t _dropOnOverflow;
+        volatile atomic_t _dropped;
+        atomic_t _reportedDropped;
+        DateCache _dateCache;
+
+        Mutex _mutex;
+        Condition _wake;
+        Condition _drained;
+        volatile atomic_t _sleeping;
+        volatile atomic_t _waiting;
+        volatile atomic_t _generation;
+        volatile atomic_t _stop;
+        volatile atomic_t _stopped;
+
+        AttachedThread _thread;
+
+        AsyncLog(const AsyncLog&);
+        AsyncLog& operator=(const AsyncLog&);
+
+        static void releaseBuffer(void* buffer);
+        AsyncLogBuffer* buffer();
+
+        void wakeup();
+        void waitDrained();
+        std::size_t drain();
+        void run();
+
+      public:
+        AsyncLog(SmartPtr<LogAppender>& appender, unsigned bufferSize, bool dropOnOverflow);
+        ~AsyncLog();
+
+        // the buffer size applies to threads, which did not log yet
+        void configure(unsigned bufferSize, bool dropOnOverflow);
+
+        void put(const char* level, const std::string& category, const char* state, const std::string& msg);
+        void flush();
+
+        unsigned long dropped() const
+        { return static_cast<unsigned long>(atomicGet(const_cast<volatile atomic_t&>(_dropped))); }
+    };
+
+    AsyncLog::AsyncLog(SmartPtr<LogAppender>& appender, unsigned bufferSize, bool dropOnOverflow)
+      : _appender(appender),
+        _bufferSize(bufferSize),
+        _dropOnOverflow(dropOnOverflow),
+        _dropped(0),
+        _reportedDropped(0),
+        _sleeping(0),
+        _waiting(0),
+        _generation(0),
+        _stop(0),
+        _stopped(0),
+        _thread(callable(*this, &AsyncLog::run))
+    {
+      pthread_key_create(&_key, &AsyncLog::releaseBuffer);
+      _thread.start();
+    }
+
+    AsyncLog::~AsyncLog()
+    {
+      atomicSet(_stop, 1);
+      wakeup();
+      _thread.join();
+
+      pthread_key_delete(_key);
+      for (Buffers::iterator it = _buffers.begin(); it != _buffers.end(); ++it)
+        delete *it;
+    }
+
+    void AsyncLog::configure(unsigned bufferSize, bool dropOnOverflow)
+    {
+      atomicSet(_bufferSize, bufferSize);
+      atomicSet(_dropOnOverflow, dropOnOverflow);
+    }
+
+    void AsyncLog::releaseBuffer(void* buffer)
+    {
+      // the background thread removes the buffer after writing the rest
+      static_cast<AsyncLogBuffer*>(buffer)->orphan();
+    }
+
+    AsyncLogBuffer* AsyncLog::buffer()
+    {
+      AsyncLogBuffer* buffer = static_cast<AsyncLogBuffer*>(pthread_getspecific(_key));
+      if (buffer == 0)
+      {
+        buffer = new AsyncLogBuffer(static_cast<std::size_t>(atomicGet(_bufferSize)));
+        {
+          MutexLock lock(_buffersMutex);
+          _buffers.push_back(buffer);
+        }
+        pthread_setspecific(_key, buffer);
+      }
+
+      return buffer;
+    }
+
+    void AsyncLog::wakeup()
+    {
+      MutexLock lock(_mutex);
+      _wake.signal();
+    }
+
+    void AsyncLog::waitDrained()
+    {
+      MutexLock lock(_mutex);
+      atomicIncrement(_waiting);
+      _wake.signal();
+      _drained.wait(lock, FlushInterval);
+      atomicDecrement(_waiting);
+    }
+
+    void AsyncLog::put(const char* level, const std::string& category, const char* state, const std::string& msg)
+    {
+      AsyncLogBuffer* buffer = this->buffer();
+
+      std::string& record = buffer->record;
+      record.clear();
+      logentry(record, level, category, buffer->dateCache);
+      if (state)
+        record += state;
+      record += msg;
+      record += '\n';
+
+      if (record.size() > buffer->maxRecordSize())
+      {
+        // does not fit into the ring buffer - write it directly after
+        // everything queued before
+        flush();
+        record.erase(record.size() - 1);
+        MutexLock lock(logMutex);
+        _appender->putMessage(record);
+        _appender->finish(true);
+      }
+      else
+      {
+        while (!buffer->put(record.data(), record.size()))
+        {
+          // fatal messages are never dropped
+          if (atomicGet(_dropOnOverflow) && *level != 'F')
+          {
+            atomicIncrement(_dropped);
+            return;
+          }
+
+          waitDrained();
+        }
+
+        if (atomicGet(_sleeping) && buffer->fill() >= buffer->size() / 4)
+          wakeup();
+      }
+
+      if (*level == 'F')
+        flush();
+    }
+
+    void AsyncLog::flush()
+    {
+      // the second drain pass completed after this point has seen
+      // everything queued before
+      atomic_t generation = atomicGet(_generation);
+
+      MutexLock lock(_mutex);
+      atomicIncrement(_waiting);
+      while (atomicGet(_generation) - generation < 2 && !atomicGet(_stopped))
+      {
+        _wake.signal();
+        _drained.wait(lock, FlushInterval);
+      }
+      atomicDecrement(_waiting);
+    }
+
+    std::size_t AsyncLog::drain()
+    {
+      MutexLock lock(_buffersMutex);
+
+      _iov.clear();
+      _tails.resize(_buffers.size());
+      for (unsigned n = 0; n < _buffers.size(); ++n)
+        _tails[n] = _buffers[n]->collect(_iov, MaxBatch);
+
+      atomic_t dropped = atomicGet(_dropped);
+
+      if (!_iov.empty() || dropped != _reportedDropped)
+      {
+        try
+        {
+          MutexLock lock(logMutex);
+
+          if (!_iov.empty())
+            _appender->putMessages(&_iov[0], _iov.size());
+
+          if (dropped != _reportedDropped)
+          {
+            std::string msg;
+            logentry(msg, "WARN", "cxxtools.log", _dateCache);
+            msg += convert<std::string>(dropped - _reportedDropped);
+            msg += " log messages dropped";
+            _appender->putMessage(msg);
+            _appender->finish(true);
+            _reportedDropped = dropped;
+          }
+        }
+        catch (const std::exception&)
+        {
+        }
+      }
+
+      for (unsigned n = 0; n < _buffers.size(); ++n)
+        _buffers[n]->release(_tails[n]);
+
+      // remove buffers of terminated threads; the order of the checks
+      // matters since the thread may still log until it is orphaned
+      for (unsigned n = 0; n < _buffers.size(); )
+      {
+        if (_buffers[n]->orphaned() && _buffers[n]->empty())
+        {
+          delete _buffers[n];
+          _buffers.erase(_buffers.begin() + n);
+        }
+        else
+          ++n;
+      }
+
+      return _iov.size();
+    }
+
+    void AsyncLog::run()
+    {
+      while (true)
+      {
+        bool stop = atomicGet(_stop) != 0;
+
+        std::size_t count = drain();
+        atomicIncrement(_generation);
+
+        if (atomicGet(_waiting) > 0)
+        {
+          MutexLock lock(_mutex);
+          _drained.broadcast();
+        }
+
+        if (count >= MaxBatch)
+          continue;
+
+        if (stop && count == 0)
+          break;
+
+        MutexLock lock(_mutex);
+        if (atomicGet(_waiting) == 0 && !atomicGet(_stop))
+        {
+          atomicSet(_sleeping, 1);
+          _wake.wait(lock, FlushInterval);
+          atomicSet(_sleeping, 0);
+        }
+      }
+
+      MutexLock lock(_mutex);
+      atomicSet(_stopped, 1);
+      _drained.broadcast();
+    }
+
     //////////////////////////////////////////////////////////////////////
     Logger::log_level_type str2loglevel(const std::string& level, const std::string& category = std::string())
     {
@@ -432,6 +942,9 @@ namespace cxxtools
       unsigned short _logport;
       bool _broadcast;
       bool _tostdout;  // flag for console output: true=stdout, false=stderr
+      bool _async;
+      unsigned _asyncBufferSize;
+      LogConfiguration::OverflowPolicy _overflowPolicy;
 
       Logger::log_level_type _rootLevel;
       LogLevels _logLevels;
@@ -444,6 +957,9 @@ namespace cxxtools
           _maxbackupindex(0),
           _logport(0),
           _broadcast(true),
+          _async(false),
+          _asyncBufferSize(65536),
+          _overflowPolicy(LogConfiguration::BlockOnOverflow),
           _rootLevel(Logger::FATAL)
       { }
 
@@ -454,6 +970,9 @@ namespace cxxtools
       unsigned short logport() const            { return _logport; }
       bool broadcast() const                    { return _broadcast; }
       bool tostdout() const                     { return _tostdout; }
+      bool async() const                        { return _async; }
+      unsigned asyncBufferSize() const          { return _asyncBufferSize; }
+      LogConfiguration::OverflowPolicy overflowPolicy() const  { return _overflowPolicy; }
 
       Logger::log_level_type rootLevel() const  { return _rootLevel; }
       Logger::log_level_type logLevel(const std::string& category) const;
@@ -503,6 +1022,18 @@ namespace cxxtools
         _tostdout = false;
       }
 
+      void setAsync(unsigned bufferSize, LogConfiguration::OverflowPolicy policy)
+      {
+        _async = true;
+        _asyncBufferSize = bufferSize;
+        _overflowPolicy = policy;
+      }
+
+      void setSync()
+      {
+        _async = false;
+      }
+
   };
 
   Logger::log_level_type LogConfiguration::Impl::logLevel(const std::string& category) const
@@ -531,6 +1062,41 @@ namespace cxxtools
     return best_level;
   }
 
+  namespace
+  {
+    // reads a size with an optional suffix k, m or g
+    unsigned getSize(const std::string& s, const char* what)
+    {
+      unsigned size = 0;
+      bool ok = true;
+      std::string::const_iterator it = getInt(s.begin(), s.end(), ok, size);
+      if (!ok)
+        throw std::runtime_error(std::string("failed to read ") + what + " (\"" + s + "\")");
+      if (it != s.end())
+      {
+        switch (*it)
+        {
+          case 'k':
+          case 'K':
+            size *= 1024;
+            break;
+
+          case 'm':
+          case 'M':
+            size *= 1024 * 1024;
+            break;
+
+          case 'g':
+          case 'G':
+            size *= 1024 * 1024 * 1024;
+            break;
+        }
+      }
+
+      return size;
+    }
+  }
+
   void operator>>= (const SerializationInfo& si, LogConfiguration::Impl& impl)
   {
     if (si.getMember("file", impl._fname))
@@ -538,31 +1104,7 @@ namespace cxxtools
       std::string s;
       if (si.getMember("maxfilesize", s))
       {
-        bool ok = true;
-        std::string::iterator it = getInt(s.begin(), s.end(), ok, impl._maxfilesize);
-        if (!ok)
-          throw std::runtime_error("failed to read maxfilesize (\"" + s + "\")");
-        if (it != s.end())
-        {
-          switch (*it)
-          {
-            case 'k':
-            case 'K':
-              impl._maxfilesize *= 1024;
-              break;
-
-            case 'm':
-            case 'M':
-              impl._maxfilesize *= 1024 * 1024;
-              break;
-
-            case 'g':
-            case 'G':
-              impl._maxfilesize *= 1024 * 1024 * 1024;
-              break;
-          }
-        }
-
+        impl._maxfilesize = getSize(s, "maxfilesize");
         si.getMember("maxbackupindex") >>= impl._maxbackupindex;
       }
     }
@@ -577,6 +1119,23 @@ namespace cxxtools
         impl._tostdout = false;
     }
 
+    if (!si.getMember("async", impl._async))
+      impl._async = false;
+
+    std::string s;
+    if (si.getMember("asyncbuffer", s))
+      impl._asyncBufferSize = getSize(s, "asyncbuffer");
+
+    if (si.getMember("overflow", s))
+    {
+      if (s == "block")
+        impl._overflowPolicy = LogConfiguration::BlockOnOverflow;
+      else if (s == "drop")
+        impl._overflowPolicy = LogConfiguration::DropOnOverflow;
+      else
+        throw std::runtime_error("unknown overflow policy \"" + s + '"');
+    }
+
     std::string rootLevel;
     if (!si.getMember("rootlogger", rootLevel))
       impl._rootLevel = Logger::FATAL;
@@ -672,6 +1231,13 @@ namespace cxxtools
     if (impl._tostdout)
       si.addMember("tostdout") <<= true;
 
+    if (impl._async)
+    {
+      si.addMember("async") <<= true;
+      si.addMember("asyncbuffer") <<= impl._asyncBufferSize;
+      si.addMember("overflow") <<= (impl._overflowPolicy == LogConfiguration::DropOnOverflow ? "drop" : "block");
+    }
+
   }
 
   //////////////////////////////////////////////////////////////////////
@@ -746,6 +1312,31 @@ namespace cxxtools
     _impl->setStderr();
   }
 
+  void LogConfiguration::setAsync(unsigned bufferSize, OverflowPolicy policy)
+  {
+    _impl->setAsync(bufferSize, policy);
+  }
+
+  void LogConfiguration::setSync()
+  {
+    _impl->setSync();
+  }
+
+  bool LogConfiguration::async() const
+  {
+    return _impl->async();
+  }
+
+  unsigned LogConfiguration::asyncBufferSize() const
+  {
+    return _impl->asyncBufferSize();
+  }
+
+  LogConfiguration::OverflowPolicy LogConfiguration::overflowPolicy() const
+  {
+    return _impl->overflowPolicy();
+  }
+
   void operator>>= (const SerializationInfo& si, LogConfiguration& logConfiguration)
   {
     si >>= *logConfiguration.impl();
@@ -763,6 +1354,9 @@ namespace cxxtools
   class LogManager::Impl
   {
       SmartPtr<LogAppender> _appender;
+      AsyncLog* _async;  // created when asynchronous logging is configured first
+      volatile atomic_t _asyncEnabled;
+      atomic_t _asyncUsers;  // threads, which may use _async right now
       LogConfiguration _config;
       typedef std::map<std::string, Logger*> Loggers;  // map category => logger
       Loggers _loggers;
@@ -781,7 +1375,17 @@ namespace cxxtools
       Logger* getLogger(const std::string& category);
       LogAppender& appender()
       { return *_appender; }
-    
+
+      void putMessage(const char* level, const std::string& category, const char* state, const std::string& msg);
+
+      void flush();
+
+      unsigned long droppedMessages() const
+      { return _async ? _async->dropped() : 0; }
+
+      // stops the background thread of asynchronous logging
+      void shutdown();
+
       Logger::log_level_type rootLevel() const
       { return _config.rootLevel(); }
 
@@ -790,6 +1394,14 @@ namespace cxxtools
   };
 
   LogManager::Impl::Impl(const LogConfiguration& config)
+    : _async(0),
+      _asyncEnabled(0),
+      _asyncUsers(0)
+  {
+    configure(config);
+  }
+
+  void LogManager::Impl::configure(const LogConfiguration& config)
   {
     if (config.impl()->fname().empty())
     {
@@ -812,31 +1424,17 @@ namespace cxxtools
     }
 
     _config = config;
-  }
 
-  void LogManager::Impl::configure(const LogConfiguration& config)
-  {
-    if (config.impl()->fname().empty())
+    if (config.async())
     {
-      if (config.impl()->logport() != 0)
-      {
-        _appender = new UdpAppender(config.impl()->loghost(), config.impl()->logport(), config.impl()->broadcast());
-      }
+      bool drop = config.overflowPolicy() == LogConfiguration::DropOnOverflow;
+      if (_async == 0)
+        _async = new AsyncLog(_appender, config.asyncBufferSize(), drop);
       else
-      {
-        _appender = new FdAppender(config.impl()->tostdout() ? STDOUT_FILENO : STDERR_FILENO);
-      }
-    }
-    else if (config.impl()->maxfilesize() == 0)
-    {
-      _appender = new FileAppender(config.impl()->fname());
-    }
-    else
-    {
-      _appender = new RollingFileAppender(config.impl()->fname(), config.impl()->maxfilesize(), config.impl()->maxbackupindex());
+        _async->configure(config.asyncBufferSize(), drop);
     }
 
-    _config = config;
+    atomicSet(_asyncEnabled, config.async());
 
     for (Loggers::iterator it = _loggers.begin(); it != _loggers.end(); ++it)
       it->second->setLogLevel(logLevel(it->second->getCategory()));
@@ -844,10 +1442,62 @@ namespace cxxtools
 
   LogManager::Impl::~Impl()
   {
+    delete _async;
     for (Loggers::iterator it = _loggers.begin(); it != _loggers.end(); ++it)
       delete it->second;
   }
 
+  void LogManager::Impl::putMessage(const char* level, const std::string& category, const char* state, const std::string& msg)
+  {
+    if (atomicGet(_asyncEnabled))
+    {
+      // shutdown waits, until no thread uses _async any more
+      ScopedAtomicIncrementer users(_asyncUsers);
+      if (atomicGet(_asyncEnabled))
+      {
+        _async->put(level, category, state, msg);
+        return;
+      }
+    }
+
+    ScopedAtomicIncrementer inc(mutexWaitCount);
+    MutexLock lock(logMutex);
+
+    if (!LogManager::isEnabled())
+      return;
+
+    std::string entry;
+    logentry(entry, level, category, syncDateCache);
+    if (state)
+      entry += state;
+    entry += msg;
+
+    _appender->putMessage(entry);
+    _appender->finish((atomicGet(mutexWaitCount) <= 1));
+  }
+
+  void LogManager::Impl::flush()
+  {
+    if (atomicGet(_asyncEnabled))
+    {
+      ScopedAtomicIncrementer users(_asyncUsers);
+      if (atomicGet(_asyncEnabled))
+        _async->flush();
+    }
+  }
+
+  void LogManager::Impl::shutdown()
+  {
+    // new messages are written synchronously from now on; the threads,
+    // which already passed the check, finish their message first
+    atomicSet(_asyncEnabled, 0);
+    while (atomicGet(_asyncUsers) > 0)
+      Thread::yield();
+
+    delete _async;
+    _async = 0;
+  }
+
   //////////////////////////////////////////////////////////////////////
   // LogManager
   //
@@ -861,6 +1511,10 @@ namespace cxxtools
 
   LogManager::~LogManager()
   {
+    // the background thread needs the log mutex for writing the rest
+    if (_impl)
+      _impl->shutdown();
+
     MutexLock lock(logMutex);
     delete _impl;
     _enabled = false;
@@ -945,6 +1599,10 @@ namespace cxxtools
 
   void LogManager::configure(const LogConfiguration& config)
   {
+    // write pending messages to the old destination
+    if (_impl)
+      _impl->flush();
+
     MutexLock lock(logMutex);
 
     _enabled = false;
@@ -972,6 +1630,17 @@ namespace cxxtools
     return _impl->logLevel(category);
   }
 
+  void LogManager::flush()
+  {
+    if (_impl)
+      _impl->flush();
+  }
+
+  unsigned long LogManager::droppedMessages() const
+  {
+    return _impl ? _impl->droppedMessages() : 0;
+  }
+
   Logger* LogManager::getLogger(const std::string& category)
   {
     if (_impl == 0)
@@ -1069,19 +1738,8 @@ namespace cxxtools
   {
     try
     {
-      ScopedAtomicIncrementer inc(mutexWaitCount);
-      MutexLock lock(logMutex);
-
-      if (!LogManager::isEnabled())
-        return;
-
-      std::string msg;
-      logentry(msg, _level, _logger->getCategory());
-      msg += _msg.str();
-
-      LogAppender& appender = LogManager::getInstance().impl()->appender();
-      appender.putMessage(msg);
-      appender.finish((atomicGet(mutexWaitCount) <= 1));
+      if (LogManager::isEnabled())
+        LogManager::getInstance().impl()->putMessage(_level, _logger->getCategory(), 0, _msg.str());
     }
     catch (const std::exception&)
     {
@@ -1174,20 +1832,8 @@ namespace cxxtools
   {
     try
     {
-      ScopedAtomicIncrementer inc(mutexWaitCount);
-      MutexLock lock(logMutex);
-
-      if (!LogManager::isEnabled())
-        return;
-
-      std::string msg;
-      logentry(msg, "TRACE", _logger->getCategory());
-      msg += state;
-      msg += _msg.str();
-
-      LogAppender& appender = LogManager::getInstance().impl()->appender();
-      appender.putMessage(msg);
-      appender.finish((atomicGet(mutexWaitCount) <= 1));
+      if (LogManager::isEnabled())
+        LogManager::getInstance().impl()->putMessage("TRACE", _logger->getCategory(), state, _msg.str());
     }
     catch (const std::exception&)
     {
@@ -0,0 +1,343 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/poolallocator.h"
+#include "cxxtools/mutex.h"
+#include <vector>
+#include <pthread.h>
+
+namespace cxxtools
+{
+    namespace
+    {
+        enum {
+            Classes = PoolAllocator::MaxSize / PoolAllocator::Granularity,
+            BatchSize = 32,          // blocks moved between thread and depot at once
+            ChunkSize = 64 * 1024
+        };
+
+        struct Block
+        {
+            Block* next;
+        };
+
+        struct FreeList
+        {
+            Block* head;
+            unsigned count;
+
+            FreeList()
+                : head(0),
+                  count(0)
+                { }
+
+            void push(Block* b)
+            {
+                b->next = head;
+                head = b;
+                ++count;
+            }
+
+            Block* pop()
+            {
+                Block* b = head;
+                head = b->next;
+                --count;
+                return b;
+            }
+        };
+
+        inline unsigned sizeClass(std::size_t size)
+        {
+            return size == 0 ? 0 : static_cast<unsigned>((size - 1) / PoolAllocator::Granularity);
+        }
+
+        inline std::size_t classSize(unsigned c)
+        {
+            return (c + 1) * PoolAllocator::Granularity;
+        }
+
+        pthread_once_t globalOnce = PTHREAD_ONCE_INIT;
+        PoolAllocator* globalAllocator = 0;
+
+        void createGlobal()
+        {
+            globalAllocator = new PoolAllocator();
+        }
+    }
+
+    class PoolAllocatorImpl
+    {
+            // The free lists of one thread. The counters are only written by
+            // the owning thread.
+            struct ThreadCache
+            {
+                explicit ThreadCache(PoolAllocatorImpl* impl_)
+                    : impl(impl_)
+                    { }
+
+                PoolAllocatorImpl* impl;
+                FreeList lists[Classes];
+                PoolAllocator::Stats stats;
+            };
+
+            pthread_key_t _key;
+
+            // protects all members below
+            mutable Mutex _mutex;
+            std::vector<ThreadCache*> _caches;
+            PoolAllocator::Stats _retired;   // counters of terminated threads
+
+            std::vector<FreeList> _depot[Classes];
+            std::vector<char*> _chunks;
+            char* _chunkPos;
+            std::size_t _chunkLeft;
+
+            static void releaseCache(void* cache);
+
+            ThreadCache* cache();
+            void refill(ThreadCache* cache, unsigned c);
+            void flush(ThreadCache* cache, unsigned c);
+            void release(ThreadCache* cache);
+
+        public:
+            PoolAllocatorImpl();
+            ~PoolAllocatorImpl();
+
+            void* allocate(std::size_t size)
+            {
+                ThreadCache* c = cache();
+                ++c->stats.allocations;
+
+                if (size > PoolAllocator::MaxSize)
+                {
+                    ++c->stats.largeAllocations;
+                    return operator new(size);
+                }
+
+                unsigned n = sizeClass(size);
+                FreeList& l = c->lists[n];
+                if (l.head == 0)
+                    refill(c, n);
+
+                return l.pop();
+            }
+
+            void deallocate(void* p, std::size_t size)
+            {
+                if (p == 0)
+                    return;
+
+                ThreadCache* c = cache();
+                ++c->stats.deallocations;
+
+                if (size > PoolAllocator::MaxSize)
+                {
+                    operator delete(p);
+                    return;
+                }
+
+                unsigned n = sizeClass(size);
+                FreeList& l = c->lists[n];
+                l.push(static_cast<Block*>(p));
+                if (l.count >= 2 * BatchSize)
+                    flush(c, n);
+            }
+
+            PoolAllocator::Stats stats() const;
+    };
+
+    PoolAllocatorImpl::PoolAllocatorImpl()
+        : _chunkPos(0),
+          _chunkLeft(0)
+    {
+        pthread_key_create(&_key, &PoolAllocatorImpl::releaseCache);
+    }
+
+    PoolAllocatorImpl::~PoolAllocatorImpl()
+    {
+        pthread_key_delete(_key);
+
+        for (std::vector<ThreadCache*>::iterator it = _caches.begin(); it != _caches.end(); ++it)
+            delete *it;
+
+        for (std::vector<char*>::iterator it = _chunks.begin(); it != _chunks.end(); ++it)
+            delete[] *it;
+    }
+
+    void PoolAllocatorImpl::releaseCache(void* cache)
+    {
+        ThreadCache* c = static_cast<ThreadCache*>(cache);
+        c->impl->release(c);
+    }
+
+    PoolAllocatorImpl::ThreadCache* PoolAllocatorImpl::cache()
+    {
+        ThreadCache* c = static_cast<ThreadCache*>(pthread_getspecific(_key));
+        if (c == 0)
+        {
+            c = new ThreadCache(this);
+
+            MutexLock lock(_mutex);
+            _caches.push_back(c);
+            pthread_setspecific(_key, c);
+        }
+
+        return c;
+    }
+
+    void PoolAllocatorImpl::refill(ThreadCache* cache, unsigned c)
+    {
+        FreeList& l = cache->lists[c];
+
+        MutexLock lock(_mutex);
+
+        ++cache->stats.refills;
+
+        if (!_depot[c].empty())
+        {
+            l = _depot[c].back();
+            _depot[c].pop_back();
+            return;
+        }
+
+        std::size_t size = classSize(c);
+        std::size_t batch = size * BatchSize;
+        if (_chunkLeft < batch)
+        {
+            // the rest of the old chunk is lost
+            std::size_t chunkSize = batch > ChunkSize ? batch : ChunkSize;
+            _chunks.reserve(_chunks.size() + 1);
+            _chunkPos = new char[chunkSize];
+            _chunkLeft = chunkSize;
+            _chunks.push_back(_chunkPos);
+            ++cache->stats.chunks;
+            cache->stats.reserved += chunkSize;
+        }
+
+        for (unsigned n = 0; n < BatchSize; ++n)
+        {
+            l.push(reinterpret_cast<Block*>(_chunkPos));
+            _chunkPos += size;
+        }
+
+        _chunkLeft -= batch;
+    }
+
+    void PoolAllocatorImpl::flush(ThreadCache* cache, unsigned c)
+    {
+        FreeList& l = cache->lists[c];
+
+        FreeList batch;
+        while (batch.count < BatchSize)
+            batch.push(l.pop());
+
+        MutexLock lock(_mutex);
+        ++cache->stats.flushes;
+        _depot[c].push_back(batch);
+    }
+
+    void PoolAllocatorImpl::release(ThreadCache* cache)
+    {
+        MutexLock lock(_mutex);
+
+        for (unsigned c = 0; c < Classes; ++c)
+            if (cache->lists[c].count > 0)
+                _depot[c].push_back(cache->lists[c]);
+
+        const PoolAllocator::Stats& s = cache->stats;
+        _retired.allocations += s.allocations;
+        _retired.deallocations += s.deallocations;
+        _retired.largeAllocations += s.largeAllocations;
+        _retired.refills += s.refills;
+        _retired.flushes += s.flushes;
+        _retired.chunks += s.chunks;
+        _retired.reserved += s.reserved;
+
+        for (std::vector<ThreadCache*>::iterator it = _caches.begin(); it != _caches.end(); ++it)
+        {
+            if (*it == cache)
+            {
+                _caches.erase(it);
+                break;
+            }
+        }
+
+        delete cache;
+    }
+
+    PoolAllocator::Stats PoolAllocatorImpl::stats() const
+    {
+        MutexLock lock(_mutex);
+
+        PoolAllocator::Stats result = _retired;
+        for (std::vector<ThreadCache*>::const_iterator it = _caches.begin(); it != _caches.end(); ++it)
+        {
+            const PoolAllocator::Stats& s = (*it)->stats;
+            result.allocations += s.allocations;
+            result.deallocations += s.deallocations;
+            result.largeAllocations += s.largeAllocations;
+            result.refills += s.refills;
+            result.flushes += s.flushes;
+            result.chunks += s.chunks;
+            result.reserved += s.reserved;
+        }
+
+        return result;
+    }
+
+    PoolAllocator::PoolAllocator()
+        : _impl(new PoolAllocatorImpl())
+    {
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        delete _impl;
+    }
+
+    void* PoolAllocator::allocate(std::size_t size)
+    {
+        return _impl->allocate(size);
+    }
+
+    void PoolAllocator::deallocate(void* p, std::size_t size)
+    {
+        _impl->deallocate(p, size);
+    }
+
+    PoolAllocator::Stats PoolAllocator::stats() const
+    {
+        return _impl->stats();
+    }
+
+    PoolAllocator& PoolAllocator::global()
+    {
+        pthread_once(&globalOnce, createGlobal);
+        return *globalAllocator;
+    }
+}
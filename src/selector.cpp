@@ -24,21 +24,31 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 #include "selectorimpl.h"
+#include "timerwheel.h"
 #include "cxxtools/selector.h"
 #include "cxxtools/timer.h"
 #include "cxxtools/clock.h"
 
 namespace cxxtools {
 
+namespace
+{
+    // The timer wheel is kept in the reserved pointer, so that the layout
+    // of SelectorBase is not changed.
+    inline TimerWheel& timerWheel(void* reserved)
+    { return *static_cast<TimerWheel*>(reserved); }
+}
+
 const std::size_t SelectorBase::WaitInfinite;
 
 SelectorBase::~SelectorBase()
 {
-    while( _timers.size() )
+    while( Timer* timer = timerWheel(_reserved).any() )
     {
-       Timer* timer = _timers.begin()->second;
         timer->setSelector(0);
     }
+
+    delete static_cast<TimerWheel*>(_reserved);
 }
 
 
@@ -68,28 +78,30 @@ void SelectorBase::remove( Timer& timer )
 }
 
 
+void SelectorBase::setTimerResolution(const Timespan& resolution)
+{
+    timerWheel(_reserved).setResolution(resolution);
+}
+
+
+const Timespan& SelectorBase::timerResolution() const
+{
+    return timerWheel(_reserved).resolution();
+}
+
+
 void SelectorBase::onAddTimer(Timer& timer)
 {
     if( timer.active() )
     {
-        TimerMap::value_type elem(timer.finished(), &timer);
-        _timers.insert(elem);
-        //_timers.insert( std::make_pair(timer.finished(), &timer) );
+        timerWheel(_reserved).add(timer);
     }
 }
 
 
 void SelectorBase::onRemoveTimer( Timer& timer )
 {
-    std::multimap<Timespan, Timer*>::iterator it;
-    for(it = _timers.begin(); it != _timers.end(); ++it)
-    {
-        if(it->second == &timer)
-        {
-            _timers.erase(it);
-            return;
-        }
-    }
+    timerWheel(_reserved).remove(timer);
 }
 
 
@@ -97,48 +109,29 @@ void SelectorBase::onTimerChanged(Timer& timer)
 {
     if( timer.active() )
     {
-        TimerMap::value_type elem(timer.finished(), &timer);
-        _timers.insert(elem);
-        //_timers.insert( std::make_pair(timer.finished(), &timer) );
+        timerWheel(_reserved).add(timer);
     }
     else
     {
-        SelectorBase::onRemoveTimer(timer);
+        timerWheel(_reserved).remove(timer);
     }
 }
 
 
 bool SelectorBase::updateTimer(std::size_t& lowestTimeout)
 {
-    if( _timers.empty() )
+    if( timerWheel(_reserved).empty() )
         return false;
 
     Timespan now = Clock::getSystemTicks();
-    Timer* timer = _timers.begin()->second;
-    bool timerActive = now >= timer->finished();
+    bool timerActive = timerWheel(_reserved).expire(now);
 
-    while( ! _timers.empty() )
+    Timespan remaining;
+    if( timerWheel(_reserved).nextTimeout(now, remaining) )
     {
-        timer = _timers.begin()->second;
-
-        if( now < timer->finished() )
-        {
-            int64_t remaining = (timer->finished() - now).toUSecs();
-            lowestTimeout = (remaining / 1000);
-            if(remaining % 1000 > 0) ++lowestTimeout;
-            break;
-        }
-
-        timer->update(now);
-
-        if( ! _timers.empty() )
-        {
-            timer = _timers.begin()->second;
-            _timers.erase( _timers.begin() );
-            TimerMap::value_type elem(timer->finished(), timer);
-            _timers.insert(elem);
-            //_timers.insert( std::make_pair(timer->finished(), timer) );
-        }
+        int64_t usecs = remaining.totalUSecs();
+        lowestTimeout = (usecs / 1000);
+        if(usecs % 1000 > 0) ++lowestTimeout;
     }
 
     return timerActive;
@@ -186,6 +179,7 @@ void SelectorBase::wake()
 
 
 SelectorBase::SelectorBase()
+: _reserved(new TimerWheel())
 {}
 
 
@@ -26,6 +26,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include "config.h"
 #include "selectorimpl.h"
 #include "selectableimpl.h"
 #include "cxxtools/ioerror.h"
@@ -33,6 +34,8 @@
 #include "cxxtools/selector.h"
 #include "cxxtools/log.h"
 #include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <unistd.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -40,15 +43,63 @@
 #include <iostream>
 #include <limits>
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 log_define("cxxtools.selector.impl")
 
 namespace cxxtools
 {
 
+namespace
+{
+#ifdef HAVE_SYS_EPOLL_H
+    // maximum number of events fetched by a single epoll_wait call
+    const int maxEpollEvents = 256;
+
+    uint32_t toEpollEvents(short events)
+    {
+        uint32_t ret = 0;
+        if (events & POLLIN)
+            ret |= EPOLLIN;
+        if (events & POLLPRI)
+            ret |= EPOLLPRI;
+        if (events & POLLOUT)
+            ret |= EPOLLOUT;
+        return ret;
+    }
+
+    short fromEpollEvents(uint32_t events)
+    {
+        short ret = 0;
+        if (events & EPOLLIN)
+            ret |= POLLIN;
+        if (events & EPOLLPRI)
+            ret |= POLLPRI;
+        if (events & EPOLLOUT)
+            ret |= POLLOUT;
+        if (events & EPOLLERR)
+            ret |= POLLERR;
+        if (events & EPOLLHUP)
+            ret |= POLLHUP;
+        return ret;
+    }
+
+    // The environment variable CXXTOOLS_SELECTOR=poll disables epoll.
+    bool epollEnabled()
+    {
+        const char* selector = ::getenv("CXXTOOLS_SELECTOR");
+        return selector == 0 || std::strcmp(selector, "poll") != 0;
+    }
+#endif
+}
+
 const short SelectorImpl::POLL_ERROR_MASK= POLLERR | POLLHUP | POLLNVAL;
 
 SelectorImpl::SelectorImpl()
-: _isDirty(true)
+: _isDirty(true),
+  _epollFd(-1)
 {
     _current = _devices.end();
 
@@ -72,6 +123,33 @@ SelectorImpl::SelectorImpl()
     if(-1 == ret)
         throwSystemError("fcntl");
 
+#ifdef HAVE_SYS_EPOLL_H
+    if (epollEnabled())
+    {
+        _epollFd = ::epoll_create(1024);
+        if (_epollFd < 0)
+        {
+            log_warn("epoll_create failed with errno " << errno << "; using poll");
+        }
+        else
+        {
+            ::fcntl(_epollFd, F_SETFD, FD_CLOEXEC);
+
+            epoll_event ev;
+            std::memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.fd = _wakePipe[0];
+            if (::epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakePipe[0], &ev) != 0)
+            {
+                log_warn("failed to register wake pipe with epoll; errno " << errno << "; using poll");
+                ::close(_epollFd);
+                _epollFd = -1;
+            }
+        }
+    }
+#endif
+
+    log_debug("selector uses " << (_epollFd >= 0 ? "epoll" : "poll"));
 }
 
 
@@ -84,6 +162,12 @@ SelectorImpl::~SelectorImpl()
         (*it)->setSelector(0);
     }
 
+    for (std::vector<Registration*>::iterator it = _garbage.begin(); it != _garbage.end(); ++it)
+        delete *it;
+
+    if (_epollFd >= 0)
+        ::close(_epollFd);
+
     if( _wakePipe[0] != -1 && _wakePipe[1] != -1 )
     {
         ::close(_wakePipe[0]);
@@ -96,6 +180,9 @@ void SelectorImpl::add(Selectable& dev)
 {
     _devices.insert(&dev);
     _isDirty = true;
+
+    if (_epollFd >= 0)
+        addEpoll(dev);
 }
 
 
@@ -119,6 +206,9 @@ void SelectorImpl::remove(Selectable& dev)
     }
 
     _isDirty = true;
+
+    if (_epollFd >= 0)
+        removeEpoll(dev);
 }
 
 
@@ -132,6 +222,14 @@ void SelectorImpl::changed( Selectable& s )
     {
         _avail.erase(&s);
     }
+
+    if (_epollFd >= 0)
+    {
+        // the device may have modified the events of its pollfds
+        Registrations::iterator it = _registrations.find(&s);
+        if (it != _registrations.end())
+            markDirty(it->second);
+    }
 }
 
 
@@ -141,6 +239,13 @@ bool SelectorImpl::wait(std::size_t umsecs)
 
     umsecs = _avail.size() ? 0 : umsecs;
 
+    return _epollFd >= 0 ? waitEpoll(umsecs)
+                         : waitPoll(umsecs);
+}
+
+
+int SelectorImpl::pollTimeout(std::size_t umsecs)
+{
     int msecs = umsecs;
     if (umsecs != SelectorBase::WaitInfinite &&
         umsecs > static_cast<std::size_t>(std::numeric_limits<int>::max()))
@@ -148,6 +253,44 @@ bool SelectorImpl::wait(std::size_t umsecs)
         msecs = std::numeric_limits<int>::max();
     }
 
+    return msecs;
+}
+
+
+bool SelectorImpl::readWakePipe()
+{
+    bool avail = false;
+
+    static char buffer[1024];
+    while(true)
+    {
+        int ret = ::read(_wakePipe[0], buffer, sizeof(buffer));
+        if(ret > 0)
+        {
+            avail = true;
+            continue;
+        }
+
+        if (ret == -1)
+        {
+            if(errno == EINTR)
+                continue;
+
+            if(errno == EAGAIN)
+                break;
+        }
+
+        throw IOError("Could not read from pipe");
+    }
+
+    return avail;
+}
+
+
+bool SelectorImpl::waitPoll(std::size_t umsecs)
+{
+    int msecs = pollTimeout(umsecs);
+
     if (_isDirty)
     {
         _pollfds.clear();
@@ -235,27 +378,8 @@ bool SelectorImpl::wait(std::size_t umsecs)
                 throw IOError("poll error on event pipe");
             }
 
-            static char buffer[1024];
-            while(true)
-            {
-                int ret = ::read(_wakePipe[0], buffer, sizeof(buffer));
-                if(ret > 0)
-                {
-                    avail = true;
-                    continue;
-                }
-
-                if (ret == -1)
-                {
-                    if(errno == EINTR)
-                        continue;
-
-                    if(errno == EAGAIN)
-                        break;
-                }
-
-                throw IOError("Could not read from pipe");
-            }
+            if (readWakePipe())
+                avail = true;
         }
 
         for( _current = _devices.begin(); _current != _devices.end(); )
@@ -286,6 +410,342 @@ bool SelectorImpl::wait(std::size_t umsecs)
 }
 
 
+#ifdef HAVE_SYS_EPOLL_H
+
+void SelectorImpl::addEpoll(Selectable& dev)
+{
+    if (_registrations.find(&dev) != _registrations.end())
+        return;
+
+    // The pollfds are initialized in the next wait call like in
+    // the poll implementation.
+    Registration* reg = new Registration(&dev);
+    _registrations[&dev] = reg;
+    markDirty(reg);
+}
+
+
+void SelectorImpl::removeEpoll(Selectable& dev)
+{
+    Registrations::iterator it = _registrations.find(&dev);
+    if (it == _registrations.end())
+        return;
+
+    Registration* reg = it->second;
+    _registrations.erase(it);
+
+    unregisterEpoll(reg);
+
+    // The registration may still be referenced by the dirty or ready list,
+    // so it is released in the next wait call.
+    reg->device = 0;
+    _garbage.push_back(reg);
+}
+
+
+void SelectorImpl::markDirty(Registration* reg)
+{
+    if (!reg->dirty)
+    {
+        reg->dirty = true;
+        _dirty.push_back(reg);
+    }
+}
+
+
+void SelectorImpl::unregisterEpoll(Registration* reg)
+{
+    for (std::size_t n = 0; n < reg->fds.size(); ++n)
+    {
+        int fd = reg->fds[n];
+        if (fd < 0)
+            continue;
+
+        // The fd number may already be reused by another device, when
+        // this device closed it.
+        if (static_cast<std::size_t>(fd) < _fdSlots.size()
+            && _fdSlots[fd].reg == reg)
+        {
+            // The file descriptor is typically already closed, which removes
+            // it from the epoll set implicitly, so errors are expected here.
+            epoll_event ev;
+            std::memset(&ev, 0, sizeof(ev));
+            ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, &ev);
+            _fdSlots[fd] = FdSlot();
+        }
+
+        reg->fds[n] = -1;
+    }
+}
+
+
+void SelectorImpl::syncEpoll(Registration* reg, bool force)
+{
+    Selectable* dev = reg->device;
+    if (dev == 0)
+        return;
+
+    std::size_t pollSize = dev->simpl().pollSize();
+    if (pollSize != reg->pfds.size())
+    {
+        // the device is new or the number of its file descriptors changed
+        unregisterEpoll(reg);
+
+        pollfd pfd;
+        pfd.fd = -1;
+        pfd.events = 0;
+        pfd.revents = 0;
+
+        reg->pfds.assign(pollSize, pfd);
+        reg->fds.assign(pollSize, -1);
+        reg->events.assign(pollSize, 0);
+
+        if (pollSize > 0)
+            dev->simpl().initializePoll(&reg->pfds[0], pollSize);
+    }
+
+    for (std::size_t n = 0; n < reg->pfds.size(); ++n)
+    {
+        const pollfd& pfd = reg->pfds[n];
+
+        if (pfd.fd == reg->fds[n] && pfd.events == reg->events[n] && !force)
+            continue;
+
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = toEpollEvents(pfd.events);
+        ev.data.fd = pfd.fd;
+
+        int oldFd = reg->fds[n];
+        if (oldFd >= 0 && oldFd != pfd.fd
+            && static_cast<std::size_t>(oldFd) < _fdSlots.size()
+            && _fdSlots[oldFd].reg == reg)
+        {
+            ::epoll_ctl(_epollFd, EPOLL_CTL_DEL, oldFd, &ev);
+            _fdSlots[oldFd] = FdSlot();
+        }
+
+        reg->fds[n] = pfd.fd;
+        reg->events[n] = pfd.events;
+
+        if (pfd.fd < 0)
+            continue;
+
+        int op = oldFd == pfd.fd ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        int ret = ::epoll_ctl(_epollFd, op, pfd.fd, &ev);
+        if (ret != 0 && op == EPOLL_CTL_MOD && errno == ENOENT)
+        {
+            // the file descriptor was closed and reopened with the same number
+            ret = ::epoll_ctl(_epollFd, EPOLL_CTL_ADD, pfd.fd, &ev);
+        }
+        else if (ret != 0 && op == EPOLL_CTL_ADD && errno == EEXIST)
+        {
+            ret = ::epoll_ctl(_epollFd, EPOLL_CTL_MOD, pfd.fd, &ev);
+        }
+
+        if (ret != 0)
+        {
+            log_warn("epoll_ctl failed for fd " << pfd.fd << "; errno " << errno);
+            reg->fds[n] = -1;
+            continue;
+        }
+
+        if (static_cast<std::size_t>(pfd.fd) >= _fdSlots.size())
+            _fdSlots.resize(pfd.fd + 1);
+
+        _fdSlots[pfd.fd].reg = reg;
+        _fdSlots[pfd.fd].idx = n;
+    }
+}
+
+
+bool SelectorImpl::waitEpoll(std::size_t umsecs)
+{
+    int msecs = pollTimeout(umsecs);
+
+    // apply the changes made since the last call
+    for (std::vector<Registration*>::size_type n = 0; n < _dirty.size(); ++n)
+    {
+        Registration* reg = _dirty[n];
+        reg->dirty = false;
+        syncEpoll(reg);
+    }
+
+    _dirty.clear();
+
+    for (std::vector<Registration*>::iterator it = _garbage.begin(); it != _garbage.end(); ++it)
+        delete *it;
+
+    _garbage.clear();
+
+    epoll_event events[maxEpollEvents];
+
+    int ret = -1;
+    while( true )
+    {
+        if(umsecs != SelectorBase::WaitInfinite)
+        {
+            int64_t diff = _clock.stop().totalMSecs();
+            _clock.start();
+
+            if (diff < msecs)
+            {
+                msecs -= int(diff);
+            }
+            else
+            {
+                msecs = 0;
+            }
+        }
+
+        log_debug("epoll_wait with " << _registrations.size() << " devices, timeout=" << msecs << "ms");
+        ret = ::epoll_wait(_epollFd, events, maxEpollEvents, msecs);
+        log_debug("epoll_wait returns " << ret);
+        if( ret != -1 )
+            break;
+
+        if( errno != EINTR )
+            throw IOError("Could not poll on file descriptors");
+    }
+
+    if( ret == 0 && _avail.empty() )
+        return false;
+
+    bool avail = false;
+
+    // collect the ready devices first, so that devices may be added or
+    // removed while the events are dispatched
+    for (int n = 0; n < ret; ++n)
+    {
+        int fd = events[n].data.fd;
+
+        if (fd == _wakePipe[0])
+        {
+            if (events[n].events & (EPOLLERR | EPOLLHUP))
+                throw IOError("poll error on event pipe");
+
+            if (readWakePipe())
+                avail = true;
+
+            continue;
+        }
+
+        if (fd < 0 || static_cast<std::size_t>(fd) >= _fdSlots.size())
+            continue;
+
+        const FdSlot& slot = _fdSlots[fd];
+        Registration* reg = slot.reg;
+        if (reg == 0 || reg->device == 0)
+            continue;
+
+        pollfd& pfd = reg->pfds[slot.idx];
+        pfd.revents = fromEpollEvents(events[n].events) & (pfd.events | POLL_ERROR_MASK);
+
+        if (pfd.revents == 0)
+        {
+            // registered events are outdated
+            markDirty(reg);
+            continue;
+        }
+
+        if (!reg->ready)
+        {
+            reg->ready = true;
+            _ready.push_back(reg);
+        }
+    }
+
+    // devices, which have data available without polling
+    for (std::set<Selectable*>::iterator it = _avail.begin(); it != _avail.end(); ++it)
+    {
+        Registrations::iterator r = _registrations.find(*it);
+        if (r != _registrations.end() && !r->second->ready)
+        {
+            r->second->ready = true;
+            _ready.push_back(r->second);
+        }
+    }
+
+    try
+    {
+        for (std::vector<Registration*>::size_type n = 0; n < _ready.size(); ++n)
+        {
+            Registration* reg = _ready[n];
+            reg->ready = false;
+
+            Selectable* dev = reg->device;
+            if (dev == 0 || !dev->enabled())
+                continue;
+
+            bool error = false;
+            for (std::size_t i = 0; i < reg->pfds.size(); ++i)
+            {
+                if (reg->pfds[i].revents & POLL_ERROR_MASK)
+                    error = true;
+            }
+
+            if (dev->simpl().checkPollEvent())
+                avail = true;
+
+            if (reg->device == 0)
+                continue;
+
+            for (std::size_t i = 0; i < reg->pfds.size(); ++i)
+                reg->pfds[i].revents = 0;
+
+            // The device may have modified its pollfds while handling the
+            // event. After an error it may even have replaced its file
+            // descriptor by a new one with the same number (e.g. when
+            // connecting to the next address), so the registration is renewed.
+            if (error)
+                syncEpoll(reg, true);
+            else
+                markDirty(reg);
+        }
+    }
+    catch (...)
+    {
+        for (std::vector<Registration*>::size_type n = 0; n < _ready.size(); ++n)
+        {
+            _ready[n]->ready = false;
+            for (std::size_t i = 0; i < _ready[n]->pfds.size(); ++i)
+                _ready[n]->pfds[i].revents = 0;
+        }
+
+        _ready.clear();
+        throw;
+    }
+
+    _ready.clear();
+
+    return avail;
+}
+
+#else
+
+void SelectorImpl::addEpoll(Selectable&)
+{ }
+
+void SelectorImpl::removeEpoll(Selectable&)
+{ }
+
+void SelectorImpl::markDirty(Registration*)
+{ }
+
+void SelectorImpl::syncEpoll(Registration*, bool)
+{ }
+
+void SelectorImpl::unregisterEpoll(Registration*)
+{ }
+
+bool SelectorImpl::waitEpoll(std::size_t umsecs)
+{
+    return waitPoll(umsecs);
+}
+
+#endif
+
+
 void SelectorImpl::wake()
 {
     ::write( _wakePipe[1], "W", 1);
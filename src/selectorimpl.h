@@ -35,6 +35,7 @@
 #include <sys/poll.h>
 #include <vector>
 #include <set>
+#include <map>
 
 namespace cxxtools {
 
@@ -56,6 +57,60 @@ class SelectorImpl
         void wake();
 
     private:
+        //! @internal epoll registration of a single Selectable
+        struct Registration
+        {
+            explicit Registration(Selectable* dev)
+            : device(dev),
+              dirty(false),
+              ready(false)
+            { }
+
+            Selectable* device;
+
+            // pollfds passed to the device in initializePoll
+            std::vector<pollfd> pfds;
+
+            // file descriptors and events currently registered with epoll
+            std::vector<int> fds;
+            std::vector<short> events;
+
+            bool dirty;
+            bool ready;
+        };
+
+        //! @internal maps a file descriptor to its registration
+        struct FdSlot
+        {
+            FdSlot()
+            : reg(0),
+              idx(0)
+            { }
+
+            Registration* reg;
+            std::size_t idx;
+        };
+
+        typedef std::map<Selectable*, Registration*> Registrations;
+
+        int pollTimeout(std::size_t umsecs);
+
+        bool readWakePipe();
+
+        bool waitPoll(std::size_t umsecs);
+
+        bool waitEpoll(std::size_t umsecs);
+
+        void addEpoll(Selectable& dev);
+
+        void removeEpoll(Selectable& dev);
+
+        void markDirty(Registration* reg);
+
+        void syncEpoll(Registration* reg, bool force = false);
+
+        void unregisterEpoll(Registration* reg);
+
         static const short POLL_ERROR_MASK;
         int _wakePipe[2];
         bool _isDirty;
@@ -64,6 +119,14 @@ class SelectorImpl
         std::set<Selectable*> _devices;
         std::set<Selectable*> _avail;
         Clock _clock;
+
+        // epoll backend; _epollFd is -1 when poll is used
+        int _epollFd;
+        Registrations _registrations;
+        std::vector<FdSlot> _fdSlots;
+        std::vector<Registration*> _dirty;
+        std::vector<Registration*> _ready;
+        std::vector<Registration*> _garbage;
 };
 
 }//namespace xpr
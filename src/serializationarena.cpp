@@ -0,0 +1,176 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cxxtools/serializationarena.h>
+#include <new>
+
+namespace cxxtools
+{
+    namespace
+    {
+        const std::string emptyName;
+
+        std::size_t hashName(const std::string& s)
+        {
+            // FNV-1a
+            std::size_t h = 2166136261u;
+            for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+            {
+                h ^= static_cast<unsigned char>(*it);
+                h *= 16777619u;
+            }
+            return h;
+        }
+    }
+
+    SerializationArena::SerializationArena(std::size_t blockSize)
+        : _blockSize(blockSize),
+          _ptr(0),
+          _avail(0),
+          _bytesUsed(0),
+          _nameCount(0)
+    { }
+
+    SerializationArena::~SerializationArena()
+    {
+        release();
+        if (!_blocks.empty())
+            delete[] _blocks[0];
+    }
+
+    void* SerializationArena::allocate(std::size_t size, std::size_t align)
+    {
+        std::size_t pad = reinterpret_cast<std::size_t>(_ptr) & (align - 1);
+        if (pad)
+            pad = align - pad;
+
+        if (pad + size > _avail)
+        {
+            // large requests get a block of their own, so that the rest
+            // of the current block is not wasted
+            if (size + align > _blockSize / 4)
+            {
+                char* block = new char[size + align];
+                _largeBlocks.push_back(block);
+                _bytesUsed += size;
+                std::size_t p = reinterpret_cast<std::size_t>(block);
+                return block + ((align - (p & (align - 1))) & (align - 1));
+            }
+
+            char* block = new char[_blockSize];
+            _blocks.push_back(block);
+            _ptr = block;
+            _avail = _blockSize;
+            pad = reinterpret_cast<std::size_t>(_ptr) & (align - 1);
+            if (pad)
+                pad = align - pad;
+        }
+
+        void* ret = _ptr + pad;
+        _ptr += pad + size;
+        _avail -= pad + size;
+        _bytesUsed += size;
+        return ret;
+    }
+
+    std::size_t SerializationArena::_findSlot(const std::string& s) const
+    {
+        std::size_t mask = _names.size() - 1;
+        std::size_t n = hashName(s) & mask;
+        while (_names[n] && *_names[n] != s)
+            n = (n + 1) & mask;
+        return n;
+    }
+
+    const std::string& SerializationArena::intern(const std::string& s)
+    {
+        if (s.empty())
+            return emptyName;
+
+        if ((_nameCount + 1) * 2 > _names.size())
+        {
+            std::vector<std::string*> names;
+            names.swap(_names);
+            _names.resize(names.empty() ? 64 : names.size() * 2);
+            for (std::vector<std::string*>::iterator it = names.begin(); it != names.end(); ++it)
+                if (*it)
+                    _names[_findSlot(**it)] = *it;
+        }
+
+        std::size_t n = _findSlot(s);
+        if (_names[n] == 0)
+        {
+            _names[n] = new std::string(s);
+            ++_nameCount;
+        }
+
+        return *_names[n];
+    }
+
+    const std::string* SerializationArena::find(const std::string& s) const
+    {
+        if (s.empty())
+            return &emptyName;
+
+        if (_nameCount == 0)
+            return 0;
+
+        return _names[_findSlot(s)];
+    }
+
+    void SerializationArena::release()
+    {
+        for (std::vector<std::string*>::iterator it = _names.begin(); it != _names.end(); ++it)
+            delete *it;
+        _names.clear();
+        _nameCount = 0;
+
+        for (std::vector<char*>::iterator it = _largeBlocks.begin(); it != _largeBlocks.end(); ++it)
+            delete[] *it;
+        _largeBlocks.clear();
+
+        // keep the first block, so that a reused arena does not allocate again
+        if (_blocks.size() > 1)
+        {
+            for (std::vector<char*>::iterator it = _blocks.begin() + 1; it != _blocks.end(); ++it)
+                delete[] *it;
+            _blocks.resize(1);
+        }
+
+        if (_blocks.empty())
+        {
+            _ptr = 0;
+            _avail = 0;
+        }
+        else
+        {
+            _ptr = _blocks[0];
+            _avail = _blockSize;
+        }
+
+        _bytesUsed = 0;
+    }
+}
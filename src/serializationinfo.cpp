@@ -30,74 +30,368 @@
 #include <cxxtools/serializationinfo.h>
 #include <stdexcept>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
 
 namespace cxxtools
 {
 
+namespace
+{
+    // objects with at least this number of members get a hash index
+    const std::size_t indexThreshold = 16;
+
+    inline std::size_t hashName(const std::string* name)
+    {
+        // names are interned, so the address identifies the name
+        std::size_t h = reinterpret_cast<std::size_t>(name) >> 4;
+        h *= 2654435761u;
+        return h ^ (h >> 15);
+    }
+}
+
+struct SerializationInfo::MemberIndex
+{
+    std::size_t* slots;   // index of the member + 1 or 0 for an empty slot
+    std::size_t mask;
+
+    void insert(const SerializationInfo* nodes, std::size_t idx)
+    {
+        const std::string* name = nodes[idx]._iname;
+        std::size_t n = hashName(name) & mask;
+        for ( ; slots[n]; n = (n + 1) & mask)
+        {
+            // keep the first member with that name
+            if (nodes[slots[n] - 1]._iname == name)
+                return;
+        }
+
+        slots[n] = idx + 1;
+    }
+
+    const SerializationInfo* find(const SerializationInfo* nodes, const std::string* name) const
+    {
+        for (std::size_t n = hashName(name) & mask; slots[n]; n = (n + 1) & mask)
+        {
+            if (nodes[slots[n] - 1]._iname == name)
+                return &nodes[slots[n] - 1];
+        }
+
+        return 0;
+    }
+};
+
+
 SerializationInfo::SerializationInfo()
 : _parent(0)
+, _arena(0)
 , _category(Void)
+, _iname(0)
+, _itype(0)
 , _t(t_none)
+, _nodes(0)
+, _nodeCount(0)
+, _nodeCapacity(0)
+, _index(0)
+{ }
+
+
+SerializationInfo::SerializationInfo(SerializationArena& arena)
+: _parent(0)
+, _arena(&arena)
+, _category(Void)
+, _iname(&arena.intern(std::string()))
+, _itype(_iname)
+, _t(t_none)
+, _nodes(0)
+, _nodeCount(0)
+, _nodeCapacity(0)
+, _index(0)
 { }
 
 
 SerializationInfo::SerializationInfo(const SerializationInfo& si)
 : _parent(si._parent)
-, _category(si._category)
-, _name(si._name)
-, _type(si._type)
-, _u(si._u)
-, _t(si._t)
-, _nodes(si._nodes)
+, _arena(0)
+, _category(Void)
+, _iname(0)
+, _itype(0)
+, _t(t_none)
+, _nodes(0)
+, _nodeCount(0)
+, _nodeCapacity(0)
+, _index(0)
 {
-    switch (_t)
-    {
-        case t_string:  new (_StringPtr()) String(si._String());
-                        break;
+    _assign(si);
+}
 
-        case t_string8: new (_String8Ptr()) std::string(si._String8());
-                        break;
 
-        default:
-            ;
+SerializationInfo::~SerializationInfo()
+{
+    // nodes in an arena hold no memory of their own
+    if (!_arena)
+    {
+        _releaseNodes();
+        _releaseValue();
     }
 }
 
 
 SerializationInfo& SerializationInfo::operator=(const SerializationInfo& si)
 {
+    if (this == &si)
+        return *this;
+
+    SerializationInfo* parent = si._parent;
+
+    _assign(si);
+
+    // nodes of a document keep their place in it
+    if (!_arena)
+        _parent = parent;
+
+    return *this;
+}
+
+
+void SerializationInfo::_assign(const SerializationInfo& si)
+{
+    // copy the members first, since si may be one of our own members
+    SerializationInfo* nodes = 0;
+    std::size_t count = si._nodeCount;
+    if (count > 0)
+    {
+        if (_arena)
+        {
+            nodes = static_cast<SerializationInfo*>(_arena->allocate(count * sizeof(SerializationInfo)));
+            for (std::size_t n = 0; n < count; ++n)
+            {
+                new (&nodes[n]) SerializationInfo(*_arena);
+                nodes[n]._assign(si._nodes[n]);
+            }
+        }
+        else
+        {
+            nodes = static_cast<SerializationInfo*>(::operator new(count * sizeof(SerializationInfo)));
+            std::size_t n = 0;
+            try
+            {
+                for ( ; n < count; ++n)
+                {
+                    new (&nodes[n]) SerializationInfo();
+                    nodes[n]._assign(si._nodes[n]);
+                }
+            }
+            catch (...)
+            {
+                for (std::size_t nn = 0; nn <= n && nn < count; ++nn)
+                    nodes[nn].~SerializationInfo();
+                ::operator delete(nodes);
+                throw;
+            }
+        }
+    }
+
+    setName(si.name());
+    setTypeName(si.typeName());
+
+    switch (si._t)
+    {
+        case t_string:   _setString(si._String());
+                         break;
+
+        case t_string8:  _setString8(si._String8());
+                         break;
+
+        case t_astring:  _setString(static_cast<const Char*>(si._u._a._data), si._u._a._length);
+                         break;
+
+        case t_astring8: _setString8(static_cast<const char*>(si._u._a._data), si._u._a._length);
+                         break;
+
+        default:         _releaseValue();
+                         _u = si._u;
+                         _t = si._t;
+    }
+
+    _category = si._category;
+
+    _releaseNodes();
+    _nodes = nodes;
+    _nodeCount = count;
+    _nodeCapacity = count;
+    _fixParents();
+
+    if (_arena && count >= indexThreshold)
+        _indexMember(count - 1);
+}
+
+
+void SerializationInfo::_releaseNodes()
+{
+    if (!_arena)
+    {
+        for (std::size_t n = 0; n < _nodeCount; ++n)
+            _nodes[n].~SerializationInfo();
+        ::operator delete(_nodes);
+    }
+
+    _nodes = 0;
+    _nodeCount = 0;
+    _nodeCapacity = 0;
+    _index = 0;
+}
+
+
+void SerializationInfo::_fixParents()
+{
+    for (std::size_t n = 0; n < _nodeCount; ++n)
+        _nodes[n]._parent = this;
+}
+
+
+void SerializationInfo::_moveFrom(SerializationInfo& si)
+{
+    // this is a newly constructed node
     _parent = si._parent;
     _category = si._category;
-    _name = si._name;
-    _type = si._type;
+    _name.swap(si._name);
+    _type.swap(si._type);
+    _iname = si._iname;
+    _itype = si._itype;
+
+    switch (si._t)
+    {
+        case t_string:  new (_StringPtr()) String();
+                        _String().swap(si._String());
+                        break;
+
+        case t_string8: new (_String8Ptr()) std::string();
+                        _String8().swap(si._String8());
+                        break;
+
+        default:        _u = si._u;
+    }
+
+    _t = si._t;
+
     _nodes = si._nodes;
+    _nodeCount = si._nodeCount;
+    _nodeCapacity = si._nodeCapacity;
+    _index = si._index;
+    si._nodes = 0;
+    si._nodeCount = 0;
+    si._nodeCapacity = 0;
+    si._index = 0;
+    _fixParents();
+}
+
+
+void SerializationInfo::_reserve(std::size_t n)
+{
+    if (n <= _nodeCapacity)
+        return;
 
-    if (si._t == t_string)
-        _setString( si._String() );
-    else if (si._t == t_string8)
-        _setString8( si._String8() );
+    SerializationInfo* nodes;
+    if (_arena)
+    {
+        nodes = static_cast<SerializationInfo*>(_arena->allocate(n * sizeof(SerializationInfo)));
+        for (std::size_t i = 0; i < _nodeCount; ++i)
+        {
+            new (&nodes[i]) SerializationInfo(*_arena);
+            nodes[i]._moveFrom(_nodes[i]);
+        }
+    }
     else
     {
-        _releaseValue();
-        _u = si._u;
-        _t = si._t;
+        nodes = static_cast<SerializationInfo*>(::operator new(n * sizeof(SerializationInfo)));
+        for (std::size_t i = 0; i < _nodeCount; ++i)
+        {
+            new (&nodes[i]) SerializationInfo();
+            nodes[i]._moveFrom(_nodes[i]);
+            _nodes[i].~SerializationInfo();
+        }
+        ::operator delete(_nodes);
     }
 
-    return *this;
+    _nodes = nodes;
+    _nodeCapacity = n;
+}
+
+
+void SerializationInfo::_indexMember(std::size_t idx)
+{
+    if (_index && _nodeCount * 2 <= _index->mask + 1)
+    {
+        _index->insert(_nodes, idx);
+        return;
+    }
+
+    // build a new index with all members
+    std::size_t size = 64;
+    while (size < _nodeCount * 4)
+        size *= 2;
+
+    _index = static_cast<MemberIndex*>(_arena->allocate(sizeof(MemberIndex)));
+    _index->slots = static_cast<std::size_t*>(_arena->allocate(size * sizeof(std::size_t)));
+    _index->mask = size - 1;
+    std::fill(_index->slots, _index->slots + size, std::size_t(0));
+
+    for (std::size_t n = 0; n < _nodeCount; ++n)
+        _index->insert(_nodes, n);
 }
 
 
 void SerializationInfo::reserve(size_t n)
 {
-    _nodes.reserve(n);
+    _reserve(n);
+}
+
+
+void SerializationInfo::setName(const std::string& name)
+{
+    if (_arena)
+    {
+        const std::string* iname = &_arena->intern(name);
+        if (iname != _iname)
+        {
+            _iname = iname;
+
+            // the index of the parent does not know the new name; it is
+            // built again when the next member is added
+            if (_parent)
+                _parent->_index = 0;
+        }
+    }
+    else
+    {
+        _name = name;
+    }
 }
 
 
 SerializationInfo& SerializationInfo::addMember(const std::string& name)
 {
-    _nodes.resize(_nodes.size() + 1);
-    _nodes.back().setParent(*this);
-    _nodes.back().setName(name);
+    if (_nodeCount == _nodeCapacity)
+        _reserve(_nodeCapacity == 0 ? 1 : _nodeCapacity * 2);
+
+    SerializationInfo* node = _nodes + _nodeCount;
+    if (_arena)
+    {
+        new (node) SerializationInfo(*_arena);
+        node->_iname = &_arena->intern(name);
+    }
+    else
+    {
+        new (node) SerializationInfo();
+        node->_name = name;
+    }
+
+    node->_parent = this;
+    ++_nodeCount;
+
+    if (_arena && _nodeCount >= indexThreshold)
+        _indexMember(_nodeCount - 1);
 
     // category Array overrides Object (is this a hack?)
     // This is needed for xmldeserialization. In the xml file the root node of a array
@@ -107,65 +401,93 @@ SerializationInfo& SerializationInfo::addMember(const std::string& name)
     if (_category != Array)
         _category = Object;
 
-    return _nodes.back();
+    return *node;
 }
 
 
 SerializationInfo::Iterator SerializationInfo::begin()
 {
-    if(_nodes.size() == 0)
+    if(_nodeCount == 0)
         return 0;
 
-    return &( _nodes[0] );
+    return _nodes;
 }
 
 
 SerializationInfo::Iterator SerializationInfo::end()
 {
-    if(_nodes.size() == 0)
+    if(_nodeCount == 0)
         return 0;
 
-    return &_nodes[0] + _nodes.size();
+    return _nodes + _nodeCount;
 }
 
 
 SerializationInfo::ConstIterator SerializationInfo::begin() const
 {
-    if(_nodes.size() == 0)
+    if(_nodeCount == 0)
         return 0;
 
-    return &( _nodes[0] );
+    return _nodes;
 }
 
 
 SerializationInfo::ConstIterator SerializationInfo::end() const
 {
-    if(_nodes.size() == 0)
+    if(_nodeCount == 0)
         return 0;
 
-    return &_nodes[0] + _nodes.size();
+    return _nodes + _nodeCount;
 }
 
 
-const SerializationInfo& SerializationInfo::getMember(const std::string& name) const
+const SerializationInfo* SerializationInfo::_findMember(const std::string& name) const
 {
-    Nodes::const_iterator it = _nodes.begin();
-    for(; it != _nodes.end(); ++it)
+    if (_arena)
     {
-        if( it->name() == name )
-            return *it;
+        // a name, which is not interned, is not used by any member
+        const std::string* iname = _arena->find(name);
+        if (iname == 0)
+            return 0;
+
+        if (_index)
+            return _index->find(_nodes, iname);
+
+        for (std::size_t n = 0; n < _nodeCount; ++n)
+        {
+            if (_nodes[n]._iname == iname)
+                return &_nodes[n];
+        }
+
+        return 0;
     }
 
-    throw SerializationMemberNotFound(name);
+    for (std::size_t n = 0; n < _nodeCount; ++n)
+    {
+        if (_nodes[n]._name == name)
+            return &_nodes[n];
+    }
+
+    return 0;
+}
+
+
+const SerializationInfo& SerializationInfo::getMember(const std::string& name) const
+{
+    const SerializationInfo* si = _findMember(name);
+    if (si == 0)
+        throw SerializationMemberNotFound(name);
+
+    return *si;
 }
 
 
 const SerializationInfo& SerializationInfo::getMember(unsigned idx) const
 {
-    if (idx >= _nodes.size())
+    if (idx >= _nodeCount)
     {
         std::ostringstream msg;
-        msg << "requested member index " << idx << " exceeds number of members " << _nodes.size();
+        msg << "requested member index " << idx << " exceeds number of members " << _nodeCount;
         throw std::range_error(msg.str());
     }
 
@@ -175,41 +497,37 @@ const SerializationInfo& SerializationInfo::getMember(unsigned idx) const
 
 const SerializationInfo* SerializationInfo::findMember(const std::string& name) const
 {
-    Nodes::const_iterator it = _nodes.begin();
-    for(; it != _nodes.end(); ++it)
-    {
-        if( it->name() == name )
-            return &(*it);
-    }
-
-    return 0;
+    return _findMember(name);
 }
 
 
 SerializationInfo* SerializationInfo::findMember(const std::string& name)
 {
-    Nodes::iterator it = _nodes.begin();
-    for(; it != _nodes.end(); ++it)
-    {
-        if( it->name() == name )
-            return &(*it);
-    }
-
-    return 0;
+    return const_cast<SerializationInfo*>(_findMember(name));
 }
 
 void SerializationInfo::clear()
 {
     _category = Void;
-    _name.clear();
-    _type.clear();
-    _nodes.clear();
-    switch (_t)
+    if (_arena)
     {
-        case t_string: _String().clear(); break;
-        case t_string8: _String8().clear(); break;
-        default: _t = t_none; break;
+        _iname = _itype = &_arena->intern(std::string());
+        _t = t_none;
     }
+    else
+    {
+        _name.clear();
+        _type.clear();
+        switch (_t)
+        {
+            case t_string: _String().clear(); break;
+            case t_string8: _String8().clear(); break;
+            default: _t = t_none; break;
+        }
+    }
+
+    // the members of a document are released with the arena
+    _releaseNodes();
 }
 
 void SerializationInfo::swap(SerializationInfo& si)
@@ -217,10 +535,21 @@ void SerializationInfo::swap(SerializationInfo& si)
     if (this == &si)
         return;
 
+    if (_arena != si._arena)
+    {
+        // the data can't be exchanged between arenas, so it is copied
+        SerializationInfo tmp(*this);
+        _assign(si);
+        si._assign(tmp);
+        return;
+    }
+
     std::swap(_parent, si._parent);
     std::swap(_category, si._category);
     std::swap(_name, si._name);
     std::swap(_type, si._type);
+    std::swap(_iname, si._iname);
+    std::swap(_itype, si._itype);
 
     if (_t == t_string)
     {
@@ -307,13 +636,18 @@ void SerializationInfo::swap(SerializationInfo& si)
         }
     }
 
-    _nodes.swap(si._nodes);
+    std::swap(_nodes, si._nodes);
+    std::swap(_nodeCount, si._nodeCount);
+    std::swap(_nodeCapacity, si._nodeCapacity);
+    std::swap(_index, si._index);
+    _fixParents();
+    si._fixParents();
 }
 
 void SerializationInfo::dump(std::ostream& out, const std::string& praefix) const
 {
-    if (!_name.empty())
-        out << praefix << "name = \"" << _name << "\"\n";
+    if (!name().empty())
+        out << praefix << "name = \"" << name() << "\"\n";
 
     if (_t != t_none)
     {
@@ -324,7 +658,9 @@ void SerializationInfo::dump(std::ostream& out, const std::string& praefix) cons
                                         _t == t_bool ? "bool" :
                                         _t == t_int ? "int" :
                                         _t == t_uint ? "uint" :
-                                        _t == t_float ? "float" : "?") << '\n';
+                                        _t == t_float ? "float" :
+                                        _t == t_astring ? "string" :
+                                        _t == t_astring8 ? "string8" : "?") << '\n';
 
         out << praefix << "value = ";
 
@@ -338,17 +674,19 @@ void SerializationInfo::dump(std::ostream& out, const std::string& praefix) cons
             case t_int:     out << _u._i; break;
             case t_uint:    out << _u._u; break;
             case t_float:   out << _u._f; break;
+            case t_astring: out << '"' << String(_AStr(), _u._a._length).narrow() << '"'; break;
+            case t_astring8: out << '"' << std::string(_AStr8(), _u._a._length) << '"'; break;
         }
 
         out << '\n';
     }
 
-    if (!_type.empty())
-        out << praefix << "typeName = " << _type << '\n';
-    if (!_nodes.empty())
+    if (!typeName().empty())
+        out << praefix << "typeName = " << typeName() << '\n';
+    if (_nodeCount > 0)
     {
         std::string p = praefix + '\t';
-        for (std::vector<SerializationInfo>::size_type n = 0; n < _nodes.size(); ++n)
+        for (std::size_t n = 0; n < _nodeCount; ++n)
         {
             out << praefix << "node[" << n << "]\n";
             _nodes[n].dump(out, p);
@@ -385,6 +723,12 @@ void SerializationInfo::setNull()
 
 void SerializationInfo::_setString(const String& value)
 {
+    if (_arena)
+    {
+        _setString(value.data(), value.size());
+        return;
+    }
+
     if (_t != t_string)
     {
         _releaseValue();
@@ -399,8 +743,40 @@ void SerializationInfo::_setString(const String& value)
     _category = Value;
 }
 
+void SerializationInfo::_setString(const Char* value, std::size_t length)
+{
+    if (_arena)
+    {
+        _releaseValue();
+        Char* p = static_cast<Char*>(_arena->allocate(length * sizeof(Char), sizeof(Char)));
+        for (std::size_t n = 0; n < length; ++n)
+            new (p + n) Char(value[n]);
+        _u._a._data = p;
+        _u._a._length = length;
+        _t = t_astring;
+    }
+    else if (_t != t_string)
+    {
+        _releaseValue();
+        new (_StringPtr()) String(value, length);
+        _t = t_string;
+    }
+    else
+    {
+        _String().assign(value, length);
+    }
+
+    _category = Value;
+}
+
 void SerializationInfo::_setString8(const std::string& value)
 {
+    if (_arena)
+    {
+        _setString8(value.data(), value.size());
+        return;
+    }
+
     if (_t != t_string8)
     {
         _releaseValue();
@@ -417,15 +793,29 @@ void SerializationInfo::_setString8(const std::string& value)
 
 void SerializationInfo::_setString8(const char* value)
 {
-    if (_t != t_string8)
+    _setString8(value, std::strlen(value));
+}
+
+void SerializationInfo::_setString8(const char* value, std::size_t length)
+{
+    if (_arena)
     {
         _releaseValue();
-        new (_String8Ptr()) std::string(value);
+        char* p = static_cast<char*>(_arena->allocate(length, 1));
+        std::memcpy(p, value, length);
+        _u._a._data = p;
+        _u._a._length = length;
+        _t = t_astring8;
+    }
+    else if (_t != t_string8)
+    {
+        _releaseValue();
+        new (_String8Ptr()) std::string(value, length);
         _t = t_string8;
     }
     else
     {
-        _String8().assign(value);
+        _String8().assign(value, length);
     }
 
     _category = Value;
@@ -509,6 +899,8 @@ void SerializationInfo::getValue(String& value) const
         case t_int:     convert(value, _u._i); break;
         case t_uint:    convert(value, _u._u); break;
         case t_float:   convert(value, _u._f); break;
+        case t_astring: value.assign(_AStr(), _u._a._length); break;
+        case t_astring8: value.assign(_AStr8(), _u._a._length); break;
     }
 }
 
@@ -524,6 +916,8 @@ void SerializationInfo::getValue(std::string& value) const
         case t_int:     convert(value, _u._i); break;
         case t_uint:    convert(value, _u._u); break;
         case t_float:   convert(value, _u._f); break;
+        case t_astring: value = String(_AStr(), _u._a._length).narrow(); break;
+        case t_astring8: value.assign(_AStr8(), _u._a._length); break;
     }
 }
 
@@ -552,6 +946,8 @@ bool SerializationInfo::_getBool() const
         case t_int:     return _u._i;
         case t_uint:    return _u._u;
         case t_float:   return _u._f;
+        case t_astring: return _u._a._length > 0 && !isFalse(_AStr()[0].narrow());
+        case t_astring8: return _u._a._length > 0 && !isFalse(_AStr8()[0]);
     }
 
     // never reached
@@ -570,6 +966,8 @@ wchar_t SerializationInfo::_getWChar() const
         case t_int:     return _u._i;
         case t_uint:    return _u._u;
         case t_float:   return static_cast<wchar_t>(_u._f);
+        case t_astring: return _u._a._length == 0 ? L'\0' : _AStr()[0].toWchar();
+        case t_astring8: return _u._a._length == 0 ? '\0' : _AStr8()[0];
     }
 
     // never reached
@@ -588,6 +986,8 @@ char SerializationInfo::_getChar() const
         case t_int:     return _u._i; break;
         case t_uint:    return _u._u; break;
         case t_float:   return static_cast<char>(_u._f); break;
+        case t_astring: return _u._a._length == 0 ? '\0' : _AStr()[0].narrow(); break;
+        case t_astring8: return _u._a._length == 0 ? '\0' : _AStr8()[0]; break;
     }
     // never reached
     return 0;
@@ -621,6 +1021,26 @@ SerializationInfo::int_type SerializationInfo::_getInt(const char* type, int_typ
                         }
                         break;
 
+        case t_astring: try
+                        {
+                            ret = convert<int_type>(String(_AStr(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "String", String(_AStr(), _u._a._length).narrow().c_str());
+                        }
+                        break;
+
+        case t_astring8: try
+                        {
+                            ret = convert<int_type>(std::string(_AStr8(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "string", std::string(_AStr8(), _u._a._length).c_str());
+                        }
+                        break;
+
         case t_char:    ret = _u._c - '0'; break;
         case t_bool:    ret = _u._b; break;
         case t_int:     ret = _u._i; break;
@@ -672,6 +1092,26 @@ SerializationInfo::unsigned_type SerializationInfo::_getUInt(const char* type, u
                         }
                         break;
 
+        case t_astring: try
+                        {
+                            ret = convert<unsigned_type>(String(_AStr(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "String", String(_AStr(), _u._a._length).narrow().c_str());
+                        }
+                        break;
+
+        case t_astring8: try
+                        {
+                            ret = convert<unsigned_type>(std::string(_AStr8(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "string", std::string(_AStr8(), _u._a._length).c_str());
+                        }
+                        break;
+
         case t_char:    ret = _u._c - '0'; break;
         case t_bool:    ret = _u._b; break;
         case t_int:     if (_u._i < 0)
@@ -720,6 +1160,26 @@ long double SerializationInfo::_getFloat(const char* type, long double max) cons
                         }
                         break;
 
+        case t_astring: try
+                        {
+                            ret = convert<long double>(String(_AStr(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "String", String(_AStr(), _u._a._length).narrow().c_str());
+                        }
+                        break;
+
+        case t_astring8: try
+                        {
+                            ret = convert<long double>(std::string(_AStr8(), _u._a._length));
+                        }
+                        catch (const ConversionError&)
+                        {
+                            ConversionError::doThrow(type, "string", std::string(_AStr8(), _u._a._length).c_str());
+                        }
+                        break;
+
         case t_char:    ret = _u._c - '0'; break;
         case t_bool:    ret = _u._b; break;
         case t_int:     ret = _u._i; break;
@@ -27,10 +27,102 @@
  */
 
 #include <cxxtools/serviceregistry.h>
+#include <cxxtools/atomicity.h>
 
 namespace cxxtools
 {
 
+// Keeps instances of a registered procedure for reuse. The instances are
+// released by the thread, which processed the call, which is often not the
+// thread, which read the request, so the slots are shared by all threads.
+// They are taken and filled with atomic operations, so that threads do not
+// wait for each other.
+class ServiceProcedurePool
+{
+        ServiceProcedurePool(const ServiceProcedurePool&);
+        ServiceProcedurePool& operator=(const ServiceProcedurePool&);
+
+    public:
+        // upper limit of unused instances
+        enum { Slots = 16 };
+
+        ServiceProcedurePool(const std::string& name, ServiceProcedure* prototype)
+            : _name(name),
+              _prototype(prototype),
+              _retired(0)
+        {
+            for (unsigned n = 0; n < Slots; ++n)
+                _slots[n] = 0;
+        }
+
+        ~ServiceProcedurePool()
+        {
+            for (unsigned n = 0; n < Slots; ++n)
+                delete static_cast<ServiceProcedure*>(_slots[n]);
+            delete _prototype;
+        }
+
+        const std::string& name() const
+        { return _name; }
+
+        ServiceProcedure* get()
+        {
+            for (unsigned n = 0; n < Slots; ++n)
+            {
+                if (_slots[n])
+                {
+                    void* proc = atomicExchange(_slots[n], 0);
+                    if (proc)
+                        return static_cast<ServiceProcedure*>(proc);
+                }
+            }
+
+            return _prototype->clone();
+        }
+
+        void release(ServiceProcedure* proc)
+        {
+            if (!atomicGet(_retired))
+            {
+                for (unsigned n = 0; n < Slots; ++n)
+                {
+                    if (_slots[n] == 0 && atomicCompareExchange(_slots[n], proc, 0) == 0)
+                        return;
+                }
+            }
+
+            delete proc;
+        }
+
+        void retire()
+        {
+            atomicSet(_retired, 1);
+            for (unsigned n = 0; n < Slots; ++n)
+                delete static_cast<ServiceProcedure*>(atomicExchange(_slots[n], 0));
+        }
+
+    private:
+        std::string _name;
+        ServiceProcedure* _prototype;
+        void* volatile _slots[Slots];
+        volatile atomic_t _retired;
+};
+
+namespace
+{
+    std::size_t hashName(const std::string& s)
+    {
+        // FNV-1a
+        std::size_t h = 2166136261u;
+        for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+        {
+            h ^= static_cast<unsigned char>(*it);
+            h *= 16777619u;
+        }
+        return h;
+    }
+}
+
 ServiceRegistry::~ServiceRegistry()
 {
     ProcedureMap::iterator it;
@@ -38,23 +130,56 @@ ServiceRegistry::~ServiceRegistry()
     {
         delete it->second;
     }
+
+    for (std::vector<ServiceProcedurePool*>::iterator r = _retired.begin(); r != _retired.end(); ++r)
+        delete *r;
+}
+
+const ServiceProcedurePool* ServiceRegistry::resolveProcedure(const std::string& name) const
+{
+    if (_index.empty())
+        return 0;
+
+    std::size_t mask = _index.size() - 1;
+    for (std::size_t n = hashName(name) & mask; _index[n]; n = (n + 1) & mask)
+    {
+        if (_index[n]->name() == name)
+            return _index[n];
+    }
+
+    return 0;
 }
 
 ServiceProcedure* ServiceRegistry::getProcedure(const std::string& name) const
 {
-    ProcedureMap::const_iterator it = _procedures.find( name );
-    if( it == _procedures.end() )
+    const ServiceProcedurePool* pool = resolveProcedure(name);
+    if( pool == 0 )
     {
         return 0;
     }
 
-    return it->second->clone();
+    return getProcedure(pool);
+}
+
+
+ServiceProcedure* ServiceRegistry::getProcedure(const ServiceProcedurePool* pool) const
+{
+    ServiceProcedurePool* p = const_cast<ServiceProcedurePool*>(pool);
+    ServiceProcedure* proc = p->get();
+    proc->_pool = p;
+    return proc;
 }
 
 
 void ServiceRegistry::releaseProcedure(ServiceProcedure* proc) const
 {
-    delete proc;
+    if (proc == 0)
+        return;
+
+    if (proc->_pool)
+        proc->_pool->release(proc);
+    else
+        delete proc;
 }
 
 
@@ -73,16 +198,42 @@ std::vector<std::string> ServiceRegistry::getProcedureNames() const
 
 void ServiceRegistry::registerProcedure(const std::string& name, ServiceProcedure* proc)
 {
+    // the prototype is not returned to a pool, even if it was taken from one
+    proc->_pool = 0;
+
     ProcedureMap::iterator it = _procedures.find(name);
     if (it == _procedures.end())
     {
-        std::pair<const std::string, ServiceProcedure*> p( name, proc );
+        std::pair<const std::string, ServiceProcedurePool*> p( name, new ServiceProcedurePool(name, proc) );
         _procedures.insert( p );
     }
     else
     {
-        delete it->second;
-        it->second = proc;
+        // instances in use are deleted, when they are released
+        it->second->retire();
+        _retired.push_back(it->second);
+        it->second = new ServiceProcedurePool(name, proc);
+    }
+
+    rebuildIndex();
+}
+
+
+void ServiceRegistry::rebuildIndex()
+{
+    std::size_t size = 8;
+    while (size < _procedures.size() * 2)
+        size *= 2;
+
+    _index.assign(size, 0);
+
+    std::size_t mask = size - 1;
+    for (ProcedureMap::const_iterator it = _procedures.begin(); it != _procedures.end(); ++it)
+    {
+        std::size_t n = hashName(it->first) & mask;
+        while (_index[n])
+            n = (n + 1) & mask;
+        _index[n] = it->second;
     }
 }
 
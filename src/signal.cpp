@@ -70,6 +70,15 @@ void SignalBase::Sentry::detach()
         }
     }
 
+    Targets::iterator t = _signal->_targets.begin();
+    while( t != _signal->_targets.end() )
+    {
+        if( t->invokable )
+            ++t;
+        else
+            t = _signal->_targets.erase(t);
+    }
+
     _signal->_dirty = false;
     _signal->_sentry = 0;
     _signal = 0;
@@ -105,7 +114,7 @@ SignalBase& SignalBase::operator=(const SignalBase& other)
         if( &signal == &other)
         {
             const Slot& slot = it->slot();
-            Connection connection( *this, slot.clone()  );
+            Connection connection( *this, slot );
         }
     }
 
@@ -116,6 +125,9 @@ SignalBase& SignalBase::operator=(const SignalBase& other)
 void SignalBase::onConnectionOpen(const Connection& c)
 {
     Connectable::onConnectionOpen(c);
+
+    if( &c.sender() == this )
+        _targets.push_back( Target(c) );
 }
 
 
@@ -125,6 +137,18 @@ void SignalBase::onConnectionClose(const Connection& c)
     // remove the connection now, but only set the cleanup flag
     // Any invalid connection objects will be removed after
     // the signal has finished calling its slots by the Sentry.
+    for( Targets::iterator it = _targets.begin(); it != _targets.end(); ++it )
+    {
+        if( it->connection == c )
+        {
+            if( _sending )
+                it->invokable = 0;
+            else
+                _targets.erase(it);
+            break;
+        }
+    }
+
     if( _sending )
     {
         _dirty = true;
@@ -29,6 +29,7 @@
 
 #include <cxxtools/string.h>
 #include <cxxtools/utf8codec.h>
+#include "transcode.h"
 #include <iostream>
 #include <algorithm>
 
@@ -160,10 +161,7 @@ basic_string<cxxtools::Char>& basic_string<cxxtools::Char>::assign(const std::st
     size_type len = str.length();
     privreserve(len);
 
-    cxxtools::Char* p = privdata_rw();
-    for (size_type n = 0; n < len; ++n)
-        p[n] = cxxtools::Char( str[n] );
-
+    cxxtools::widenLatin1(str.data(), len, privdata_rw());
     setLength(len);
 
     return *this;
@@ -174,10 +172,7 @@ basic_string<cxxtools::Char>& basic_string<cxxtools::Char>::assign(const std::st
 {
     privreserve(len);
 
-    cxxtools::Char* p = privdata_rw();
-    for (size_type n = 0; n < len; ++n)
-        p[n] = cxxtools::Char( str[pos + n] );
-
+    cxxtools::widenLatin1(str.data() + pos, len, privdata_rw());
     setLength(len);
 
     return *this;
@@ -676,14 +671,21 @@ basic_string<cxxtools::Char>::find_last_not_of(cxxtools::Char ch, size_type pos)
 
 std::string basic_string<cxxtools::Char>::narrow(char dfault) const
 {
-    std::string ret;
     size_type len = this->length();
     const cxxtools::Char* s = privdata_ro();
 
-    ret.reserve(len);
-
-    for (size_type n = 0; n < len; ++n)
-        ret.append( 1, s[n].narrow(dfault) );
+    std::string ret(len, '\0');
+    size_type n = 0;
+    while (n < len)
+    {
+        // characters up to 0xff are copied in bulk
+        n += cxxtools::narrowBelow(s + n, len - n, &ret[n], 0x100);
+        if (n < len)
+        {
+            ret[n] = s[n].narrow(dfault);
+            ++n;
+        }
+    }
 
     return ret;
 }
@@ -695,9 +697,8 @@ basic_string<cxxtools::Char> basic_string<cxxtools::Char>::widen(const char* str
 
     size_type len = std::char_traits<char>::length(str);
     ret.privreserve(len);
-
-    for (size_type n = 0; n < len; ++n)
-        ret += cxxtools::Char( str[n] );
+    cxxtools::widenLatin1(str, len, ret.privdata_rw());
+    ret.setLength(len);
 
     return ret;
 }
@@ -709,9 +710,8 @@ basic_string<cxxtools::Char> basic_string<cxxtools::Char>::widen(const std::stri
 
     size_type len = str.length();
     ret.privreserve(len);
-
-    for (size_type n = 0; n < len; ++n)
-        ret += cxxtools::Char( str[n] );
+    cxxtools::widenLatin1(str.data(), len, ret.privdata_rw());
+    ret.setLength(len);
 
     return ret;
 }
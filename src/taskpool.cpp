@@ -0,0 +1,152 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cxxtools/taskpool.h>
+#include "taskpoolimpl.h"
+#include <cxxtools/log.h>
+#include <stdexcept>
+
+log_define("cxxtools.taskpool")
+
+namespace cxxtools
+{
+    namespace
+    {
+        class ScheduledTask : public PoolTask
+        {
+                Callable<void>* _cb;
+
+            public:
+                explicit ScheduledTask(const Callable<void>& cb)
+                    : _cb(cb.clone())
+                    { }
+
+                ~ScheduledTask()
+                { delete _cb; }
+
+                void run()
+                {
+                    try
+                    {
+                        (*_cb)();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        log_warn("task failed: " << e.what());
+                    }
+                    catch (...)
+                    {
+                        log_warn("task failed with unknown exception");
+                    }
+                }
+        };
+    }
+
+    void FutureStateBase::setFinished()
+    {
+        MutexLock lock(_mutex);
+        atomicSet(_ready, 1);
+        _finished.broadcast();
+    }
+
+    void FutureStateBase::setError(const std::string& msg)
+    {
+        MutexLock lock(_mutex);
+        if (!_failed)
+        {
+            _failed = true;
+            _error = msg;
+        }
+    }
+
+    void FutureStateBase::wait() const
+    {
+        MutexLock lock(_mutex);
+        while (!ready())
+            _finished.wait(lock);
+    }
+
+    bool FutureStateBase::wait(unsigned msecs) const
+    {
+        MutexLock lock(_mutex);
+        if (!ready())
+            _finished.wait(lock, msecs);
+        return ready();
+    }
+
+    void FutureStateBase::checkError() const
+    {
+        MutexLock lock(_mutex);
+        if (_failed)
+            throw std::runtime_error(_error);
+    }
+
+    TaskPool::TaskPool(unsigned size)
+        : _impl(new TaskPoolImpl(size))
+    {
+    }
+
+    TaskPool::~TaskPool()
+    {
+        delete _impl;
+    }
+
+    unsigned TaskPool::size() const
+    {
+        return _impl->size();
+    }
+
+    int TaskPool::currentWorker() const
+    {
+        return _impl->currentWorker();
+    }
+
+    void TaskPool::schedule(const Callable<void>& cb, int affinity)
+    {
+        submit(new ScheduledTask(cb), affinity);
+    }
+
+    void TaskPool::submit(PoolTask* task, int affinity)
+    {
+        _impl->submit(task, affinity);
+    }
+
+    void TaskPool::wait(const FutureStateBase& state)
+    {
+        _impl->wait(state);
+    }
+
+    std::size_t TaskPool::grainSize(std::size_t count, std::size_t grain) const
+    {
+        if (grain > 0)
+            return grain;
+
+        // some pieces per worker for load balancing
+        std::size_t pieces = size() * 4;
+        grain = count / pieces;
+        return grain > 0 ? grain : 1;
+    }
+}
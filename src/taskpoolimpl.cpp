@@ -0,0 +1,248 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "taskpoolimpl.h"
+#include <cxxtools/log.h>
+#include <pthread.h>
+#include <unistd.h>
+
+log_define("cxxtools.taskpool.impl")
+
+namespace cxxtools
+{
+    namespace
+    {
+        // the worker, which runs the current thread
+        pthread_key_t workerKey;
+        pthread_once_t workerKeyOnce = PTHREAD_ONCE_INIT;
+
+        void createWorkerKey()
+        {
+            pthread_key_create(&workerKey, 0);
+        }
+    }
+
+    void TaskPoolImpl::Worker::run()
+    {
+        pthread_setspecific(workerKey, this);
+
+        log_debug("worker " << index << " started");
+
+        while (true)
+        {
+            PoolTask* task = pool.findTask(index);
+            if (task)
+            {
+                pool.execute(task);
+                continue;
+            }
+
+            MutexLock lock(pool._mutex);
+
+            if (pool._stop && atomicGet(pool._pending) == 0)
+                break;
+
+            atomicIncrement(pool._sleeping);
+            if (atomicGet(pool._pending) == 0 && !pool._stop)
+                pool._work.wait(lock);
+            atomicDecrement(pool._sleeping);
+        }
+
+        log_debug("worker " << index << " stopped");
+    }
+
+    TaskPoolImpl::TaskPoolImpl(unsigned size)
+        : _pending(0),
+          _sleeping(0),
+          _stop(false)
+    {
+        pthread_once(&workerKeyOnce, createWorkerKey);
+
+        if (size == 0)
+        {
+            long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+            size = n > 0 ? static_cast<unsigned>(n) : 1;
+        }
+
+        for (unsigned n = 0; n < size; ++n)
+            _workers.push_back(new Worker(*this, n));
+
+        for (Workers::iterator it = _workers.begin(); it != _workers.end(); ++it)
+            (*it)->thread.start();
+    }
+
+    TaskPoolImpl::~TaskPoolImpl()
+    {
+        {
+            MutexLock lock(_mutex);
+            _stop = true;
+            _work.broadcast();
+        }
+
+        for (Workers::iterator it = _workers.begin(); it != _workers.end(); ++it)
+        {
+            (*it)->thread.join();
+            delete *it;
+        }
+    }
+
+    int TaskPoolImpl::currentWorker() const
+    {
+        Worker* worker = static_cast<Worker*>(pthread_getspecific(workerKey));
+        return worker && &worker->pool == this ? static_cast<int>(worker->index) : -1;
+    }
+
+    void TaskPoolImpl::submit(PoolTask* task, int affinity)
+    {
+        if (affinity < 0)
+            affinity = currentWorker();
+
+        try
+        {
+            if (affinity >= 0)
+            {
+                Worker* worker = _workers[affinity % _workers.size()];
+                MutexLock lock(worker->mutex);
+                worker->tasks.push_back(task);
+            }
+            else
+            {
+                MutexLock lock(_queueMutex);
+                _queue.push_back(task);
+            }
+        }
+        catch (...)
+        {
+            delete task;
+            throw;
+        }
+
+        atomicIncrement(_pending);
+
+        if (atomicGet(_sleeping) > 0)
+        {
+            MutexLock lock(_mutex);
+            _work.signal();
+        }
+    }
+
+    PoolTask* TaskPoolImpl::popOwn(unsigned index)
+    {
+        Worker* worker = _workers[index];
+        MutexLock lock(worker->mutex);
+        if (worker->tasks.empty())
+            return 0;
+
+        PoolTask* task = worker->tasks.back();
+        worker->tasks.pop_back();
+        return task;
+    }
+
+    PoolTask* TaskPoolImpl::popShared()
+    {
+        MutexLock lock(_queueMutex);
+        if (_queue.empty())
+            return 0;
+
+        PoolTask* task = _queue.front();
+        _queue.pop_front();
+        return task;
+    }
+
+    PoolTask* TaskPoolImpl::steal(unsigned index)
+    {
+        for (unsigned n = 1; n <= _workers.size(); ++n)
+        {
+            Worker* victim = _workers[(index + n) % _workers.size()];
+            MutexLock lock(victim->mutex);
+            if (!victim->tasks.empty())
+            {
+                PoolTask* task = victim->tasks.front();
+                victim->tasks.pop_front();
+                return task;
+            }
+        }
+
+        return 0;
+    }
+
+    PoolTask* TaskPoolImpl::findTask(int index)
+    {
+        if (atomicGet(_pending) == 0)
+            return 0;
+
+        PoolTask* task = 0;
+        if (index >= 0)
+            task = popOwn(index);
+
+        if (task == 0)
+            task = popShared();
+
+        if (task == 0)
+            task = steal(index >= 0 ? index : 0);
+
+        if (task)
+            atomicDecrement(_pending);
+
+        return task;
+    }
+
+    void TaskPoolImpl::execute(PoolTask* task)
+    {
+        try
+        {
+            task->run();
+        }
+        catch (...)
+        {
+            delete task;
+            throw;
+        }
+
+        delete task;
+    }
+
+    void TaskPoolImpl::wait(const FutureStateBase& state)
+    {
+        int index = currentWorker();
+        if (index < 0)
+        {
+            state.wait();
+            return;
+        }
+
+        // help processing tasks while waiting, so that nested waits do
+        // not block all workers
+        while (!state.ready())
+        {
+            PoolTask* task = findTask(index);
+            if (task)
+                execute(task);
+            else
+                state.wait(1);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_TASKPOOLIMPL_H
+#define CXXTOOLS_TASKPOOLIMPL_H
+
+#include <cxxtools/taskpool.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/atomicity.h>
+#include <deque>
+#include <vector>
+
+namespace cxxtools
+{
+    class TaskPoolImpl
+    {
+            class Worker
+            {
+                public:
+                    Worker(TaskPoolImpl& pool, unsigned index)
+                        : pool(pool),
+                          index(index),
+                          thread(callable(*this, &Worker::run))
+                        { }
+
+                    void run();
+
+                    TaskPoolImpl& pool;
+                    unsigned index;
+                    AttachedThread thread;
+
+                    Mutex mutex;
+                    std::deque<PoolTask*> tasks;
+            };
+
+            typedef std::vector<Worker*> Workers;
+            Workers _workers;
+
+            Mutex _queueMutex;
+            std::deque<PoolTask*> _queue;
+
+            // number of tasks in all queues
+            volatile atomic_t _pending;
+
+            // parking of idle workers
+            Mutex _mutex;
+            Condition _work;
+            volatile atomic_t _sleeping;
+            bool _stop;
+
+            PoolTask* popOwn(unsigned index);
+            PoolTask* popShared();
+            PoolTask* steal(unsigned index);
+            PoolTask* findTask(int index);
+            void execute(PoolTask* task);
+
+        public:
+            explicit TaskPoolImpl(unsigned size);
+            ~TaskPoolImpl();
+
+            unsigned size() const
+            { return _workers.size(); }
+
+            int currentWorker() const;
+
+            void submit(PoolTask* task, int affinity);
+
+            void wait(const FutureStateBase& state);
+    };
+}
+
+#endif // CXXTOOLS_TASKPOOLIMPL_H
@@ -31,8 +31,8 @@
 
 namespace cxxtools
 {
-    ThreadPool::ThreadPool(unsigned size, bool doStart)
-        : _impl(new ThreadPoolImpl(size))
+    ThreadPool::ThreadPool(unsigned size, bool doStart, std::size_t queueSize)
+        : _impl(new ThreadPoolImpl(size, queueSize))
     {
         if (doStart)
             start();
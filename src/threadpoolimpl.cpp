@@ -40,9 +40,11 @@ namespace cxxtools
         for (ThreadsType::iterator it = _threads.begin(); it != _threads.end(); ++it)
             delete *it;
 
-        log_debug("delete " << _queue.size() << " left tasks");
-        while (!_queue.empty())
-            delete _queue.get();
+        std::pair<Callable<void>*, bool> c;
+        while ((c = tryGet()).second)
+            delete c.first;
+
+        delete _lockFreeQueue;
     }
 
     void ThreadPoolImpl::start()
@@ -75,12 +77,12 @@ namespace cxxtools
         if (cancel)
         {
             std::pair<Callable<void>*, bool> c;
-            while ((c = _queue.tryGet()).second)
+            while ((c = tryGet()).second)
                 delete c.first;
         }
 
         for (ThreadsType::iterator it = _threads.begin(); it != _threads.end(); ++it)
-            _queue.put(0);
+            put(0);
 
         for (ThreadsType::iterator it = _threads.begin(); it != _threads.end(); ++it)
         {
@@ -98,16 +100,23 @@ namespace cxxtools
     {
         Callable<void>* c = cb.clone();
         log_debug("queue new task " << static_cast<void*>(c));
-        _queue.put(c);
-        log_debug("queue size " << _queue.size());
+        try
+        {
+            put(c);
+        }
+        catch (...)
+        {
+            delete c;
+            throw;
+        }
     }
 
     void ThreadPoolImpl::threadFunc()
     {
         Callable<void>* c = 0;
-        while ((c = _queue.get()) != 0)
+        while ((c = get()) != 0)
         {
-            log_debug("new task " << static_cast<void*>(c) << " received " << _queue.size() << " tasks left");
+            log_debug("new task " << static_cast<void*>(c) << " received");
 
             try
             {
@@ -30,6 +30,7 @@
 #define CXXTOOLS_THREADPOOLIMPL_H
 
 #include <cxxtools/queue.h>
+#include <cxxtools/mpmcqueue.h>
 #include <cxxtools/thread.h>
 #include <vector>
 
@@ -38,8 +39,9 @@ namespace cxxtools
     class ThreadPoolImpl
     {
         public:
-            explicit ThreadPoolImpl(unsigned size)
+            ThreadPoolImpl(unsigned size, std::size_t queueSize)
                 : _state(Stopped),
+                  _lockFreeQueue(queueSize > 0 ? new MpmcQueue<Callable<void>*>(queueSize) : 0),
                   _size(size)
                   { }
 
@@ -60,6 +62,20 @@ namespace cxxtools
         private:
             void threadFunc();
 
+            void put(Callable<void>* c)
+            {
+                if (_lockFreeQueue)
+                    _lockFreeQueue->put(c);
+                else
+                    _queue.put(c);
+            }
+
+            Callable<void>* get()
+            { return _lockFreeQueue ? _lockFreeQueue->get() : _queue.get(); }
+
+            std::pair<Callable<void>*, bool> tryGet()
+            { return _lockFreeQueue ? _lockFreeQueue->tryGet() : _queue.tryGet(); }
+
             enum {
                 Stopped,
                 Starting,
@@ -68,6 +84,7 @@ namespace cxxtools
             } _state;
 
             Queue<Callable<void>*> _queue;
+            MpmcQueue<Callable<void>*>* _lockFreeQueue;
             typedef std::vector<AttachedThread*> ThreadsType;
             ThreadsType _threads;
             unsigned _size;
@@ -100,9 +100,7 @@ std::size_t Timer::interval() const
 
 void Timer::start(std::size_t interval)
 {
-    if( _active)
-        stop();
-    
+    // a running timer is rescheduled by onTimerChanged
     _active = true;
     _interval = interval;
     _remaining = int64_t(_interval) * 1000;
@@ -147,13 +145,18 @@ bool Timer::update(const Timespan& now)
     {
         _finished += (_interval * 1000);
 
+        timeout.send();
+
+        // the timer may be destroyed in the timeout handler
         if( ! sentry )
             return hasElapsed;
-
-        timeout.send();
     }
 
     _remaining = _finished - now;
+
+    if (_active && _selector)
+        _selector->onTimerChanged(*this);
+
     return hasElapsed;
 }
 
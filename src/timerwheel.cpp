@@ -0,0 +1,494 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "timerwheel.h"
+#include "cxxtools/timer.h"
+#include "cxxtools/clock.h"
+#include "cxxtools/log.h"
+#include <stdexcept>
+
+log_define("cxxtools.timerwheel")
+
+namespace cxxtools
+{
+
+namespace
+{
+    // level of timers, which are about to be sent
+    const int workLevel = -1;
+
+    const std::size_t initialBuckets = 64;
+}
+
+TimerWheel::TimerWheel(const Timespan& resolution)
+: _resolution(resolution),
+  _resolutionUSecs(resolution.totalUSecs()),
+  _next(0),
+  _started(false),
+  _size(0),
+  _index(initialBuckets),
+  _entries(0),
+  _free(0)
+{
+    if (_resolutionUSecs <= 0)
+        throw std::invalid_argument("invalid timer resolution");
+
+    for (unsigned l = 0; l <= Levels; ++l)
+        _count[l] = 0;
+
+    for (unsigned n = 0; n < RootSize; ++n)
+        _root[n] = 0;
+
+    for (unsigned l = 0; l < Levels; ++l)
+        for (unsigned n = 0; n < LevelSize; ++n)
+            _levels[l][n] = 0;
+}
+
+
+TimerWheel::~TimerWheel()
+{
+    while (Entry* entry = first())
+        remove(*entry->timer);
+
+    for (std::size_t b = 0; b < _index.size(); ++b)
+    {
+        while (Entry* entry = _index[b])
+        {
+            _index[b] = entry->hashNext;
+            delete entry;
+        }
+    }
+
+    while (_free)
+    {
+        Entry* entry = _free;
+        _free = entry->hashNext;
+        delete entry;
+    }
+}
+
+
+uint64_t TimerWheel::tick(const Timespan& t) const
+{
+    int64_t usecs = t.totalUSecs();
+    return usecs > 0 ? static_cast<uint64_t>(usecs / _resolutionUSecs) : 0;
+}
+
+
+uint64_t TimerWheel::expires(const Timer& timer) const
+{
+    // round up, so that the timer is never sent early
+    int64_t usecs = timer.finished().totalUSecs();
+    if (usecs <= 0)
+        return 0;
+
+    return static_cast<uint64_t>((usecs + _resolutionUSecs - 1) / _resolutionUSecs);
+}
+
+
+TimerWheel::Entry*& TimerWheel::slot(unsigned level, std::size_t idx)
+{
+    return level == 0 ? _root[idx] : _levels[level - 1][idx];
+}
+
+
+void TimerWheel::link(Entry*& head, Entry& entry)
+{
+    entry.next = head;
+    if (head)
+        head->prev = &entry.next;
+    head = &entry;
+    entry.prev = &head;
+}
+
+
+void TimerWheel::unlink(Entry& entry)
+{
+    *entry.prev = entry.next;
+    if (entry.next)
+        entry.next->prev = entry.prev;
+
+    entry.next = 0;
+    entry.prev = 0;
+}
+
+
+std::size_t TimerWheel::bucket(const Timer* timer) const
+{
+    std::size_t h = reinterpret_cast<std::size_t>(timer) >> 3;
+    h ^= h >> 11;
+    return h & (_index.size() - 1);
+}
+
+
+TimerWheel::Entry* TimerWheel::find(const Timer* timer) const
+{
+    Entry* entry = _index[bucket(timer)];
+    while (entry && entry->timer != timer)
+        entry = entry->hashNext;
+    return entry;
+}
+
+
+TimerWheel::Entry& TimerWheel::acquire(Timer& timer)
+{
+    Entry* entry = find(&timer);
+    if (entry)
+        return *entry;
+
+    if (_entries >= _index.size())
+    {
+        // rehash into twice as many buckets
+        std::vector<Entry*> index(_index.size() * 2);
+        index.swap(_index);
+        for (std::size_t b = 0; b < index.size(); ++b)
+        {
+            while (Entry* e = index[b])
+            {
+                index[b] = e->hashNext;
+                std::size_t n = bucket(e->timer);
+                e->hashNext = _index[n];
+                _index[n] = e;
+            }
+        }
+    }
+
+    if (_free)
+    {
+        entry = _free;
+        _free = entry->hashNext;
+    }
+    else
+        entry = new Entry();
+
+    entry->timer = &timer;
+    entry->next = 0;
+    entry->prev = 0;
+    entry->level = 0;
+
+    std::size_t n = bucket(&timer);
+    entry->hashNext = _index[n];
+    _index[n] = entry;
+    ++_entries;
+
+    return *entry;
+}
+
+
+void TimerWheel::release(Entry& entry)
+{
+    Entry** p = &_index[bucket(entry.timer)];
+    while (*p != &entry)
+        p = &(*p)->hashNext;
+    *p = entry.hashNext;
+    --_entries;
+
+    entry.timer = 0;
+    entry.hashNext = _free;
+    _free = &entry;
+}
+
+
+void TimerWheel::add(Timer& timer)
+{
+    Entry& entry = acquire(timer);
+    if (entry.prev)
+        unschedule(entry);
+
+    if (!_started || _size == 0)
+    {
+        // nothing to process before now
+        uint64_t now = tick(Clock::getSystemTicks());
+        if (!_started || now > _next)
+            _next = now;
+        _started = true;
+    }
+
+    insert(entry);
+    ++_size;
+}
+
+
+void TimerWheel::insert(Entry& entry)
+{
+    uint64_t exp = expires(*entry.timer);
+
+    if (exp < _next)
+        exp = _next;
+
+    uint64_t diff = exp - _next;
+
+    if (diff < RootSize)
+    {
+        entry.level = 0;
+        link(_root[exp & (RootSize - 1)], entry);
+        ++_count[0];
+        return;
+    }
+
+    unsigned level = 1;
+    unsigned shift = RootBits;
+    while (level < Levels && diff >= (uint64_t(1) << (shift + LevelBits)))
+    {
+        ++level;
+        shift += LevelBits;
+    }
+
+    if (diff >= (uint64_t(1) << (shift + LevelBits)))
+    {
+        // beyond the range of the wheel; the timer is rescheduled,
+        // when the outermost slot is cascaded
+        exp = _next + (uint64_t(1) << (shift + LevelBits)) - 1;
+    }
+
+    entry.level = level;
+    link(_levels[level - 1][(exp >> shift) & (LevelSize - 1)], entry);
+    ++_count[level];
+}
+
+
+void TimerWheel::unschedule(Entry& entry)
+{
+    if (entry.level != workLevel)
+        --_count[entry.level];
+
+    unlink(entry);
+    --_size;
+}
+
+
+void TimerWheel::remove(Timer& timer)
+{
+    Entry* entry = find(&timer);
+    if (entry == 0)
+        return;
+
+    if (entry->prev)
+        unschedule(*entry);
+
+    release(*entry);
+}
+
+
+TimerWheel::Entry* TimerWheel::first() const
+{
+    if (_size == 0)
+        return 0;
+
+    for (unsigned n = 0; n < RootSize; ++n)
+        if (_root[n])
+            return _root[n];
+
+    for (unsigned l = 0; l < Levels; ++l)
+        for (unsigned n = 0; n < LevelSize; ++n)
+            if (_levels[l][n])
+                return _levels[l][n];
+
+    return 0;
+}
+
+
+Timer* TimerWheel::any() const
+{
+    Entry* entry = first();
+    return entry ? entry->timer : 0;
+}
+
+
+bool TimerWheel::cascade(unsigned level)
+{
+    unsigned shift = RootBits + (level - 1) * LevelBits;
+    std::size_t idx = (_next >> shift) & (LevelSize - 1);
+
+    Entry* list = slot(level, idx);
+    slot(level, idx) = 0;
+    if (list)
+        list->prev = &list;
+
+    while (list)
+    {
+        Entry* entry = list;
+        unlink(*entry);
+        --_count[level];
+        insert(*entry);
+    }
+
+    // the next level is cascaded when this level wraps around
+    return idx != 0;
+}
+
+
+bool TimerWheel::expire(const Timespan& now)
+{
+    if (!_started)
+        return false;
+
+    uint64_t target = tick(now);
+    bool fired = false;
+
+    while (_next <= target)
+    {
+        if (_size == 0)
+        {
+            _next = target + 1;
+            break;
+        }
+
+        std::size_t idx = _next & (RootSize - 1);
+
+        if (idx == 0)
+        {
+            for (unsigned level = 1; level <= Levels && !cascade(level); ++level)
+                ;
+        }
+        else if (_count[0] == 0)
+        {
+            // nothing to do until the root wheel wraps around
+            uint64_t wrap = (_next | (RootSize - 1)) + 1;
+            _next = wrap <= target ? wrap : target + 1;
+            continue;
+        }
+
+        Entry* slotList = _root[idx];
+        _root[idx] = 0;
+        ++_next;
+
+        if (slotList == 0)
+            continue;
+
+        // Timers are linked in reverse order, so reverse the list to send
+        // the timers of one tick in the order they were scheduled.
+        Entry* work = 0;
+        while (slotList)
+        {
+            Entry* entry = slotList;
+            slotList = entry->next;
+            link(work, *entry);
+            entry->level = workLevel;
+            --_count[0];
+        }
+
+        // The timeout handlers may start, stop or even destroy any timer.
+        // Timers, which are still active, reschedule themself.
+        while (work)
+        {
+            Entry* entry = work;
+            Timer* timer = entry->timer;
+            unlink(*entry);
+            --_size;
+
+            log_debug("timer " << static_cast<void*>(timer) << " expired");
+            timer->update(now);
+
+            // The timer may be destroyed by now, so it is only used as
+            // the key. An entry, which was not rescheduled, is released.
+            entry = find(timer);
+            if (entry && entry->prev == 0)
+                release(*entry);
+
+            fired = true;
+        }
+    }
+
+    return fired;
+}
+
+
+bool TimerWheel::nextTimeout(const Timespan& now, Timespan& timeout) const
+{
+    if (_size == 0)
+        return false;
+
+    uint64_t next = 0;
+    bool found = false;
+
+    if (_count[0] > 0)
+    {
+        for (uint64_t t = _next; t < _next + RootSize; ++t)
+        {
+            if (_root[t & (RootSize - 1)])
+            {
+                next = t;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    // the timers of the outer wheels expire at the earliest, when their
+    // slot is cascaded
+    unsigned shift = RootBits;
+    for (unsigned level = 1; level <= Levels; ++level, shift += LevelBits)
+    {
+        if (_count[level] == 0)
+            continue;
+
+        uint64_t base = _next >> shift;
+        for (uint64_t k = 1; k <= LevelSize; ++k)
+        {
+            if (_levels[level - 1][(base + k) & (LevelSize - 1)])
+            {
+                uint64_t t = (base + k) << shift;
+                if (!found || t < next)
+                {
+                    next = t;
+                    found = true;
+                }
+                break;
+            }
+        }
+    }
+
+    if (!found)
+        next = _next;
+
+    int64_t usecs = static_cast<int64_t>(next) * _resolutionUSecs - now.totalUSecs();
+    timeout = usecs > 0 ? Timespan(usecs) : Timespan(0);
+    return true;
+}
+
+
+void TimerWheel::setResolution(const Timespan& resolution)
+{
+    if (resolution.totalUSecs() <= 0)
+        throw std::invalid_argument("invalid timer resolution");
+
+    std::vector<Timer*> timers;
+    while (Entry* entry = first())
+    {
+        timers.push_back(entry->timer);
+        remove(*entry->timer);
+    }
+
+    _resolution = resolution;
+    _resolutionUSecs = resolution.totalUSecs();
+    _started = false;
+
+    for (std::vector<Timer*>::iterator it = timers.begin(); it != timers.end(); ++it)
+        add(**it);
+}
+
+}
@@ -0,0 +1,164 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CXXTOOLS_TIMERWHEEL_H
+#define CXXTOOLS_TIMERWHEEL_H
+
+#include <cxxtools/timespan.h>
+#include <cxxtools/noncopyable.h>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace cxxtools
+{
+
+class Timer;
+
+/** @internal Hierarchical timer wheel used by the SelectorBase
+
+    Active timers are kept in linked lists in the slots of 5 wheels. The
+    list entries are owned by the wheel and found by the address of the
+    timer in a hash index, so that the layout of Timer is not changed.
+    The first wheel has 256 slots with one tick per slot, each further
+    wheel has 64 slots covering 64 slots of the previous wheel. Timers
+    in the outer wheels are moved (cascaded) to the inner wheels when
+    the inner wheel wraps around.
+
+    Adding and removing a timer is O(1). Timers are never sent before
+    they expire, but may be delayed by up to one tick.
+ */
+class TimerWheel : private NonCopyable
+{
+    public:
+        explicit TimerWheel(const Timespan& resolution = Timespan(1000));
+
+        ~TimerWheel();
+
+        //! @brief Schedules the timer by its finished time
+        void add(Timer& timer);
+
+        //! @brief Removes the timer; does nothing if it is not scheduled
+        void remove(Timer& timer);
+
+        bool empty() const
+        { return _size == 0; }
+
+        std::size_t size() const
+        { return _size; }
+
+        //! @brief Returns any scheduled timer or 0 if there is none
+        Timer* any() const;
+
+        /** @brief Sends the timeout signal of all timers expired at now
+
+            Returns true if at least one timer expired.
+         */
+        bool expire(const Timespan& now);
+
+        /** @brief Calculates the time until the next timer may expire
+
+            The returned time is a lower bound. Returns false if no timer
+            is scheduled.
+         */
+        bool nextTimeout(const Timespan& now, Timespan& timeout) const;
+
+        const Timespan& resolution() const
+        { return _resolution; }
+
+        //! @brief Changes the tick resolution and reschedules all timers
+        void setResolution(const Timespan& resolution);
+
+    private:
+        enum
+        {
+            RootBits = 8,
+            LevelBits = 6,
+            RootSize = 1 << RootBits,
+            LevelSize = 1 << LevelBits,
+            Levels = 4
+        };
+
+        struct Entry
+        {
+            Timer* timer;
+            Entry* next;       // in the slot or the list of expired timers
+            Entry** prev;      // 0 if the timer is not scheduled
+            int level;
+            Entry* hashNext;   // in the bucket of the index
+        };
+
+        uint64_t tick(const Timespan& t) const;
+
+        uint64_t expires(const Timer& timer) const;
+
+        void insert(Entry& entry);
+
+        void unschedule(Entry& entry);
+
+        static void link(Entry*& head, Entry& entry);
+
+        static void unlink(Entry& entry);
+
+        bool cascade(unsigned level);
+
+        Entry*& slot(unsigned level, std::size_t idx);
+
+        Entry* first() const;
+
+        std::size_t bucket(const Timer* timer) const;
+
+        //! @brief Returns the entry of the timer or 0
+        Entry* find(const Timer* timer) const;
+
+        //! @brief Returns the entry of the timer and creates it if needed
+        Entry& acquire(Timer& timer);
+
+        //! @brief Removes the entry from the index and keeps it for reuse
+        void release(Entry& entry);
+
+        Timespan _resolution;
+        int64_t _resolutionUSecs;
+
+        // the next tick to process; all ticks before are processed
+        uint64_t _next;
+        bool _started;
+
+        std::size_t _size;
+        std::size_t _count[Levels + 1];
+
+        Entry* _root[RootSize];
+        Entry* _levels[Levels][LevelSize];
+
+        // entries by the address of their timer
+        std::vector<Entry*> _index;
+        std::size_t _entries;
+        Entry* _free;
+};
+
+}
+
+#endif // CXXTOOLS_TIMERWHEEL_H
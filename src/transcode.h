@@ -0,0 +1,155 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef CXXTOOLS_TRANSCODE_H
+#define CXXTOOLS_TRANSCODE_H
+
+#include <cxxtools/char.h>
+#include <cstddef>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#  include <immintrin.h>
+#  define CXXTOOLS_TRANSCODE_AVX2
+#endif
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define CXXTOOLS_TRANSCODE_SSE2
+#endif
+
+namespace cxxtools
+{
+
+#ifdef CXXTOOLS_TRANSCODE_SSE2
+// zero extends 16 bytes to 16 characters
+inline void widen16(__m128i v, Char* to)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+    __m128i* out = reinterpret_cast<__m128i*>(to);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+}
+#endif
+
+/// Converts the leading ASCII characters of [from, from + n) to Char and
+/// returns their number.
+inline std::size_t widenAscii(const char* from, std::size_t n, Char* to)
+{
+    std::size_t i = 0;
+
+#ifdef CXXTOOLS_TRANSCODE_AVX2
+    for ( ; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+        if (_mm256_movemask_epi8(v))
+            break;
+
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+
+        __m256i* out = reinterpret_cast<__m256i*>(to + i);
+        _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(lo));
+        _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        _mm256_storeu_si256(out + 2, _mm256_cvtepu8_epi32(hi));
+        _mm256_storeu_si256(out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+    }
+#endif
+
+#ifdef CXXTOOLS_TRANSCODE_SSE2
+    for ( ; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+        if (_mm_movemask_epi8(v))
+            break;
+
+        widen16(v, to + i);
+    }
+#endif
+
+    for ( ; i < n && static_cast<unsigned char>(from[i]) < 0x80; ++i)
+        to[i] = Char(from[i]);
+
+    return i;
+}
+
+/// Converts the bytes of [from, from + n) as ISO-8859-1 to Char.
+inline void widenLatin1(const char* from, std::size_t n, Char* to)
+{
+    std::size_t i = 0;
+
+#ifdef CXXTOOLS_TRANSCODE_SSE2
+    for ( ; i + 16 <= n; i += 16)
+        widen16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i)), to + i);
+#endif
+
+    for ( ; i < n; ++i)
+        to[i] = Char(from[i]);
+}
+
+/// Converts the leading characters of [from, from + n), which are below
+/// \a limit, to char and returns their number. The limit must be 0x80
+/// or 0x100.
+inline std::size_t narrowBelow(const Char* from, std::size_t n, char* to, unsigned limit)
+{
+    std::size_t i = 0;
+
+#ifdef CXXTOOLS_TRANSCODE_SSE2
+    const __m128i high = _mm_set1_epi32(static_cast<int>(~(limit - 1)));
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; i + 16 <= n; i += 16)
+    {
+        const __m128i* in = reinterpret_cast<const __m128i*>(from + i);
+        __m128i a = _mm_loadu_si128(in);
+        __m128i b = _mm_loadu_si128(in + 1);
+        __m128i c = _mm_loadu_si128(in + 2);
+        __m128i d = _mm_loadu_si128(in + 3);
+
+        __m128i above = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(above, zero)) != 0xffff)
+            break;
+
+        // all values are below 0x100 and survive the saturating packs
+        __m128i ab = _mm_packs_epi32(a, b);
+        __m128i cd = _mm_packs_epi32(c, d);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm_packus_epi16(ab, cd));
+    }
+#endif
+
+    for ( ; i < n && static_cast<unsigned>(from[i].value()) < limit; ++i)
+        to[i] = static_cast<char>(from[i].value());
+
+    return i;
+}
+
+} // namespace cxxtools
+
+#endif // CXXTOOLS_TRANSCODE_H
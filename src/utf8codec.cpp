@@ -27,6 +27,8 @@
  */
 #include "cxxtools/utf8codec.h"
 #include <cxxtools/conversionerror.h>
+#include "transcode.h"
+#include <algorithm>
 
 #define byteMask 0xBF
 #define byteMark 0x80
@@ -151,7 +153,7 @@ Utf8Codec::result Utf8Codec::do_in(MBState& s, const char* fromBegin, const char
     toNext = toBegin;
 
     // check for incomplete byte order mark:
-    if (fromEnd - fromBegin < 3 && fromBegin[0] == '\xef')
+    if (fromEnd - fromBegin < 3 && fromBegin < fromEnd && fromBegin[0] == '\xef')
         return ok;
 
     // skip byte order mark
@@ -169,6 +171,22 @@ Utf8Codec::result Utf8Codec::do_in(MBState& s, const char* fromBegin, const char
             break;
         }
 
+        // convert runs of ASCII characters in bulk; single ones between
+        // multibyte sequences are not worth the vector setup
+        if(*fnext < 0x80) {
+            if(fromNext + 1 == fromEnd || fnext[1] >= 0x80) {
+                *toNext++ = Char(*fnext);
+                ++fromNext;
+                continue;
+            }
+
+            size_t n = widenAscii(fromNext,
+                std::min<size_t>(fromEnd - fromNext, toEnd - toNext), toNext);
+            fromNext += n;
+            toNext += n;
+            continue;
+        }
+
         const size_t extraBytesToRead = trailingBytesForUTF8[*fnext];
         if(fromNext + extraBytesToRead >= fromEnd) {
             retstat = partial;
@@ -220,6 +238,27 @@ Utf8Codec::result Utf8Codec::do_out(MBState& s, const Char* fromBegin, const Cha
 
     while(fromNext < fromEnd) {
         ch = *fromNext;
+
+        // convert runs of ASCII characters in bulk
+        if (static_cast<uint32_t>(ch.value()) < 0x80) {
+            if (toNext >= toEnd) {
+                retstat = partial;
+                break;
+            }
+
+            if (fromNext + 1 == fromEnd || static_cast<uint32_t>(fromNext[1].value()) >= 0x80) {
+                *toNext++ = static_cast<char>(ch.value());
+                ++fromNext;
+                continue;
+            }
+
+            size_t n = narrowBelow(fromNext,
+                std::min<size_t>(fromEnd - fromNext, toEnd - toNext), toNext, 0x80);
+            fromNext += n;
+            toNext += n;
+            continue;
+        }
+
         if (ch >= SurHighStart && ch <= SurLowEnd) {
             retstat = error;
             break;
@@ -245,7 +284,7 @@ Utf8Codec::result Utf8Codec::do_out(MBState& s, const Char* fromBegin, const Cha
         }
 
         uint8_t* current = (uint8_t*)(toNext + bytesToWrite);
-        if( current >= (uint8_t*)(toEnd) ) {
+        if( current > (uint8_t*)(toEnd) ) {
             retstat = partial;
             break;
         }
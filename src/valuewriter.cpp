@@ -0,0 +1,78 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cxxtools/valuewriter.h>
+#include <stdexcept>
+
+namespace cxxtools
+{
+    void ValueWriter::beginObject(const std::string& type)
+    {
+        _formatter.beginObject(_name, type);
+        _memberOpen.push_back(false);
+    }
+
+    ValueWriter& ValueWriter::addMember(const std::string& name)
+    {
+        if (_memberOpen.empty())
+            throw std::logic_error("member added outside of an object");
+
+        if (_memberOpen.back())
+            _formatter.finishMember();
+
+        _formatter.beginMember(name);
+        _memberOpen.back() = true;
+        _name = name;
+        return *this;
+    }
+
+    void ValueWriter::finishObject()
+    {
+        if (_memberOpen.empty())
+            throw std::logic_error("no object to finish");
+
+        if (_memberOpen.back())
+            _formatter.finishMember();
+
+        _memberOpen.pop_back();
+        _formatter.finishObject();
+    }
+
+    void ValueWriter::beginArray(const std::string& type)
+    {
+        _formatter.beginArray(_name, type);
+        _memberOpen.push_back(false);
+    }
+
+    void ValueWriter::finishArray()
+    {
+        if (_memberOpen.empty())
+            throw std::logic_error("no array to finish");
+
+        _memberOpen.pop_back();
+        _formatter.finishArray();
+    }
+}
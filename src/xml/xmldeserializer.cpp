@@ -29,6 +29,7 @@
 #include "cxxtools/xml/startelement.h"
 #include "cxxtools/xml/endelement.h"
 #include "cxxtools/xml/characters.h"
+#include "cxxtools/xml/xmltokenizer.h"
 #include "cxxtools/string.h"
 #include <stdexcept>
 
@@ -38,6 +39,20 @@ namespace xml {
 
 XmlDeserializer::XmlDeserializer(cxxtools::xml::XmlReader& reader)
 : _reader(&reader)
+, _tokenizer(0)
+, _node(0)
+, _symbols(0)
+, _contentValid(false)
+{
+}
+
+
+XmlDeserializer::XmlDeserializer(cxxtools::xml::XmlTokenizer& tokenizer)
+: _reader(0)
+, _tokenizer(&tokenizer)
+, _node(0)
+, _symbols(0)
+, _contentValid(false)
 {
 }
 
@@ -45,6 +60,10 @@ XmlDeserializer::XmlDeserializer(cxxtools::xml::XmlReader& reader)
 XmlDeserializer::XmlDeserializer(std::istream& is)
 : _reader( 0 )
 , _deleter( new cxxtools::xml::XmlReader(is) )
+, _tokenizer(0)
+, _node(0)
+, _symbols(0)
+, _contentValid(false)
 {
     _reader = _deleter.get();
 }
@@ -52,17 +71,25 @@ XmlDeserializer::XmlDeserializer(std::istream& is)
 
 void XmlDeserializer::doDeserialize()
 {
+    if (_tokenizer)
+    {
+        doDeserialize(*_tokenizer);
+        return;
+    }
+
     if(_reader->get().type() != cxxtools::xml::Node::StartElement)
         _reader->nextElement();
 
     _processNode = &XmlDeserializer::beginDocument;
 
-    _startDepth = _reader->depth();
+    _startDepth = depth();
     for(cxxtools::xml::XmlReader::Iterator it = _reader->current(); it != _reader->end(); ++it)
     {
-        (this->*_processNode)(*it);
+        _node = &*it;
+        _contentValid = false;
+        (this->*_processNode)(it->type());
 
-        if( (it->type() == cxxtools::xml::Node::EndElement) && (_reader->depth() < _startDepth) )
+        if( (it->type() == cxxtools::xml::Node::EndElement) && (depth() < _startDepth) )
         {
             break;
         }
@@ -70,15 +97,93 @@ void XmlDeserializer::doDeserialize()
 }
 
 
-void XmlDeserializer::beginDocument(const cxxtools::xml::Node& node)
+void XmlDeserializer::doDeserialize(cxxtools::xml::XmlTokenizer& tokenizer)
+{
+    cxxtools::xml::Node::Type type = tokenizer.type();
+    while (type != cxxtools::xml::Node::StartElement)
+    {
+        if (type == cxxtools::xml::Node::EndDocument)
+            throw std::logic_error("Expected start element");
+        type = tokenizer.next();
+    }
+
+    _processNode = &XmlDeserializer::beginDocument;
+
+    _startDepth = depth();
+    for ( ; ; type = tokenizer.next())
+    {
+        _contentValid = false;
+        (this->*_processNode)(type);
+
+        if( (type == cxxtools::xml::Node::EndElement) && (depth() < _startDepth) )
+            break;
+
+        if (type == cxxtools::xml::Node::EndDocument)
+            break;
+    }
+}
+
+
+void XmlDeserializer::readStartElement()
+{
+    if (_tokenizer)
+    {
+        if (_symbols != &_tokenizer->symbols())
+        {
+            _symbols = &_tokenizer->symbols();
+            _typeSymbol = _tokenizer->symbols().intern("type");
+            _categorySymbol = _tokenizer->symbols().intern("category");
+        }
+
+        _nodeName = _tokenizer->nameString();
+        _nodeType = _tokenizer->attribute(_typeSymbol).toString();
+        _nodeCategory = _tokenizer->attribute(_categorySymbol).toString();
+    }
+    else
+    {
+        const cxxtools::xml::StartElement& se = static_cast<const cxxtools::xml::StartElement&>(*_node);
+        _nodeName = se.name();
+        _nodeType = se.attribute(L"type");
+        _nodeCategory = se.attribute(L"category");
+    }
+}
+
+
+const cxxtools::String& XmlDeserializer::endElementName() const
+{
+    return _tokenizer ? _tokenizer->nameString()
+                      : static_cast<const cxxtools::xml::EndElement&>(*_node).name();
+}
+
+
+const cxxtools::String& XmlDeserializer::content()
+{
+    if (!_tokenizer)
+        return static_cast<const cxxtools::xml::Characters&>(*_node).content();
+
+    if (!_contentValid)
+    {
+        _content = _tokenizer->text().toString();
+        _contentValid = true;
+    }
+
+    return _content;
+}
+
+
+std::size_t XmlDeserializer::depth() const
+{
+    return _tokenizer ? _tokenizer->depth() : _reader->depth();
+}
+
+
+void XmlDeserializer::beginDocument(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::StartElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::StartElement&>(node).name();
-            _nodeType = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"type");
-            _nodeCategory = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"category");
+            readStartElement();
             setName( _nodeName.narrow() );
 
             _processNode = &XmlDeserializer::onRootElement;
@@ -90,16 +195,16 @@ void XmlDeserializer::beginDocument(const cxxtools::xml::Node& node)
 }
 
 
-void XmlDeserializer::onRootElement(const cxxtools::xml::Node& node)
+void XmlDeserializer::onRootElement(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::Characters:
         {
-            const cxxtools::xml::Characters& chars = static_cast<const cxxtools::xml::Characters&>(node);
-            if(cxxtools::String::npos != chars.content().find_first_not_of(L" \t\n\r") )
+            const cxxtools::String& content = this->content();
+            if(cxxtools::String::npos != content.find_first_not_of(L" \t\n\r") )
             {
-                setValue( chars.content() );
+                setValue( content );
                 _processNode = &XmlDeserializer::onContent;
             }
             else
@@ -111,9 +216,7 @@ void XmlDeserializer::onRootElement(const cxxtools::xml::Node& node)
         }
         case cxxtools::xml::Node::StartElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::StartElement&>(node).name();
-            _nodeType = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"type");
-            _nodeCategory = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"category");
+            readStartElement();
 
             _processNode = &XmlDeserializer::onStartElement;
             break;
@@ -125,19 +228,19 @@ void XmlDeserializer::onRootElement(const cxxtools::xml::Node& node)
 }
 
 
-void XmlDeserializer::onStartElement(const cxxtools::xml::Node& node)
+void XmlDeserializer::onStartElement(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::Characters:
         {
-            const cxxtools::xml::Characters& chars = static_cast<const cxxtools::xml::Characters&>(node);
-            if(cxxtools::String::npos != chars.content().find_first_not_of(L" \t\n\r") )
+            const cxxtools::String& content = this->content();
+            if(cxxtools::String::npos != content.find_first_not_of(L" \t\n\r") )
             {
                 std::string nodeName = _nodeName.narrow();
                 std::string nodeType = _nodeType.empty() ? nodeName : _nodeType.narrow();
                 beginMember(nodeName, nodeType, nodeCategory());
-                setValue( chars.content() );
+                setValue( content );
                 leaveMember();
                 //_current->addValue( _nodeName.narrow(), chars.content() );
 
@@ -162,14 +265,12 @@ void XmlDeserializer::onStartElement(const cxxtools::xml::Node& node)
             //SerializationInfo& added = _current->addMember( _nodeName.narrow() );
             //_current = &added;
 
-            _nodeName = static_cast<const cxxtools::xml::StartElement&>(node).name();
-            _nodeType = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"type");
-            _nodeCategory = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"category");
+            readStartElement();
             break;
         }
         case cxxtools::xml::Node::EndElement:
         {
-            if( _nodeName != static_cast<const cxxtools::xml::EndElement&>(node).name() )
+            if( _nodeName != endElementName() )
                 throw std::logic_error("Invalid element");
 
             std::string nodeName = _nodeName.narrow();
@@ -188,23 +289,21 @@ void XmlDeserializer::onStartElement(const cxxtools::xml::Node& node)
 }
 
 
-void XmlDeserializer::onWhitespace(const cxxtools::xml::Node& node)
+void XmlDeserializer::onWhitespace(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::StartElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::StartElement&>(node).name();
-            _nodeType = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"type");
-            _nodeCategory = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"category");
+            readStartElement();
             _processNode = &XmlDeserializer::onStartElement;
             break;
         }
         case cxxtools::xml::Node::EndElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::EndElement&>(node).name();
+            _nodeName = endElementName();
 
-            if(_reader->depth() >= _startDepth)
+            if(depth() >= _startDepth)
                 leaveMember();
 
             _processNode = &XmlDeserializer::onEndElement;
@@ -216,9 +315,9 @@ void XmlDeserializer::onWhitespace(const cxxtools::xml::Node& node)
 }
 
 
-void XmlDeserializer::onContent(const cxxtools::xml::Node& node)
+void XmlDeserializer::onContent(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::EndElement:
         {
@@ -231,9 +330,9 @@ void XmlDeserializer::onContent(const cxxtools::xml::Node& node)
 }
 
 
-void XmlDeserializer::onEndElement(const cxxtools::xml::Node& node)
+void XmlDeserializer::onEndElement(cxxtools::xml::Node::Type type)
 {
-    switch( node.type() )
+    switch( type )
     {
         case cxxtools::xml::Node::Characters:
         {
@@ -242,17 +341,15 @@ void XmlDeserializer::onEndElement(const cxxtools::xml::Node& node)
         }
         case cxxtools::xml::Node::StartElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::StartElement&>(node).name();
-            _nodeType = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"type");
-            _nodeCategory = static_cast<const cxxtools::xml::StartElement&>(node).attribute(L"category");
+            readStartElement();
             _processNode = &XmlDeserializer::onStartElement;
             break;
         }
         case cxxtools::xml::Node::EndElement:
         {
-            _nodeName = static_cast<const cxxtools::xml::EndElement&>(node).name();
+            _nodeName = endElementName();
 
-            if(_reader->depth() >= _startDepth)
+            if(depth() >= _startDepth)
                 leaveMember();
 
             break;
@@ -0,0 +1,639 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/xml/xmltokenizer.h"
+#include "cxxtools/xml/xmlerror.h"
+#include <cxxtools/utf8codec.h>
+#include <algorithm>
+#include <istream>
+
+namespace cxxtools {
+
+namespace xml {
+
+namespace
+{
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    inline bool isNameChar(char c)
+    {
+        return !isSpace(c) && c != '/' && c != '>' && c != '='
+            && c != '<' && c != '"' && c != '\'';
+    }
+
+    inline bool startsWith(const char* p, const char* end, const char* s, std::size_t n)
+    {
+        return static_cast<std::size_t>(end - p) >= n && std::memcmp(p, s, n) == 0;
+    }
+
+    bool isWhitespace(const char* b, const char* e)
+    {
+        for ( ; b != e; ++b)
+            if (!isSpace(*b))
+                return false;
+        return true;
+    }
+
+    // FNV-1a
+    inline unsigned hashName(const char* name, std::size_t len)
+    {
+        unsigned h = 2166136261u;
+        for (std::size_t n = 0; n < len; ++n)
+        {
+            h ^= static_cast<unsigned char>(name[n]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    void appendUtf8(std::string& out, unsigned long code)
+    {
+        if (code < 0x80)
+            out += static_cast<char>(code);
+        else if (code < 0x800)
+        {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else if (code < 0x10000)
+        {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    void readAll(std::istream& in, std::string& out)
+    {
+        out.clear();
+
+        std::streambuf* sb = in.rdbuf();
+        if (sb == 0)
+            return;
+
+        char buffer[8192];
+        std::streamsize n;
+        while ((n = sb->sgetn(buffer, sizeof(buffer))) > 0)
+            out.append(buffer, static_cast<std::size_t>(n));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+// XmlSymbolTable
+//
+const XmlSymbol XmlSymbolTable::none = static_cast<XmlSymbol>(-1);
+
+XmlSymbolTable::XmlSymbolTable()
+: _slots(64, 0)
+{
+}
+
+XmlSymbol XmlSymbolTable::find(const char* name, std::size_t len) const
+{
+    unsigned h = hashName(name, len);
+    std::size_t mask = _slots.size() - 1;
+    for (std::size_t n = h & mask; _slots[n] != 0; n = (n + 1) & mask)
+    {
+        const Entry& e = _entries[_slots[n] - 1];
+        if (e.hash == h && e.name.size() == len && std::memcmp(e.name.data(), name, len) == 0)
+            return _slots[n] - 1;
+    }
+
+    return none;
+}
+
+XmlSymbol XmlSymbolTable::intern(const char* name, std::size_t len)
+{
+    unsigned h = hashName(name, len);
+    std::size_t mask = _slots.size() - 1;
+    std::size_t n = h & mask;
+    for ( ; _slots[n] != 0; n = (n + 1) & mask)
+    {
+        const Entry& e = _entries[_slots[n] - 1];
+        if (e.hash == h && e.name.size() == len && std::memcmp(e.name.data(), name, len) == 0)
+            return _slots[n] - 1;
+    }
+
+    XmlSymbol sym = static_cast<XmlSymbol>(_entries.size());
+    _entries.resize(_entries.size() + 1);
+    Entry& e = _entries.back();
+    e.name.assign(name, len);
+    e.nameString = Utf8Codec::decode(e.name);
+    e.hash = h;
+
+    if (2 * _entries.size() <= _slots.size())
+    {
+        _slots[n] = sym + 1;
+    }
+    else
+    {
+        // keep the load factor below one half
+        std::vector<unsigned> slots(_slots.size() * 2, 0);
+        mask = slots.size() - 1;
+        for (std::size_t i = 0; i < _entries.size(); ++i)
+        {
+            std::size_t s = _entries[i].hash & mask;
+            while (slots[s] != 0)
+                s = (s + 1) & mask;
+            slots[s] = static_cast<unsigned>(i + 1);
+        }
+
+        _slots.swap(slots);
+    }
+
+    return sym;
+}
+
+////////////////////////////////////////////////////////////////////////
+// XmlTokenizer
+//
+String XmlTokenizer::Text::toString() const
+{
+    if (_size == 0)
+        return String();
+
+    return Utf8Codec::decode(_data, static_cast<unsigned>(_size));
+}
+
+XmlTokenizer::XmlTokenizer(const char* data, std::size_t size)
+: _symbols(&_ownSymbols)
+{
+    init(data, size);
+}
+
+XmlTokenizer::XmlTokenizer(const char* data, std::size_t size, XmlSymbolTable& symbols)
+: _symbols(&symbols)
+{
+    init(data, size);
+}
+
+XmlTokenizer::XmlTokenizer(std::istream& in)
+: _symbols(&_ownSymbols)
+{
+    reset(in);
+}
+
+XmlTokenizer::XmlTokenizer(std::istream& in, XmlSymbolTable& symbols)
+: _symbols(&symbols)
+{
+    reset(in);
+}
+
+void XmlTokenizer::reset(const char* data, std::size_t size)
+{
+    _input.clear();
+    init(data, size);
+}
+
+void XmlTokenizer::reset(std::istream& in)
+{
+    readAll(in, _input);
+    init(_input.data(), _input.size());
+}
+
+void XmlTokenizer::init(const char* data, std::size_t size)
+{
+    _begin = data;
+    _pos = data;
+    _end = data + size;
+
+    // skip byte order mark
+    if (startsWith(_pos, _end, "\xef\xbb\xbf", 3))
+        _pos += 3;
+
+    _type = Node::StartDocument;
+    _name = XmlSymbolTable::none;
+    _text = Text();
+    _textDecoded = false;
+    _emptyElement = false;
+    _attributes.clear();
+    _open.clear();
+}
+
+Node::Type XmlTokenizer::next()
+{
+    _attributes.clear();
+    _text = Text();
+    _textDecoded = false;
+
+    if (_emptyElement)
+    {
+        // the name is still the one of the start element
+        _emptyElement = false;
+        _open.pop_back();
+        _type = Node::EndElement;
+        return _type;
+    }
+
+    if (_type == Node::EndDocument)
+        return _type;
+
+    const char* p = _pos;
+    while (true)
+    {
+        const char* lt = static_cast<const char*>(std::memchr(p, '<', _end - p));
+        if (lt == 0)
+            lt = _end;
+
+        if (lt != p)
+            appendText(p, lt, true);
+
+        p = lt;
+
+        if (p == _end)
+        {
+            if (!_open.empty())
+                syntaxError("unexpected end of document", p);
+
+            if (!isWhitespace(_text.begin(), _text.end()))
+                syntaxError("unexpected characters after root element", p);
+
+            _pos = p;
+            _text = Text();
+            _type = Node::EndDocument;
+            return _type;
+        }
+
+        if (p + 1 < _end && p[1] == '!')
+        {
+            if (startsWith(p, _end, "<!--", 4))
+            {
+                p = find(p + 4, "--") + 2;
+                if (p == _end || *p != '>')
+                    syntaxError("'--' not allowed in comment", p);
+                ++p;
+            }
+            else if (startsWith(p, _end, "<![CDATA[", 9))
+            {
+                const char* e = find(p + 9, "]]>");
+                appendText(p + 9, e, false);
+                p = e + 3;
+            }
+            else
+            {
+                p = skipDocType(p + 2);
+            }
+
+            continue;
+        }
+
+        if (p + 1 < _end && p[1] == '?')
+        {
+            p = find(p + 2, "?>") + 2;
+            continue;
+        }
+
+        if (!_text.empty())
+        {
+            if (!_open.empty())
+            {
+                _pos = p;
+                _type = Node::Characters;
+                return _type;
+            }
+
+            if (!isWhitespace(_text.begin(), _text.end()))
+                syntaxError("unexpected characters outside of root element", p);
+
+            _text = Text();
+            _textDecoded = false;
+        }
+
+        if (p + 1 < _end && p[1] == '/')
+        {
+            _pos = parseEndElement(p + 2);
+            _type = Node::EndElement;
+        }
+        else
+        {
+            _pos = parseStartElement(p + 1);
+            _type = Node::StartElement;
+        }
+
+        return _type;
+    }
+}
+
+XmlTokenizer::Text XmlTokenizer::attribute(XmlSymbol name) const
+{
+    for (std::vector<Attribute>::const_iterator it = _attributes.begin(); it != _attributes.end(); ++it)
+        if (it->name == name)
+            return it->value;
+
+    return Text();
+}
+
+XmlTokenizer::Text XmlTokenizer::attribute(const char* name) const
+{
+    XmlSymbol sym = _symbols->find(name);
+    return sym == XmlSymbolTable::none ? Text() : attribute(sym);
+}
+
+bool XmlTokenizer::hasAttribute(XmlSymbol name) const
+{
+    for (std::vector<Attribute>::const_iterator it = _attributes.begin(); it != _attributes.end(); ++it)
+        if (it->name == name)
+            return true;
+
+    return false;
+}
+
+std::size_t XmlTokenizer::line() const
+{
+    return 1 + std::count(_begin, _pos, '\n');
+}
+
+void XmlTokenizer::appendText(const char* b, const char* e, bool entities)
+{
+    const char* amp = entities ? static_cast<const char*>(std::memchr(b, '&', e - b)) : 0;
+
+    if (amp == 0 && _text.empty())
+    {
+        // the common case: the text is a view into the input
+        _text = Text(b, e - b);
+        return;
+    }
+
+    if (!_textDecoded)
+    {
+        _textBuffer.assign(_text.begin(), _text.end());
+        _textDecoded = true;
+    }
+
+    if (amp == 0)
+        _textBuffer.append(b, e);
+    else
+        decode(b, e, _textBuffer);
+
+    _text = Text(_textBuffer.data(), _textBuffer.size());
+}
+
+void XmlTokenizer::decode(const char* b, const char* e, std::string& out)
+{
+    while (b < e)
+    {
+        const char* amp = static_cast<const char*>(std::memchr(b, '&', e - b));
+        if (amp == 0)
+        {
+            out.append(b, e);
+            return;
+        }
+
+        out.append(b, amp);
+
+        const char* semi = static_cast<const char*>(std::memchr(amp, ';', e - amp));
+        if (semi == 0)
+            syntaxError("unterminated entity", amp);
+
+        const char* n = amp + 1;
+        std::size_t len = semi - n;
+
+        if (len == 2 && n[0] == 'l' && n[1] == 't')
+            out += '<';
+        else if (len == 2 && n[0] == 'g' && n[1] == 't')
+            out += '>';
+        else if (len == 3 && std::memcmp(n, "amp", 3) == 0)
+            out += '&';
+        else if (len == 4 && std::memcmp(n, "quot", 4) == 0)
+            out += '"';
+        else if (len == 4 && std::memcmp(n, "apos", 4) == 0)
+            out += '\'';
+        else if (len > 1 && n[0] == '#')
+        {
+            unsigned long code = 0;
+            bool hex = n[1] == 'x';
+            const char* d = n + (hex ? 2 : 1);
+            if (d == semi)
+                syntaxError("invalid character reference", amp);
+
+            for ( ; d != semi; ++d)
+            {
+                if (*d >= '0' && *d <= '9')
+                    code = code * (hex ? 16 : 10) + (*d - '0');
+                else if (hex && *d >= 'a' && *d <= 'f')
+                    code = code * 16 + (*d - 'a' + 10);
+                else if (hex && *d >= 'A' && *d <= 'F')
+                    code = code * 16 + (*d - 'A' + 10);
+                else
+                    syntaxError("invalid character reference", amp);
+
+                if (code > 0x10ffff)
+                    syntaxError("invalid character reference", amp);
+            }
+
+            appendUtf8(out, code);
+        }
+        else
+        {
+            out += Utf8Codec::encode(_resolver.resolveEntity(String::widen(std::string(n, len))));
+        }
+
+        b = semi + 1;
+    }
+}
+
+const char* XmlTokenizer::find(const char* p, const char* delim) const
+{
+    std::size_t len = std::strlen(delim);
+    while (true)
+    {
+        p = static_cast<const char*>(std::memchr(p, delim[0], _end - p));
+        if (p == 0 || static_cast<std::size_t>(_end - p) < len)
+            syntaxError("unexpected end of document", _end);
+
+        if (std::memcmp(p, delim, len) == 0)
+            return p;
+
+        ++p;
+    }
+}
+
+const char* XmlTokenizer::skipDocType(const char* p)
+{
+    if (!startsWith(p, _end, "DOCTYPE", 7))
+        syntaxError("invalid markup declaration", p);
+
+    int brackets = 0;
+    char quote = 0;
+    for (p += 7; p < _end; ++p)
+    {
+        char c = *p;
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == '[')
+            ++brackets;
+        else if (c == ']')
+            --brackets;
+        else if (c == '>' && brackets <= 0)
+            return p + 1;
+    }
+
+    syntaxError("unexpected end of document", p);
+    return p;
+}
+
+const char* XmlTokenizer::parseStartElement(const char* p)
+{
+    const char* n = p;
+    while (p < _end && isNameChar(*p))
+        ++p;
+
+    if (p == n)
+        syntaxError("element name expected", p);
+
+    _name = _symbols->intern(n, p - n);
+    _attributeBuffer.clear();
+    _decodedAttributes.clear();
+
+    while (true)
+    {
+        while (p < _end && isSpace(*p))
+            ++p;
+
+        if (p == _end)
+            syntaxError("unexpected end of document", p);
+
+        if (*p == '>')
+        {
+            ++p;
+            break;
+        }
+
+        if (*p == '/')
+        {
+            if (p + 1 == _end || p[1] != '>')
+                syntaxError("'>' expected", p);
+
+            _emptyElement = true;
+            p += 2;
+            break;
+        }
+
+        const char* an = p;
+        while (p < _end && isNameChar(*p))
+            ++p;
+
+        if (p == an)
+            syntaxError("attribute name expected", p);
+
+        Attribute attr;
+        attr.name = _symbols->intern(an, p - an);
+
+        while (p < _end && isSpace(*p))
+            ++p;
+
+        if (p == _end || *p != '=')
+            syntaxError("'=' expected", p);
+
+        ++p;
+        while (p < _end && isSpace(*p))
+            ++p;
+
+        if (p == _end || (*p != '"' && *p != '\''))
+            syntaxError("quote expected", p);
+
+        const char* v = ++p;
+        p = static_cast<const char*>(std::memchr(v, p[-1], _end - v));
+        if (p == 0)
+            syntaxError("unexpected end of document", _end);
+
+        if (std::memchr(v, '&', p - v))
+        {
+            std::size_t offset = _attributeBuffer.size();
+            decode(v, p, _attributeBuffer);
+            _decodedAttributes.push_back(std::make_pair(_attributes.size(), offset));
+            attr.value = Text(0, _attributeBuffer.size() - offset);
+        }
+        else
+        {
+            attr.value = Text(v, p - v);
+        }
+
+        _attributes.push_back(attr);
+        ++p;
+    }
+
+    // the buffer is complete now and can not move any more
+    for (std::vector<std::pair<std::size_t, std::size_t> >::const_iterator it = _decodedAttributes.begin();
+        it != _decodedAttributes.end(); ++it)
+    {
+        Text& value = _attributes[it->first].value;
+        value = Text(_attributeBuffer.data() + it->second, value.size());
+    }
+
+    _open.push_back(_name);
+    return p;
+}
+
+const char* XmlTokenizer::parseEndElement(const char* p)
+{
+    const char* n = p;
+    while (p < _end && isNameChar(*p))
+        ++p;
+
+    if (_open.empty())
+        syntaxError("unexpected end element", n);
+
+    const std::string& expected = _symbols->name(_open.back());
+    if (expected.size() != static_cast<std::size_t>(p - n)
+        || std::memcmp(expected.data(), n, expected.size()) != 0)
+        syntaxError("end element does not match start element", n);
+
+    _name = _open.back();
+    _open.pop_back();
+
+    while (p < _end && isSpace(*p))
+        ++p;
+
+    if (p == _end || *p != '>')
+        syntaxError("'>' expected", p);
+
+    return p + 1;
+}
+
+void XmlTokenizer::syntaxError(const char* msg, const char* p) const
+{
+    throw XmlError(msg, static_cast<unsigned>(1 + std::count(_begin, p, '\n')));
+}
+
+}
+
+}
@@ -47,6 +47,11 @@ namespace
     {
         SerializationError::doThrow(msg);
     }
+
+    // element names in the order of Scanner::Tag, starting with ValueTag
+    const char* const tagNames[] = {
+        "value", "struct", "array", "member", "name", "data", "param", "fault"
+    };
 }
 
 void Scanner::begin(DeserializerBase& handler, IComposer& composer)
@@ -58,21 +63,88 @@ void Scanner::begin(DeserializerBase& handler, IComposer& composer)
 }
 
 bool Scanner::advance(const cxxtools::xml::Node& node)
+{
+    switch (node.type())
+    {
+        case xml::Node::StartElement:
+        {
+            const String& name = static_cast<const xml::StartElement&>(node).name();
+            return advance(node.type(), tagOf(name), name);
+        }
+
+        case xml::Node::EndElement:
+        {
+            const String& name = static_cast<const xml::EndElement&>(node).name();
+            return advance(node.type(), tagOf(name), name);
+        }
+
+        case xml::Node::Characters:
+            return advance(node.type(), OtherTag, static_cast<const xml::Characters&>(node).content());
+
+        default:
+            return advance(node.type(), OtherTag, String());
+    }
+}
+
+bool Scanner::advance(xml::XmlTokenizer& tokenizer)
+{
+    if (_symbols != &tokenizer.symbols())
+    {
+        _symbols = &tokenizer.symbols();
+        for (unsigned n = ValueTag; n < TagCount; ++n)
+            _tags[n] = tokenizer.symbols().intern(tagNames[n - ValueTag]);
+    }
+
+    switch (tokenizer.type())
+    {
+        case xml::Node::StartElement:
+        case xml::Node::EndElement:
+        {
+            Tag tag = OtherTag;
+            for (unsigned n = ValueTag; n < TagCount; ++n)
+            {
+                if (_tags[n] == tokenizer.name())
+                {
+                    tag = static_cast<Tag>(n);
+                    break;
+                }
+            }
+
+            return advance(tokenizer.type(), tag, tokenizer.nameString());
+        }
+
+        case xml::Node::Characters:
+            _text = tokenizer.text().toString();
+            return advance(tokenizer.type(), OtherTag, _text);
+
+        default:
+            return advance(tokenizer.type(), OtherTag, String());
+    }
+}
+
+Scanner::Tag Scanner::tagOf(const String& name)
+{
+    for (unsigned n = ValueTag; n < TagCount; ++n)
+        if (name == tagNames[n - ValueTag])
+            return static_cast<Tag>(n);
+
+    return OtherTag;
+}
+
+bool Scanner::advance(xml::Node::Type type, Tag tag, const String& text)
 {
     switch(_state)
     {
         case OnParam:
         {
-            if(node.type() == xml::Node::StartElement) // value
+            if(type == xml::Node::StartElement) // value
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 _state = OnValueBegin;
             }
-            else if(node.type() == xml::Node::EndElement)
+            else if(type == xml::Node::EndElement)
             {
                 throwSerializationError();
             }
@@ -82,15 +154,13 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnValueBegin:
         {
-            if(node.type() == xml::Node::StartElement) // i4, struct, array...
+            if(type == xml::Node::StartElement) // i4, struct, array...
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() == L"struct")
+                if(tag == StructTag)
                 {
                     _state = OnStructBegin;
                 }
-                else if(se.name() == L"array")
+                else if(tag == ArrayTag)
                 {
                     _state = OnArrayBegin;
                 }
@@ -100,19 +170,17 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
                 }
 
                 _value.clear();
-                _type = se.name();
+                _type = text;
             }
-            else if(node.type() == xml::Node::Characters)
+            else if(type == xml::Node::Characters)
             {
                 // maybe <value>...<type>...</type>...</value>  (case 1)
                 //    or <value>...</value>                     (case 2)
-                const xml::Characters& chars = static_cast<const xml::Characters&>(node);
-                _value = chars.content();
+                _value = text;
             }
-            else if(node.type() == xml::Node::EndElement)
+            else if(type == xml::Node::EndElement)
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-                if(ee.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 // is always type string
@@ -131,27 +199,25 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnValueEnd:
         {
-            if(node.type() == xml::Node::EndElement)
+            if(type == xml::Node::EndElement)
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() == L"member")
+                if(tag == MemberTag)
                 {
                     _deserializer->leaveMember();
                     _state = OnStructBegin;
                 }
-                else if(ee.name() == L"data")
+                else if(tag == DataTag)
                 {
                     _deserializer->leaveMember();
                     _state = OnDataEnd;
                 }
-                else if(ee.name() == L"param")
+                else if(tag == ParamTag)
                 {
                     _composer->fixup(*_deserializer->si());
                     _state = OnValueEnd;
                     return true;
                 }
-                else if(ee.name() == L"fault")
+                else if(tag == FaultTag)
                 {
                     _composer->fixup(*_deserializer->si());
                     _state = OnValueEnd;
@@ -162,10 +228,9 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
                     throwSerializationError();
                 }
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-                if(se.name() == L"value")
+                if(tag == ValueTag)
                 {
                     _deserializer->leaveMember();
                     _deserializer->beginMember(std::string(), _type.narrow(), SerializationInfo::Value);
@@ -182,16 +247,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnStructBegin:
         {
-            if(node.type() == xml::Node::StartElement) // <member>
+            if(type == xml::Node::StartElement) // <member>
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() != L"member")
+                if(tag != MemberTag)
                     throwSerializationError();
 
                 _state = OnMemberBegin;
             }
-            else if(node.type() == xml::Node::EndElement) // </struct>
+            else if(type == xml::Node::EndElement) // </struct>
             {
                 _state = OnStructEnd;
             }
@@ -200,16 +263,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnStructEnd:
         {
-            if(node.type() == xml::Node::EndElement) // </value>
+            if(type == xml::Node::EndElement) // </value>
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 _state = OnValueEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
@@ -219,16 +280,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnMemberBegin:
         {
-            if(node.type() == xml::Node::StartElement) // name
+            if(type == xml::Node::StartElement) // name
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() != L"name")
+                if(tag != NameTag)
                     throwSerializationError();
 
                 _state = OnNameBegin;
             }
-            else if(node.type() == xml::Node::EndElement)
+            else if(type == xml::Node::EndElement)
             {
                 throwSerializationError();
             }
@@ -238,10 +297,9 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnNameBegin:
         {
-            if(node.type() == xml::Node::Characters) // member-name
+            if(type == xml::Node::Characters) // member-name
             {
-                const xml::Characters& chars = static_cast<const xml::Characters&>(node);
-                const std::string& name = chars.content().narrow();
+                const std::string& name = text.narrow();
 
                 _deserializer->beginMember(name, std::string(), SerializationInfo::Object);
 
@@ -257,16 +315,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnName:
         {
-            if(node.type() == xml::Node::EndElement) // </name>
+            if(type == xml::Node::EndElement) // </name>
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() != L"name")
+                if(tag != NameTag)
                     throwSerializationError();
 
                 _state = OnNameEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
@@ -276,16 +332,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnNameEnd:
         {
-            if(node.type() == xml::Node::StartElement) // <value>
+            if(type == xml::Node::StartElement) // <value>
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 _state = OnValueBegin;
             }
-            else if(node.type() == xml::Node::EndElement)
+            else if(type == xml::Node::EndElement)
             {
                 throwSerializationError();
             }
@@ -295,14 +349,13 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnScalarBegin:
         {
-            if(node.type() == xml::Node::Characters)
+            if(type == xml::Node::Characters)
             {
-                const xml::Characters& chars = static_cast<const xml::Characters&>(node);
                 _state = OnScalar;
 
-                _deserializer->setValue( chars.content() );
+                _deserializer->setValue( text );
             }
-            else if(node.type() == xml::Node::EndElement) // no content, for example empty strings
+            else if(type == xml::Node::EndElement) // no content, for example empty strings
             {
                
                 _deserializer->setValue( cxxtools::String() );
@@ -318,11 +371,11 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnScalar:
         {
-            if(node.type() == xml::Node::EndElement) // </int>, boolean ...
+            if(type == xml::Node::EndElement) // </int>, boolean ...
             {
                 _state = OnScalarEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
@@ -332,16 +385,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnScalarEnd:
         {
-            if(node.type() == xml::Node::EndElement) // </value>
+            if(type == xml::Node::EndElement) // </value>
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 _state = OnValueEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
@@ -351,16 +402,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnArrayBegin:
         {
-            if(node.type() == xml::Node::StartElement) // <data>
+            if(type == xml::Node::StartElement) // <data>
             {
-                const xml::StartElement& se = static_cast<const xml::StartElement&>(node);
-
-                if(se.name() != L"data")
+                if(tag != DataTag)
                     throwSerializationError();
 
                 _state = OnDataBegin;
             }
-            else if(node.type() == xml::Node::EndElement)
+            else if(type == xml::Node::EndElement)
             {
                 throwSerializationError();
             }
@@ -370,15 +419,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnDataBegin:
         {
-            if(node.type() == xml::Node::StartElement) // value
+            if(type == xml::Node::StartElement) // value
             {
                 _deserializer->beginMember(std::string(), std::string(), SerializationInfo::Array);
                 _state = OnValueBegin;
             }
-            else if(node.type() == xml::Node::EndElement) // empty array
+            else if(type == xml::Node::EndElement) // empty array
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-                if(ee.name() != L"data")
+                if(tag != DataTag)
                     throwSerializationError();
 
                 _state = OnDataEnd;
@@ -389,16 +437,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnDataEnd:
         {
-            if(node.type() == xml::Node::EndElement) // </array>
+            if(type == xml::Node::EndElement) // </array>
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() != L"array")
+                if(tag != ArrayTag)
                     throwSerializationError();
 
                 _state = OnArrayEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
@@ -408,16 +454,14 @@ bool Scanner::advance(const cxxtools::xml::Node& node)
 
         case OnArrayEnd:
         {
-            if(node.type() == xml::Node::EndElement) // </value>
+            if(type == xml::Node::EndElement) // </value>
             {
-                const xml::EndElement& ee = static_cast<const xml::EndElement&>(node);
-
-                if(ee.name() != L"value")
+                if(tag != ValueTag)
                     throwSerializationError();
 
                 _state = OnValueEnd;
             }
-            else if(node.type() == xml::Node::StartElement)
+            else if(type == xml::Node::StartElement)
             {
                 throwSerializationError();
             }
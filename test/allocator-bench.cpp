@@ -0,0 +1,135 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <cxxtools/function.h>
+#include <cxxtools/poolallocator.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+
+namespace
+{
+    // Keeps a window of live blocks of varying size and replaces the
+    // oldest one in each step, like objects passed through a queue.
+    class Bench
+    {
+            cxxtools::Allocator& _allocator;
+            unsigned _n;
+            unsigned _window;
+
+        public:
+            Bench(cxxtools::Allocator& allocator, unsigned n, unsigned window)
+                : _allocator(allocator),
+                  _n(n),
+                  _window(window)
+                { }
+
+            void run()
+            {
+                std::vector<std::pair<void*, std::size_t> > blocks(_window, std::pair<void*, std::size_t>(0, 0));
+
+                for (unsigned n = 0; n < _n; ++n)
+                {
+                    std::pair<void*, std::size_t>& b = blocks[n % _window];
+                    _allocator.deallocate(b.first, b.second);
+                    b.second = 16 + (n * 7) % 200;
+                    b.first = _allocator.allocate(b.second);
+                }
+
+                for (unsigned n = 0; n < _window; ++n)
+                    _allocator.deallocate(blocks[n].first, blocks[n].second);
+            }
+    };
+
+    void bench(const char* name, cxxtools::Allocator& allocator, unsigned threads, unsigned n, unsigned window)
+    {
+        Bench b(allocator, n, window);
+        std::vector<cxxtools::AttachedThread*> t;
+        for (unsigned i = 0; i < threads; ++i)
+            t.push_back(new cxxtools::AttachedThread(cxxtools::callable(b, &Bench::run)));
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->join();
+
+        cxxtools::Timespan ts = clock.stop();
+
+        for (unsigned i = 0; i < threads; ++i)
+            delete t[i];
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << '\t' << name << ": " << secs << " sec, "
+                  << secs * 1e9 / (threads * n) << " ns per allocation" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 2000000);
+        cxxtools::Arg<unsigned> maxThreads(argc, argv, 't', 8);
+        cxxtools::Arg<unsigned> window(argc, argv, 'w', 100);
+
+        std::cout << "benchmark " << n.getValue() << " allocations per thread\n\n"
+                     "options:\n"
+                     "   -n <number>       number of allocations per thread\n"
+                     "   -t <number>       maximum number of threads (default: 8)\n"
+                     "   -w <number>       number of live blocks per thread (default: 100)\n" << std::endl;
+
+        cxxtools::Allocator newAllocator;
+        cxxtools::PoolAllocator poolAllocator;
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            std::cout << threads << " threads:" << std::endl;
+            bench("operator new", newAllocator, threads, n, window);
+            bench("PoolAllocator", poolAllocator, threads, n, window);
+        }
+
+        cxxtools::PoolAllocator::Stats s = poolAllocator.stats();
+        std::cout << "\nPoolAllocator: " << s.allocations << " allocations, "
+                  << s.refills << " refills, "
+                  << s.flushes << " flushes, "
+                  << s.chunks << " chunks, "
+                  << s.reserved << " bytes reserved" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -33,6 +33,7 @@
 #include "cxxtools/remoteprocedure.h"
 #include "cxxtools/eventloop.h"
 #include "cxxtools/log.h"
+#include "cxxtools/thread.h"
 #include <stdlib.h>
 #include <sstream>
 
@@ -105,6 +106,8 @@ class BinRpcTest : public cxxtools::unit::TestSuite
             registerMethod("CallbackException", *this, &BinRpcTest::CallbackException);
             registerMethod("ConnectError", *this, &BinRpcTest::ConnectError);
             registerMethod("BigRequest", *this, &BinRpcTest::BigRequest);
+            registerMethod("Pipelined", *this, &BinRpcTest::Pipelined);
+            registerMethod("OutOfOrder", *this, &BinRpcTest::OutOfOrder);
 
             char* PORT = getenv("UTEST_PORT");
             if (PORT)
@@ -676,6 +679,82 @@ class BinRpcTest : public cxxtools::unit::TestSuite
             return v.size();
         }
 
+        ////////////////////////////////////////////////////////////
+        // Pipelined
+        //
+        void Pipelined()
+        {
+            _server->registerMethod("multiply", *this, &BinRpcTest::multiplyInt);
+
+            cxxtools::bin::RpcClient client(_loop, "", _port);
+            cxxtools::RemoteProcedure<int, int, int> multiply1(client, "multiply");
+            cxxtools::RemoteProcedure<int, int, int> multiply2(client, "multiply");
+            cxxtools::RemoteProcedure<int, int, int> multiply3(client, "multiply");
+
+            multiply1.begin(2, 3);
+            multiply2.begin(4, 5);
+            multiply3.begin(6, 7);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(multiply3.end(2000), 42);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(multiply1.end(2000), 6);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(multiply2.end(2000), 20);
+
+            // the connection is reused after negotiation
+            multiply1.begin(8, 9);
+            multiply2.begin(10, 11);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(multiply2.end(2000), 110);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(multiply1.end(2000), 72);
+        }
+
+        ////////////////////////////////////////////////////////////
+        // OutOfOrder
+        //
+        void OutOfOrder()
+        {
+            _server->minThreads(2);
+            _server->registerMethod("sleep", *this, &BinRpcTest::sleep);
+
+            cxxtools::bin::RpcClient client(_loop, "", _port);
+            cxxtools::RemoteProcedure<unsigned, unsigned> slow(client, "sleep");
+            cxxtools::RemoteProcedure<unsigned, unsigned> fast(client, "sleep");
+
+            // negotiate the protocol first
+            fast.begin(0);
+            fast.end(2000);
+
+            connect(slow.finished, *this, &BinRpcTest::onSlowFinished);
+            connect(fast.finished, *this, &BinRpcTest::onFastFinished);
+
+            _finished.clear();
+            slow.begin(200);
+            fast.begin(0);
+
+            _loop.run();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_finished, "fast slow");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(slow.result(), 200u);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(fast.result(), 0u);
+        }
+
+        unsigned sleep(unsigned msecs)
+        {
+            cxxtools::Thread::sleep(msecs);
+            return msecs;
+        }
+
+        void onFastFinished(const cxxtools::RemoteResult<unsigned>& r)
+        {
+            _finished += "fast ";
+        }
+
+        void onSlowFinished(const cxxtools::RemoteResult<unsigned>& r)
+        {
+            _finished += "slow";
+            _loop.exit();
+        }
+
+        std::string _finished;
+
 };
 
 cxxtools::unit::RegisterTest<BinRpcTest> register_BinRpcTest;
@@ -124,6 +124,13 @@ class BinSerializerTest : public cxxtools::unit::TestSuite
             registerMethod("testComplexObject", *this, &BinSerializerTest::testComplexObject);
             registerMethod("testObjectVector", *this, &BinSerializerTest::testObjectVector);
             registerMethod("testBinaryData", *this, &BinSerializerTest::testBinaryData);
+            registerMethod("testDictionary", *this, &BinSerializerTest::testDictionary);
+            registerMethod("testLargeDictionary", *this, &BinSerializerTest::testLargeDictionary);
+            registerMethod("testReferenceLikeNames", *this, &BinSerializerTest::testReferenceLikeNames);
+            registerMethod("testPackedArray", *this, &BinSerializerTest::testPackedArray);
+            registerMethod("testPackedArrayConversion", *this, &BinSerializerTest::testPackedArrayConversion);
+            registerMethod("testSizedContainers", *this, &BinSerializerTest::testSizedContainers);
+            registerMethod("testProjection", *this, &BinSerializerTest::testProjection);
         }
 
         void testScalar()
@@ -400,6 +407,305 @@ class BinSerializerTest : public cxxtools::unit::TestSuite
             CXXTOOLS_UNIT_ASSERT(v == v2);
 
         }
+        void testDictionary()
+        {
+            std::vector<TestObject2> obj;
+            obj.resize(1000);
+            for (unsigned n = 0; n < obj.size(); ++n)
+            {
+                obj[n].intValue = n;
+                obj[n].stringValue = "foo";
+                obj[n].doubleValue = n * 0.5;
+                obj[n].boolValue = n % 2 == 0;
+                obj[n].nullValue = true;
+                obj[n].setValue.insert(n);
+                obj[n].mapValue[n] = "bar";
+            }
+
+            std::stringstream plain;
+            cxxtools::bin::Serializer(plain).serialize(obj);
+
+            std::stringstream data;
+            cxxtools::bin::Serializer serializer(data);
+            serializer.useDictionary(true);
+            serializer.serialize(obj);
+            serializer.serialize(obj);
+
+            log_debug("size without dictionary " << plain.str().size() << " with dictionary " << data.str().size() / 2);
+            CXXTOOLS_UNIT_ASSERT(data.str().size() / 2 < plain.str().size() / 2);
+
+            // each value has its own dictionary
+            for (unsigned n = 0; n < 2; ++n)
+            {
+                cxxtools::bin::Deserializer deserializer(data);
+                std::vector<TestObject2> obj2;
+                deserializer.deserialize(obj2);
+                CXXTOOLS_UNIT_ASSERT(obj == obj2);
+            }
+        }
+
+        void testLargeDictionary()
+        {
+            cxxtools::SerializationInfo si;
+            si.setTypeName("Large");
+            for (unsigned n = 0; n < 300; ++n)
+            {
+                std::ostringstream name;
+                name << "member" << n;
+                si.addMember(name.str()) <<= n;
+            }
+
+            std::vector<cxxtools::SerializationInfo> v(2, si);
+
+            std::stringstream data;
+            cxxtools::bin::Serializer serializer(data);
+            serializer.useDictionary(true);
+            serializer.serialize(v);
+
+            cxxtools::bin::Deserializer deserializer(data);
+            std::vector<cxxtools::SerializationInfo> v2;
+            deserializer.deserialize(v2);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v2.size(), 2);
+            for (unsigned n = 0; n < 2; ++n)
+            {
+                CXXTOOLS_UNIT_ASSERT_EQUALS(v2[n].typeName(), "Large");
+                CXXTOOLS_UNIT_ASSERT_EQUALS(v2[n].memberCount(), 300);
+                unsigned value = 0;
+                v2[n].getMember("member299") >>= value;
+                CXXTOOLS_UNIT_ASSERT_EQUALS(value, 299);
+            }
+        }
+
+        void testReferenceLikeNames()
+        {
+            // names starting with the bytes of name references, e.g. "\xfc" "ber"
+            // in latin 1
+            cxxtools::SerializationInfo si;
+            si.setTypeName("\xfe");
+            si.addMember("\xfc" "ber") <<= 1;
+            si.addMember("\xfd") <<= 2;
+            si.addMember("\xfe" "x") <<= 3;
+
+            for (unsigned n = 0; n < 2; ++n)
+            {
+                std::stringstream data;
+                cxxtools::bin::Serializer serializer(data);
+                serializer.useDictionary(n == 1);
+                serializer.serialize(si);
+                serializer.serialize(si);
+
+                for (unsigned nn = 0; nn < 2; ++nn)
+                {
+                    cxxtools::bin::Deserializer deserializer(data);
+                    cxxtools::SerializationInfo si2;
+                    deserializer.deserialize(si2);
+
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(si2.typeName(), "\xfe");
+                    int v = 0;
+                    si2.getMember("\xfc" "ber") >>= v;
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(v, 1);
+                    si2.getMember("\xfd") >>= v;
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(v, 2);
+                    si2.getMember("\xfe" "x") >>= v;
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(v, 3);
+                }
+            }
+        }
+
+        void testPackedArray()
+        {
+            std::vector<double> v;
+            for (unsigned n = 0; n < 1000; ++n)
+                v.push_back(n * 3.14159);
+
+            std::stringstream data;
+            cxxtools::bin::Serializer serializer(data);
+            serializer.serialize(v);
+
+            // type code, name, element type, count and 8 bytes per element
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data.str().size(), 1 + 1 + 1 + 4 + 8 * v.size());
+
+            std::vector<double> v2;
+            cxxtools::bin::Deserializer deserializer(data);
+            deserializer.deserialize(v2);
+            CXXTOOLS_UNIT_ASSERT(v == v2);
+
+            // the generic parser gives a normal array
+            data.seekg(0);
+            cxxtools::bin::Deserializer deserializer2(data);
+            cxxtools::SerializationInfo si;
+            deserializer2.deserialize(si);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(si.category(), cxxtools::SerializationInfo::Array);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(si.memberCount(), v.size());
+            double d = 0;
+            si.getMember(999) >>= d;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(d, v[999]);
+
+            data.str(std::string());
+            std::vector<int> i;
+            i.push_back(-1);
+            i.push_back(0);
+            i.push_back(0x7fffffff);
+            serializer.serialize(i, "ints");
+
+            std::vector<int> i2;
+            cxxtools::bin::Deserializer deserializer3(data);
+            deserializer3.deserialize(i2);
+            CXXTOOLS_UNIT_ASSERT(i == i2);
+
+            // empty array
+            data.str(std::string());
+            i.clear();
+            serializer.serialize(i);
+            i2.push_back(5);
+            cxxtools::bin::Deserializer deserializer4(data);
+            deserializer4.deserialize(i2);
+            CXXTOOLS_UNIT_ASSERT(i2.empty());
+        }
+
+        void testPackedArrayConversion()
+        {
+            std::vector<short> v;
+            v.push_back(-300);
+            v.push_back(17);
+
+            std::stringstream data;
+            cxxtools::bin::Serializer serializer(data);
+            serializer.serialize(v);
+
+            std::vector<double> v2;
+            cxxtools::bin::Deserializer deserializer(data);
+            deserializer.deserialize(v2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v2.size(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v2[0], -300);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v2[1], 17);
+
+            // a vector of objects containing packed arrays
+            data.str(std::string());
+            std::vector<std::vector<float> > vv(2);
+            vv[0].push_back(1.5);
+            vv[1].push_back(-2.25);
+            vv[1].push_back(4);
+
+            cxxtools::bin::Formatter formatter(data);
+            formatter.beginObject("", "");
+            formatter.beginMember("a");
+            formatter.addPackedArray("a", &vv[0][0], vv[0].size());
+            formatter.finishMember();
+            formatter.beginMember("b");
+            formatter.addPackedArray("b", &vv[1][0], vv[1].size());
+            formatter.finishMember();
+            formatter.finishObject();
+
+            cxxtools::bin::Deserializer deserializer2(data);
+            cxxtools::SerializationInfo si2;
+            deserializer2.deserialize(si2);
+            std::vector<float> b;
+            si2.getMember("b") >>= b;
+            CXXTOOLS_UNIT_ASSERT(b == vv[1]);
+        }
+
+        void testSizedContainers()
+        {
+            std::vector<TestObject2> obj;
+            obj.resize(100);
+            for (unsigned n = 0; n < obj.size(); ++n)
+            {
+                obj[n].intValue = n;
+                obj[n].stringValue = "foo";
+                obj[n].doubleValue = n * 0.5;
+                obj[n].boolValue = n % 2 == 0;
+                obj[n].nullValue = true;
+                obj[n].setValue.insert(n);
+                obj[n].setValue.insert(n + 1);
+                obj[n].mapValue[n] = "bar";
+            }
+
+            std::stringstream data;
+            cxxtools::bin::Serializer serializer(data);
+            serializer.useSizedContainers(true);
+            serializer.serialize(obj);
+            serializer.serialize(42);
+            serializer.useDictionary(true);
+            serializer.serialize(obj);
+
+            std::vector<TestObject2> obj2;
+            cxxtools::bin::Deserializer deserializer(data);
+            deserializer.deserialize(obj2);
+            CXXTOOLS_UNIT_ASSERT(obj == obj2);
+
+            int i = 0;
+            cxxtools::bin::Deserializer deserializer2(data);
+            deserializer2.deserialize(i);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(i, 42);
+
+            cxxtools::SerializationInfo si;
+            cxxtools::bin::Deserializer deserializer3(data);
+            deserializer3.deserialize(si);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(si.memberCount(), obj.size());
+            si >>= obj2;
+            CXXTOOLS_UNIT_ASSERT(obj == obj2);
+        }
+
+        void testProjection()
+        {
+            std::vector<TestObject2> obj;
+            obj.resize(10);
+            for (unsigned n = 0; n < obj.size(); ++n)
+            {
+                obj[n].intValue = n;
+                obj[n].stringValue = "foo";
+                obj[n].doubleValue = n * 0.5;
+                obj[n].boolValue = true;
+                obj[n].nullValue = true;
+                obj[n].mapValue[n] = "bar";
+            }
+
+            std::set<std::string> members;
+            members.insert("intValue");
+            members.insert("mapValue");
+
+            // skipping works with and without sized containers
+            for (unsigned sized = 0; sized < 2; ++sized)
+            {
+                std::stringstream data;
+                cxxtools::bin::Serializer serializer(data);
+                serializer.useSizedContainers(sized != 0);
+                serializer.serialize(obj);
+                serializer.serialize(obj[3]);
+
+                cxxtools::bin::Deserializer deserializer(data);
+                deserializer.projection(members);
+
+                cxxtools::SerializationInfo si;
+                deserializer.deserialize(si);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(si.memberCount(), obj.size());
+
+                for (unsigned n = 0; n < obj.size(); ++n)
+                {
+                    const cxxtools::SerializationInfo& m = si.getMember(n);
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(m.memberCount(), 2);
+                    CXXTOOLS_UNIT_ASSERT(m.findMember("stringValue") == 0);
+                    CXXTOOLS_UNIT_ASSERT(m.findMember("setValue") == 0);
+
+                    int intValue = -1;
+                    m.getMember("intValue") >>= intValue;
+                    CXXTOOLS_UNIT_ASSERT_EQUALS(intValue, static_cast<int>(n));
+
+                    // members of a projected member are read completely
+                    TestObject2::MapType mapValue;
+                    m.getMember("mapValue") >>= mapValue;
+                    CXXTOOLS_UNIT_ASSERT(mapValue == obj[n].mapValue);
+                }
+
+                TestObject2 obj2;
+                cxxtools::bin::Deserializer deserializer2(data);
+                deserializer2.deserialize(obj2);
+                CXXTOOLS_UNIT_ASSERT(obj2 == obj[3]);
+            }
+        }
+
 };
 
 cxxtools::unit::RegisterTest<BinSerializerTest> register_BinSerializerTest;
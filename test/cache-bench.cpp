@@ -0,0 +1,163 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <cxxtools/function.h>
+#include <cxxtools/concurrentcache.h>
+#include <cxxtools/lrucache.h>
+#include <cxxtools/cache.h>
+#include <cxxtools/mutex.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+
+namespace
+{
+    // The existing caches are not thread safe, so they are shared
+    // behind a mutex the way applications use them.
+    template <typename CacheType>
+    class Locked
+    {
+            CacheType _cache;
+            cxxtools::Mutex _mutex;
+
+        public:
+            explicit Locked(unsigned capacity)
+                : _cache(capacity)
+                { }
+
+            bool get(unsigned key, unsigned& value)
+            {
+                cxxtools::MutexLock lock(_mutex);
+                std::pair<bool, unsigned> r = _cache.getx(key);
+                value = r.second;
+                return r.first;
+            }
+
+            void put(unsigned key, unsigned value)
+            {
+                cxxtools::MutexLock lock(_mutex);
+                _cache.put(key, value);
+            }
+    };
+
+    // Looks up pseudo random keys and puts the missing ones.
+    template <typename CacheType>
+    class Bench
+    {
+            CacheType& _cache;
+            unsigned _keys;
+            unsigned _n;
+
+        public:
+            Bench(CacheType& cache, unsigned keys, unsigned n)
+                : _cache(cache),
+                  _keys(keys),
+                  _n(n)
+                { }
+
+            void run()
+            {
+                unsigned r = reinterpret_cast<unsigned long>(this) & 0xffff;
+                for (unsigned n = 0; n < _n; ++n)
+                {
+                    r = r * 1103515245 + 12345;
+                    unsigned key = (r >> 8) % _keys;
+                    unsigned value;
+                    if (!_cache.get(key, value))
+                        _cache.put(key, key);
+                }
+            }
+    };
+
+    template <typename CacheType>
+    void bench(const char* name, CacheType& cache, unsigned keys, unsigned threads, unsigned n)
+    {
+        Bench<CacheType> b(cache, keys, n);
+        std::vector<cxxtools::AttachedThread*> t;
+        for (unsigned i = 0; i < threads; ++i)
+            t.push_back(new cxxtools::AttachedThread(cxxtools::callable(b, &Bench<CacheType>::run)));
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->join();
+
+        cxxtools::Timespan ts = clock.stop();
+
+        for (unsigned i = 0; i < threads; ++i)
+            delete t[i];
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << '\t' << name << ": " << secs << " sec, "
+                  << static_cast<unsigned long>(threads * n / secs) << " lookups/sec" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 200000);
+        cxxtools::Arg<unsigned> maxThreads(argc, argv, 't', 8);
+        cxxtools::Arg<unsigned> capacity(argc, argv, 'c', 1000);
+        cxxtools::Arg<unsigned> keys(argc, argv, 'k', 1500);
+
+        std::cout << "benchmark " << n.getValue() << " cache lookups per thread\n\n"
+                     "options:\n"
+                     "   -n <number>       number of lookups per thread\n"
+                     "   -t <number>       maximum number of threads (default: 8)\n"
+                     "   -c <number>       capacity of the cache (default: 1000)\n"
+                     "   -k <number>       number of distinct keys (default: 1500)\n" << std::endl;
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            std::cout << threads << " threads:" << std::endl;
+
+            Locked<cxxtools::LruCache<unsigned, unsigned> > lruCache(capacity);
+            bench("LruCache with mutex", lruCache, keys, threads, n);
+
+            Locked<cxxtools::Cache<unsigned, unsigned> > cache(capacity);
+            bench("Cache with mutex", cache, keys, threads, n);
+
+            cxxtools::ConcurrentCache<unsigned, unsigned> concurrentCache(capacity);
+            bench("ConcurrentCache", concurrentCache, keys, threads, n);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,276 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/concurrentcache.h"
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/thread.h"
+#include "cxxtools/atomicity.h"
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    class Square
+    {
+            volatile cxxtools::atomic_t& _calls;
+
+        public:
+            explicit Square(volatile cxxtools::atomic_t& calls)
+                : _calls(calls)
+                { }
+
+            int operator() (int n) const
+            {
+                cxxtools::atomicIncrement(_calls);
+                cxxtools::Thread::sleep(10);
+                return n * n;
+            }
+    };
+
+    int fail(int)
+    {
+        throw std::runtime_error("compute failed");
+    }
+}
+
+class ConcurrentCacheTest : public cxxtools::unit::TestSuite
+{
+        cxxtools::ConcurrentCache<int, int>* _cache;
+        volatile cxxtools::atomic_t _calls;
+
+        void compute()
+        {
+            for (int n = 0; n < 4; ++n)
+                _cache->getOrCompute(n, Square(_calls));
+        }
+
+    public:
+        ConcurrentCacheTest()
+        : cxxtools::unit::TestSuite("concurrentcache")
+        {
+            registerMethod("cacheTest", *this, &ConcurrentCacheTest::cacheTest);
+            registerMethod("lru", *this, &ConcurrentCacheTest::lru);
+            registerMethod("erase", *this, &ConcurrentCacheTest::erase);
+            registerMethod("cost", *this, &ConcurrentCacheTest::cost);
+            registerMethod("stringKeys", *this, &ConcurrentCacheTest::stringKeys);
+            registerMethod("ttl", *this, &ConcurrentCacheTest::ttl);
+            registerMethod("getOrCompute", *this, &ConcurrentCacheTest::getOrCompute);
+            registerMethod("computeFails", *this, &ConcurrentCacheTest::computeFails);
+            registerMethod("collapseMisses", *this, &ConcurrentCacheTest::collapseMisses);
+            registerMethod("stats", *this, &ConcurrentCacheTest::stats);
+        }
+
+        void cacheTest()
+        {
+            // single shard, so that the capacity is exact
+            cxxtools::ConcurrentCache<int, int> cache(6, 1);
+
+            for (int n = 1; n <= 10; ++n)
+                cache.put(n, n * 10);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 6);
+
+            int value;
+            CXXTOOLS_UNIT_ASSERT(!cache.get(1, value));
+            CXXTOOLS_UNIT_ASSERT(!cache.get(4, value));
+            CXXTOOLS_UNIT_ASSERT(cache.get(8, value));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(value, 80);
+
+            cache.put(8, 81);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(8), 81);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 6);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(11, -1), -1);
+        }
+
+        void lru()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(3, 1);
+
+            cache.put(1, 10);
+            cache.put(2, 20);
+            cache.put(3, 30);
+
+            // 1 becomes the most recently used, so 2 is evicted
+            int value;
+            CXXTOOLS_UNIT_ASSERT(cache.get(1, value));
+            cache.put(4, 40);
+
+            CXXTOOLS_UNIT_ASSERT(cache.get(1, value));
+            CXXTOOLS_UNIT_ASSERT(!cache.get(2, value));
+            CXXTOOLS_UNIT_ASSERT(cache.get(3, value));
+            CXXTOOLS_UNIT_ASSERT(cache.get(4, value));
+        }
+
+        void erase()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(100);
+
+            for (int n = 0; n < 50; ++n)
+                cache.put(n, n);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 50);
+            CXXTOOLS_UNIT_ASSERT(cache.erase(7));
+            CXXTOOLS_UNIT_ASSERT(!cache.erase(7));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 49);
+
+            int value;
+            CXXTOOLS_UNIT_ASSERT(!cache.get(7, value));
+            CXXTOOLS_UNIT_ASSERT(cache.get(8, value));
+
+            cache.clear();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.cost(), 0);
+            CXXTOOLS_UNIT_ASSERT(!cache.get(8, value));
+        }
+
+        void cost()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(1000, 1);
+
+            cache.put(1, 1, 400);
+            cache.put(2, 2, 400);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.cost(), 800);
+
+            cache.put(3, 3, 300);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.cost(), 700);
+
+            int value;
+            CXXTOOLS_UNIT_ASSERT(!cache.get(1, value));
+
+            cache.put(2, 2, 100);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.cost(), 400);
+
+            cache.setCapacity(350);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.cost(), 100);
+            CXXTOOLS_UNIT_ASSERT(cache.get(2, value));
+        }
+
+        void stringKeys()
+        {
+            cxxtools::ConcurrentCache<std::string, std::string> cache(1000);
+
+            for (int n = 0; n < 500; ++n)
+                cache.put(std::string(n % 50 + 1, 'a' + n % 26), "value");
+
+            CXXTOOLS_UNIT_ASSERT(cache.size() <= 500);
+
+            cache.put("foo", "bar");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get("foo"), "bar");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get("baz", "none"), "none");
+        }
+
+        void ttl()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(10);
+            cache.ttl(cxxtools::Timespan(0, 50000));
+
+            cache.put(1, 10);
+
+            int value;
+            CXXTOOLS_UNIT_ASSERT(cache.get(1, value));
+
+            cxxtools::Thread::sleep(100);
+            CXXTOOLS_UNIT_ASSERT(!cache.get(1, value));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 0);
+        }
+
+        void getOrCompute()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(10);
+            _calls = 0;
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getOrCompute(5, Square(_calls)), 25);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getOrCompute(5, Square(_calls)), 25);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::atomicGet(_calls), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(5), 25);
+        }
+
+        void computeFails()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(10);
+
+            CXXTOOLS_UNIT_ASSERT_THROW(cache.getOrCompute(5, fail), std::runtime_error);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 0);
+
+            int value;
+            CXXTOOLS_UNIT_ASSERT(!cache.get(5, value));
+
+            _calls = 0;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.getOrCompute(5, Square(_calls)), 25);
+        }
+
+        void collapseMisses()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(100);
+            _cache = &cache;
+            _calls = 0;
+
+            std::vector<cxxtools::AttachedThread*> threads;
+            for (unsigned n = 0; n < 8; ++n)
+                threads.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &ConcurrentCacheTest::compute)));
+
+            for (unsigned n = 0; n < threads.size(); ++n)
+                threads[n]->start();
+
+            for (unsigned n = 0; n < threads.size(); ++n)
+            {
+                threads[n]->join();
+                delete threads[n];
+            }
+
+            // each value is computed just once
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::atomicGet(_calls), 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.size(), 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.get(3), 9);
+        }
+
+        void stats()
+        {
+            cxxtools::ConcurrentCache<int, int> cache(10);
+
+            cache.put(1, 10);
+
+            int value;
+            cache.get(1, value);
+            cache.get(1, value);
+            cache.get(1, value);
+            cache.get(2, value);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.hits(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.misses(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.hitRatio(), 0.75);
+
+            cache.clear(true);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.hits(), 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(cache.misses(), 0);
+        }
+};
+
+cxxtools::unit::RegisterTest<ConcurrentCacheTest> register_ConcurrentCacheTest;
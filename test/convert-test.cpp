@@ -32,6 +32,9 @@
 #include "cxxtools/string.h"
 #include "cxxtools/log.h"
 #include <limits>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 log_define("cxxtools.test.convert")
@@ -43,6 +46,39 @@ namespace
         double q = v1 / v2;
         return q > 1 - e && q < 1 + e;
     }
+
+    // xorshift random generator, which gives the same sequence everywhere
+    uint64_t nextRandom(uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    bool sameBits(double a, double b)
+    {
+        return memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+    bool sameBits(float a, float b)
+    {
+        return memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+    // number of digits of the shortest representation, which the C library
+    // reads back to the same value
+    int libcShortest(double d)
+    {
+        char buffer[40];
+        for (int p = 1; p < 17; ++p)
+        {
+            snprintf(buffer, sizeof(buffer), "%.*e", p - 1, d);
+            if (sameBits(strtod(buffer, 0), d))
+                return p;
+        }
+        return 17;
+    }
 }
 
 class ConvertTest : public cxxtools::unit::TestSuite
@@ -57,6 +93,11 @@ class ConvertTest : public cxxtools::unit::TestSuite
             registerMethod("infTest", *this, &ConvertTest::infTest);
             registerMethod("emptyTest", *this, &ConvertTest::emptyTest);
             registerMethod("floatTest", *this, &ConvertTest::floatTest);
+            registerMethod("shortestTest", *this, &ConvertTest::shortestTest);
+            registerMethod("shortestDecimalTest", *this, &ConvertTest::shortestDecimalTest);
+            registerMethod("exactParseTest", *this, &ConvertTest::exactParseTest);
+            registerMethod("doubleRoundTripTest", *this, &ConvertTest::doubleRoundTripTest);
+            registerMethod("floatRoundTripTest", *this, &ConvertTest::floatRoundTripTest);
         }
 
         void successTest()
@@ -281,6 +322,165 @@ class ConvertTest : public cxxtools::unit::TestSuite
           t(12);
         }
 
+        void shortestTest()
+        {
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(0.1), "0.1");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(0.1 + 0.2), "0.30000000000000004");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(-1.5), "-1.5");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(100.0), "100");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(0.0), "0");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(1e21), "1000000000000000000000");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(1.25e-5), "0.0000125");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(9007199254740993.0), "9007199254740992");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(1e23), "1" + std::string(23, '0'));
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(5e-324), "0." + std::string(323, '0') + '5');
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(1.7976931348623157e308), "17976931348623157" + std::string(292, '0'));
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(2.2250738585072014e-308), "0." + std::string(307, '0') + "22250738585072014");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(1e-45f), "0." + std::string(44, '0') + '1');
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(0.1f), "0.1");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(16777216.0f), "16777216");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<std::string>(3.4028235e38f), "340282350000000000000000000000000000000");
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<cxxtools::String>(2.5), cxxtools::String(L"2.5"));
+        }
+
+        // Decimal numbers with up to 15 digits are shortest with their own digits.
+        // Many of them are hard cases for approximating algorithms like 1e23.
+        void shortestDecimalTest()
+        {
+          for (unsigned k = 1; k < 2000; ++k)
+          {
+            std::string kdigits = cxxtools::convert<std::string>(k);
+            while (kdigits[kdigits.size() - 1] == '0')
+              kdigits.erase(kdigits.size() - 1);
+
+            for (int e = -330; e <= 300; ++e)
+            {
+              std::string s = cxxtools::convert<std::string>(k) + 'e' + cxxtools::convert<std::string>(e);
+              double d = strtod(s.c_str(), 0);
+              if (d < std::numeric_limits<double>::min() || d > std::numeric_limits<double>::max())
+                continue;
+
+              char digits[17];
+              int exp10;
+              int count = cxxtools::formatFloatShortest(digits, exp10, d);
+              if (std::string(digits, count) != kdigits)
+              {
+                log_error("shortest digits of " << s << ": " << std::string(digits, count));
+                CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(digits, count), kdigits);
+              }
+            }
+          }
+        }
+
+        void exactParseTest()
+        {
+          static const char* values[] = {
+            "0.1",
+            "1e23",
+            "9007199254740993",
+            "2.2250738585072011e-308",
+            "2.2250738585072012e-308",
+            "4.9406564584124654e-324",
+            "2.4703282292062327e-324",
+            "2.4703282292062328e-324",
+            "1.7976931348623157e308",
+            "1.7976931348623158e308",
+            "0.1000000000000000055511151231257827021181583404541015625",
+            "0.1000000000000000055511151231257827021181583404541015624",
+            "0.1000000000000000055511151231257827021181583404541015626",
+            "7.038531e-26",
+            "3.0000000000000004440892098500626161694526672363281249999999",
+            "123456789012345678901234567890e-20",
+            "0.000000000000000000000000000000000000000000001e330",
+            "1e-400",
+            "1e400",
+            0
+          };
+
+          for (unsigned i = 0; values[i]; ++i)
+          {
+            double d = cxxtools::convert<double>(values[i]);
+            double expected = strtod(values[i], 0);
+            log_debug(values[i] << " => " << d);
+            CXXTOOLS_UNIT_ASSERT(sameBits(d, expected));
+
+            float f = cxxtools::convert<float>(values[i]);
+            float fexpected = strtof(values[i], 0);
+            CXXTOOLS_UNIT_ASSERT(sameBits(f, fexpected));
+          }
+
+          // more digits than are kept
+          std::string s = "0." + std::string(1000, '0') + "1e1000";
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<double>(s), 0.1);
+
+          s = "1" + std::string(1000, '0') + "e-1000";
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<double>(s), 1);
+
+          s = "4.5" + std::string(900, '0') + "1";
+          CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::convert<double>(s), 4.5);
+        }
+
+        void doubleRoundTripTest()
+        {
+          uint64_t state = 0x2545f4914f6cdd1dull;
+          for (unsigned n = 0; n < 100000; ++n)
+          {
+            uint64_t bits = nextRandom(state);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (d != d || d == std::numeric_limits<double>::infinity() || d == -std::numeric_limits<double>::infinity())
+              continue;
+
+            std::string s = cxxtools::convert<std::string>(d);
+            double r = cxxtools::convert<double>(s);
+            if (!sameBits(d, r) && d != 0)
+            {
+              log_error("double round trip failed for " << s);
+              CXXTOOLS_UNIT_ASSERT(sameBits(d, r));
+            }
+
+            // the C library does not find a shorter representation
+            if (d != 0)
+            {
+              char digits[17];
+              int exp10;
+              int count = cxxtools::formatFloatShortest(digits, exp10, d < 0 ? -d : d);
+              if (count > libcShortest(d))
+              {
+                log_error("digits of " << s << " are not shortest");
+                CXXTOOLS_UNIT_ASSERT(count <= libcShortest(d));
+              }
+            }
+
+            // compare against the C library with random decimal digits
+            std::string digits = cxxtools::convert<std::string>(bits % 100000000000000000ull);
+            digits += 'e';
+            digits += cxxtools::convert<std::string>(static_cast<int>(bits >> 50) % 700 - 350);
+            CXXTOOLS_UNIT_ASSERT(sameBits(cxxtools::convert<double>(digits), strtod(digits.c_str(), 0)));
+          }
+        }
+
+        void floatRoundTripTest()
+        {
+          uint64_t state = 0x9e3779b97f4a7c15ull;
+          for (unsigned n = 0; n < 100000; ++n)
+          {
+            uint32_t bits = static_cast<uint32_t>(nextRandom(state));
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            if (f != f || f == std::numeric_limits<float>::infinity() || f == -std::numeric_limits<float>::infinity())
+              continue;
+
+            std::string s = cxxtools::convert<std::string>(f);
+            float r = cxxtools::convert<float>(s);
+            if (!sameBits(f, r) && f != 0)
+            {
+              log_error("float round trip failed for " << s);
+              CXXTOOLS_UNIT_ASSERT(sameBits(f, r));
+            }
+          }
+        }
+
 };
 
 cxxtools::unit::RegisterTest<ConvertTest> register_ConvertTest;
@@ -0,0 +1,139 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cxxtools/csvfileparser.h>
+#include <cxxtools/csvdeserializer.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include "bench.h"
+
+namespace
+{
+    std::string document(unsigned rows)
+    {
+        std::ostringstream s;
+        s << "id,name,price,amount,comment\n";
+        for (unsigned n = 0; n < rows; ++n)
+            s << n << ",\"item " << n << "\"," << n * 0.25 << ',' << n % 100
+              << (n % 10 == 0 ? ",\"some, quoted\ncomment\"\n" : ",plain comment\n");
+        return s.str();
+    }
+
+    class RowCounter : public cxxtools::CsvRowHandler
+    {
+        public:
+            RowCounter()
+                : fields(0)
+                { }
+
+            virtual void begin(const std::vector<std::string>& titles, unsigned chunks)
+            { _chunks.assign(chunks, 0); }
+
+            virtual void onRow(const cxxtools::CsvRow& row)
+            { _chunks[row.chunk()] += row.size(); }
+
+            virtual void end()
+            {
+                for (unsigned n = 0; n < _chunks.size(); ++n)
+                    fields += _chunks[n];
+            }
+
+            std::size_t fields;
+
+        private:
+            std::vector<std::size_t> _chunks;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 10);
+        cxxtools::Arg<unsigned> rows(argc, argv, 'r', 200000);
+        cxxtools::Arg<unsigned> threads(argc, argv, 't', 0);
+
+        std::cout << "benchmark csv parsing " << n.getValue() << " times " << rows.getValue() << " rows\n\n"
+                     "options:\n"
+                     "   -n <number>       number of iterations\n"
+                     "   -r <number>       number of rows (default: 200000)\n"
+                     "   -t <number>       number of threads of CsvFileParser (default: number of processors)\n" << std::endl;
+
+        std::string data = document(rows);
+        std::cout << "document size " << data.size() << " bytes" << std::endl;
+
+        cxxtools::Clock clock;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::istringstream in(data);
+            cxxtools::CsvDeserializer deserializer(in);
+            std::vector<std::vector<std::string> > result;
+            deserializer.deserialize(result);
+        }
+        report("CsvDeserializer", clock.stop(), data.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::CsvFileParser parser(data.data(), data.size());
+            if (threads > 0)
+                parser.threads(threads);
+            RowCounter counter;
+            parser.addHandler(counter);
+            parser.parse();
+        }
+        report("CsvFileParser rows", clock.stop(), data.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::CsvFileParser parser(data.data(), data.size());
+            if (threads > 0)
+                parser.threads(threads);
+            cxxtools::CsvColumn<unsigned> ids("id");
+            cxxtools::CsvColumn<double> prices("price");
+            parser.addHandler(ids);
+            parser.addHandler(prices);
+            parser.parse();
+        }
+        report("CsvFileParser columns", clock.stop(), data.size(), n);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
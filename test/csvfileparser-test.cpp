@@ -0,0 +1,260 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/csvfileparser.h"
+#include "cxxtools/csvdeserializer.h"
+#include "cxxtools/serializationerror.h"
+#include "cxxtools/systemerror.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
+
+namespace
+{
+    typedef std::vector<std::vector<std::string> > Rows;
+
+    // collects the rows of each chunk separately and joins them in the end
+    class RowCollector : public cxxtools::CsvRowHandler
+    {
+        public:
+            Rows rows;
+
+            virtual void begin(const std::vector<std::string>& titles, unsigned chunks)
+            {
+                rows.clear();
+                _chunks.clear();
+                _chunks.resize(chunks);
+            }
+
+            virtual void onRow(const cxxtools::CsvRow& row)
+            {
+                Rows& rows = _chunks[row.chunk()];
+                rows.push_back(std::vector<std::string>());
+                for (std::size_t n = 0; n < row.size(); ++n)
+                    rows.back().push_back(row[n].str());
+            }
+
+            virtual void end()
+            {
+                for (unsigned n = 0; n < _chunks.size(); ++n)
+                    rows.insert(rows.end(), _chunks[n].begin(), _chunks[n].end());
+            }
+
+        private:
+            std::vector<Rows> _chunks;
+    };
+
+    Rows parse(const std::string& data, unsigned threads = 1)
+    {
+        cxxtools::CsvFileParser parser(data.data(), data.size());
+        parser.threads(threads);
+        RowCollector collector;
+        parser.addHandler(collector);
+        parser.parse();
+        return collector.rows;
+    }
+
+    // a csv document with quoted values spanning lines, which is large
+    // enough to be split into several chunks; text following a closing
+    // quote is optional since CsvDeserializer does not accept it
+    std::string largeDocument(bool textAfterQuote = true)
+    {
+        std::ostringstream s;
+        s << "id;name;comment\r\n";
+        for (unsigned n = 0; n < 3000; ++n)
+        {
+            s << n << ';';
+            if (n % 3 == 0)
+                s << "\"name\n" << n << ";\"";
+            else if (n % 3 == 1)
+                s << "'multi\nline\n'";
+            else
+                s << "plain " << n;
+            s << ';' << (textAfterQuote && n % 7 == 0 ? "'x'y" : "c") << (n % 2 ? "\n" : "\r\n");
+        }
+        return s.str();
+    }
+}
+
+class CsvFileParserTest : public cxxtools::unit::TestSuite
+{
+    public:
+        CsvFileParserTest()
+            : cxxtools::unit::TestSuite("csvfileparser")
+        {
+            registerMethod("rows", *this, &CsvFileParserTest::rows);
+            registerMethod("noTitle", *this, &CsvFileParserTest::noTitle);
+            registerMethod("singleColumn", *this, &CsvFileParserTest::singleColumn);
+            registerMethod("columnCount", *this, &CsvFileParserTest::columnCount);
+            registerMethod("chunks", *this, &CsvFileParserTest::chunks);
+            registerMethod("columns", *this, &CsvFileParserTest::columns);
+            registerMethod("file", *this, &CsvFileParserTest::file);
+        }
+
+        void rows()
+        {
+            Rows data = parse(
+                "A|B|C\n"
+                "Hello|World|\n"
+                "34|67|\"23\"\n"
+                "col1|'col|2'|col3");
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data.size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0].size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0][0], "Hello");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0][2], "");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[1][2], "23");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[2][1], "col|2");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[2][2], "col3");
+        }
+
+        void noTitle()
+        {
+            std::string data = "Hello,World\r34,67\r\n";
+            cxxtools::CsvFileParser parser(data.data(), data.size());
+            RowCollector collector;
+            parser.addHandler(collector);
+            parser.readTitle(false);
+            CXXTOOLS_UNIT_ASSERT_THROW(parser.parse(), std::logic_error);
+
+            parser.delimiter(',');
+            parser.parse();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(collector.rows.size(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(collector.rows[1][1], "67");
+        }
+
+        void singleColumn()
+        {
+            Rows data = parse("value\n1\n\n'2,3'\n");
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data.size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0][0], "1");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[1][0], "");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[2][0], "2,3");
+        }
+
+        void columnCount()
+        {
+            try
+            {
+                parse("A,B\n1,2\n3\n");
+                CXXTOOLS_UNIT_FAIL("SerializationError expected");
+            }
+            catch (const cxxtools::SerializationError& e)
+            {
+                CXXTOOLS_UNIT_ASSERT(std::string(e.what()).find("in line 3") != std::string::npos);
+            }
+        }
+
+        void chunks()
+        {
+            std::string data = largeDocument(false);
+
+            Rows expected;
+            std::istringstream in(data);
+            cxxtools::CsvDeserializer deserializer(in);
+            deserializer.deserialize(expected);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(expected.size(), 3000);
+
+            for (unsigned threads = 1; threads <= 8; ++threads)
+            {
+                Rows result = parse(data, threads);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(result.size(), expected.size());
+                CXXTOOLS_UNIT_ASSERT(result == expected);
+            }
+        }
+
+        void columns()
+        {
+            std::string data = largeDocument();
+            cxxtools::CsvFileParser parser(data.data(), data.size());
+            parser.threads(4);
+
+            cxxtools::CsvColumn<unsigned> ids("id");
+            cxxtools::CsvColumn<std::string> comments(2);
+            parser.addHandler(ids);
+            parser.addHandler(comments);
+            parser.parse();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(ids.values().size(), 3000);
+            for (unsigned n = 0; n < ids.values().size(); ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(ids.values()[n], n);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(comments.values()[0], "'x'y");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(comments.values()[1], "c");
+
+            cxxtools::CsvColumn<int> names("name");
+            cxxtools::CsvFileParser parser2(data.data(), data.size());
+            parser2.addHandler(names);
+            CXXTOOLS_UNIT_ASSERT_THROW(parser2.parse(), cxxtools::ConversionError);
+
+            cxxtools::CsvColumn<int> missing("price");
+            cxxtools::CsvFileParser parser3(data.data(), data.size());
+            parser3.addHandler(missing);
+            CXXTOOLS_UNIT_ASSERT_THROW(parser3.parse(), cxxtools::SerializationError);
+        }
+
+        void file()
+        {
+            char fname[] = "/tmp/csvfileparser-testXXXXXX";
+            int fd = ::mkstemp(fname);
+            CXXTOOLS_UNIT_ASSERT(fd >= 0);
+            ::close(fd);
+
+            std::string data = largeDocument();
+            {
+                std::ofstream out(fname);
+                out << data;
+            }
+
+            Rows result;
+            try
+            {
+                cxxtools::CsvFileParser parser(fname);
+                parser.threads(3);
+                RowCollector collector;
+                parser.addHandler(collector);
+                parser.parse();
+                result = collector.rows;
+            }
+            catch (...)
+            {
+                std::remove(fname);
+                throw;
+            }
+
+            std::remove(fname);
+
+            CXXTOOLS_UNIT_ASSERT(result == parse(data));
+            CXXTOOLS_UNIT_ASSERT_THROW(cxxtools::CsvFileParser parser("/nonexistent/file.csv"), cxxtools::SystemError);
+        }
+};
+
+cxxtools::unit::RegisterTest<CsvFileParserTest> register_CsvFileParserTest;
@@ -0,0 +1,271 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/jsonserializer.h"
+#include "cxxtools/jsondeserializer.h"
+#include "cxxtools/xml/xmlserializer.h"
+#include "cxxtools/xml/xmldeserializer.h"
+#include "cxxtools/bin/serializer.h"
+#include "cxxtools/bin/deserializer.h"
+#include <sstream>
+
+namespace
+{
+    struct TestObject
+    {
+        int intValue;
+        std::string stringValue;
+        double doubleValue;
+        bool boolValue;
+
+        TestObject()
+            : intValue(0),
+              doubleValue(0),
+              boolValue(false)
+              { }
+
+        bool operator== (const TestObject& other) const
+        {
+            return intValue == other.intValue
+                && stringValue == other.stringValue
+                && doubleValue == other.doubleValue
+                && boolValue == other.boolValue;
+        }
+    };
+
+    void operator>>= (const cxxtools::SerializationInfo& si, TestObject& obj)
+    {
+        si.getMember("intValue") >>= obj.intValue;
+        si.getMember("stringValue") >>= obj.stringValue;
+        si.getMember("doubleValue") >>= obj.doubleValue;
+        si.getMember("boolValue") >>= obj.boolValue;
+    }
+
+    void operator<<= (cxxtools::SerializationInfo& si, const TestObject& obj)
+    {
+        si.addMember("intValue") <<= obj.intValue;
+        si.addMember("stringValue") <<= obj.stringValue;
+        si.addMember("doubleValue") <<= obj.doubleValue;
+        si.addMember("boolValue") <<= obj.boolValue;
+        si.setTypeName("TestObject");
+    }
+
+    void operator<<= (cxxtools::ValueWriter& w, const TestObject& obj)
+    {
+        w.beginObject("TestObject");
+        w.addMember("intValue") <<= obj.intValue;
+        w.addMember("stringValue") <<= obj.stringValue;
+        w.addMember("doubleValue") <<= obj.doubleValue;
+        w.addMember("boolValue") <<= obj.boolValue;
+        w.finishObject();
+    }
+
+    // has no operator for ValueWriter
+    struct Point
+    {
+        int x;
+        int y;
+
+        bool operator== (const Point& other) const
+        { return x == other.x && y == other.y; }
+    };
+
+    void operator>>= (const cxxtools::SerializationInfo& si, Point& p)
+    {
+        si.getMember("x") >>= p.x;
+        si.getMember("y") >>= p.y;
+    }
+
+    void operator<<= (cxxtools::SerializationInfo& si, const Point& p)
+    {
+        si.addMember("x") <<= p.x;
+        si.addMember("y") <<= p.y;
+        si.setTypeName("Point");
+    }
+
+    std::vector<TestObject> testObjects()
+    {
+        std::vector<TestObject> v;
+        for (int n = 0; n < 3; ++n)
+        {
+            TestObject obj;
+            obj.intValue = n - 1;
+            obj.stringValue = std::string(n, 'a');
+            obj.doubleValue = n * 1.5;
+            obj.boolValue = n & 1;
+            v.push_back(obj);
+        }
+        return v;
+    }
+
+    std::vector<Point> testPoints()
+    {
+        std::vector<Point> v;
+        for (int n = 0; n < 3; ++n)
+        {
+            Point p;
+            p.x = n;
+            p.y = -n;
+            v.push_back(p);
+        }
+        return v;
+    }
+
+    template <typename T>
+    std::string toJson(const T& value, bool direct)
+    {
+        std::ostringstream out;
+        cxxtools::JsonSerializer serializer(out);
+        if (direct)
+            serializer.serializeDirect(value, "value");
+        else
+            serializer.serialize(value, "value");
+        serializer.finish();
+        return out.str();
+    }
+
+    template <typename T>
+    std::string toXml(const T& value, bool direct)
+    {
+        std::ostringstream out;
+        cxxtools::xml::XmlSerializer serializer(out);
+        if (direct)
+            serializer.serializeDirect(value, "value");
+        else
+            serializer.serialize(value, "value");
+        return out.str();
+    }
+
+    template <typename T>
+    std::string toBin(const T& value, bool direct)
+    {
+        std::ostringstream out;
+        cxxtools::bin::Serializer serializer(out);
+        if (direct)
+            serializer.serializeDirect(value, "value");
+        else
+            serializer.serialize(value, "value");
+        serializer.finish();
+        return out.str();
+    }
+}
+
+class DirectSerializerTest : public cxxtools::unit::TestSuite
+{
+    public:
+        DirectSerializerTest()
+            : cxxtools::unit::TestSuite("directserializer")
+        {
+            registerMethod("testWriteJson", *this, &DirectSerializerTest::testWriteJson);
+            registerMethod("testWriteXml", *this, &DirectSerializerTest::testWriteXml);
+            registerMethod("testWriteBin", *this, &DirectSerializerTest::testWriteBin);
+            registerMethod("testReadJson", *this, &DirectSerializerTest::testReadJson);
+            registerMethod("testReadXml", *this, &DirectSerializerTest::testReadXml);
+            registerMethod("testReadBin", *this, &DirectSerializerTest::testReadBin);
+            registerMethod("testReadMap", *this, &DirectSerializerTest::testReadMap);
+        }
+
+        void testWriteJson()
+        {
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toJson(testObjects(), true), toJson(testObjects(), false));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toJson(testPoints(), true), toJson(testPoints(), false));
+
+            std::map<std::string, std::vector<double> > m;
+            m["a"].push_back(1.25);
+            m["b"];
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toJson(m, true), toJson(m, false));
+        }
+
+        void testWriteXml()
+        {
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toXml(testObjects(), true), toXml(testObjects(), false));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toXml(testPoints(), true), toXml(testPoints(), false));
+        }
+
+        void testWriteBin()
+        {
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toBin(testObjects(), true), toBin(testObjects(), false));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toBin(testPoints(), true), toBin(testPoints(), false));
+
+            std::vector<std::vector<int> > v(2);
+            v[1].push_back(-7);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(toBin(v, true), toBin(v, false));
+        }
+
+        void testReadJson()
+        {
+            std::istringstream in("[{\"intValue\":-1,\"stringValue\":\"\",\"doubleValue\":0,\"boolValue\":false},"
+                                  "{\"intValue\":0,\"stringValue\":\"a\",\"doubleValue\":1.5,\"boolValue\":true},"
+                                  "{\"intValue\":1,\"stringValue\":\"aa\",\"doubleValue\":3,\"boolValue\":false}]");
+            cxxtools::JsonDeserializer deserializer(in);
+
+            std::vector<TestObject> v;
+            deserializer.deserializeDirect(v);
+
+            CXXTOOLS_UNIT_ASSERT(v == testObjects());
+        }
+
+        void testReadXml()
+        {
+            std::istringstream in(toXml(testPoints(), false));
+            cxxtools::xml::XmlDeserializer deserializer(in);
+
+            std::vector<Point> v;
+            deserializer.deserializeDirect(v);
+
+            CXXTOOLS_UNIT_ASSERT(v == testPoints());
+        }
+
+        void testReadBin()
+        {
+            std::istringstream in(toBin(testObjects(), true));
+            cxxtools::bin::Deserializer deserializer(in);
+
+            std::vector<TestObject> v;
+            deserializer.deserializeDirect(v);
+
+            CXXTOOLS_UNIT_ASSERT(v == testObjects());
+        }
+
+        void testReadMap()
+        {
+            std::map<int, std::string> m;
+            m[3] = "three";
+            m[-1] = "minus one";
+
+            std::istringstream in(toBin(m, false));
+            cxxtools::bin::Deserializer deserializer(in);
+
+            std::map<int, std::string> r;
+            deserializer.deserializeDirect(r);
+
+            CXXTOOLS_UNIT_ASSERT(r == m);
+        }
+};
+
+cxxtools::unit::RegisterTest<DirectSerializerTest> register_DirectSerializerTest;
@@ -0,0 +1,164 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cxxtools/convert.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    uint64_t nextRandom(uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    double randomDouble(uint64_t& state)
+    {
+        for (;;)
+        {
+            uint64_t bits = nextRandom(state);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (d == d && d - d == 0)  // neither nan nor inf
+                return d;
+        }
+    }
+
+    // a number as found in typical documents: up to 17 significant digits
+    // scaled by a moderate power of ten
+    double randomNumber(uint64_t& state)
+    {
+        uint64_t r = nextRandom(state);
+        unsigned digits = static_cast<unsigned>(r % 17) + 1;
+        int exp = static_cast<int>((r >> 8) % 21) - 10;
+
+        uint64_t m = nextRandom(state);
+        uint64_t limit = 1;
+        for (unsigned d = 0; d < digits; ++d)
+            limit *= 10;
+
+        char buffer[48];
+        snprintf(buffer, sizeof(buffer), "%llue%d", static_cast<unsigned long long>(m % limit), exp - static_cast<int>(digits / 2));
+        return strtod(buffer, 0);
+    }
+
+    void report(const char* name, const cxxtools::Timespan& ts, unsigned n)
+    {
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << name << ": " << secs << " sec, "
+                  << secs * 1e9 / n << " nsec per number" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 1000000);
+        cxxtools::Arg<unsigned long> check(argc, argv, 'c', 0);
+
+        std::cout << "benchmark converting " << n.getValue() << " random numbers\n\n"
+                     "options:\n"
+                     "   -n <number>       number of values\n"
+                     "   -c <number>       check round trip of <number> random bit patterns\n" << std::endl;
+
+        uint64_t state = 88172645463325252ull;
+        std::vector<double> values;
+        for (unsigned i = 0; i < n; ++i)
+            values.push_back(randomNumber(state));
+
+        std::vector<std::string> strings(values.size());
+        cxxtools::Clock clock;
+        double sum = 0;
+
+        clock.start();
+        for (unsigned i = 0; i < values.size(); ++i)
+            cxxtools::convert(strings[i], values[i]);
+        report("format convert", clock.stop(), n);
+
+        char buffer[32];
+        clock.start();
+        for (unsigned i = 0; i < values.size(); ++i)
+            sum += snprintf(buffer, sizeof(buffer), "%.17g", values[i]);
+        report("format snprintf %.17g", clock.stop(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < values.size(); ++i)
+            sum += snprintf(buffer, sizeof(buffer), "%.15g", values[i]);
+        report("format snprintf %.15g (no round trip)", clock.stop(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < strings.size(); ++i)
+            sum += cxxtools::convert<double>(strings[i]);
+        report("parse convert", clock.stop(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < strings.size(); ++i)
+            sum += strtod(strings[i].c_str(), 0);
+        report("parse strtod", clock.stop(), n);
+
+        if (check > 0)
+        {
+            unsigned long failed = 0;
+            std::string s;
+            for (unsigned long i = 0; i < check; ++i)
+            {
+                double d = randomDouble(state);
+                cxxtools::convert(s, d);
+                double r = cxxtools::convert<double>(s);
+                if (memcmp(&d, &r, sizeof(d)) != 0 && d != 0)
+                {
+                    if (++failed <= 10)
+                        std::cerr << "round trip failed for " << s << std::endl;
+                }
+            }
+
+            std::cout << check.getValue() << " round trips checked, " << failed << " failed" << std::endl;
+        }
+
+        // keep the compiler from dropping the loops
+        if (sum == 42)
+            std::cout << sum << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
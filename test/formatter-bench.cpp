@@ -0,0 +1,160 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cxxtools/jsonformatter.h>
+#include <cxxtools/bin/formatter.h>
+#include <cxxtools/valuewriter.h>
+#include <cxxtools/textstream.h>
+#include <cxxtools/utf8codec.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/convert.h>
+#include <cxxtools/log.h>
+#include "bench.h"
+
+namespace
+{
+    struct TestObject
+    {
+        int intValue;
+        std::string stringValue;
+        cxxtools::String textValue;
+        double doubleValue;
+        bool boolValue;
+    };
+
+    void operator<<= (cxxtools::ValueWriter& w, const TestObject& obj)
+    {
+        w.beginObject("TestObject");
+        w.addMember("intValue") <<= obj.intValue;
+        w.addMember("stringValue") <<= obj.stringValue;
+        w.addMember("textValue") <<= obj.textValue;
+        w.addMember("doubleValue") <<= obj.doubleValue;
+        w.addMember("boolValue") <<= obj.boolValue;
+        w.finishObject();
+    }
+
+    template <typename T>
+    void benchJson(const char* name, const T& data, unsigned n)
+    {
+        std::size_t size = 0;
+        cxxtools::Clock clock;
+
+        std::cout << name << ":" << std::endl;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::ostringstream out;
+            cxxtools::TextOStream ts(out, new cxxtools::Utf8Codec());
+            cxxtools::JsonFormatter formatter(ts);
+            cxxtools::ValueWriter w(formatter);
+            w <<= data;
+            formatter.finish();
+            ts.flush();
+            size = out.str().size();
+        }
+        report("JsonFormatter to TextOStream", clock.stop(), size, n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::ostringstream out;
+            cxxtools::JsonFormatter formatter(out);
+            cxxtools::ValueWriter w(formatter);
+            w <<= data;
+            formatter.finish();
+            size = out.str().size();
+        }
+        report("JsonFormatter to ostream", clock.stop(), size, n);
+    }
+
+    template <typename T>
+    void benchBin(const char* name, const T& data, unsigned n)
+    {
+        std::size_t size = 0;
+        cxxtools::Clock clock;
+
+        std::cout << name << ":" << std::endl;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::ostringstream out;
+            cxxtools::bin::Formatter formatter(out);
+            cxxtools::ValueWriter w(formatter);
+            w <<= data;
+            formatter.finish();
+            size = out.str().size();
+        }
+        report("bin::Formatter", clock.stop(), size, n);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 10);
+        cxxtools::Arg<unsigned> size(argc, argv, 's', 100000);
+
+        std::cout << "benchmark formatting " << n.getValue() << " times " << size.getValue() << " values\n\n"
+                     "options:\n"
+                     "   -n <number>       number of iterations\n"
+                     "   -s <number>       number of values (default: 100000)\n" << std::endl;
+
+        std::vector<TestObject> objects(size);
+        std::vector<int> ints(size);
+        std::vector<std::string> strings(size);
+        for (unsigned i = 0; i < size; ++i)
+        {
+            objects[i].intValue = i * 7919;
+            objects[i].stringValue = "value " + cxxtools::convert<std::string>(i) + " with a \"quote\"";
+            objects[i].textValue = cxxtools::String(L"some longer text for the object ") + cxxtools::String(L"with äöü\n");
+            objects[i].doubleValue = i * 0.25;
+            objects[i].boolValue = i % 2;
+            ints[i] = (i % 2 ? -1 : 1) * static_cast<int>(i * 7919);
+            strings[i] = "a plain ascii string value, which needs no escaping at all";
+        }
+
+        benchJson("json objects", objects, n);
+        benchJson("json ints", ints, n);
+        benchJson("json strings", strings, n);
+        benchBin("bin objects", objects, n);
+        benchBin("bin ints", ints, n);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,243 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/http/service.h"
+#include "cxxtools/http/responder.h"
+#include "cxxtools/http/request.h"
+#include "cxxtools/regex.h"
+#include "http/mapper.h"
+
+namespace
+{
+    class TestResponder : public cxxtools::http::Responder
+    {
+        public:
+            explicit TestResponder(cxxtools::http::Service& service)
+                : cxxtools::http::Responder(service)
+                { }
+
+            void reply(std::ostream&, cxxtools::http::Request&, cxxtools::http::Reply&)
+            { }
+    };
+
+    class TestService : public cxxtools::http::Service
+    {
+            TestResponder _responder;
+
+        public:
+            bool decline;
+            unsigned calls;
+            std::string id;       // route parameters of the last request
+            std::string post;
+            std::string other;
+            std::string group;
+
+            TestService()
+                : _responder(*this),
+                  decline(false),
+                  calls(0)
+                { }
+
+            cxxtools::http::Responder* responder()
+            { return &_responder; }
+
+        protected:
+            cxxtools::http::Responder* createResponder(const cxxtools::http::Request& r)
+            {
+                ++calls;
+                id = r.routeParam("id");
+                post = r.routeParam("post");
+                other = r.routeParam("other");
+                group = r.routeParam("1");
+                return decline ? 0 : &_responder;
+            }
+
+            void releaseResponder(cxxtools::http::Responder*)
+            { }
+    };
+}
+
+class HttpMapperTest : public cxxtools::unit::TestSuite
+{
+        // returns the responder for the url and releases it
+        static cxxtools::http::Responder* get(cxxtools::http::Mapper& mapper, const std::string& url)
+        {
+            cxxtools::http::Request request(url);
+            cxxtools::http::Responder* responder = mapper.getResponder(request);
+            responder->release();
+            return responder;
+        }
+
+    public:
+        HttpMapperTest()
+        : cxxtools::unit::TestSuite("httpmapper")
+        {
+            registerMethod("url", *this, &HttpMapperTest::url);
+            registerMethod("commonPrefix", *this, &HttpMapperTest::commonPrefix);
+            registerMethod("params", *this, &HttpMapperTest::params);
+            registerMethod("prefix", *this, &HttpMapperTest::prefix);
+            registerMethod("regex", *this, &HttpMapperTest::regex);
+            registerMethod("order", *this, &HttpMapperTest::order);
+            registerMethod("remove", *this, &HttpMapperTest::remove);
+            registerMethod("repeatedChanges", *this, &HttpMapperTest::repeatedChanges);
+        }
+
+        void url()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService a, b;
+            mapper.addService("/a", a);
+            mapper.addService("/b", b);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/a") == a.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/b") == b.responder());
+
+            cxxtools::http::Responder* r = get(mapper, "/c");
+            CXXTOOLS_UNIT_ASSERT(r != a.responder() && r != b.responder());
+            r = get(mapper, "/a/");
+            CXXTOOLS_UNIT_ASSERT(r != a.responder());
+        }
+
+        void commonPrefix()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService s1, s2, s3, s4;
+            mapper.addService("/abc", s1);
+            mapper.addService("/abd", s2);
+            mapper.addService("/ab", s3);
+            mapper.addService("/a", s4);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/abc") == s1.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/abd") == s2.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/ab") == s3.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/a") == s4.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/abe") != s3.responder());
+        }
+
+        void params()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService user, post;
+            mapper.addService("/user/{id}", user);
+            mapper.addService("/user/{id}/post/{post}", post);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/user/42") == user.responder());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(user.id, "42");
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/user/tom/post/7") == post.responder());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(post.id, "tom");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(post.post, "7");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(post.other, "");
+
+            // a parameter does not match an empty segment
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/user/") != user.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/user/42/post") != user.responder());
+        }
+
+        void prefix()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService files, index;
+            mapper.addPrefixService("/static/", files);
+            mapper.addService("/static/index.html", index);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/static/app.css") == files.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/static/") == files.responder());
+
+            // the prefix service was added first
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/static/index.html") == files.responder());
+
+            files.decline = true;
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/static/index.html") == index.responder());
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/static") != files.responder());
+        }
+
+        void regex()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService s;
+            mapper.addService(cxxtools::Regex("^/item/([0-9]+)$"), s);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/item/17") == s.responder());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(s.group, "17");
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/item/x") != s.responder());
+        }
+
+        void order()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService first, second, third;
+            mapper.addService(cxxtools::Regex("^/x"), first);
+            mapper.addService("/x", second);
+            mapper.addService(cxxtools::Regex("^/"), third);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/x") == first.responder());
+
+            first.decline = true;
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/x") == second.responder());
+
+            second.decline = true;
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/x") == third.responder());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(first.calls, 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(second.calls, 2);
+        }
+
+        void remove()
+        {
+            cxxtools::http::Mapper mapper;
+            TestService a, b;
+            mapper.addService("/x", a);
+            mapper.addService("/x", b);
+
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/x") == a.responder());
+
+            mapper.removeService(a);
+            CXXTOOLS_UNIT_ASSERT(get(mapper, "/x") == b.responder());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(a.calls, 1);
+        }
+
+        void repeatedChanges()
+        {
+            // replaced snapshots are freed while the mapper is in use
+            cxxtools::http::Mapper mapper;
+            TestService a, b;
+            mapper.addService("/a", a);
+
+            for (unsigned n = 0; n < 1000; ++n)
+            {
+                mapper.addService("/b", b);
+                CXXTOOLS_UNIT_ASSERT(get(mapper, "/b") == b.responder());
+                mapper.removeService(b);
+                CXXTOOLS_UNIT_ASSERT(get(mapper, "/b") != b.responder());
+                CXXTOOLS_UNIT_ASSERT(get(mapper, "/a") == a.responder());
+            }
+        }
+};
+
+cxxtools::unit::RegisterTest<HttpMapperTest> register_HttpMapperTest;
@@ -0,0 +1,131 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <sstream>
+#include <cxxtools/http/messageheader.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include "http/parser.h"
+
+namespace
+{
+    std::string makeRequest(unsigned cookieSize)
+    {
+        std::string cookie;
+        for (unsigned n = 0; n < cookieSize; ++n)
+            cookie += static_cast<char>('a' + n % 26);
+
+        return "GET /api/v1/resource/42?format=json HTTP/1.1\r\n"
+               "Host: www.example.com\r\n"
+               "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101 Firefox/60.0\r\n"
+               "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+               "Accept-Language: en-US,en;q=0.5\r\n"
+               "Accept-Encoding: gzip, deflate\r\n"
+               "Connection: keep-alive\r\n"
+               "Cookie: " + cookie + "\r\n"
+               "\r\n";
+    }
+
+    void report(const char* name, const cxxtools::Timespan& ts, std::size_t size, unsigned n)
+    {
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << name << ": " << secs << " sec, "
+                  << secs * 1e6 / n << " usec per header, "
+                  << size * static_cast<double>(n) / secs / 1e6 << " MB/s" << std::endl;
+    }
+
+    // feeds the parser one character at a time like a non buffered reader
+    void benchChars(const std::string& msg, unsigned n)
+    {
+        cxxtools::http::MessageHeader header;
+        cxxtools::http::HeaderParser::MessageHeaderEvent ev(header);
+        cxxtools::http::HeaderParser parser(ev, false);
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            header.clear();
+            parser.reset(false);
+            for (std::string::const_iterator it = msg.begin(); it != msg.end(); ++it)
+                if (parser.parse(*it))
+                    break;
+        }
+
+        report("characters", clock.stop(), msg.size(), n);
+    }
+
+    // lets the parser consume the buffered data of a streambuf
+    void benchStreambuf(const std::string& msg, unsigned n)
+    {
+        cxxtools::http::MessageHeader header;
+        cxxtools::http::HeaderParser::MessageHeaderEvent ev(header);
+        cxxtools::http::HeaderParser parser(ev, false);
+        std::stringbuf sb(msg, std::ios::in);
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            header.clear();
+            parser.reset(false);
+            sb.pubseekpos(0, std::ios::in);
+            parser.advance(sb);
+        }
+
+        report("streambuf", clock.stop(), msg.size(), n);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 100000);
+        cxxtools::Arg<unsigned> cookie(argc, argv, 'c', 512);
+
+        std::string msg = makeRequest(cookie);
+
+        std::cout << "benchmark parsing " << n.getValue() << " http headers of " << msg.size() << " bytes\n\n"
+                     "options:\n"
+                     "   -n <number>       number of headers\n"
+                     "   -c <number>       size of cookie (default: 512)\n" << std::endl;
+
+        benchChars(msg, n);
+        benchStreambuf(msg, n);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,245 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/http/messageheader.h"
+#include "http/parser.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    class TestEvent : public cxxtools::http::HeaderParser::MessageHeaderEvent
+    {
+        public:
+            std::string method;
+            std::string url;
+            std::string qparams;
+
+            explicit TestEvent(cxxtools::http::MessageHeader& header)
+                : cxxtools::http::HeaderParser::MessageHeaderEvent(header)
+                { }
+
+            void onMethod(const std::string& m)
+            { method = m; }
+
+            void onUrl(const std::string& u)
+            { url = u; }
+
+            void onUrlParam(const std::string& q)
+            { qparams = q; }
+    };
+
+    const char request[] =
+        "GET /index.html?a=1 HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "User-Agent: cxxtools-test/1.0\r\n"
+        "Accept: text/html,application/xhtml+xml\r\n"
+        "X-Folded: first\r\n"
+        " second\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"
+        "body";
+}
+
+class HttpParserTest : public cxxtools::unit::TestSuite
+{
+        static void checkRequest(const TestEvent& ev, const cxxtools::http::MessageHeader& header)
+        {
+            CXXTOOLS_UNIT_ASSERT_EQUALS(ev.method, "GET");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(ev.url, "/index.html");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(ev.qparams, "a=1");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(header.httpVersionMajor(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(header.httpVersionMinor(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("Host")), "localhost");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("user-agent")), "cxxtools-test/1.0");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("Accept")), "text/html,application/xhtml+xml");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("X-Folded")), "first second");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(header.contentLength(), 0);
+        }
+
+        static std::string bigRequest(std::size_t cookieSize)
+        {
+            std::string cookie;
+            for (std::size_t n = 0; n < cookieSize; ++n)
+                cookie += static_cast<char>('a' + n % 26);
+
+            return "GET / HTTP/1.1\r\n"
+                   "Host: localhost\r\n"
+                   "Cookie: " + cookie + "\r\n"
+                   "\r\n";
+        }
+
+    public:
+        HttpParserTest()
+        : cxxtools::unit::TestSuite("httpparser")
+        {
+            registerMethod("streambuf", *this, &HttpParserTest::streambuf);
+            registerMethod("chunks", *this, &HttpParserTest::chunks);
+            registerMethod("largeHeader", *this, &HttpParserTest::largeHeader);
+            registerMethod("maxSize", *this, &HttpParserTest::maxSize);
+            registerMethod("copyHeader", *this, &HttpParserTest::copyHeader);
+            registerMethod("removeHeader", *this, &HttpParserTest::removeHeader);
+        }
+
+        void streambuf()
+        {
+            cxxtools::http::MessageHeader header;
+            TestEvent ev(header);
+            cxxtools::http::HeaderParser parser(ev, false);
+
+            std::istringstream in(request);
+            parser.advance(in);
+
+            CXXTOOLS_UNIT_ASSERT(parser.end());
+            CXXTOOLS_UNIT_ASSERT(!parser.fail());
+            checkRequest(ev, header);
+
+            // the body is left in the stream
+            std::string body;
+            in >> body;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(body, "body");
+        }
+
+        void chunks()
+        {
+            const std::size_t size = sizeof(request) - 1;
+
+            for (std::size_t chunk = 1; chunk < 16; ++chunk)
+            {
+                cxxtools::http::MessageHeader header;
+                TestEvent ev(header);
+                cxxtools::http::HeaderParser parser(ev, false);
+
+                std::size_t pos = 0;
+                while (!parser.end() && pos < size)
+                {
+                    std::size_t n = std::min(chunk, size - pos);
+                    pos += parser.parse(request + pos, request + pos + n);
+                }
+
+                CXXTOOLS_UNIT_ASSERT(parser.end());
+                CXXTOOLS_UNIT_ASSERT(!parser.fail());
+                CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(request + pos), "body");
+                checkRequest(ev, header);
+            }
+        }
+
+        void largeHeader()
+        {
+            std::string msg = bigRequest(20000);
+
+            cxxtools::http::MessageHeader header;
+            TestEvent ev(header);
+            cxxtools::http::HeaderParser parser(ev, false);
+
+            std::istringstream in(msg);
+            parser.advance(in);
+
+            CXXTOOLS_UNIT_ASSERT(parser.end());
+            CXXTOOLS_UNIT_ASSERT(!parser.fail());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("Host")), "localhost");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::strlen(header.getHeader("Cookie")), 20000);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(header.getHeader("Cookie")[19999], 'a' + 19999 % 26);
+
+            header.clear();
+            CXXTOOLS_UNIT_ASSERT(header.begin() == header.end());
+        }
+
+        void maxSize()
+        {
+            std::size_t maxSize = cxxtools::http::MessageHeader::maxSize();
+            cxxtools::http::MessageHeader::maxSize(8192);
+
+            try
+            {
+                cxxtools::http::MessageHeader header;
+                TestEvent ev(header);
+                cxxtools::http::HeaderParser parser(ev, false);
+
+                std::istringstream in(bigRequest(10000));
+                CXXTOOLS_UNIT_ASSERT_THROW(parser.advance(in), std::runtime_error);
+            }
+            catch (...)
+            {
+                cxxtools::http::MessageHeader::maxSize(maxSize);
+                throw;
+            }
+
+            cxxtools::http::MessageHeader::maxSize(maxSize);
+        }
+
+        void copyHeader()
+        {
+            std::string value(10000, 'x');
+
+            cxxtools::http::MessageHeader header;
+            header.setHeader("Host", "localhost");
+            header.setHeader("Cookie", value.c_str());
+
+            cxxtools::http::MessageHeader copy(header);
+            header.clear();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(copy.getHeader("Host")), "localhost");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(copy.getHeader("Cookie")), value);
+
+            cxxtools::http::MessageHeader small;
+            small.setHeader("Host", "example.com");
+            small = copy;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(small.getHeader("Cookie")), value);
+
+            copy = cxxtools::http::MessageHeader();
+            CXXTOOLS_UNIT_ASSERT(copy.begin() == copy.end());
+        }
+
+        void removeHeader()
+        {
+            cxxtools::http::MessageHeader header;
+            header.setHeader("A", "1");
+            header.setHeader("B", "2");
+            header.setHeader("C", "3");
+
+            header.removeHeader("b");
+            CXXTOOLS_UNIT_ASSERT(!header.hasHeader("B"));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("A")), "1");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("C")), "3");
+
+            header.setHeader("D", "4");
+            header.setHeader("A", "5");
+
+            unsigned count = 0;
+            for (cxxtools::http::MessageHeader::const_iterator it = header.begin(); it != header.end(); ++it)
+                ++count;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(count, 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(std::string(header.getHeader("A")), "5");
+        }
+};
+
+cxxtools::unit::RegisterTest<HttpParserTest> register_HttpParserTest;
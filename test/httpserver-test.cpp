@@ -0,0 +1,282 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/http/server.h"
+#include "cxxtools/http/client.h"
+#include "cxxtools/http/service.h"
+#include "cxxtools/http/responder.h"
+#include "cxxtools/http/request.h"
+#include "cxxtools/http/reply.h"
+#include "cxxtools/eventloop.h"
+#include "cxxtools/net/tcpsocket.h"
+#include "cxxtools/thread.h"
+#include "cxxtools/method.h"
+#include "cxxtools/log.h"
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <unistd.h>
+
+log_define("cxxtools.test.httpserver")
+
+namespace
+{
+    class BodyService;
+
+    class BodyResponder : public cxxtools::http::Responder
+    {
+            BodyService& _service;
+
+        public:
+            explicit BodyResponder(BodyService& service);
+
+            void reply(std::ostream& out, cxxtools::http::Request& request, cxxtools::http::Reply& reply);
+    };
+
+    class BodyService : public cxxtools::http::Service
+    {
+        public:
+            enum Mode { Data, File, Producer, Large };
+
+            Mode mode;
+            std::string fname;
+            const char* data;
+            std::string large;
+            unsigned count;
+
+            BodyService()
+                : mode(Data),
+                  data("<segment>"),
+                  count(0)
+                { }
+
+            bool produce(std::ostream& out)
+            {
+                out << "chunk" << count << ';';
+                return ++count < 3;
+            }
+
+        protected:
+            cxxtools::http::Responder* createResponder(const cxxtools::http::Request&)
+            { return new BodyResponder(*this); }
+
+            void releaseResponder(cxxtools::http::Responder* responder)
+            { delete responder; }
+    };
+
+    BodyResponder::BodyResponder(BodyService& service)
+        : cxxtools::http::Responder(service),
+          _service(service)
+    { }
+
+    void BodyResponder::reply(std::ostream& out, cxxtools::http::Request& request, cxxtools::http::Reply& reply)
+    {
+        switch (_service.mode)
+        {
+            case BodyService::Data:
+                out << "head";
+                reply.addBodyData(_service.data, 9);
+                out << "tail";
+                break;
+
+            case BodyService::File:
+                out << '[';
+                reply.addBodyFile(_service.fname, 2, 5);
+                out << ']';
+                reply.addBodyFile(_service.fname);
+                break;
+
+            case BodyService::Producer:
+                _service.count = 0;
+                out << "start;";
+                reply.bodyProducer(cxxtools::callable(_service, &BodyService::produce));
+                break;
+
+            case BodyService::Large:
+                reply.addBodyData(_service.large.data(), _service.large.size());
+                reply.addBodyFile(_service.fname);
+                break;
+        }
+    }
+}
+
+class HttpServerTest : public cxxtools::unit::TestSuite
+{
+    private:
+        cxxtools::EventLoop _loop;
+        cxxtools::http::Server* _server;
+        BodyService _service;
+        unsigned short _port;
+
+    public:
+        HttpServerTest()
+        : cxxtools::unit::TestSuite("httpserver"),
+          _port(8001)
+        {
+            registerMethod("DataBody", *this, &HttpServerTest::DataBody);
+            registerMethod("FileBody", *this, &HttpServerTest::FileBody);
+            registerMethod("ProducedBody", *this, &HttpServerTest::ProducedBody);
+            registerMethod("SlowClient", *this, &HttpServerTest::SlowClient);
+
+            char* PORT = getenv("UTEST_PORT");
+            if (PORT)
+            {
+                std::istringstream s(PORT);
+                s >> _port;
+            }
+        }
+
+        void setUp()
+        {
+            _server = new cxxtools::http::Server(_loop, _port);
+            _server->minThreads(1);
+            _server->addService("/body", _service);
+
+            // process the start event of the server
+            _loop.processEvents();
+        }
+
+        void tearDown()
+        {
+            delete _server;
+        }
+
+        void DataBody()
+        {
+            _service.mode = BodyService::Data;
+
+            cxxtools::http::Client client("", _port);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(client.get("/body", 2000), "head<segment>tail");
+
+            // keep alive
+            CXXTOOLS_UNIT_ASSERT_EQUALS(client.get("/body", 2000), "head<segment>tail");
+        }
+
+        void FileBody()
+        {
+            _service.mode = BodyService::File;
+            _service.fname = "httpserver-test.data";
+
+            {
+                std::ofstream f(_service.fname.c_str());
+                f << "0123456789";
+            }
+
+            cxxtools::http::Client client("", _port);
+            std::string body = client.get("/body", 2000);
+            ::unlink(_service.fname.c_str());
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(body, "[23456]0123456789");
+        }
+
+        void ProducedBody()
+        {
+            _service.mode = BodyService::Producer;
+
+            cxxtools::http::Client client("", _port);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(client.get("/body", 2000), "start;chunk0;chunk1;chunk2;");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(client.header().getHeader("Transfer-Encoding"), std::string("chunked"));
+
+            // keep alive
+            CXXTOOLS_UNIT_ASSERT_EQUALS(client.get("/body", 2000), "start;chunk0;chunk1;chunk2;");
+        }
+
+        void SlowClient()
+        {
+            // a client, which does not read its reply, must not stall the
+            // other connections of the io thread
+
+            delete _server;
+            _server = new cxxtools::http::Server(_loop, _port);
+            _server->ioThreads(1);
+            _server->addService("/body", _service);
+
+            const std::size_t size = 8 * 1024 * 1024;
+            _service.mode = BodyService::Large;
+            _service.large.assign(size, 'x');
+            _service.fname = "httpserver-test.data";
+
+            {
+                std::ofstream f(_service.fname.c_str());
+                f << std::string(size, 'y');
+            }
+
+            cxxtools::AttachedThread loopThread(cxxtools::callable(_loop, &cxxtools::EventLoop::run));
+            loopThread.start();
+
+            std::string body;
+            std::string slowReply;
+
+            try
+            {
+                cxxtools::net::TcpSocket slow("", _port);
+                slow.setTimeout(2000);
+
+                std::string request = "GET /body HTTP/1.1\r\nHost: localhost\r\n\r\n";
+                slow.write(request.data(), request.size());
+
+                // give the server time to fill the socket buffers
+                cxxtools::Thread::sleep(200);
+
+                _service.mode = BodyService::Data;
+                cxxtools::http::Client client("", _port);
+                body = client.get("/body", 2000);
+
+                char buffer[8192];
+                std::string::size_type headerEnd;
+                do
+                {
+                    std::size_t n = slow.read(buffer, sizeof(buffer));
+                    slowReply.append(buffer, n);
+                    headerEnd = slowReply.find("\r\n\r\n");
+                } while (headerEnd == std::string::npos || slowReply.size() < headerEnd + 4 + 2 * size);
+            }
+            catch (...)
+            {
+                _loop.exit();
+                loopThread.join();
+                ::unlink(_service.fname.c_str());
+                throw;
+            }
+
+            _loop.exit();
+            loopThread.join();
+            ::unlink(_service.fname.c_str());
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(body, "head<segment>tail");
+
+            std::string::size_type headerEnd = slowReply.find("\r\n\r\n") + 4;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(slowReply.size(), headerEnd + 2 * size);
+            CXXTOOLS_UNIT_ASSERT(slowReply.compare(headerEnd, size, _service.large) == 0);
+            CXXTOOLS_UNIT_ASSERT(slowReply.compare(headerEnd + size, size, std::string(size, 'y')) == 0);
+
+            _service.large.clear();
+        }
+};
+
+cxxtools::unit::RegisterTest<HttpServerTest> register_HttpServerTest;
@@ -30,6 +30,7 @@
 #include "cxxtools/unit/registertest.h"
 #include "cxxtools/jsondeserializer.h"
 #include "cxxtools/log.h"
+#include <algorithm>
 
 //log_define("cxxtools.test.jsondeserializer")
 //
@@ -84,6 +85,37 @@ namespace
     {
     };
 
+    // delivers the input in small chunks to test tokens spanning buffers
+    class ChunkedStreamBuf : public std::streambuf
+    {
+            std::string _data;
+            std::string::size_type _pos;
+            std::string::size_type _chunkSize;
+
+        public:
+            ChunkedStreamBuf(const std::string& data, std::string::size_type chunkSize)
+                : _data(data),
+                  _pos(0),
+                  _chunkSize(chunkSize)
+            { }
+
+        protected:
+            int_type underflow()
+            {
+                if (gptr() < egptr())
+                    return traits_type::to_int_type(*gptr());
+
+                if (_pos >= _data.size())
+                    return traits_type::eof();
+
+                std::string::size_type n = std::min(_chunkSize, _data.size() - _pos);
+                char* p = &_data[_pos];
+                setg(&_data[0], p, p + n);
+                _pos += n;
+                return traits_type::to_int_type(*gptr());
+            }
+    };
+
     inline void operator>>= (const cxxtools::SerializationInfo& si, EmptyObject& obj)
     {
     }
@@ -106,6 +138,10 @@ class JsonDeserializerTest : public cxxtools::unit::TestSuite
             registerMethod("testComplexObject", *this, &JsonDeserializerTest::testComplexObject);
             registerMethod("testCommentLine", *this, &JsonDeserializerTest::testCommentLine);
             registerMethod("testCommentMultiline", *this, &JsonDeserializerTest::testCommentMultiline);
+            registerMethod("testUtf8", *this, &JsonDeserializerTest::testUtf8);
+            registerMethod("testChunked", *this, &JsonDeserializerTest::testChunked);
+            registerMethod("testMultipleValues", *this, &JsonDeserializerTest::testMultipleValues);
+            registerMethod("testInvalidCharacter", *this, &JsonDeserializerTest::testInvalidCharacter);
         }
 
         void testInt()
@@ -302,6 +338,91 @@ class JsonDeserializerTest : public cxxtools::unit::TestSuite
             CXXTOOLS_UNIT_ASSERT_EQUALS(data.boolValue, true);
             CXXTOOLS_UNIT_ASSERT_EQUALS(data.nullValue, true);
         }
+
+        void testUtf8()
+        {
+            std::vector<cxxtools::String> data;
+
+            std::istringstream in("\xef\xbb\xbf[\"K\xc3\xa4se\", \"\\u00e4\\ud834\\udd1e\", \"\xe2\x82\xac 17\"]");
+
+            cxxtools::JsonDeserializer deserializer(in);
+            deserializer.deserialize(data);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data.size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0].size(), 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[0][1].value(), 0xe4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[1].size(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[1][0].value(), 0xe4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[1][1].value(), 0x1d11e);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[2].size(), 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(data[2][0].value(), 0x20ac);
+        }
+
+        void testChunked()
+        {
+            std::string json = " {"
+                "\"intValue\": 17, "
+                "\"stringValue\":  \"foo bar with a somewhat longer text\\t\","
+                "\"doubleValue\": 1.5e3, "
+                "\"boolValue\"  :    true,"
+                "\"nullValue\"  :  null"
+            "}";
+
+            for (unsigned chunkSize = 1; chunkSize < 8; ++chunkSize)
+            {
+                TestObject data;
+
+                ChunkedStreamBuf sb(json, chunkSize);
+                std::istream in(&sb);
+
+                cxxtools::JsonDeserializer deserializer(in);
+                deserializer.deserialize(data);
+
+                CXXTOOLS_UNIT_ASSERT_EQUALS(data.intValue, 17);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(data.stringValue, "foo bar with a somewhat longer text\t");
+                CXXTOOLS_UNIT_ASSERT_EQUALS(data.doubleValue, 1500.0);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(data.boolValue, true);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(data.nullValue, true);
+            }
+        }
+
+        void testMultipleValues()
+        {
+            std::istringstream in("[1,2] 42 \"foo\"x");
+
+            std::vector<int> v;
+            cxxtools::JsonDeserializer(in).deserialize(v);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v.size(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(v[1], 2);
+
+            int i = 0;
+            cxxtools::JsonDeserializer(in).deserialize(i);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(i, 42);
+
+            std::string s;
+            cxxtools::JsonDeserializer(in).deserialize(s);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(s, "foo");
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(in.get(), 'x');
+        }
+
+        void testInvalidCharacter()
+        {
+            std::vector<int> data;
+
+            std::istringstream in("[1,\n2;3]");
+
+            cxxtools::JsonDeserializer deserializer(in);
+            try
+            {
+                deserializer.deserialize(data);
+                CXXTOOLS_UNIT_FAIL("JsonParserError expected");
+            }
+            catch (const cxxtools::JsonParserError& e)
+            {
+                CXXTOOLS_UNIT_ASSERT(std::string(e.what()).find("line 2") != std::string::npos);
+            }
+        }
 };
 
 cxxtools::unit::RegisterTest<JsonDeserializerTest> register_JsonDeserializerTest;
@@ -89,6 +89,7 @@ class JsonRpcHttpTest : public cxxtools::unit::TestSuite
             registerMethod("Nothing", *this, &JsonRpcHttpTest::Nothing);
             registerMethod("Boolean", *this, &JsonRpcHttpTest::Boolean);
             registerMethod("Integer", *this, &JsonRpcHttpTest::Integer);
+            registerMethod("IOThreads", *this, &JsonRpcHttpTest::IOThreads);
             registerMethod("Double", *this, &JsonRpcHttpTest::Double);
             registerMethod("String", *this, &JsonRpcHttpTest::String);
             registerMethod("EmptyValues", *this, &JsonRpcHttpTest::EmptyValues);
@@ -258,6 +259,31 @@ class JsonRpcHttpTest : public cxxtools::unit::TestSuite
             return a*b;
         }
 
+        ////////////////////////////////////////////////////////////
+        // IOThreads
+        //
+        void IOThreads()
+        {
+            _server->ioThreads(2);
+
+            cxxtools::json::HttpService service;
+            service.registerMethod("multiply", *this, &JsonRpcHttpTest::multiplyInt);
+            _server->addService("/calc", service);
+
+            cxxtools::json::HttpClient client1(_loop, "", _port, "/calc");
+            cxxtools::json::HttpClient client2(_loop, "", _port, "/calc");
+            cxxtools::RemoteProcedure<int, int, int> multiply1(client1, "multiply");
+            cxxtools::RemoteProcedure<int, int, int> multiply2(client2, "multiply");
+
+            for (int n = 1; n <= 3; ++n)
+            {
+                multiply1.begin(2, n);
+                multiply2.begin(3, n);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(multiply1.end(2000), 2 * n);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(multiply2.end(2000), 3 * n);
+            }
+        }
+
         ////////////////////////////////////////////////////////////
         // Double
         //
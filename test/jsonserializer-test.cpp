@@ -76,6 +76,9 @@ class JsonSerializerTest : public cxxtools::unit::TestSuite
             registerMethod("testMultipleObjects", *this, &JsonSerializerTest::testMultipleObjects);
             registerMethod("testPlainEmpty", *this, &JsonSerializerTest::testPlainEmpty);
             registerMethod("testEmptyObject", *this, &JsonSerializerTest::testEmptyObject);
+            registerMethod("testEscape", *this, &JsonSerializerTest::testEscape);
+            registerMethod("testLongString", *this, &JsonSerializerTest::testLongString);
+            registerMethod("testTextStream", *this, &JsonSerializerTest::testTextStream);
         }
 
         void testInt()
@@ -234,6 +237,73 @@ class JsonSerializerTest : public cxxtools::unit::TestSuite
             CXXTOOLS_UNIT_ASSERT_EQUALS(out.str(), "{}");
         }
 
+        void testEscape()
+        {
+            cxxtools::String text(L"x\ty");
+            text.insert(2, 1, cxxtools::Char(cxxtools::Char::value_type(0x1f600)));
+
+            std::ostringstream out;
+            cxxtools::JsonSerializer serializer(out);
+            serializer.serialize(std::string("a\"b\\c\n\x01\xe4"), "s")
+                      .serialize(text, "t")
+                      .finish();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out.str(),
+                "{\"s\":\"a\\\"b\\\\c\\n\\u0001\\u00e4\","
+                "\"t\":\"x\\t\\ud83d\\ude00y\"}");
+        }
+
+        void testLongString()
+        {
+            // longer than the output buffer of the formatter
+            std::string data;
+            std::string expected = "\"";
+            for (unsigned n = 0; n < 1000; ++n)
+            {
+                data += "abc\"";
+                expected += "abc\\\"";
+            }
+            expected += '"';
+
+            std::ostringstream out;
+            cxxtools::JsonSerializer serializer(out);
+            serializer.serialize(data).finish();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out.str(), expected);
+
+            std::ostringstream wout;
+            cxxtools::JsonSerializer wserializer(wout);
+            wserializer.serialize(cxxtools::String(data)).finish();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(wout.str(), expected);
+        }
+
+        void testTextStream()
+        {
+            TestObject data;
+            data.intValue = -17;
+            data.stringValue = "foo\tbar";
+            data.doubleValue = 2.25;
+            data.boolValue = true;
+
+            std::ostringstream out;
+            cxxtools::JsonSerializer serializer(out);
+            serializer.serialize(data).finish();
+
+            std::basic_ostringstream<cxxtools::Char> ts;
+            cxxtools::JsonSerializer tserializer(ts);
+            tserializer.serialize(data).finish();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out.str(), "{"
+                "\"intValue\":-17,"
+                "\"stringValue\":\"foo\\tbar\","
+                "\"doubleValue\":2.25,"
+                "\"boolValue\":true,"
+                "\"nullValue\":null"
+                "}");
+            CXXTOOLS_UNIT_ASSERT(ts.str() == cxxtools::String(out.str()));
+        }
+
 };
 
 cxxtools::unit::RegisterTest<JsonSerializerTest> register_JsonSerializerTest;
@@ -0,0 +1,226 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/log.h"
+#include "cxxtools/thread.h"
+#include "cxxtools/method.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+
+log_define("cxxtools.test.log")
+
+class LogTest : public cxxtools::unit::TestSuite
+{
+        cxxtools::LogConfiguration _savedConfig;
+        std::string _fname;
+
+        enum { Threads = 4, Messages = 2000 };
+
+    public:
+        LogTest()
+        : cxxtools::unit::TestSuite("log"),
+          _fname("log-test.log")
+        {
+            registerMethod("testThreadOrder", *this, &LogTest::testThreadOrder);
+            registerMethod("testFlush", *this, &LogTest::testFlush);
+            registerMethod("testDropCount", *this, &LogTest::testDropCount);
+            registerMethod("testFatal", *this, &LogTest::testFatal);
+        }
+
+        void setUp()
+        {
+            _savedConfig = cxxtools::LogManager::getInstance().getLogConfiguration();
+            ::unlink(_fname.c_str());
+        }
+
+        void tearDown()
+        {
+            cxxtools::LogManager::getInstance().configure(_savedConfig);
+            ::unlink(_fname.c_str());
+        }
+
+        void configureAsync(unsigned bufferSize, cxxtools::LogConfiguration::OverflowPolicy policy)
+        {
+            cxxtools::LogConfiguration config;
+            config.setFile(_fname);
+            config.setRootLevel(cxxtools::Logger::FATAL);
+            config.setLogLevel("cxxtools.test.log", cxxtools::Logger::INFO);
+            config.setAsync(bufferSize, policy);
+            cxxtools::LogManager::getInstance().configure(config);
+        }
+
+        std::vector<std::string> readLog()
+        {
+            std::vector<std::string> lines;
+            std::ifstream in(_fname.c_str());
+            std::string line;
+            while (std::getline(in, line))
+                lines.push_back(line);
+            return lines;
+        }
+
+        // returns the number n of a line ending with "<prefix> n"
+        static bool messageNumber(const std::string& line, const std::string& prefix, unsigned& n)
+        {
+            std::string::size_type p = line.find(prefix);
+            if (p == std::string::npos)
+                return false;
+
+            std::istringstream s(line.substr(p + prefix.size()));
+            return static_cast<bool>(s >> n);
+        }
+
+        void writeMessages()
+        {
+            static cxxtools::atomic_t nextThread = 0;
+            unsigned thread = static_cast<unsigned>(cxxtools::atomicIncrement(nextThread)) % Threads;
+            for (unsigned n = 0; n < Messages; ++n)
+                log_info("thread " << thread << " message " << n);
+        }
+
+        void testThreadOrder()
+        {
+            configureAsync(4096, cxxtools::LogConfiguration::BlockOnOverflow);
+
+            std::vector<cxxtools::AttachedThread*> threads;
+            for (unsigned t = 0; t < Threads; ++t)
+            {
+                threads.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &LogTest::writeMessages)));
+                threads.back()->start();
+            }
+
+            for (unsigned t = 0; t < threads.size(); ++t)
+            {
+                threads[t]->join();
+                delete threads[t];
+            }
+
+            cxxtools::LogManager::getInstance().flush();
+
+            // each thread has its own message numbers; all messages are written in order
+            std::vector<unsigned> next(Threads, 0);
+            std::vector<std::string> lines = readLog();
+            for (unsigned l = 0; l < lines.size(); ++l)
+            {
+                unsigned thread = 0;
+                unsigned n = 0;
+                CXXTOOLS_UNIT_ASSERT(messageNumber(lines[l], "thread ", thread));
+                CXXTOOLS_UNIT_ASSERT(thread < Threads);
+                CXXTOOLS_UNIT_ASSERT(messageNumber(lines[l], " message ", n));
+                CXXTOOLS_UNIT_ASSERT_EQUALS(n, next[thread]);
+                ++next[thread];
+            }
+
+            for (unsigned t = 0; t < Threads; ++t)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(next[t], Messages);
+        }
+
+        void testFlush()
+        {
+            configureAsync(65536, cxxtools::LogConfiguration::BlockOnOverflow);
+
+            for (unsigned n = 0; n < 10; ++n)
+            {
+                log_info("flushed " << n);
+                cxxtools::LogManager::getInstance().flush();
+
+                std::vector<std::string> lines = readLog();
+                CXXTOOLS_UNIT_ASSERT_EQUALS(lines.size(), n + 1);
+                unsigned m = 0;
+                CXXTOOLS_UNIT_ASSERT(messageNumber(lines.back(), "flushed ", m));
+                CXXTOOLS_UNIT_ASSERT_EQUALS(m, n);
+            }
+        }
+
+        void testDropCount()
+        {
+            configureAsync(1024, cxxtools::LogConfiguration::DropOnOverflow);
+
+            unsigned long droppedBefore = cxxtools::LogManager::getInstance().droppedMessages();
+
+            const unsigned count = 20000;
+            for (unsigned n = 0; n < count; ++n)
+                log_info("message " << n);
+
+            cxxtools::LogManager::getInstance().flush();
+
+            unsigned long dropped = cxxtools::LogManager::getInstance().droppedMessages() - droppedBefore;
+
+            // every message is either written or counted; the written ones keep their order
+            std::vector<std::string> lines = readLog();
+            unsigned written = 0;
+            unsigned last = 0;
+            bool reported = false;
+            for (unsigned l = 0; l < lines.size(); ++l)
+            {
+                unsigned n;
+                if (messageNumber(lines[l], "message ", n))
+                {
+                    CXXTOOLS_UNIT_ASSERT(written == 0 || n > last);
+                    last = n;
+                    ++written;
+                }
+                else if (lines[l].find("log messages dropped") != std::string::npos)
+                    reported = true;
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(written + dropped, count);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(reported, (dropped > 0));
+        }
+
+        void testFatal()
+        {
+            // a buffer, which overflows quickly, must not drop fatal messages
+            configureAsync(1024, cxxtools::LogConfiguration::DropOnOverflow);
+
+            for (unsigned n = 0; n < 50; ++n)
+            {
+                // fill the buffer, until messages get dropped
+                unsigned long dropped = cxxtools::LogManager::getInstance().droppedMessages();
+                for (unsigned m = 0; cxxtools::LogManager::getInstance().droppedMessages() == dropped; ++m)
+                    log_info("message " << m);
+
+                log_fatal("fatal " << n);
+
+                // written without flush
+                std::vector<std::string> lines = readLog();
+                bool found = false;
+                for (unsigned l = 0; l < lines.size() && !found; ++l)
+                {
+                    unsigned f;
+                    found = messageNumber(lines[l], "fatal ", f) && f == n;
+                }
+
+                CXXTOOLS_UNIT_ASSERT(found);
+            }
+        }
+};
+
+cxxtools::unit::RegisterTest<LogTest> register_LogTest;
@@ -0,0 +1,131 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cxxtools/http/service.h>
+#include <cxxtools/http/responder.h>
+#include <cxxtools/http/request.h>
+#include <cxxtools/regex.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include "http/mapper.h"
+
+namespace
+{
+    class BenchResponder : public cxxtools::http::Responder
+    {
+        public:
+            explicit BenchResponder(cxxtools::http::Service& service)
+                : cxxtools::http::Responder(service)
+                { }
+
+            void reply(std::ostream&, cxxtools::http::Request&, cxxtools::http::Reply&)
+            { }
+    };
+
+    class BenchService : public cxxtools::http::Service
+    {
+            BenchResponder _responder;
+
+        public:
+            BenchService()
+                : _responder(*this)
+                { }
+
+        protected:
+            cxxtools::http::Responder* createResponder(const cxxtools::http::Request&)
+            { return &_responder; }
+
+            void releaseResponder(cxxtools::http::Responder*)
+            { }
+    };
+
+    void bench(const char* name, cxxtools::http::Mapper& mapper, const std::vector<std::string>& urls, unsigned n)
+    {
+        cxxtools::http::Request request;
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            request.url(urls[i % urls.size()]);
+            mapper.getResponder(request)->release();
+        }
+
+        cxxtools::Timespan ts = clock.stop();
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << name << ": " << secs << " sec, "
+                  << secs * 1e6 / n << " usec per lookup" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 100000);
+        cxxtools::Arg<unsigned> routes(argc, argv, 'r', 1000);
+
+        std::cout << "benchmark " << n.getValue() << " lookups in " << routes.getValue() << " routes\n\n"
+                     "options:\n"
+                     "   -n <number>       number of lookups\n"
+                     "   -r <number>       number of routes (default: 1000)\n" << std::endl;
+
+        BenchService service;
+        cxxtools::http::Mapper regexMapper;
+        cxxtools::http::Mapper urlMapper;
+        cxxtools::http::Mapper paramMapper;
+        std::vector<std::string> urls;
+
+        for (unsigned r = 0; r < routes; ++r)
+        {
+            std::ostringstream url;
+            url << "/api/v1/resource" << r;
+
+            regexMapper.addService(cxxtools::Regex('^' + url.str() + "/([^/]+)$"), service);
+            urlMapper.addService(url.str() + "/item", service);
+            paramMapper.addService(url.str() + "/{id}", service);
+
+            urls.push_back(url.str() + "/item");
+        }
+
+        bench("regular expressions", regexMapper, urls, n);
+        bench("urls", urlMapper, urls, n);
+        bench("urls with parameter", paramMapper, urls, n);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
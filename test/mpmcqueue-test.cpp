@@ -0,0 +1,209 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/mpmcqueue.h"
+#include "cxxtools/queue.h"
+#include "cxxtools/threadpool.h"
+#include "cxxtools/thread.h"
+#include "cxxtools/method.h"
+#include <vector>
+
+class MpmcQueueTest : public cxxtools::unit::TestSuite
+{
+        cxxtools::MpmcQueue<int>* _queue;
+        cxxtools::Queue<int>* _limitedQueue;
+        cxxtools::Mutex _mutex;
+        long _sum;
+
+    public:
+        MpmcQueueTest()
+            : cxxtools::unit::TestSuite("mpmcqueue"),
+              _queue(0),
+              _limitedQueue(0),
+              _sum(0)
+        {
+            registerMethod("testFifo", *this, &MpmcQueueTest::testFifo);
+            registerMethod("testFull", *this, &MpmcQueueTest::testFull);
+            registerMethod("testBatch", *this, &MpmcQueueTest::testBatch);
+            registerMethod("testThreads", *this, &MpmcQueueTest::testThreads);
+            registerMethod("testThreadPool", *this, &MpmcQueueTest::testThreadPool);
+            registerMethod("testQueueMaxSize", *this, &MpmcQueueTest::testQueueMaxSize);
+        }
+
+        void testFifo()
+        {
+            cxxtools::MpmcQueue<int> queue(8);
+            CXXTOOLS_UNIT_ASSERT(queue.empty());
+
+            queue.put(1);
+            queue.put(2);
+            queue.put(3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.size(), 3);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.get(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.get(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.get(), 3);
+            CXXTOOLS_UNIT_ASSERT(queue.empty());
+            CXXTOOLS_UNIT_ASSERT(!queue.tryGet().second);
+        }
+
+        void testFull()
+        {
+            cxxtools::MpmcQueue<int> queue(3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.maxSize(), 4);
+
+            for (int n = 0; n < 4; ++n)
+                CXXTOOLS_UNIT_ASSERT(queue.tryPut(n));
+            CXXTOOLS_UNIT_ASSERT(!queue.tryPut(4));
+
+            // wraps around
+            for (int n = 0; n < 10; ++n)
+            {
+                std::pair<int, bool> r = queue.tryGet();
+                CXXTOOLS_UNIT_ASSERT(r.second);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(r.first, n);
+                CXXTOOLS_UNIT_ASSERT(queue.tryPut(n + 4));
+            }
+        }
+
+        void testBatch()
+        {
+            cxxtools::MpmcQueue<int> queue(16);
+            std::vector<int> in;
+            for (int n = 0; n < 10; ++n)
+                in.push_back(n);
+
+            queue.put(in.begin(), in.end());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.size(), 10);
+
+            std::vector<int> out(20);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.get(out.begin(), 4), 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out[3], 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.tryGet(out.begin(), 20), 6);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out[0], 4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(out[5], 9);
+            CXXTOOLS_UNIT_ASSERT(queue.empty());
+        }
+
+        void produce()
+        {
+            for (int n = 1; n <= 10000; ++n)
+                _queue->put(n);
+        }
+
+        void consume()
+        {
+            long sum = 0;
+            int v;
+            while ((v = _queue->get()) != 0)
+                sum += v;
+
+            cxxtools::MutexLock lock(_mutex);
+            _sum += sum;
+        }
+
+        void testThreads()
+        {
+            cxxtools::MpmcQueue<int> queue(16);
+            _queue = &queue;
+            _sum = 0;
+
+            std::vector<cxxtools::AttachedThread*> threads;
+            for (unsigned n = 0; n < 4; ++n)
+                threads.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &MpmcQueueTest::produce)));
+            for (unsigned n = 0; n < 4; ++n)
+                threads.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &MpmcQueueTest::consume)));
+
+            for (unsigned n = 0; n < threads.size(); ++n)
+                threads[n]->start();
+
+            for (unsigned n = 0; n < 4; ++n)
+                threads[n]->join();
+
+            for (unsigned n = 0; n < 4; ++n)
+                queue.put(0);
+
+            for (unsigned n = 0; n < threads.size(); ++n)
+                delete threads[n];
+
+            _queue = 0;
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 4 * 10000L * 10001L / 2);
+        }
+
+        void putLimited()
+        {
+            _limitedQueue->put(1);
+        }
+
+        void testQueueMaxSize()
+        {
+            cxxtools::Queue<int> queue;
+            queue.maxSize(1);
+            queue.put(1);
+            _limitedQueue = &queue;
+
+            cxxtools::AttachedThread producer1(cxxtools::callable(*this, &MpmcQueueTest::putLimited));
+            cxxtools::AttachedThread producer2(cxxtools::callable(*this, &MpmcQueueTest::putLimited));
+            producer1.start();
+            producer2.start();
+
+            // both producers block until the limit is removed
+            cxxtools::Thread::sleep(50);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.size(), 1);
+
+            queue.maxSize(0);
+
+            producer1.join();
+            producer2.join();
+            _limitedQueue = 0;
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(queue.size(), 3);
+        }
+
+        void add()
+        {
+            cxxtools::MutexLock lock(_mutex);
+            ++_sum;
+        }
+
+        void testThreadPool()
+        {
+            _sum = 0;
+
+            {
+                cxxtools::ThreadPool pool(4, true, 8);
+                for (unsigned n = 0; n < 1000; ++n)
+                    pool.schedule(cxxtools::callable(*this, &MpmcQueueTest::add));
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 1000);
+        }
+};
+
+cxxtools::unit::RegisterTest<MpmcQueueTest> register_MpmcQueueTest;
@@ -0,0 +1,217 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/poolallocator.h"
+#include "cxxtools/pool.h"
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/thread.h"
+#include "cxxtools/threadpool.h"
+#include "cxxtools/atomicity.h"
+#include <cstring>
+#include <vector>
+
+class PoolAllocatorTest : public cxxtools::unit::TestSuite
+{
+    struct Object
+    {
+        static unsigned instCount;
+
+        char data[40];
+
+        Object()
+        { ++instCount; }
+        ~Object()
+        { --instCount; }
+    };
+
+    cxxtools::PoolAllocator* _allocator;
+    std::vector<void*> _blocks;
+    volatile cxxtools::atomic_t _tasks;
+
+    void allocateBlocks()
+    {
+        for (unsigned n = 0; n < 1000; ++n)
+            _blocks.push_back(_allocator->allocate(24));
+    }
+
+    void deallocateBlocks()
+    {
+        for (unsigned n = 0; n < _blocks.size(); ++n)
+            _allocator->deallocate(_blocks[n], 24);
+    }
+
+    void task()
+    {
+        cxxtools::atomicIncrement(_tasks);
+    }
+
+  public:
+    PoolAllocatorTest()
+    : cxxtools::unit::TestSuite("poolallocator")
+    {
+        registerMethod("reuse", *this, &PoolAllocatorTest::reuse);
+        registerMethod("sizeClasses", *this, &PoolAllocatorTest::sizeClasses);
+        registerMethod("largeBlocks", *this, &PoolAllocatorTest::largeBlocks);
+        registerMethod("crossThread", *this, &PoolAllocatorTest::crossThread);
+        registerMethod("pool", *this, &PoolAllocatorTest::pool);
+        registerMethod("threadPool", *this, &PoolAllocatorTest::threadPool);
+    }
+
+    void reuse()
+    {
+        cxxtools::PoolAllocator allocator;
+
+        void* p = allocator.allocate(20);
+        allocator.deallocate(p, 20);
+
+        // the last freed block of the size class is returned first
+        void* q = allocator.allocate(32);
+        CXXTOOLS_UNIT_ASSERT(p == q);
+        allocator.deallocate(q, 32);
+
+        cxxtools::PoolAllocator::Stats s = allocator.stats();
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.allocations, 2);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.deallocations, 2);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.inUse(), 0);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.refills, 1);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.chunks, 1);
+    }
+
+    void sizeClasses()
+    {
+        cxxtools::PoolAllocator allocator;
+
+        std::vector<char*> blocks;
+        for (unsigned size = 0; size <= cxxtools::PoolAllocator::MaxSize; ++size)
+        {
+            char* p = static_cast<char*>(allocator.allocate(size));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(reinterpret_cast<unsigned long>(p) % cxxtools::PoolAllocator::Granularity, 0);
+            std::memset(p, size & 0xff, size);
+            blocks.push_back(p);
+        }
+
+        for (unsigned size = 0; size <= cxxtools::PoolAllocator::MaxSize; ++size)
+        {
+            for (unsigned n = 0; n < size; ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(static_cast<unsigned char>(blocks[size][n]), (size & 0xff));
+            allocator.deallocate(blocks[size], size);
+        }
+
+        CXXTOOLS_UNIT_ASSERT_EQUALS(allocator.stats().inUse(), 0);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(allocator.stats().largeAllocations, 0);
+    }
+
+    void largeBlocks()
+    {
+        cxxtools::PoolAllocator allocator;
+
+        void* p = allocator.allocate(cxxtools::PoolAllocator::MaxSize + 1);
+        std::memset(p, 0, cxxtools::PoolAllocator::MaxSize + 1);
+        allocator.deallocate(p, cxxtools::PoolAllocator::MaxSize + 1);
+
+        cxxtools::PoolAllocator::Stats s = allocator.stats();
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.largeAllocations, 1);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.chunks, 0);
+    }
+
+    void crossThread()
+    {
+        cxxtools::PoolAllocator allocator;
+        _allocator = &allocator;
+        _blocks.clear();
+
+        // allocated in one thread and freed in another, which returns
+        // the blocks to the depot when it terminates
+        {
+            cxxtools::AttachedThread producer(cxxtools::callable(*this, &PoolAllocatorTest::allocateBlocks));
+            producer.start();
+            producer.join();
+        }
+
+        {
+            cxxtools::AttachedThread consumer(cxxtools::callable(*this, &PoolAllocatorTest::deallocateBlocks));
+            consumer.start();
+            consumer.join();
+        }
+
+        cxxtools::PoolAllocator::Stats s = allocator.stats();
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.allocations, 1000);
+        CXXTOOLS_UNIT_ASSERT_EQUALS(s.deallocations, 1000);
+        CXXTOOLS_UNIT_ASSERT(s.flushes > 0);
+
+        // the next thread is served from the depot
+        unsigned long chunks = s.chunks;
+        {
+            cxxtools::AttachedThread producer(cxxtools::callable(*this, &PoolAllocatorTest::allocateBlocks));
+            producer.start();
+            producer.join();
+        }
+
+        CXXTOOLS_UNIT_ASSERT_EQUALS(allocator.stats().chunks, chunks);
+        _blocks.clear();
+    }
+
+    void pool()
+    {
+        Object::instCount = 0;
+
+        {
+            typedef cxxtools::Pool<Object, cxxtools::PoolAllocatorCreator<Object>,
+                                   cxxtools::RefLinked, cxxtools::PoolAllocatorDestroyPolicy> PoolType;
+            PoolType pool(1);
+
+            {
+                PoolType::Ptr p1 = pool.get();
+                PoolType::Ptr p2 = pool.get();
+                CXXTOOLS_UNIT_ASSERT_EQUALS(Object::instCount, 2);
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(pool.size(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(Object::instCount, 1);
+        }
+
+        CXXTOOLS_UNIT_ASSERT_EQUALS(Object::instCount, 0);
+    }
+
+    void threadPool()
+    {
+        _tasks = 0;
+
+        {
+            cxxtools::ThreadPool pool(4);
+            for (unsigned n = 0; n < 1000; ++n)
+                pool.schedule(cxxtools::callable(*this, &PoolAllocatorTest::task));
+        }
+
+        CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::atomicGet(_tasks), 1000);
+    }
+};
+
+unsigned PoolAllocatorTest::Object::instCount = 0;
+
+cxxtools::unit::RegisterTest<PoolAllocatorTest> register_PoolAllocatorTest;
@@ -0,0 +1,170 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cxxtools/function.h>
+#include <cxxtools/serviceregistry.h>
+#include <cxxtools/serializationinfo.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/method.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+
+namespace
+{
+    int add(int a, int b)
+    {
+        return a + b;
+    }
+
+    // Dispatches n calls of "add" per thread the way the rpc servers do:
+    // get a procedure, compose the arguments, call it and release it.
+    class Bench
+    {
+        public:
+            enum Mode
+            {
+                Clone,     // new instance for each call
+                Pool,      // instance from the free list of the registry
+                Resolved   // like Pool, but the name is resolved once
+            };
+
+        private:
+            const cxxtools::ServiceRegistry& _registry;
+            Mode _mode;
+            unsigned _n;
+
+        public:
+            Bench(const cxxtools::ServiceRegistry& registry, Mode mode, unsigned n)
+                : _registry(registry),
+                  _mode(mode),
+                  _n(n)
+                { }
+
+            void run()
+            {
+                cxxtools::SerializationInfo a;
+                cxxtools::SerializationInfo b;
+
+                cxxtools::ServiceProcedure* prototype = _registry.getProcedure("add");
+                const cxxtools::ServiceProcedurePool* resolved = _registry.resolveProcedure("add");
+
+                for (unsigned n = 0; n < _n; ++n)
+                {
+                    cxxtools::ServiceProcedure* proc;
+                    switch (_mode)
+                    {
+                        case Clone:    proc = prototype->clone(); break;
+                        case Pool:     proc = _registry.getProcedure("add"); break;
+                        default:       proc = _registry.getProcedure(resolved); break;
+                    }
+
+                    a.setValue(static_cast<int>(n));
+                    b.setValue(1);
+
+                    cxxtools::IComposer** args = proc->beginCall();
+                    args[0]->fixup(a);
+                    args[1]->fixup(b);
+                    proc->endCall();
+
+                    if (_mode == Clone)
+                        delete proc;
+                    else
+                        _registry.releaseProcedure(proc);
+                }
+
+                _registry.releaseProcedure(prototype);
+            }
+    };
+
+    void bench(const char* name, const cxxtools::ServiceRegistry& registry, Bench::Mode mode, unsigned threads, unsigned n)
+    {
+        Bench b(registry, mode, n);
+        std::vector<cxxtools::AttachedThread*> t;
+        for (unsigned i = 0; i < threads; ++i)
+            t.push_back(new cxxtools::AttachedThread(cxxtools::callable(b, &Bench::run)));
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->start();
+
+        for (unsigned i = 0; i < threads; ++i)
+            t[i]->join();
+
+        cxxtools::Timespan ts = clock.stop();
+
+        for (unsigned i = 0; i < threads; ++i)
+            delete t[i];
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << '\t' << name << ": " << secs << " sec, "
+                  << static_cast<unsigned long>(threads * n / secs) << " calls/sec" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 1000000);
+        cxxtools::Arg<unsigned> maxThreads(argc, argv, 't', 8);
+        cxxtools::Arg<unsigned> procedures(argc, argv, 'p', 100);
+
+        std::cout << "benchmark dispatching " << n.getValue() << " calls of \"add\" per thread\n\n"
+                     "options:\n"
+                     "   -n <number>       number of calls per thread\n"
+                     "   -t <number>       maximum number of threads (default: 8)\n"
+                     "   -p <number>       number of further registered procedures (default: 100)\n" << std::endl;
+
+        cxxtools::ServiceRegistry registry;
+        registry.registerFunction("add", add);
+        for (unsigned p = 0; p < procedures; ++p)
+        {
+            std::ostringstream name;
+            name << "add" << p;
+            registry.registerFunction(name.str(), add);
+        }
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            std::cout << threads << " threads:" << std::endl;
+            bench("clone per call", registry, Bench::Clone, threads, n);
+            bench("free list", registry, Bench::Pool, threads, n);
+            bench("resolved procedure", registry, Bench::Resolved, threads, n);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <iostream>
+#include <vector>
+#include <cxxtools/queue.h>
+#include <cxxtools/mpmcqueue.h>
+#include <cxxtools/thread.h>
+#include <cxxtools/method.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+
+namespace
+{
+    // Passes n elements per producer through the queue; consumers stop at 0.
+    template <typename QueueType>
+    class Bench
+    {
+            QueueType& _queue;
+            unsigned _n;
+
+        public:
+            Bench(QueueType& queue, unsigned n)
+                : _queue(queue),
+                  _n(n)
+                { }
+
+            void produce()
+            {
+                for (unsigned n = 1; n <= _n; ++n)
+                    _queue.put(n);
+            }
+
+            void consume()
+            {
+                while (_queue.get() != 0)
+                    ;
+            }
+
+            cxxtools::Timespan run(unsigned threads)
+            {
+                std::vector<cxxtools::AttachedThread*> producers;
+                std::vector<cxxtools::AttachedThread*> consumers;
+
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    producers.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &Bench::produce)));
+                    consumers.push_back(new cxxtools::AttachedThread(cxxtools::callable(*this, &Bench::consume)));
+                }
+
+                cxxtools::Clock clock;
+                clock.start();
+
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    consumers[t]->start();
+                    producers[t]->start();
+                }
+
+                for (unsigned t = 0; t < threads; ++t)
+                    producers[t]->join();
+
+                for (unsigned t = 0; t < threads; ++t)
+                    _queue.put(0);
+
+                for (unsigned t = 0; t < threads; ++t)
+                    consumers[t]->join();
+
+                cxxtools::Timespan ts = clock.stop();
+
+                for (unsigned t = 0; t < threads; ++t)
+                {
+                    delete producers[t];
+                    delete consumers[t];
+                }
+
+                return ts;
+            }
+    };
+
+    template <typename QueueType>
+    void bench(const char* name, QueueType& queue, unsigned threads, unsigned n)
+    {
+        Bench<QueueType> b(queue, n);
+        cxxtools::Timespan ts = b.run(threads);
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << '\t' << name << ": " << secs << " sec, "
+                  << static_cast<unsigned long>(threads * n / secs) << " elements/sec" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 100000);
+        cxxtools::Arg<unsigned> maxThreads(argc, argv, 't', 64);
+        cxxtools::Arg<unsigned> capacity(argc, argv, 'c', 1024);
+
+        std::cout << "benchmark queues with " << n.getValue() << " elements per producer\n\n"
+                     "options:\n"
+                     "   -n <number>       number of elements per producer\n"
+                     "   -t <number>       maximum number of producers and consumers (default: 64)\n"
+                     "   -c <number>       capacity of the bounded queues (default: 1024)\n" << std::endl;
+
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            std::cout << threads << " producers and " << threads << " consumers:" << std::endl;
+
+            cxxtools::Queue<unsigned> queue;
+            bench("Queue", queue, threads, n);
+
+            cxxtools::Queue<unsigned> boundedQueue;
+            boundedQueue.maxSize(capacity);
+            bench("Queue (bounded)", boundedQueue, threads, n);
+
+            cxxtools::MpmcQueue<unsigned> mpmcQueue(capacity);
+            bench("MpmcQueue", mpmcQueue, threads, n);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
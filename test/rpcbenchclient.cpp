@@ -39,16 +39,20 @@
 #include <cxxtools/clock.h>
 #include <cxxtools/timespan.h>
 #include <cxxtools/atomicity.h>
+#include <cxxtools/selector.h>
+#include <cxxtools/connectable.h>
 
 class BenchClient
 {
     void exec();
+    void execPipelined();
 
     cxxtools::RemoteClient* client;
     cxxtools::AttachedThread thread;
 
     static unsigned _numRequests;
     static unsigned _vectorSize;
+    static unsigned _depth;
     static cxxtools::atomic_t _requestsStarted;
     static cxxtools::atomic_t _requestsFinished;
     static cxxtools::atomic_t _requestsFailed;
@@ -74,6 +78,12 @@ class BenchClient
     static void vectorSize(unsigned n)
     { _vectorSize = n; }
 
+    static unsigned depth()
+    { return _depth; }
+
+    static void depth(unsigned n)
+    { _depth = n; }
+
     static unsigned requestsStarted()
     { return static_cast<unsigned>(cxxtools::atomicGet(_requestsStarted)); }
 
@@ -95,12 +105,161 @@ cxxtools::atomic_t BenchClient::_requestsFinished(0);
 cxxtools::atomic_t BenchClient::_requestsFailed(0);
 unsigned BenchClient::_numRequests = 0;
 unsigned BenchClient::_vectorSize = 0;
+unsigned BenchClient::_depth = 1;
 typedef std::vector<BenchClient*> BenchClients;
 
 static cxxtools::Mutex mutex;
 
+// Runs one request after another on a client without waiting for the other
+// requests on the same connection.
+class PipelinedCall : public cxxtools::Connectable
+{
+    cxxtools::RemoteProcedure<std::string, std::string> echo;
+    cxxtools::RemoteProcedure<std::vector<int>, int, int> seq;
+    unsigned _vectorSize;
+    unsigned _numRequests;
+    cxxtools::atomic_t& _requestsStarted;
+    cxxtools::atomic_t& _requestsFinished;
+    cxxtools::atomic_t& _requestsFailed;
+    bool _running;
+
+    void onEchoFinished(const cxxtools::RemoteResult<std::string>& r);
+    void onSeqFinished(const cxxtools::RemoteResult<std::vector<int> >& r);
+    void failed(const std::exception& e);
+
+  public:
+    PipelinedCall(cxxtools::RemoteClient& client, unsigned vectorSize, unsigned numRequests,
+        cxxtools::atomic_t& requestsStarted, cxxtools::atomic_t& requestsFinished, cxxtools::atomic_t& requestsFailed)
+      : echo(client, "echo"),
+        seq(client, "seq"),
+        _vectorSize(vectorSize),
+        _numRequests(numRequests),
+        _requestsStarted(requestsStarted),
+        _requestsFinished(requestsFinished),
+        _requestsFailed(requestsFailed),
+        _running(false)
+    {
+      connect(echo.finished, *this, &PipelinedCall::onEchoFinished);
+      connect(seq.finished, *this, &PipelinedCall::onSeqFinished);
+    }
+
+    void begin();
+
+    bool running() const
+    { return _running; }
+};
+
+void PipelinedCall::begin()
+{
+  _running = static_cast<unsigned>(cxxtools::atomicIncrement(_requestsStarted)) <= _numRequests;
+  if (!_running)
+    return;
+
+  if (_vectorSize > 0)
+    seq.begin(1, _vectorSize);
+  else
+    echo.begin("hi");
+}
+
+void PipelinedCall::onEchoFinished(const cxxtools::RemoteResult<std::string>& r)
+{
+  try
+  {
+    const std::string& ret = r.get();
+    cxxtools::atomicIncrement(_requestsFinished);
+    if (ret != "hi")
+    {
+      std::cerr << "wrong response result \"" << ret << '"' << std::endl;
+      cxxtools::atomicIncrement(_requestsFailed);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    failed(e);
+  }
+
+  begin();
+}
+
+void PipelinedCall::onSeqFinished(const cxxtools::RemoteResult<std::vector<int> >& r)
+{
+  try
+  {
+    const std::vector<int>& ret = r.get();
+    cxxtools::atomicIncrement(_requestsFinished);
+    if (ret.size() != _vectorSize)
+    {
+      std::cerr << "wrong response result size " << ret.size() << std::endl;
+      cxxtools::atomicIncrement(_requestsFailed);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    failed(e);
+  }
+
+  begin();
+}
+
+void PipelinedCall::failed(const std::exception& e)
+{
+  {
+    cxxtools::MutexLock lock(mutex);
+    std::cerr << "request failed with error message \"" << e.what() << '"' << std::endl;
+  }
+
+  cxxtools::atomicIncrement(_requestsFailed);
+}
+
+void BenchClient::execPipelined()
+{
+  cxxtools::Selector selector;
+  dynamic_cast<cxxtools::bin::RpcClient&>(*client).setSelector(selector);
+
+  std::vector<PipelinedCall*> calls;
+  for (unsigned n = 0; n < _depth; ++n)
+  {
+    calls.push_back(new PipelinedCall(*client, _vectorSize, _numRequests,
+      _requestsStarted, _requestsFinished, _requestsFailed));
+    calls.back()->begin();
+  }
+
+  while (true)
+  {
+    bool running = false;
+    for (unsigned n = 0; n < calls.size(); ++n)
+      running = running || calls[n]->running();
+
+    if (!running)
+      break;
+
+    try
+    {
+      selector.wait();
+    }
+    catch (const std::exception& e)
+    {
+      {
+        cxxtools::MutexLock lock(mutex);
+        std::cerr << "connection failed with error message \"" << e.what() << '"' << std::endl;
+      }
+
+      break;
+    }
+  }
+
+  for (unsigned n = 0; n < calls.size(); ++n)
+    delete calls[n];
+}
+
 void BenchClient::exec()
 {
+  if (_depth > 1)
+  {
+    execPipelined();
+    return;
+  }
+
   cxxtools::RemoteProcedure<std::string, std::string> echo(*client, "echo");
   cxxtools::RemoteProcedure<std::vector<int>, int, int> seq(*client, "seq");
 
@@ -156,8 +315,10 @@ int main(int argc, char* argv[])
     cxxtools::Arg<unsigned short> port(argc, argv, 'p', binary ? 7003 : json ? 7004 : 7002);
     BenchClient::numRequests(cxxtools::Arg<unsigned>(argc, argv, 'n', 10000));
     BenchClient::vectorSize(cxxtools::Arg<unsigned>(argc, argv, 'v', 0));
+    BenchClient::depth(cxxtools::Arg<unsigned>(argc, argv, 'P', 1));
 
-    if (!xmlrpc && !binary && !json && !jsonhttp)
+    if ((!xmlrpc && !binary && !json && !jsonhttp)
+        || (BenchClient::depth() > 1 && !binary))
     {
         std::cerr << "usage: " << argv[0] << " [options]\n"
                      "options:\n"
@@ -169,6 +330,7 @@ int main(int argc, char* argv[])
                      "   -J         use json rpc over http protocol\n"
                      "   -t number  set number of threads (default: 4)\n"
                      "   -n number  set number of requests (default: 10000)\n"
+                     "   -P number  set number of pipelined requests per connection (binary only, default: 1)\n"
                      "one protocol must be selected\n"
                   << std::endl;
         return -1;
@@ -62,6 +62,7 @@ int main(int argc, char* argv[])
     cxxtools::Arg<unsigned short> jport(argc, argv, 'j', 7004);
     cxxtools::Arg<unsigned> threads(argc, argv, 't', 4);
     cxxtools::Arg<unsigned> maxThreads(argc, argv, 'T', 200);
+    cxxtools::Arg<unsigned> ioThreads(argc, argv, 'I', 0);
 
     std::cout << "rpc echo server running on port " << port.getValue() << "\n\n"
                  "options:\n\n"
@@ -71,6 +72,7 @@ int main(int argc, char* argv[])
                  "   -j number  set port number run json rpc server (default: 7004)\n"
                  "   -t number  set minimum number of threads (default: 4)\n"
                  "   -T number  set maximum number of threads (default: 200)\n"
+                 "   -I number  serve http event driven with number io threads (default: 0)\n"
               << std::endl;
 
     cxxtools::EventLoop loop;
@@ -78,6 +80,7 @@ int main(int argc, char* argv[])
     cxxtools::http::Server server(loop, ip, port);
     server.minThreads(threads);
     server.maxThreads(maxThreads);
+    server.ioThreads(ioThreads);
     cxxtools::xmlrpc::Service service;
     service.registerFunction("echo", echo);
     service.registerFunction("seq", seq);
@@ -58,6 +58,9 @@ class SerializationInfoTest : public cxxtools::unit::TestSuite
             registerMethod("testSiSwap", *this, &SerializationInfoTest::testSiSwap);
             registerMethod("testStringToBool", *this, &SerializationInfoTest::testStringToBool);
             registerMethod("testRangeCheck", *this, &SerializationInfoTest::testRangeCheck);
+            registerMethod("testArena", *this, &SerializationInfoTest::testArena);
+            registerMethod("testArenaIndex", *this, &SerializationInfoTest::testArenaIndex);
+            registerMethod("testArenaCopy", *this, &SerializationInfoTest::testArenaCopy);
         }
 
         void testSiSet()
@@ -441,6 +444,113 @@ class SerializationInfoTest : public cxxtools::unit::TestSuite
             CXXTOOLS_UNIT_ASSERT_NOTHROW(siValue<long>(si));
         }
 
+        void testArena()
+        {
+            cxxtools::SerializationArena arena;
+            cxxtools::SerializationInfo si(arena);
+
+            for (int n = 0; n < 100; ++n)
+            {
+                cxxtools::SerializationInfo& m = si.addMember();
+                m.addMember("value").setValue(n);
+                m.addMember("text").setValue("Hello");
+                m.addMember("wtext").setValue(cxxtools::String(L"42"));
+                m.setTypeName("element");
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(si.memberCount(), 100);
+            CXXTOOLS_UNIT_ASSERT(si.getMember(0).getMember("text").isString8());
+            CXXTOOLS_UNIT_ASSERT(si.getMember(0).getMember("wtext").isString());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember(99).getMember("value")), 99);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<std::string>(si.getMember(99).getMember("text")), "Hello");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember(99).getMember("wtext")), 42);
+            CXXTOOLS_UNIT_ASSERT(si.getMember(5).findMember("nothing") == 0);
+
+            // names are interned
+            CXXTOOLS_UNIT_ASSERT(&si.getMember(0).typeName() == &si.getMember(99).typeName());
+            CXXTOOLS_UNIT_ASSERT(&si.getMember(0).getMember("text").name() == &si.getMember(1).getMember("text").name());
+
+            // parents stay valid, when the members are moved
+            for (cxxtools::SerializationInfo::Iterator it = si.begin(); it != si.end(); ++it)
+            {
+                CXXTOOLS_UNIT_ASSERT(it->parent() == &si);
+                CXXTOOLS_UNIT_ASSERT(it->getMember("text").parent() == &*it);
+            }
+
+            si.clear();
+            arena.release();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(si.memberCount(), 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(arena.bytesUsed(), 0);
+
+            si.addMember("foo").setValue(5);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("foo")), 5);
+        }
+
+        void testArenaIndex()
+        {
+            cxxtools::SerializationArena arena;
+            cxxtools::SerializationInfo si(arena);
+
+            for (int n = 0; n < 1000; ++n)
+                si.addMember("m" + cxxtools::convert<std::string>(n)) <<= n;
+
+            si.addMember("m17") <<= -1;
+
+            for (int n = 0; n < 1000; ++n)
+            {
+                int v = -2;
+                CXXTOOLS_UNIT_ASSERT(si.getMember("m" + cxxtools::convert<std::string>(n), v));
+                CXXTOOLS_UNIT_ASSERT_EQUALS(v, n);
+            }
+
+            CXXTOOLS_UNIT_ASSERT(si.findMember("m1000") == 0);
+
+            // renaming a member invalidates the index
+            si.findMember("m20")->setName("renamed");
+            CXXTOOLS_UNIT_ASSERT(si.findMember("m20") == 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("renamed")), 20);
+
+            si.addMember("last") <<= 1;
+            CXXTOOLS_UNIT_ASSERT(si.findMember("m20") == 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("renamed")), 20);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("last")), 1);
+        }
+
+        void testArenaCopy()
+        {
+            cxxtools::SerializationArena arena;
+            cxxtools::SerializationInfo si(arena);
+            si.setTypeName("object");
+            si.addMember("a").setValue("Hello");
+            si.addMember("b").addMember("c").setValue(cxxtools::String(L"World"));
+
+            // copy from the arena to the heap
+            cxxtools::SerializationInfo heap(si);
+            CXXTOOLS_UNIT_ASSERT(heap.arena() == 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(heap.typeName(), "object");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<std::string>(heap.getMember("a")), "Hello");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<std::string>(heap.getMember("b").getMember("c")), "World");
+            CXXTOOLS_UNIT_ASSERT(heap.getMember("b").getMember("c").parent() == &heap.getMember("b"));
+
+            // copy from the heap to the arena
+            heap.addMember("d").setValue(3);
+            cxxtools::SerializationInfo& m = si.addMember("e");
+            m = heap;
+            CXXTOOLS_UNIT_ASSERT(m.parent() == &si);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(m.name(), "");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("").getMember("d")), 3);
+
+            // swap between arena and heap
+            cxxtools::SerializationInfo other;
+            other.setName("x");
+            other.setValue(17);
+            si.findMember("a")->swap(other);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(other.name(), "a");
+            CXXTOOLS_UNIT_ASSERT(other.isString8());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<std::string>(other), "Hello");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(siValue<int>(si.getMember("x")), 17);
+        }
+
 };
 
 cxxtools::unit::RegisterTest<SerializationInfoTest> register_SerializationInfoTest;
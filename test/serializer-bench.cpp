@@ -68,6 +68,16 @@ namespace
         si.setTypeName("TestObject");
     }
 
+    void operator<<= (cxxtools::ValueWriter& w, const TestObject& obj)
+    {
+        w.beginObject("TestObject");
+        w.addMember("intValue") <<= obj.intValue;
+        w.addMember("stringValue") <<= obj.stringValue;
+        w.addMember("doubleValue") <<= obj.doubleValue;
+        w.addMember("boolValue") <<= obj.boolValue;
+        w.finishObject();
+    }
+
     class JsonSerializer2 : public cxxtools::JsonSerializer
     {
         public:
@@ -88,6 +98,13 @@ namespace
                 cxxtools::JsonSerializer::serialize(v);
                 return *this;
             }
+
+            template <typename T>
+            JsonSerializer2& serializeDirect(const T& v, const std::string& name)
+            {
+                cxxtools::JsonSerializer::serializeDirect(v);
+                return *this;
+            }
     };
 }
 
@@ -114,8 +131,25 @@ void benchSerialization(const T& d, const char* fname = 0)
     deserializer.deserialize(v2);
     cxxtools::Timespan td = clock.stop();
 
+    // same again without building a SerializationInfo for the whole data
+    std::stringstream directData;
+    Serializer directSerializer(directData);
+    Deserializer directDeserializer(directData);
+
+    clock.start();
+    directSerializer.serializeDirect(d, "d");
+    directSerializer.finish();
+    cxxtools::Timespan tsd = clock.stop();
+
+    T v3;
+    clock.start();
+    directDeserializer.deserializeDirect(v3);
+    cxxtools::Timespan tdd = clock.stop();
+
     std::cout << "\tserialization: " << ts.toUSecs() / 1e6 << " sec\n"
                  "\tdeserialization: " << td.toUSecs() / 1e6 << " sec\n"
+                 "\tdirect serialization: " << tsd.toUSecs() / 1e6 << " sec\n"
+                 "\tdirect deserialization: " << tdd.toUSecs() / 1e6 << " sec\n"
                  "\tsize: " << data.str().size() << " bytes" << std::endl;
 }
 
@@ -0,0 +1,164 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/serviceregistry.h"
+#include "cxxtools/serializationinfo.h"
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include <sstream>
+
+class ServiceRegistryTest : public cxxtools::unit::TestSuite
+{
+        std::string _a;
+        std::string _b;
+
+        bool record(std::string a, std::string b)
+        {
+            _a = a;
+            _b = b;
+            return true;
+        }
+
+        bool other(std::string a, std::string b)
+        {
+            _a = "other";
+            return true;
+        }
+
+        static void call(cxxtools::ServiceProcedure* proc, const char* a, const char* b = 0)
+        {
+            cxxtools::IComposer** args = proc->beginCall();
+
+            cxxtools::SerializationInfo sa;
+            sa.setValue(a);
+            args[0]->fixup(sa);
+
+            if (b)
+            {
+                cxxtools::SerializationInfo sb;
+                sb.setValue(b);
+                args[1]->fixup(sb);
+            }
+
+            proc->endCall();
+        }
+
+    public:
+        ServiceRegistryTest()
+        : cxxtools::unit::TestSuite("serviceregistry")
+        {
+            registerMethod("testReuse", *this, &ServiceRegistryTest::testReuse);
+            registerMethod("testResetArguments", *this, &ServiceRegistryTest::testResetArguments);
+            registerMethod("testResolve", *this, &ServiceRegistryTest::testResolve);
+            registerMethod("testReplace", *this, &ServiceRegistryTest::testReplace);
+        }
+
+        void testReuse()
+        {
+            cxxtools::ServiceRegistry registry;
+            registry.registerMethod("record", *this, &ServiceRegistryTest::record);
+
+            cxxtools::ServiceProcedure* proc1 = registry.getProcedure("record");
+            CXXTOOLS_UNIT_ASSERT(proc1 != 0);
+            cxxtools::ServiceProcedure* proc2 = registry.getProcedure("record");
+            CXXTOOLS_UNIT_ASSERT(proc2 != 0);
+            CXXTOOLS_UNIT_ASSERT(proc1 != proc2);
+
+            registry.releaseProcedure(proc1);
+            cxxtools::ServiceProcedure* proc3 = registry.getProcedure("record");
+            CXXTOOLS_UNIT_ASSERT(proc3 == proc1);
+
+            registry.releaseProcedure(proc2);
+            registry.releaseProcedure(proc3);
+
+            CXXTOOLS_UNIT_ASSERT(registry.getProcedure("unknown") == 0);
+        }
+
+        void testResetArguments()
+        {
+            cxxtools::ServiceRegistry registry;
+            registry.registerMethod("record", *this, &ServiceRegistryTest::record);
+
+            cxxtools::ServiceProcedure* proc = registry.getProcedure("record");
+            call(proc, "foo", "bar");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_a, "foo");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_b, "bar");
+            registry.releaseProcedure(proc);
+
+            // the reused instance must not remember the last arguments
+            proc = registry.getProcedure("record");
+            call(proc, "baz");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_a, "baz");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_b, "");
+            registry.releaseProcedure(proc);
+        }
+
+        void testResolve()
+        {
+            cxxtools::ServiceRegistry registry;
+            for (unsigned n = 0; n < 100; ++n)
+            {
+                std::ostringstream name;
+                name << "record" << n;
+                registry.registerMethod(name.str(), *this, &ServiceRegistryTest::record);
+            }
+
+            CXXTOOLS_UNIT_ASSERT(registry.resolveProcedure("record") == 0);
+
+            const cxxtools::ServiceProcedurePool* pool = registry.resolveProcedure("record42");
+            CXXTOOLS_UNIT_ASSERT(pool != 0);
+            CXXTOOLS_UNIT_ASSERT(pool != registry.resolveProcedure("record43"));
+
+            cxxtools::ServiceProcedure* proc = registry.getProcedure(pool);
+            call(proc, "foo", "bar");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_a, "foo");
+            registry.releaseProcedure(proc);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(registry.getProcedureNames().size(), 100);
+        }
+
+        void testReplace()
+        {
+            cxxtools::ServiceRegistry registry;
+            registry.registerMethod("record", *this, &ServiceRegistryTest::record);
+
+            cxxtools::ServiceProcedure* proc1 = registry.getProcedure("record");
+            cxxtools::ServiceProcedure* proc2 = registry.getProcedure("record");
+            registry.releaseProcedure(proc1);
+
+            registry.registerMethod("record", *this, &ServiceRegistryTest::other);
+
+            // an instance of the replaced procedure is still in use
+            registry.releaseProcedure(proc2);
+
+            cxxtools::ServiceProcedure* proc = registry.getProcedure("record");
+            call(proc, "foo", "bar");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_a, "other");
+            registry.releaseProcedure(proc);
+        }
+};
+
+cxxtools::unit::RegisterTest<ServiceRegistryTest> register_ServiceRegistryTest;
@@ -0,0 +1,113 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <cxxtools/signal.h>
+#include <cxxtools/connectable.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+
+namespace
+{
+    class Receiver : public cxxtools::Connectable
+    {
+        public:
+            unsigned long sum;
+
+            Receiver()
+                : sum(0)
+                { }
+
+            void onValue(int n)
+            { sum += n; }
+    };
+
+    void bench(unsigned slots, unsigned n)
+    {
+        cxxtools::Signal<int> signal;
+        Receiver receiver;
+        for (unsigned s = 0; s < slots; ++s)
+            cxxtools::connect(signal, receiver, &Receiver::onValue);
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < n; ++i)
+            signal.send(static_cast<int>(i));
+
+        cxxtools::Timespan ts = clock.stop();
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << slots << " slots: " << secs << " sec, "
+                  << secs * 1e9 / n << " ns per send" << std::endl;
+    }
+
+    void benchConnect(unsigned n)
+    {
+        cxxtools::Signal<int> signal;
+        Receiver receiver;
+
+        cxxtools::Clock clock;
+        clock.start();
+
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::connect(signal, receiver, &Receiver::onValue);
+            cxxtools::disconnect(signal, receiver, &Receiver::onValue);
+        }
+
+        cxxtools::Timespan ts = clock.stop();
+
+        double secs = ts.toUSecs() / 1e6;
+        std::cout << "connect and disconnect: " << secs << " sec, "
+                  << secs * 1e9 / n << " ns per connection" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 10000000);
+        cxxtools::Arg<unsigned> maxSlots(argc, argv, 's', 8);
+
+        std::cout << "benchmark " << n.getValue() << " sends of a Signal<int>\n\n"
+                     "options:\n"
+                     "   -n <number>       number of sends\n"
+                     "   -s <number>       maximum number of slots (default: 8)\n" << std::endl;
+
+        bench(0, n);
+        for (unsigned slots = 1; slots <= maxSlots; slots *= 2)
+            bench(slots, n);
+
+        benchConnect(n / 10);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,277 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/signal.h"
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+
+namespace
+{
+    struct Receiver : public cxxtools::Connectable
+    {
+        int sum;
+
+        Receiver()
+        : sum(0)
+        { }
+
+        void add(int n)
+        { sum += n; }
+    };
+
+    // a slot with Size bytes of payload, which counts its instances
+    template <unsigned Size>
+    class PaddedSlot : public cxxtools::BasicSlot<void, int>
+    {
+            cxxtools::Method<void, Receiver, int> _method;
+            char _padding[Size];
+
+        public:
+            static int instances;
+
+            explicit PaddedSlot(Receiver& r)
+            : _method(r, &Receiver::add)
+            { ++instances; }
+
+            PaddedSlot(const PaddedSlot& s)
+            : cxxtools::BasicSlot<void, int>(),
+              _method(s._method)
+            { ++instances; }
+
+            ~PaddedSlot()
+            { --instances; }
+
+            Slot* clone() const
+            { return new PaddedSlot(*this); }
+
+            Slot* clone(void* buffer, std::size_t size) const
+            { return sizeof(PaddedSlot) <= size ? ::new (buffer) PaddedSlot(*this) : clone(); }
+
+            const void* callable() const
+            { return &_method; }
+
+            void onConnect(const cxxtools::Connection& c)
+            { _method.object().onConnectionOpen(c); }
+
+            void onDisconnect(const cxxtools::Connection& c)
+            { _method.object().onConnectionClose(c); }
+
+            bool equals(const Slot& slot) const
+            {
+                const PaddedSlot* ps = dynamic_cast<const PaddedSlot*>(&slot);
+                return ps ? (_method == ps->_method) : false;
+            }
+    };
+
+    template <unsigned Size>
+    int PaddedSlot<Size>::instances = 0;
+}
+
+class SignalTest : public cxxtools::unit::TestSuite
+{
+        int _sum;
+        unsigned _calls;
+        cxxtools::Signal<int>* _signal;
+        cxxtools::Connection _connection;
+
+        void add(int n)
+        {
+            _sum += n;
+            ++_calls;
+        }
+
+        void addTwice(int n)
+        {
+            _sum += 2 * n;
+            ++_calls;
+        }
+
+        void disconnectSelf(int n)
+        {
+            ++_calls;
+            _connection.close();
+        }
+
+        void connectMore(int n)
+        {
+            ++_calls;
+            if (_calls == 1)
+                _signal->connect(cxxtools::slot(*this, &SignalTest::add));
+        }
+
+        void deleteSignal(int n)
+        {
+            ++_calls;
+            delete _signal;
+            _signal = 0;
+        }
+
+    public:
+        SignalTest()
+        : cxxtools::unit::TestSuite("signal")
+        {
+            registerMethod("send", *this, &SignalTest::send);
+            registerMethod("disconnect", *this, &SignalTest::disconnect);
+            registerMethod("disconnectWhileSending", *this, &SignalTest::disconnectWhileSending);
+            registerMethod("connectWhileSending", *this, &SignalTest::connectWhileSending);
+            registerMethod("deleteWhileSending", *this, &SignalTest::deleteWhileSending);
+            registerMethod("receiverDeleted", *this, &SignalTest::receiverDeleted);
+            registerMethod("chain", *this, &SignalTest::chain);
+            registerMethod("slotStorage", *this, &SignalTest::slotStorage);
+        }
+
+        void setUp()
+        {
+            _sum = 0;
+            _calls = 0;
+        }
+
+        void send()
+        {
+            cxxtools::Signal<int> signal;
+            signal.send(1);
+
+            cxxtools::connect(signal, *this, &SignalTest::add);
+            signal.send(2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 2);
+
+            cxxtools::connect(signal, *this, &SignalTest::addTwice);
+            signal.send(3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 11);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_calls, 3);
+        }
+
+        void disconnect()
+        {
+            cxxtools::Signal<int> signal;
+            cxxtools::connect(signal, *this, &SignalTest::add);
+            cxxtools::connect(signal, *this, &SignalTest::addTwice);
+
+            cxxtools::disconnect(signal, *this, &SignalTest::add);
+            signal.send(1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 2);
+
+            cxxtools::disconnect(signal, *this, &SignalTest::addTwice);
+            signal.send(1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(signal.connectionCount(), 0);
+        }
+
+        void disconnectWhileSending()
+        {
+            cxxtools::Signal<int> signal;
+            _connection = cxxtools::connect(signal, *this, &SignalTest::disconnectSelf);
+            cxxtools::connect(signal, *this, &SignalTest::add);
+
+            signal.send(1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_calls, 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(signal.connectionCount(), 1);
+
+            signal.send(1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_calls, 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 2);
+        }
+
+        void connectWhileSending()
+        {
+            cxxtools::Signal<int> signal;
+            _signal = &signal;
+            cxxtools::connect(signal, *this, &SignalTest::connectMore);
+
+            // the new slot is called in the same send
+            signal.send(5);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_calls, 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 5);
+        }
+
+        void deleteWhileSending()
+        {
+            _signal = new cxxtools::Signal<int>();
+            cxxtools::connect(*_signal, *this, &SignalTest::deleteSignal);
+            cxxtools::connect(*_signal, *this, &SignalTest::add);
+
+            _signal->send(1);
+            CXXTOOLS_UNIT_ASSERT(_signal == 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_calls, 1);
+        }
+
+        void receiverDeleted()
+        {
+            cxxtools::Signal<int> signal;
+
+            {
+                Receiver receiver;
+                cxxtools::connect(signal, receiver, &Receiver::add);
+                cxxtools::connect(signal, *this, &SignalTest::add);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(signal.connectionCount(), 2);
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(signal.connectionCount(), 1);
+            signal.send(4);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 4);
+        }
+
+        void chain()
+        {
+            cxxtools::Signal<int> first;
+            cxxtools::Signal<int> second;
+            first.connect(cxxtools::slot(second));
+            cxxtools::connect(second, *this, &SignalTest::add);
+
+            first.send(7);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_sum, 7);
+        }
+
+        void slotStorage()
+        {
+            // small slots are kept inline in the connection, large ones on the heap
+            Receiver receiver;
+            {
+                cxxtools::Signal<int> signal;
+                PaddedSlot<1> small(receiver);
+                PaddedSlot<256> large(receiver);
+                signal.connect(small);
+                signal.connect(large);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(PaddedSlot<1>::instances, 2);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(PaddedSlot<256>::instances, 2);
+
+                signal.send(3);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(receiver.sum, 6);
+
+                signal.disconnect(small);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(PaddedSlot<1>::instances, 1);
+
+                signal.send(1);
+                CXXTOOLS_UNIT_ASSERT_EQUALS(receiver.sum, 7);
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(PaddedSlot<1>::instances, 0);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(PaddedSlot<256>::instances, 0);
+        }
+};
+
+cxxtools::unit::RegisterTest<SignalTest> register_SignalTest;
@@ -0,0 +1,218 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/taskpool.h"
+#include "cxxtools/method.h"
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    struct Square
+    {
+        std::vector<unsigned>& v;
+
+        explicit Square(std::vector<unsigned>& v_)
+            : v(v_)
+            { }
+
+        void operator() (std::size_t begin, std::size_t end) const
+        {
+            for (std::size_t n = begin; n < end; ++n)
+                v[n] = n * n;
+        }
+    };
+
+    struct Sum
+    {
+        unsigned long operator() (std::size_t begin, std::size_t end) const
+        {
+            unsigned long sum = 0;
+            for (std::size_t n = begin; n < end; ++n)
+                sum += n;
+            return sum;
+        }
+    };
+
+    struct Plus
+    {
+        unsigned long operator() (unsigned long a, unsigned long b) const
+        { return a + b; }
+    };
+
+    struct Concat
+    {
+        std::string operator() (std::size_t begin, std::size_t end) const
+        {
+            std::string s;
+            for (std::size_t n = begin; n < end; ++n)
+                s += static_cast<char>('a' + n);
+            return s;
+        }
+
+        std::string operator() (const std::string& a, const std::string& b) const
+        { return a + b; }
+    };
+
+    struct Fail
+    {
+        void operator() (std::size_t begin, std::size_t end) const
+        {
+            if (begin <= 50 && 50 < end)
+                throw std::runtime_error("fail at 50");
+        }
+    };
+}
+
+class TaskPoolTest : public cxxtools::unit::TestSuite
+{
+        cxxtools::TaskPool* _pool;
+        unsigned _depth;
+
+    public:
+        TaskPoolTest()
+            : cxxtools::unit::TestSuite("taskpool"),
+              _pool(0),
+              _depth(0)
+        {
+            registerMethod("testSubmit", *this, &TaskPoolTest::testSubmit);
+            registerMethod("testException", *this, &TaskPoolTest::testException);
+            registerMethod("testParallelFor", *this, &TaskPoolTest::testParallelFor);
+            registerMethod("testParallelForException", *this, &TaskPoolTest::testParallelForException);
+            registerMethod("testParallelReduce", *this, &TaskPoolTest::testParallelReduce);
+            registerMethod("testNested", *this, &TaskPoolTest::testNested);
+            registerMethod("testAffinity", *this, &TaskPoolTest::testAffinity);
+        }
+
+        void setUp()
+        {
+            _pool = new cxxtools::TaskPool(3);
+        }
+
+        void tearDown()
+        {
+            delete _pool;
+            _pool = 0;
+        }
+
+        int answer()
+        {
+            return 42;
+        }
+
+        int fail()
+        {
+            throw std::runtime_error("task failed");
+        }
+
+        void testSubmit()
+        {
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_pool->size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_pool->currentWorker(), -1);
+
+            std::vector<cxxtools::Future<int> > futures;
+            for (unsigned n = 0; n < 100; ++n)
+                futures.push_back(_pool->submit(cxxtools::callable(*this, &TaskPoolTest::answer)));
+
+            for (unsigned n = 0; n < futures.size(); ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(futures[n].get(), 42);
+        }
+
+        void testException()
+        {
+            cxxtools::Future<int> f = _pool->submit(cxxtools::callable(*this, &TaskPoolTest::fail));
+            CXXTOOLS_UNIT_ASSERT_THROW(f.get(), std::runtime_error);
+            CXXTOOLS_UNIT_ASSERT(f.ready());
+        }
+
+        void testParallelFor()
+        {
+            std::vector<unsigned> v(1000);
+            _pool->parallelFor(0, v.size(), Square(v));
+            for (unsigned n = 0; n < v.size(); ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(v[n], n * n);
+
+            // explicit grain size with a rest
+            std::vector<unsigned> w(100);
+            _pool->parallelFor(0, w.size(), Square(w), 7);
+            for (unsigned n = 0; n < w.size(); ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(w[n], n * n);
+        }
+
+        void testParallelForException()
+        {
+            CXXTOOLS_UNIT_ASSERT_THROW(_pool->parallelFor(0, 100, Fail(), 10), std::runtime_error);
+        }
+
+        void testParallelReduce()
+        {
+            Sum sum;
+            Plus plus;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_pool->parallelReduce(0, 10001, 0ul, sum, plus), 50005000ul);
+
+            // combined in index order
+            Concat concat;
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_pool->parallelReduce(0, 26, std::string(), concat, concat, 3),
+                "abcdefghijklmnopqrstuvwxyz");
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_pool->parallelReduce(5, 5, 7ul, sum, plus), 7ul);
+        }
+
+        unsigned long nested()
+        {
+            // tasks waiting for subtasks must not block the pool
+            return _pool->parallelReduce(0, 100, 0ul, Sum(), Plus(), 10);
+        }
+
+        void testNested()
+        {
+            std::vector<cxxtools::Future<unsigned long> > futures;
+            for (unsigned n = 0; n < 20; ++n)
+                futures.push_back(_pool->submit(cxxtools::callable(*this, &TaskPoolTest::nested)));
+
+            for (unsigned n = 0; n < futures.size(); ++n)
+                CXXTOOLS_UNIT_ASSERT_EQUALS(futures[n].get(), 4950ul);
+        }
+
+        int worker()
+        {
+            return _pool->currentWorker();
+        }
+
+        void testAffinity()
+        {
+            // affinity is just a hint, but a worker always reports itself
+            for (int n = 0; n < 6; ++n)
+            {
+                int w = _pool->submit(cxxtools::callable(*this, &TaskPoolTest::worker), n).get();
+                CXXTOOLS_UNIT_ASSERT(w >= 0 && w < 3);
+            }
+        }
+};
+
+cxxtools::unit::RegisterTest<TaskPoolTest> register_TaskPoolTest;
@@ -0,0 +1,271 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/eventloop.h"
+#include "cxxtools/timer.h"
+#include "cxxtools/clock.h"
+#include "cxxtools/log.h"
+#include <vector>
+
+log_define("cxxtools.test.timer")
+
+class TimerTest : public cxxtools::unit::TestSuite
+{
+        cxxtools::EventLoop* _loop;
+        std::vector<int> _fired;
+        cxxtools::Timer* _t1;
+        cxxtools::Timer* _t2;
+        cxxtools::Timer* _other;
+        unsigned _count;
+
+    public:
+        TimerTest()
+            : cxxtools::unit::TestSuite("timer"),
+              _loop(0),
+              _t1(0),
+              _t2(0),
+              _other(0),
+              _count(0)
+        {
+            registerMethod("testOrder", *this, &TimerTest::testOrder);
+            registerMethod("testNotEarly", *this, &TimerTest::testNotEarly);
+            registerMethod("testRestart", *this, &TimerTest::testRestart);
+            registerMethod("testStopOther", *this, &TimerTest::testStopOther);
+            registerMethod("testDeleteInHandler", *this, &TimerTest::testDeleteInHandler);
+            registerMethod("testManyTimers", *this, &TimerTest::testManyTimers);
+            registerMethod("testResolution", *this, &TimerTest::testResolution);
+        }
+
+        void setUp()
+        {
+            _loop = new cxxtools::EventLoop();
+            _fired.clear();
+            _other = 0;
+            _count = 0;
+        }
+
+        void tearDown()
+        {
+            delete _loop;
+            _loop = 0;
+        }
+
+        // timers are periodic, so t1 and t2 stop themself after the first timeout
+        void onTimer1()  { _fired.push_back(1); _t1->stop(); }
+        void onTimer2()  { _fired.push_back(2); _t2->stop(); }
+        void onTimer3()  { _fired.push_back(3); _loop->exit(); }
+
+        void onTimeout()
+        {
+            ++_count;
+        }
+
+        void onExit()
+        {
+            _loop->exit();
+        }
+
+        void testOrder()
+        {
+            cxxtools::Timer t1, t2, t3;
+            _t1 = &t1;
+            _t2 = &t2;
+            _loop->add(t1);
+            _loop->add(t2);
+            _loop->add(t3);
+
+            connect(t1.timeout, *this, &TimerTest::onTimer1);
+            connect(t2.timeout, *this, &TimerTest::onTimer2);
+            connect(t3.timeout, *this, &TimerTest::onTimer3);
+
+            t3.start(30);
+            t2.start(20);
+            t1.start(10);
+
+            _loop->run();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired.size(), 3);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired[0], 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired[1], 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired[2], 3);
+        }
+
+        void testNotEarly()
+        {
+            cxxtools::Timer timer;
+            _loop->add(timer);
+            connect(timer.timeout, *this, &TimerTest::onExit);
+
+            cxxtools::Clock clock;
+            clock.start();
+            timer.start(20);
+            _loop->run();
+            cxxtools::Timespan t = clock.stop();
+
+            log_debug("timer expired after " << t.totalUSecs() << "us");
+            CXXTOOLS_UNIT_ASSERT(t.totalMSecs() >= 20);
+        }
+
+        void onRestart()
+        {
+            if (++_count < 5)
+            {
+                _other->start(1);
+            }
+            else
+            {
+                _other->stop();
+                _loop->exit();
+            }
+        }
+
+        void testRestart()
+        {
+            cxxtools::Timer timer;
+            _other = &timer;
+            _loop->add(timer);
+            connect(timer.timeout, *this, &TimerTest::onRestart);
+
+            // restarting a running timer must not schedule it twice
+            timer.start(100);
+            timer.start(1);
+
+            _loop->run();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_count, 5);
+        }
+
+        void onStopOther()
+        {
+            _t1->stop();
+            _t2->stop();
+        }
+
+        void testStopOther()
+        {
+            cxxtools::Timer t1, t2, t3;
+            _t1 = &t1;
+            _t2 = &t2;
+            _loop->add(t1);
+            _loop->add(t2);
+            _loop->add(t3);
+
+            connect(t1.timeout, *this, &TimerTest::onStopOther);
+            connect(t2.timeout, *this, &TimerTest::onTimer2);
+            connect(t3.timeout, *this, &TimerTest::onTimer3);
+
+            // t1 and t2 expire in the same tick and are sent in the order
+            // they were started
+            t1.start(5);
+            t2.start(5);
+            t3.start(20);
+
+            _loop->run();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired.size(), 1);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_fired[0], 3);
+        }
+
+        void onDelete()
+        {
+            delete _other;
+            _other = 0;
+            ++_count;
+        }
+
+        void testDeleteInHandler()
+        {
+            cxxtools::Timer* timer = new cxxtools::Timer();
+            _other = timer;
+            _loop->add(*timer);
+            connect(timer->timeout, *this, &TimerTest::onDelete);
+
+            cxxtools::Timer t;
+            _loop->add(t);
+            connect(t.timeout, *this, &TimerTest::onExit);
+
+            timer->start(1);
+            t.start(20);
+
+            _loop->run();
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_count, 1);
+            CXXTOOLS_UNIT_ASSERT(_other == 0);
+        }
+
+        void testManyTimers()
+        {
+            // intervals up to 70 seconds put timers into the outer wheels
+            std::vector<cxxtools::Timer*> timers;
+            for (unsigned n = 0; n < 1000; ++n)
+            {
+                cxxtools::Timer* timer = new cxxtools::Timer();
+                _loop->add(*timer);
+                connect(timer->timeout, *this, &TimerTest::onTimeout);
+                timer->start(n < 10 ? 1 + n : 1000 + n * 70);
+                timers.push_back(timer);
+            }
+
+            cxxtools::Timer t;
+            _loop->add(t);
+            connect(t.timeout, *this, &TimerTest::onExit);
+            t.start(30);
+
+            _loop->run();
+
+            // the short timers are periodic and fire at least once
+            CXXTOOLS_UNIT_ASSERT(_count >= 10);
+
+            for (unsigned n = 10; n < timers.size(); ++n)
+                timers[n]->stop();
+
+            for (unsigned n = 0; n < timers.size(); ++n)
+                delete timers[n];
+        }
+
+        void testResolution()
+        {
+            _loop->setTimerResolution(cxxtools::Timespan(10000));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(_loop->timerResolution().totalMSecs(), 10);
+
+            cxxtools::Timer timer;
+            _loop->add(timer);
+            connect(timer.timeout, *this, &TimerTest::onExit);
+            timer.start(5);
+
+            cxxtools::Clock clock;
+            clock.start();
+            _loop->run();
+            cxxtools::Timespan t = clock.stop();
+
+            CXXTOOLS_UNIT_ASSERT(t.totalMSecs() >= 5);
+            CXXTOOLS_UNIT_ASSERT(t.totalMSecs() < 1000);
+        }
+};
+
+cxxtools::unit::RegisterTest<TimerTest> register_TimerTest;
@@ -0,0 +1,130 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <iostream>
+#include <string>
+#include <cxxtools/utf8codec.h>
+#include <cxxtools/string.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include "bench.h"
+
+namespace
+{
+    // repeats the text until it has at least size bytes
+    std::string corpus(const char* text, unsigned size)
+    {
+        std::string ret;
+        while (ret.size() < size)
+            ret += text;
+        return ret;
+    }
+
+    void bench(const char* name, const std::string& utf8, unsigned n)
+    {
+        std::cout << name << " (" << utf8.size() << " bytes):" << std::endl;
+
+        cxxtools::Utf8Codec codec(1);
+        cxxtools::String ustr = cxxtools::Utf8Codec::decode(utf8);
+        cxxtools::String decoded(ustr.size(), cxxtools::Char(' '));
+        std::string encoded(utf8.size(), ' ');
+        cxxtools::Clock clock;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::MBState state;
+            const char* fromNext;
+            cxxtools::Char* toNext;
+            codec.in(state, utf8.data(), utf8.data() + utf8.size(), fromNext,
+                     &decoded[0], &decoded[0] + decoded.size(), toNext);
+        }
+        report("decode", clock.stop(), utf8.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::MBState state;
+            const cxxtools::Char* fromNext;
+            char* toNext;
+            codec.out(state, ustr.data(), ustr.data() + ustr.size(), fromNext,
+                      &encoded[0], &encoded[0] + encoded.size(), toNext);
+        }
+        report("encode", clock.stop(), utf8.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+            cxxtools::Utf8Codec::decode(utf8);
+        report("Utf8Codec::decode", clock.stop(), utf8.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+            cxxtools::Utf8Codec::encode(ustr);
+        report("Utf8Codec::encode", clock.stop(), utf8.size(), n);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 1000);
+        cxxtools::Arg<unsigned> size(argc, argv, 's', 65536);
+
+        std::cout << "benchmark transcoding " << n.getValue() << " times " << size.getValue() << " bytes\n\n"
+                     "options:\n"
+                     "   -n <number>       number of iterations\n"
+                     "   -s <number>       size of text (default: 65536)\n" << std::endl;
+
+        bench("ascii", corpus("The quick brown fox jumps over the lazy dog. ", size), n);
+        bench("latin", corpus("Fran\xc3\xa7ois m\xc3\xb6" "chte gr\xc3\xbc\xc3\x9f" "e Stra\xc3\x9f" "en und \xc3\xa9t\xc3\xa9 sehen. ", size), n);
+        bench("cjk", corpus("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9\xe3\x83\x88\xe3\x80\x82", size), n);
+
+        std::string latin1 = corpus("The quick brown fox jumps over the lazy dog. \xe4\xf6\xfc", size);
+        cxxtools::String wide = cxxtools::String::widen(latin1);
+        cxxtools::Clock clock;
+
+        std::cout << "latin1 (" << latin1.size() << " bytes):" << std::endl;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+            cxxtools::String::widen(latin1);
+        report("String::widen", clock.stop(), latin1.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+            wide.narrow();
+        report("String::narrow", clock.stop(), latin1.size(), n);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
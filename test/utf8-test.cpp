@@ -30,6 +30,7 @@
 #include "cxxtools/unit/testsuite.h"
 #include "cxxtools/unit/registertest.h"
 #include "cxxtools/string.h"
+#include "cxxtools/conversionerror.h"
 
 class Utf8Test : public cxxtools::unit::TestSuite
 {
@@ -42,6 +43,9 @@ class Utf8Test : public cxxtools::unit::TestSuite
       registerMethod("decode", *this, &Utf8Test::decodeTest);
       registerMethod("byteordermark", *this, &Utf8Test::byteordermarkTest);
       registerMethod("incompleteBom", *this, &Utf8Test::incompleteBomTest);
+      registerMethod("longText", *this, &Utf8Test::longTextTest);
+      registerMethod("invalid", *this, &Utf8Test::invalidTest);
+      registerMethod("widenNarrow", *this, &Utf8Test::widenNarrowTest);
     }
 
     void encodeTest()
@@ -72,6 +76,69 @@ class Utf8Test : public cxxtools::unit::TestSuite
       CXXTOOLS_UNIT_ASSERT(ustr.empty());
     }
 
+    void longTextTest()
+    {
+      // runs of ascii characters of all lengths around the block sizes
+      // interrupted by 2, 3 and 4 byte sequences
+      static const char* const seqs[] = { "\xc3\xa4", "\xe6\x97\xa5", "\xf0\x9f\x98\x80" };
+      static const cxxtools::Char::value_type chars[] = { 0xe4, 0x65e5, 0x1f600 };
+
+      std::string bstr;
+      cxxtools::String expected;
+      for (unsigned n = 0; n < 70; ++n)
+      {
+        for (unsigned i = 0; i < n; ++i)
+        {
+          bstr += static_cast<char>('a' + i % 26);
+          expected += cxxtools::Char(static_cast<char>('a' + i % 26));
+        }
+
+        bstr += seqs[n % 3];
+        expected += cxxtools::Char(chars[n % 3]);
+      }
+
+      cxxtools::String ustr = cxxtools::Utf8Codec::decode(bstr);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ustr.size(), expected.size());
+      CXXTOOLS_UNIT_ASSERT(ustr == expected);
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(cxxtools::Utf8Codec::encode(ustr), bstr);
+    }
+
+    void invalidTest()
+    {
+      std::string bstr(40, 'a');
+      bstr += "\xff";
+      CXXTOOLS_UNIT_ASSERT_THROW(cxxtools::Utf8Codec::decode(bstr), cxxtools::ConversionError);
+
+      bstr = std::string(40, 'a') + "\xed\xa0\x80";  // surrogate
+      CXXTOOLS_UNIT_ASSERT_THROW(cxxtools::Utf8Codec::decode(bstr), cxxtools::ConversionError);
+
+      cxxtools::String ustr(40, cxxtools::Char('a'));
+      ustr += cxxtools::Char(0xd800);
+      CXXTOOLS_UNIT_ASSERT_THROW(cxxtools::Utf8Codec::encode(ustr), cxxtools::ConversionError);
+    }
+
+    void widenNarrowTest()
+    {
+      std::string bstr;
+      for (unsigned n = 0; n < 100; ++n)
+        bstr += static_cast<char>(n * 7 % 255 + 1);
+
+      cxxtools::String ustr = cxxtools::String::widen(bstr);
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ustr.size(), bstr.size());
+      for (unsigned n = 0; n < bstr.size(); ++n)
+        CXXTOOLS_UNIT_ASSERT_EQUALS(ustr[n].value(), static_cast<unsigned char>(bstr[n]));
+
+      CXXTOOLS_UNIT_ASSERT_EQUALS(ustr.narrow(), bstr);
+      CXXTOOLS_UNIT_ASSERT(cxxtools::String::widen(bstr.c_str()) == ustr);
+
+      ustr[50] = cxxtools::Char(0x1234);
+      std::string narrowed = ustr.narrow('?');
+      CXXTOOLS_UNIT_ASSERT_EQUALS(narrowed.size(), bstr.size());
+      CXXTOOLS_UNIT_ASSERT_EQUALS(narrowed[50], '?');
+      CXXTOOLS_UNIT_ASSERT_EQUALS(narrowed.substr(51), bstr.substr(51));
+    }
+
 };
 
 cxxtools::unit::RegisterTest<Utf8Test> register_Utf8Test;
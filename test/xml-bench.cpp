@@ -0,0 +1,151 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cxxtools/xml/xmlreader.h>
+#include <cxxtools/xml/xmltokenizer.h>
+#include <cxxtools/xml/xmlserializer.h>
+#include <cxxtools/xml/xmldeserializer.h>
+#include <cxxtools/serializationinfo.h>
+#include <cxxtools/arg.h>
+#include <cxxtools/clock.h>
+#include <cxxtools/log.h>
+#include "bench.h"
+
+namespace
+{
+    struct Item
+    {
+        int id;
+        std::string name;
+        double price;
+        bool available;
+    };
+
+    void operator>>= (const cxxtools::SerializationInfo& si, Item& item)
+    {
+        si.getMember("id") >>= item.id;
+        si.getMember("name") >>= item.name;
+        si.getMember("price") >>= item.price;
+        si.getMember("available") >>= item.available;
+    }
+
+    void operator<<= (cxxtools::SerializationInfo& si, const Item& item)
+    {
+        si.addMember("id") <<= item.id;
+        si.addMember("name") <<= item.name;
+        si.addMember("price") <<= item.price;
+        si.addMember("available") <<= item.available;
+        si.setTypeName("Item");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        log_init();
+
+        cxxtools::Arg<unsigned> n(argc, argv, 'n', 100);
+        cxxtools::Arg<unsigned> items(argc, argv, 'i', 1000);
+
+        std::cout << "benchmark xml parsing " << n.getValue() << " times " << items.getValue() << " items\n\n"
+                     "options:\n"
+                     "   -n <number>       number of iterations\n"
+                     "   -i <number>       number of items in the document (default: 1000)\n" << std::endl;
+
+        std::vector<Item> v(items);
+        for (unsigned i = 0; i < v.size(); ++i)
+        {
+            v[i].id = i;
+            v[i].name = "item & <name>";
+            v[i].price = i * 1.25;
+            v[i].available = i % 2;
+        }
+
+        std::ostringstream s;
+        cxxtools::xml::XmlSerializer serializer(s);
+        serializer.serialize(v, "items");
+        serializer.finish();
+
+        const std::string xml = s.str();
+        std::cout << "document size " << xml.size() << " bytes" << std::endl;
+
+        cxxtools::Clock clock;
+        unsigned count = 0;
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::istringstream in(xml);
+            cxxtools::xml::XmlReader reader(in);
+            while (reader.get().type() != cxxtools::xml::Node::EndDocument)
+            {
+                reader.next();
+                ++count;
+            }
+        }
+        report("XmlReader", clock.stop(), xml.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+            while (tok.next() != cxxtools::xml::Node::EndDocument)
+                ++count;
+        }
+        report("XmlTokenizer", clock.stop(), xml.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            std::istringstream in(xml);
+            std::vector<Item> result;
+            cxxtools::xml::XmlDeserializer deserializer(in);
+            deserializer.deserialize(result);
+        }
+        report("XmlDeserializer with XmlReader", clock.stop(), xml.size(), n);
+
+        clock.start();
+        for (unsigned i = 0; i < n; ++i)
+        {
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+            std::vector<Item> result;
+            cxxtools::xml::XmlDeserializer deserializer(tok);
+            deserializer.deserialize(result);
+        }
+        report("XmlDeserializer with XmlTokenizer", clock.stop(), xml.size(), n);
+
+        std::cout << count << " events" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
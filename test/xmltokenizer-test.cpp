@@ -0,0 +1,254 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * As a special exception, you may use this file as part of a free
+ * software library without restriction. Specifically, if other files
+ * instantiate templates or use macros or inline functions from this
+ * file, or you compile this file and link it with other files to
+ * produce an executable, this file does not by itself cause the
+ * resulting executable to be covered by the GNU General Public
+ * License. This exception does not however invalidate any other
+ * reasons why the executable file might be covered by the GNU Library
+ * General Public License.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "cxxtools/unit/testsuite.h"
+#include "cxxtools/unit/registertest.h"
+#include "cxxtools/xml/xmltokenizer.h"
+#include "cxxtools/xml/xmlerror.h"
+#include "cxxtools/xml/xmlserializer.h"
+#include "cxxtools/xml/xmldeserializer.h"
+#include "cxxtools/xmlrpc/scanner.h"
+#include "cxxtools/deserializerbase.h"
+#include "cxxtools/composer.h"
+#include "cxxtools/serializationinfo.h"
+#include <sstream>
+#include <map>
+#include <vector>
+
+namespace
+{
+    struct Point
+    {
+        int a;
+        int b;
+    };
+
+    void operator>>= (const cxxtools::SerializationInfo& si, Point& p)
+    {
+        si.getMember("a") >>= p.a;
+        si.getMember("b") >>= p.b;
+    }
+
+    void parseAll(cxxtools::xml::XmlTokenizer& tok)
+    {
+        while (tok.next() != cxxtools::xml::Node::EndDocument)
+            ;
+    }
+}
+
+class XmlTokenizerTest : public cxxtools::unit::TestSuite
+{
+    public:
+        XmlTokenizerTest()
+        : cxxtools::unit::TestSuite("xmltokenizer")
+        {
+            registerMethod("events", *this, &XmlTokenizerTest::events);
+            registerMethod("symbols", *this, &XmlTokenizerTest::symbols);
+            registerMethod("entities", *this, &XmlTokenizerTest::entities);
+            registerMethod("errors", *this, &XmlTokenizerTest::errors);
+            registerMethod("deserialize", *this, &XmlTokenizerTest::deserialize);
+            registerMethod("xmlrpcScanner", *this, &XmlTokenizerTest::xmlrpcScanner);
+        }
+
+        void events()
+        {
+            const std::string xml =
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<!DOCTYPE doc [ <!ENTITY e \"x>y\"> ]>\n"
+                "<!-- comment -->\n"
+                "<doc a=\"1\" b='two'><item/>text<?pi data?></doc>\n";
+
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.type(), cxxtools::xml::Node::StartDocument);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::StartElement);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.symbols().name(tok.name()), "doc");
+            CXXTOOLS_UNIT_ASSERT(tok.nameString() == L"doc");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.attributes().size(), 2);
+            CXXTOOLS_UNIT_ASSERT(tok.attribute("a") == "1");
+            CXXTOOLS_UNIT_ASSERT(tok.attribute("b") == "two");
+            CXXTOOLS_UNIT_ASSERT(tok.attribute("c").empty());
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.depth(), 1);
+
+            // values without entities are views into the input
+            const char* a = tok.attribute("a").data();
+            CXXTOOLS_UNIT_ASSERT(a > xml.data() && a < xml.data() + xml.size());
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::StartElement);
+            CXXTOOLS_UNIT_ASSERT(tok.nameString() == L"item");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.depth(), 2);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::EndElement);
+            CXXTOOLS_UNIT_ASSERT(tok.nameString() == L"item");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.depth(), 1);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::Characters);
+            CXXTOOLS_UNIT_ASSERT(tok.text() == "text");
+            CXXTOOLS_UNIT_ASSERT(tok.text().data() > xml.data() && tok.text().data() < xml.data() + xml.size());
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::EndElement);
+            CXXTOOLS_UNIT_ASSERT(tok.nameString() == L"doc");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.depth(), 0);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::EndDocument);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::EndDocument);
+        }
+
+        void symbols()
+        {
+            cxxtools::xml::XmlSymbolTable symbols;
+            cxxtools::xml::XmlSymbol value = symbols.intern("value");
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.find("member"), cxxtools::xml::XmlSymbolTable::none);
+
+            for (unsigned n = 0; n < 1000; ++n)
+            {
+                std::ostringstream s;
+                s << "name" << n;
+                symbols.intern(s.str());
+            }
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.size(), 1001);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.intern("value"), value);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.find("name500"), symbols.intern("name500"));
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.name(symbols.find("name999")), "name999");
+
+            // a shared table gives the same ids in every document
+            std::string xml = "<value><value/></value>";
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size(), symbols);
+            tok.next();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.name(), value);
+            tok.next();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.name(), value);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(symbols.size(), 1001);
+        }
+
+        void entities()
+        {
+            std::istringstream in(
+                "<a v=\"x &amp; y\" w=\"&lt;&gt;\">1 &lt; 2 <![CDATA[<&>]]> &#x41;&#66;&auml;&quot;&apos;</a>");
+            cxxtools::xml::XmlTokenizer tok(in);
+
+            tok.next();
+            CXXTOOLS_UNIT_ASSERT(tok.attribute("v") == "x & y");
+            CXXTOOLS_UNIT_ASSERT(tok.attribute("w") == "<>");
+
+            tok.next();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.type(), cxxtools::xml::Node::Characters);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.text().str(), "1 < 2 <&> AB\xc3\xa4\"'");
+
+            cxxtools::String s = tok.text().toString();
+            CXXTOOLS_UNIT_ASSERT_EQUALS(s.size(), 15);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(s[12].value(), 0xe4);
+
+            CXXTOOLS_UNIT_ASSERT_EQUALS(tok.next(), cxxtools::xml::Node::EndElement);
+        }
+
+        void errors()
+        {
+            const char* docs[] = {
+                "<a></b>",
+                "<a>",
+                "<a x=1></a>",
+                "<a x=\"1></a>",
+                "text<a/>",
+                "<a/>text",
+                "<a>&lt</a>",
+                "<a><!-- x </a>",
+                0
+            };
+
+            for (unsigned n = 0; docs[n]; ++n)
+            {
+                std::string xml = docs[n];
+                cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+                CXXTOOLS_UNIT_ASSERT_THROW(parseAll(tok), cxxtools::xml::XmlError);
+            }
+
+            std::string xml = "<a>\n<b>\n</c>";
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+            try
+            {
+                parseAll(tok);
+                CXXTOOLS_UNIT_FAIL("XmlError expected");
+            }
+            catch (const cxxtools::xml::XmlError& e)
+            {
+                CXXTOOLS_UNIT_ASSERT_EQUALS(e.line(), 3);
+            }
+        }
+
+        void deserialize()
+        {
+            std::map<std::string, std::vector<int> > data;
+            data["a < b"].push_back(1);
+            data["a < b"].push_back(-2);
+            data["c"].push_back(42);
+
+            std::stringstream s;
+            cxxtools::xml::XmlSerializer serializer(s);
+            serializer.serialize(data, "data");
+            serializer.finish();
+
+            std::map<std::string, std::vector<int> > result;
+            cxxtools::xml::XmlTokenizer tok(s);
+            cxxtools::xml::XmlDeserializer deserializer(tok);
+            deserializer.deserialize(result);
+
+            CXXTOOLS_UNIT_ASSERT(result == data);
+        }
+
+        void xmlrpcScanner()
+        {
+            const std::string xml =
+                "<params><param><value><struct>"
+                "<member><name>a</name><value><int>5</int></value></member>"
+                "<member><name>b</name><value><i4>-7</i4></value></member>"
+                "</struct></value></param></params>";
+
+            cxxtools::xml::XmlTokenizer tok(xml.data(), xml.size());
+            tok.next();
+            tok.next();
+            CXXTOOLS_UNIT_ASSERT(tok.nameString() == L"param");
+
+            Point result;
+            cxxtools::DeserializerBase deserializer;
+            cxxtools::Composer<Point> composer;
+            composer.begin(result);
+
+            cxxtools::xmlrpc::Scanner scanner;
+            scanner.begin(deserializer, composer);
+
+            bool finished = false;
+            while (!finished && tok.next() != cxxtools::xml::Node::EndDocument)
+                finished = scanner.advance(tok);
+
+            CXXTOOLS_UNIT_ASSERT(finished);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(result.a, 5);
+            CXXTOOLS_UNIT_ASSERT_EQUALS(result.b, -7);
+        }
+};
+
+cxxtools::unit::RegisterTest<XmlTokenizerTest> register_XmlTokenizerTest;